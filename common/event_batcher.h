@@ -0,0 +1,241 @@
+#ifndef EVENT_BATCHER_H_
+#define EVENT_BATCHER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+namespace flutter_mcp {
+
+struct EventBatchingConfig {
+  bool enabled = false;
+  // A type's buffer is flushed as soon as it holds this many events...
+  size_t max_batch_size = 32;
+  // ...or once its oldest event has waited this long.
+  int64_t max_delay_ms = 16;
+  // Keep only the latest of consecutive coalescible events (periodic ticks).
+  bool coalesce_periodic = false;
+};
+
+// Buffers outgoing events per type and flushes each buffer as one list.
+//
+// |Value| is the platform's event payload type and only needs to be
+// movable. Flushes are delivered outside the buffer lock but serialized,
+// so events of one type always arrive in the order they were added.
+template <typename Value>
+class EventBatcher {
+ public:
+  using Clock = std::chrono::steady_clock;
+  // Receives the event type, the batched payloads and how many coalescible
+  // events were folded into the ones kept.
+  using FlushCallback = std::function<void(const std::string& type,
+                                           std::vector<Value>&& events,
+                                           size_t coalesced)>;
+
+  explicit EventBatcher(FlushCallback flush)
+      : flush_(std::move(flush)), stopping_(false) {}
+
+  ~EventBatcher() {
+    StopTimer();
+    FlushAll();
+  }
+
+  EventBatcher(const EventBatcher&) = delete;
+  EventBatcher& operator=(const EventBatcher&) = delete;
+
+  void Configure(const EventBatchingConfig& config) {
+    bool enabled;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      config_ = config;
+      if (config_.max_batch_size == 0) {
+        config_.max_batch_size = 1;
+      }
+      if (config_.max_delay_ms < 0) {
+        config_.max_delay_ms = 0;
+      }
+      enabled = config_.enabled;
+      if (enabled && !timer_thread_.joinable()) {
+        stopping_ = false;
+        timer_thread_ = std::thread(&EventBatcher::RunTimer, this);
+      }
+    }
+    cv_.notify_all();
+
+    if (!enabled) {
+      StopTimer();
+      // Nothing may stay buffered once batching is switched off.
+      FlushAll();
+    }
+  }
+
+  bool enabled() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_.enabled;
+  }
+
+  // Buffers |value| and returns true, or returns false and leaves |value|
+  // untouched when batching is disabled so the caller can deliver it.
+  bool Add(const std::string& type, Value&& value, bool coalescible) {
+    bool full = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!config_.enabled) {
+        return false;
+      }
+
+      Buffer& buffer = buffers_[type];
+      if (buffer.events.empty()) {
+        buffer.first_added = Clock::now();
+        buffer.coalescible_index = -1;
+        cv_.notify_one();
+      }
+
+      if (coalescible && config_.coalesce_periodic &&
+          buffer.coalescible_index >= 0 &&
+          buffer.coalescible_index ==
+              static_cast<int64_t>(buffer.events.size()) - 1) {
+        // Replace the previous tick rather than queueing another one.
+        buffer.events.back() = std::move(value);
+        buffer.coalesced++;
+      } else {
+        buffer.events.push_back(std::move(value));
+        buffer.coalescible_index =
+            coalescible ? static_cast<int64_t>(buffer.events.size()) - 1 : -1;
+      }
+      full = buffer.events.size() >= config_.max_batch_size;
+    }
+
+    if (full) {
+      Flush(type);
+    }
+    return true;
+  }
+
+  void FlushAll() {
+    std::lock_guard<std::mutex> delivery_lock(delivery_mutex_);
+    std::vector<std::pair<std::string, Buffer>> ready;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (auto& entry : buffers_) {
+        if (!entry.second.events.empty()) {
+          ready.emplace_back(entry.first, std::move(entry.second));
+          entry.second = Buffer();
+        }
+      }
+    }
+    Deliver(ready);
+  }
+
+ private:
+  struct Buffer {
+    std::vector<Value> events;
+    Clock::time_point first_added;
+    size_t coalesced = 0;
+    int64_t coalescible_index = -1;
+  };
+
+  void Flush(const std::string& type) {
+    std::lock_guard<std::mutex> delivery_lock(delivery_mutex_);
+    std::vector<std::pair<std::string, Buffer>> ready;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = buffers_.find(type);
+      if (it == buffers_.end() || it->second.events.empty()) {
+        return;
+      }
+      ready.emplace_back(it->first, std::move(it->second));
+      it->second = Buffer();
+    }
+    Deliver(ready);
+  }
+
+  void Deliver(std::vector<std::pair<std::string, Buffer>>& ready) {
+    for (auto& entry : ready) {
+      if (flush_) {
+        flush_(entry.first, std::move(entry.second.events),
+               entry.second.coalesced);
+      }
+    }
+  }
+
+  void StopTimer() {
+    std::thread thread;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+      thread = std::move(timer_thread_);
+    }
+    cv_.notify_all();
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  void RunTimer() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+      // Find the buffer whose oldest event expires first.
+      bool have_deadline = false;
+      Clock::time_point next_deadline;
+      const auto max_delay = std::chrono::milliseconds(config_.max_delay_ms);
+      for (const auto& entry : buffers_) {
+        if (entry.second.events.empty()) {
+          continue;
+        }
+        Clock::time_point deadline = entry.second.first_added + max_delay;
+        if (!have_deadline || deadline < next_deadline) {
+          next_deadline = deadline;
+          have_deadline = true;
+        }
+      }
+
+      if (!have_deadline) {
+        cv_.wait(lock);
+        continue;
+      }
+      if (next_deadline > Clock::now()) {
+        cv_.wait_until(lock, next_deadline);
+        continue;
+      }
+
+      std::vector<std::string> expired;
+      const auto now = Clock::now();
+      for (const auto& entry : buffers_) {
+        if (!entry.second.events.empty() &&
+            entry.second.first_added + max_delay <= now) {
+          expired.push_back(entry.first);
+        }
+      }
+
+      lock.unlock();
+      for (const auto& type : expired) {
+        Flush(type);
+      }
+      lock.lock();
+    }
+  }
+
+  FlushCallback flush_;
+  EventBatchingConfig config_;
+  std::unordered_map<std::string, Buffer> buffers_;
+
+  std::mutex mutex_;
+  std::mutex delivery_mutex_;
+  std::condition_variable cv_;
+  std::thread timer_thread_;
+  bool stopping_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // EVENT_BATCHER_H_
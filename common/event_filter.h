@@ -0,0 +1,102 @@
+#ifndef EVENT_FILTER_H_
+#define EVENT_FILTER_H_
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+namespace flutter_mcp {
+
+// Which event types a Dart listener subscribed to, and at what rate.
+struct EventSubscription {
+  // When false only the types in |rates| are sent.
+  bool all_types = true;
+  // Fraction of events of a type to send, in (0, 1]; types not listed send
+  // every event. A rate of 0 or less sends none.
+  std::unordered_map<std::string, double> rates;
+};
+
+// Decides, before an event is built, whether it reaches Dart at all.
+//
+// Sampling is deterministic: at rate r the n-th event of a type is sent
+// whenever floor(n * r) steps up, so a rate of 0.25 sends every fourth
+// event. Admit() is safe from any thread and never waits on Subscribe(),
+// but its shared_ptr snapshot goes through the standard library's atomic
+// shared_ptr support, which takes a short internal lock on common
+// implementations. Subscribe() swaps in a new subscription atomically and
+// restarts every type's count.
+class EventFilter {
+ public:
+  EventFilter() : rules_(std::make_shared<const Rules>()) {}
+
+  EventFilter(const EventFilter&) = delete;
+  EventFilter& operator=(const EventFilter&) = delete;
+
+  void Subscribe(const EventSubscription& subscription) {
+    auto rules = std::make_shared<Rules>();
+    rules->all_types = subscription.all_types;
+    for (const auto& entry : subscription.rates) {
+      rules->types.emplace(entry.first, std::unique_ptr<Rule>(new Rule(entry.second)));
+    }
+    std::atomic_store(&rules_, std::shared_ptr<const Rules>(std::move(rules)));
+  }
+
+  // Back to sending every event.
+  void Reset() { Subscribe(EventSubscription()); }
+
+  // Consumes one event of |type|; true if it should be sent.
+  bool Admit(const char* type) {
+    const std::shared_ptr<const Rules> rules = std::atomic_load(&rules_);
+    if (rules->types.empty() && rules->all_types) {
+      return true;
+    }
+    auto it = rules->types.find(type);
+    const bool admitted = it == rules->types.end() ? rules->all_types : it->second->Admit();
+    if (!admitted) {
+      filtered_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return admitted;
+  }
+
+  // Events rejected since the filter was created.
+  uint64_t filtered() const { return filtered_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Rule {
+    explicit Rule(double sample_rate) : rate(sample_rate), seen(0) {}
+
+    bool Admit() {
+      if (rate >= 1.0) {
+        return true;
+      }
+      if (rate <= 0.0) {
+        return false;
+      }
+      const uint64_t n = seen.fetch_add(1, std::memory_order_relaxed);
+      return std::floor(static_cast<double>(n + 1) * rate) >
+             std::floor(static_cast<double>(n) * rate);
+    }
+
+    const double rate;
+    std::atomic<uint64_t> seen;
+  };
+
+  struct Rules {
+    bool all_types = true;
+    // Rules are reached through a const snapshot but count as they admit.
+    std::unordered_map<std::string, std::unique_ptr<Rule>> types;
+  };
+
+  std::shared_ptr<const Rules> rules_;
+  std::atomic<uint64_t> filtered_{0};
+};
+
+}  // namespace flutter_mcp
+
+#endif  // EVENT_FILTER_H_
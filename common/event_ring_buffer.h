@@ -0,0 +1,126 @@
+#ifndef EVENT_RING_BUFFER_H_
+#define EVENT_RING_BUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+namespace flutter_mcp {
+
+// What a producer does when the event ring buffer is full.
+enum class OverflowPolicy { kDropOldest, kDropNewest, kBlock };
+
+// Parses "dropOldest"/"dropNewest"/"block"; anything else maps to kDropOldest.
+inline OverflowPolicy ParseOverflowPolicy(const std::string& name) {
+  if (name == "dropNewest") {
+    return OverflowPolicy::kDropNewest;
+  }
+  if (name == "block") {
+    return OverflowPolicy::kBlock;
+  }
+  return OverflowPolicy::kDropOldest;
+}
+
+// Bounded lock-free ring buffer (Vyukov's MPMC queue).
+//
+// Each cell carries a sequence number that tells producers and consumers
+// whether it is free or filled for their lap, so TryPush/TryPop only CAS
+// their own position counter. Any thread may pop, which lets a producer
+// evict the oldest entry when applying a drop-oldest policy.
+template <typename T>
+class EventRingBuffer {
+ public:
+  // |capacity| is rounded up to a power of two.
+  explicit EventRingBuffer(size_t capacity)
+      : capacity_(RoundUpToPowerOfTwo(capacity)),
+        mask_(capacity_ - 1),
+        cells_(new Cell[capacity_]),
+        enqueue_pos_(0),
+        dequeue_pos_(0) {
+    for (size_t i = 0; i < capacity_; i++) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  EventRingBuffer(const EventRingBuffer&) = delete;
+  EventRingBuffer& operator=(const EventRingBuffer&) = delete;
+
+  // Returns false and leaves |value| untouched when the buffer is full.
+  bool TryPush(T&& value) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->value = std::move(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool TryPop(T& value) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    value = std::move(cell->value);
+    // Release whatever the moved-from value still holds before reuse.
+    cell->value = T();
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t capacity() const { return capacity_; }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  static size_t RoundUpToPowerOfTwo(size_t value) {
+    size_t result = 2;
+    while (result < value) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  // Keep producer and consumer positions on separate cache lines.
+  alignas(64) std::atomic<size_t> enqueue_pos_;
+  alignas(64) std::atomic<size_t> dequeue_pos_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // EVENT_RING_BUFFER_H_
@@ -0,0 +1,25 @@
+# The platform-neutral core shared by the Linux and Windows plugins: the
+# timer-heap TaskScheduler and its WorkerPool. The rest of common/ is
+# header-only and reaches each target through the include directory.
+#
+# Included from each platform's CMakeLists.txt after apply_standard_settings
+# is available. Targets that need their own instrumentation (the stress
+# tests' sanitizers) compile FLUTTER_MCP_CORE_SOURCES directly instead of
+# linking the library.
+set(FLUTTER_MCP_CORE_DIR "${CMAKE_CURRENT_LIST_DIR}")
+set(FLUTTER_MCP_CORE_SOURCES
+  "${FLUTTER_MCP_CORE_DIR}/task_scheduler.cc"
+  "${FLUTTER_MCP_CORE_DIR}/worker_pool.cc"
+)
+
+if(NOT TARGET flutter_mcp_core)
+  add_library(flutter_mcp_core STATIC ${FLUTTER_MCP_CORE_SOURCES})
+  apply_standard_settings(flutter_mcp_core)
+  # Linked into the plugin's shared library.
+  set_target_properties(flutter_mcp_core PROPERTIES
+    POSITION_INDEPENDENT_CODE ON
+    CXX_VISIBILITY_PRESET hidden)
+  target_include_directories(flutter_mcp_core PUBLIC "${FLUTTER_MCP_CORE_DIR}")
+  find_package(Threads REQUIRED)
+  target_link_libraries(flutter_mcp_core PUBLIC Threads::Threads)
+endif()
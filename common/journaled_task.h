@@ -0,0 +1,178 @@
+#ifndef JOURNALED_TASK_H_
+#define JOURNALED_TASK_H_
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+
+#include "recurrence.h"
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+namespace flutter_mcp {
+
+// What replay does with a task whose due time passed while the app was not
+// running.
+enum class OverduePolicy {
+  // Run it as soon as the scheduler starts.
+  kFire,
+  // Drop a one-shot task; move a recurring one to its next slot ahead.
+  kSkip,
+};
+
+// "skip" selects kSkip; anything else kFire.
+inline OverduePolicy ParseOverduePolicy(const char* name) {
+  return name && std::strcmp(name, "skip") == 0 ? OverduePolicy::kSkip : OverduePolicy::kFire;
+}
+
+// A Dart-scheduled task as kept in the task journal, keyed by its id.
+// Times are wall-clock milliseconds since the Unix epoch, since the
+// monotonic clock does not survive a restart.
+struct JournaledTask {
+  // When a one-shot task is due, or a recurring job's first nominal run.
+  int64_t due_unix_ms = 0;
+  // A TaskPriority value.
+  uint8_t priority = 1;
+  bool recurring = false;
+  Recurrence recurrence;
+};
+
+// Journal key holding the overdue policy, which replay needs before Dart
+// can configure anything. Task ids never start with \x1f.
+constexpr char kJournalPolicyKey[] = "\x1fpolicy";
+
+namespace journaled_task_internal {
+
+constexpr uint8_t kVersion = 1;
+constexpr uint8_t kRecurringFlag = 1;
+
+inline void PutInt64(std::string* out, int64_t value) {
+  const uint64_t bits = static_cast<uint64_t>(value);
+  for (int i = 0; i < 8; i++) {
+    out->push_back(static_cast<char>((bits >> (8 * i)) & 0xff));
+  }
+}
+
+inline int64_t GetInt64(const uint8_t* data) {
+  uint64_t bits = 0;
+  for (int i = 7; i >= 0; i--) {
+    bits = (bits << 8) | data[i];
+  }
+  return static_cast<int64_t>(bits);
+}
+
+}  // namespace journaled_task_internal
+
+// Little-endian and fixed-width, so the journal reads back the same on
+// every build.
+inline std::string EncodeJournaledTask(const JournaledTask& task) {
+  using namespace journaled_task_internal;
+  std::string out;
+  out.push_back(static_cast<char>(kVersion));
+  PutInt64(&out, task.due_unix_ms);
+  out.push_back(static_cast<char>(task.priority));
+  out.push_back(static_cast<char>(task.recurring ? kRecurringFlag : 0));
+  if (task.recurring) {
+    PutInt64(&out, task.recurrence.period_ms);
+    PutInt64(&out, task.recurrence.jitter_ms);
+    out.push_back(static_cast<char>(task.recurrence.mode));
+    out.push_back(static_cast<char>(task.recurrence.overrun));
+  }
+  return out;
+}
+
+// Returns false for a value this version cannot read.
+inline bool DecodeJournaledTask(const uint8_t* data, size_t length, JournaledTask* task) {
+  using namespace journaled_task_internal;
+  if (length < 11 || data[0] != kVersion || data[9] > 2) {
+    return false;
+  }
+  task->due_unix_ms = GetInt64(data + 1);
+  task->priority = data[9];
+  task->recurring = (data[10] & kRecurringFlag) != 0;
+  if (!task->recurring) {
+    return length == 11;
+  }
+  if (length != 29 || data[27] > 1 || data[28] > 1) {
+    return false;
+  }
+  task->recurrence.period_ms = GetInt64(data + 11);
+  task->recurrence.jitter_ms = GetInt64(data + 19);
+  task->recurrence.mode = static_cast<RecurrenceMode>(data[27]);
+  task->recurrence.overrun = static_cast<OverrunPolicy>(data[28]);
+  return true;
+}
+
+// Works out how long after |now_unix_ms| a replayed task should first run.
+// Returns false when |policy| drops it.
+inline bool PlanReplay(const JournaledTask& task, int64_t now_unix_ms,
+                       OverduePolicy policy, int64_t* delay_ms) {
+  const int64_t remaining = task.due_unix_ms - now_unix_ms;
+  if (remaining >= 0) {
+    *delay_ms = remaining;
+    return true;
+  }
+  if (policy == OverduePolicy::kFire) {
+    *delay_ms = 0;
+    return true;
+  }
+  if (!task.recurring) {
+    return false;
+  }
+  // The next slot on the job's original grid.
+  const int64_t period = task.recurrence.period_ms > 0 ? task.recurrence.period_ms : 1;
+  const int64_t late = -remaining;
+  *delay_ms = (period - late % period) % period;
+  return true;
+}
+
+// Journaled tasks planned at registration but not yet scheduled. Replay
+// waits for Dart to listen for events, since an overdue task would
+// otherwise run, and have its result dropped, before anything could
+// receive it.
+//
+// Not thread-safe; used on the platform thread.
+class HeldReplay {
+ public:
+  // Plans |task| against |now_unix_ms| with PlanReplay(). Returns false,
+  // holding nothing, when |policy| drops it.
+  bool Hold(const std::string& task_id, const JournaledTask& task, int64_t now_unix_ms,
+            OverduePolicy policy) {
+    int64_t delay_ms = 0;
+    if (!PlanReplay(task, now_unix_ms, policy, &delay_ms)) {
+      return false;
+    }
+    held_[task_id] = Held{task, now_unix_ms + delay_ms};
+    return true;
+  }
+
+  // Dart scheduled or cancelled |task_id| itself, which supersedes the
+  // journaled entry.
+  void Forget(const std::string& task_id) { held_.erase(task_id); }
+
+  // Calls schedule(task_id, task, delay_ms) for every held task with what
+  // is left of its planned delay at |now_unix_ms|, then holds nothing.
+  template <typename Schedule>
+  void Release(int64_t now_unix_ms, Schedule schedule) {
+    std::map<std::string, Held> held;
+    held.swap(held_);
+    for (const auto& entry : held) {
+      const int64_t delay_ms = entry.second.run_unix_ms - now_unix_ms;
+      schedule(entry.first, entry.second.task, delay_ms > 0 ? delay_ms : 0);
+    }
+  }
+
+  size_t size() const { return held_.size(); }
+
+ private:
+  struct Held {
+    JournaledTask task;
+    int64_t run_unix_ms;
+  };
+  std::map<std::string, Held> held_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // JOURNALED_TASK_H_
@@ -0,0 +1,301 @@
+#ifndef JSONRPC_ENVELOPE_H_
+#define JSONRPC_ENVELOPE_H_
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+// SSE2 is baseline on x86-64 for both GCC/Clang and MSVC. Elsewhere, or with
+// FLUTTER_MCP_NO_SIMD defined, the scanner runs its scalar loop.
+#if !defined(FLUTTER_MCP_NO_SIMD) && \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define FLUTTER_MCP_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+namespace flutter_mcp {
+
+// A span of a message being scanned; valid for as long as the message is.
+struct JsonSlice {
+  const char* data = nullptr;
+  size_t size = 0;
+
+  bool empty() const { return size == 0; }
+  bool Equals(const char* text) const {
+    return std::strlen(text) == size && std::memcmp(data, text, size) == 0;
+  }
+  std::string str() const { return std::string(data, size); }
+};
+
+namespace json_scan {
+
+#if defined(FLUTTER_MCP_SSE2)
+inline unsigned FirstBit(unsigned mask) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return static_cast<unsigned>(index);
+#else
+  return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+#endif
+
+// The next '"' or '\' at or after |p|, or |end|.
+inline const char* FindStringSpecial(const char* p, const char* end) {
+#if defined(FLUTTER_MCP_SSE2)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  for (; end - p >= 16; p += 16) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash))));
+    if (mask != 0) {
+      return p + FirstBit(mask);
+    }
+  }
+#endif
+  for (; p < end; p++) {
+    if (*p == '"' || *p == '\\') {
+      return p;
+    }
+  }
+  return end;
+}
+
+// The next '"', '{', '}', '[' or ']' at or after |p|, or |end|.
+inline const char* FindStructural(const char* p, const char* end) {
+#if defined(FLUTTER_MCP_SSE2)
+  // Setting bit 5 folds '[' onto '{' and ']' onto '}', and nothing else.
+  const __m128i case_bit = _mm_set1_epi8(0x20);
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i open = _mm_set1_epi8('{');
+  const __m128i close = _mm_set1_epi8('}');
+  for (; end - p >= 16; p += 16) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i folded = _mm_or_si128(chunk, case_bit);
+    const __m128i hits =
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                     _mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close)));
+    const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+    if (mask != 0) {
+      return p + FirstBit(mask);
+    }
+  }
+#endif
+  for (; p < end; p++) {
+    const char folded = static_cast<char>(*p | 0x20);
+    if (*p == '"' || folded == '{' || folded == '}') {
+      return p;
+    }
+  }
+  return end;
+}
+
+inline const char* SkipWhitespace(const char* p, const char* end) {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+    p++;
+  }
+  return p;
+}
+
+// |p| is at an opening quote. Returns just past the closing one, or null.
+inline const char* SkipString(const char* p, const char* end) {
+  p++;
+  while (p < end) {
+    p = FindStringSpecial(p, end);
+    if (p == end) {
+      return nullptr;
+    }
+    if (*p == '"') {
+      return p + 1;
+    }
+    // An escape; its second character cannot end the string.
+    p += 2;
+  }
+  return nullptr;
+}
+
+// |p| is at '{' or '['. Returns just past its match, or null. Brackets are
+// only counted, not paired by kind; this is a scanner, not a validator.
+inline const char* SkipContainer(const char* p, const char* end) {
+  size_t depth = 0;
+  while (p < end) {
+    p = FindStructural(p, end);
+    if (p == end) {
+      return nullptr;
+    }
+    if (*p == '"') {
+      p = SkipString(p, end);
+      if (!p) {
+        return nullptr;
+      }
+      continue;
+    }
+    if (*p == '{' || *p == '[') {
+      depth++;
+    } else if (--depth == 0) {
+      return p + 1;
+    }
+    p++;
+  }
+  return nullptr;
+}
+
+// Returns just past the value starting at |p|, or null.
+inline const char* SkipValue(const char* p, const char* end) {
+  if (p == end) {
+    return nullptr;
+  }
+  if (*p == '"') {
+    return SkipString(p, end);
+  }
+  if (*p == '{' || *p == '[') {
+    return SkipContainer(p, end);
+  }
+  // A number, true, false or null.
+  const char* start = p;
+  while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\t' &&
+         *p != '\n' && *p != '\r') {
+    p++;
+  }
+  return p == start ? nullptr : p;
+}
+
+// Calls |fn(JsonSlice key, JsonSlice value)| for each member of the object
+// in |object| until it returns false. Keys come without their quotes, and
+// escapes in them are left as they are. False if |object| is malformed.
+template <typename Fn>
+bool ForEachMember(JsonSlice object, Fn fn) {
+  const char* end = object.data + object.size;
+  const char* p = SkipWhitespace(object.data, end);
+  if (p == end || *p != '{') {
+    return false;
+  }
+  p = SkipWhitespace(p + 1, end);
+  if (p < end && *p == '}') {
+    return true;
+  }
+  while (p < end) {
+    if (*p != '"') {
+      return false;
+    }
+    const char* key_end = SkipString(p, end);
+    if (!key_end) {
+      return false;
+    }
+    JsonSlice key;
+    key.data = p + 1;
+    key.size = static_cast<size_t>(key_end - p) - 2;
+    p = SkipWhitespace(key_end, end);
+    if (p == end || *p != ':') {
+      return false;
+    }
+    p = SkipWhitespace(p + 1, end);
+    const char* value_end = SkipValue(p, end);
+    if (!value_end) {
+      return false;
+    }
+    JsonSlice value;
+    value.data = p;
+    value.size = static_cast<size_t>(value_end - p);
+    if (!fn(key, value)) {
+      return true;
+    }
+    p = SkipWhitespace(value_end, end);
+    if (p == end) {
+      return false;
+    }
+    if (*p == '}') {
+      return true;
+    }
+    if (*p != ',') {
+      return false;
+    }
+    p = SkipWhitespace(p + 1, end);
+  }
+  return false;
+}
+
+}  // namespace json_scan
+
+// The routing-relevant members of a JSON-RPC 2.0 message.
+struct JsonRpcEnvelope {
+  enum class Kind { kInvalid, kRequest, kNotification, kResponse };
+
+  Kind kind = Kind::kInvalid;
+  // The raw token: "\"abc\"", "7" or "null". Empty when absent.
+  JsonSlice id;
+  // Without its quotes; escapes are left as they are.
+  JsonSlice method;
+  // The raw value, empty when absent.
+  JsonSlice params;
+  bool has_error = false;
+};
+
+// Extracts the envelope of one message without building a DOM: nested
+// values are skipped over by a SIMD scan for quotes and brackets. False,
+// with |envelope| left kInvalid, for anything that is not a single JSON-RPC
+// object, including batches.
+inline bool ParseJsonRpcEnvelope(const char* data, size_t size, JsonRpcEnvelope* envelope) {
+  *envelope = JsonRpcEnvelope();
+  JsonSlice object;
+  object.data = data;
+  object.size = size;
+  bool has_result = false;
+  bool method_is_string = true;
+  const bool parsed = json_scan::ForEachMember(object, [&](JsonSlice key, JsonSlice value) {
+    if (key.Equals("id")) {
+      envelope->id = value;
+    } else if (key.Equals("method")) {
+      method_is_string = value.size >= 2 && value.data[0] == '"';
+      if (method_is_string) {
+        envelope->method.data = value.data + 1;
+        envelope->method.size = value.size - 2;
+      }
+    } else if (key.Equals("params")) {
+      envelope->params = value;
+    } else if (key.Equals("result")) {
+      has_result = true;
+    } else if (key.Equals("error")) {
+      envelope->has_error = true;
+    }
+    return true;
+  });
+  if (!parsed || !method_is_string) {
+    *envelope = JsonRpcEnvelope();
+    return false;
+  }
+
+  if (!envelope->method.empty()) {
+    envelope->kind = envelope->id.empty() ? JsonRpcEnvelope::Kind::kNotification
+                                          : JsonRpcEnvelope::Kind::kRequest;
+  } else if (!envelope->id.empty() && (has_result || envelope->has_error)) {
+    envelope->kind = JsonRpcEnvelope::Kind::kResponse;
+  }
+  return envelope->kind != JsonRpcEnvelope::Kind::kInvalid;
+}
+
+// Finds the raw value of |key| in the object |object|. False if it is
+// missing or |object| is not an object.
+inline bool FindJsonMember(JsonSlice object, const char* key, JsonSlice* value) {
+  bool found = false;
+  json_scan::ForEachMember(object, [&](JsonSlice member, JsonSlice member_value) {
+    if (member.Equals(key)) {
+      *value = member_value;
+      found = true;
+      return false;
+    }
+    return true;
+  });
+  return found;
+}
+
+}  // namespace flutter_mcp
+
+#endif  // JSONRPC_ENVELOPE_H_
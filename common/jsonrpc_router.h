@@ -0,0 +1,199 @@
+#ifndef JSONRPC_ROUTER_H_
+#define JSONRPC_ROUTER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "jsonrpc_envelope.h"
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+namespace flutter_mcp {
+
+// What a server's traffic is trimmed down to before it reaches Dart.
+struct RoutingRules {
+  // Notification methods that are dropped, e.g. ones Dart unsubscribed from.
+  std::unordered_set<std::string> dropped_notifications;
+  // Keep only the newest notifications/progress per progressToken in each
+  // batch.
+  bool coalesce_progress = true;
+  // Drop responses whose id matches no pending request: duplicates, and
+  // answers to requests Dart cancelled with notifications/cancelled.
+  bool match_responses = true;
+};
+
+struct RoutingCounts {
+  uint64_t dropped_notifications = 0;
+  uint64_t coalesced_progress = 0;
+  uint64_t unmatched_responses = 0;
+
+  RoutingCounts& operator+=(const RoutingCounts& other) {
+    dropped_notifications += other.dropped_notifications;
+    coalesced_progress += other.coalesced_progress;
+    unmatched_responses += other.unmatched_responses;
+    return *this;
+  }
+};
+
+// The messages one wakeup read from a server, as routed.
+class RoutedBatch {
+ public:
+  bool empty() const { return messages_.size() == holes_; }
+
+  // Adds a message no rule applies to.
+  void Add(const char* data, size_t size) { messages_.emplace_back(data, size); }
+
+  // The surviving messages, in arrival order.
+  std::vector<std::string> Take() {
+    if (holes_ > 0) {
+      std::vector<std::string> kept;
+      kept.reserve(messages_.size() - holes_);
+      for (auto& message : messages_) {
+        if (!message.empty()) {
+          kept.push_back(std::move(message));
+        }
+      }
+      messages_.swap(kept);
+    }
+    std::vector<std::string> messages;
+    messages.swap(messages_);
+    progress_.clear();
+    holes_ = 0;
+    return messages;
+  }
+
+ private:
+  friend class JsonRpcRouter;
+
+  std::vector<std::string> messages_;
+  // progressToken to the index of its newest notification
+  std::unordered_map<std::string, size_t> progress_;
+  // Coalesced messages, left empty in |messages_| until Take()
+  size_t holes_ = 0;
+};
+
+// Routes one server's JSON-RPC traffic on its envelope alone.
+//
+// Every message is pre-parsed with ParseJsonRpcEnvelope() before it is
+// copied anywhere, so a dropped or superseded message costs one scan and no
+// allocation. Anything that does not parse as a single JSON-RPC object is
+// passed through untouched. OnOutgoing() may run on any thread; Route() on
+// one thread at a time.
+class JsonRpcRouter {
+ public:
+  // Requests tracked at once. Past this, responses are no longer matched,
+  // since one that is dropped could be a real answer.
+  static constexpr size_t kMaxPending = 64 * 1024;
+
+  explicit JsonRpcRouter(const RoutingRules& rules = RoutingRules())
+      : rules_(std::make_shared<const RoutingRules>(rules)), overflowed_(false) {}
+
+  JsonRpcRouter(const JsonRpcRouter&) = delete;
+  JsonRpcRouter& operator=(const JsonRpcRouter&) = delete;
+
+  void Configure(const RoutingRules& rules) {
+    std::atomic_store(&rules_, std::make_shared<const RoutingRules>(rules));
+  }
+
+  // Sees each message sent to the server. Request ids are tracked whatever
+  // the rules, so turning matching on later does not drop live answers.
+  void OnOutgoing(const char* data, size_t size) {
+    JsonRpcEnvelope envelope;
+    if (!ParseJsonRpcEnvelope(data, size, &envelope)) {
+      return;
+    }
+    if (envelope.kind == JsonRpcEnvelope::Kind::kRequest) {
+      std::lock_guard<std::mutex> lock(pending_mutex_);
+      if (pending_.size() >= kMaxPending) {
+        overflowed_ = true;
+      } else {
+        pending_.insert(envelope.id.str());
+      }
+    } else if (envelope.kind == JsonRpcEnvelope::Kind::kNotification &&
+               envelope.method.Equals("notifications/cancelled")) {
+      JsonSlice request_id;
+      if (FindJsonMember(envelope.params, "requestId", &request_id)) {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        pending_.erase(request_id.str());
+      }
+    }
+  }
+
+  // Adds one message from the server to |batch| unless the rules drop it.
+  void Route(const char* data, size_t size, RoutedBatch* batch) {
+    JsonRpcEnvelope envelope;
+    if (ParseJsonRpcEnvelope(data, size, &envelope)) {
+      const std::shared_ptr<const RoutingRules> rules = std::atomic_load(&rules_);
+      if (envelope.kind == JsonRpcEnvelope::Kind::kNotification) {
+        if (!rules->dropped_notifications.empty() &&
+            rules->dropped_notifications.count(envelope.method.str()) > 0) {
+          dropped_notifications_.fetch_add(1, std::memory_order_relaxed);
+          return;
+        }
+        JsonSlice token;
+        if (rules->coalesce_progress && envelope.method.Equals("notifications/progress") &&
+            FindJsonMember(envelope.params, "progressToken", &token)) {
+          auto inserted = batch->progress_.emplace(token.str(), batch->messages_.size());
+          if (!inserted.second) {
+            std::string& superseded = batch->messages_[inserted.first->second];
+            std::string().swap(superseded);
+            batch->holes_++;
+            inserted.first->second = batch->messages_.size();
+            coalesced_progress_.fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+      } else if (envelope.kind == JsonRpcEnvelope::Kind::kResponse &&
+                 !MatchResponse(envelope.id) && rules->match_responses) {
+        unmatched_responses_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+    }
+    batch->Add(data, size);
+  }
+
+  RoutingCounts counts() const {
+    RoutingCounts counts;
+    counts.dropped_notifications = dropped_notifications_.load(std::memory_order_relaxed);
+    counts.coalesced_progress = coalesced_progress_.load(std::memory_order_relaxed);
+    counts.unmatched_responses = unmatched_responses_.load(std::memory_order_relaxed);
+    return counts;
+  }
+
+  size_t pending_requests() {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    return pending_.size();
+  }
+
+ private:
+  // Retires the request |id| answers; false if none was pending.
+  bool MatchResponse(JsonSlice id) {
+    // The answer to a request the server could not parse.
+    if (id.Equals("null")) {
+      return true;
+    }
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    return pending_.erase(id.str()) > 0 || overflowed_;
+  }
+
+  std::shared_ptr<const RoutingRules> rules_;
+
+  std::mutex pending_mutex_;
+  // Raw id tokens, so 1 and "1" stay distinct
+  std::unordered_set<std::string> pending_;
+  bool overflowed_;
+
+  std::atomic<uint64_t> dropped_notifications_{0};
+  std::atomic<uint64_t> coalesced_progress_{0};
+  std::atomic<uint64_t> unmatched_responses_{0};
+};
+
+}  // namespace flutter_mcp
+
+#endif  // JSONRPC_ROUTER_H_
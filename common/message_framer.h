@@ -0,0 +1,212 @@
+#ifndef MESSAGE_FRAMER_H_
+#define MESSAGE_FRAMER_H_
+
+#include <cctype>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+namespace flutter_mcp {
+
+// How JSON-RPC messages are delimited on an MCP server's stdio.
+enum class Framing {
+  // One message per line, as the MCP stdio transport specifies.
+  kNewline,
+  // LSP-style "Content-Length: N\r\n\r\n" headers before each message.
+  kContentLength,
+};
+
+// "contentLength" selects kContentLength; anything else kNewline.
+inline Framing ParseFraming(const char* name) {
+  return name && std::strcmp(name, "contentLength") == 0 ? Framing::kContentLength
+                                                         : Framing::kNewline;
+}
+
+// Bytes to write before a |payload_size|-byte message.
+inline std::string FramePrefix(Framing framing, size_t payload_size) {
+  if (framing == Framing::kNewline) {
+    return std::string();
+  }
+  return "Content-Length: " + std::to_string(payload_size) + "\r\n\r\n";
+}
+
+// Bytes to write after a message.
+inline const char* FrameSuffix(Framing framing) {
+  return framing == Framing::kNewline ? "\n" : "";
+}
+
+// Splits a byte stream into complete messages.
+//
+// Messages found wholly inside the bytes passed to one Feed() are handed out
+// in place; only a trailing partial message is copied, to be completed by the
+// next Feed(). A newline-framed message has its trailing \r dropped and empty
+// lines are skipped. Not thread-safe.
+class MessageFramer {
+ public:
+  static constexpr size_t kDefaultMaxMessage = 64 * 1024 * 1024;
+  static constexpr size_t kMaxHeader = 8 * 1024;
+
+  explicit MessageFramer(Framing framing, size_t max_message = kDefaultMaxMessage)
+      : framing_(framing), max_message_(max_message), scanned_(0), failed_(false) {}
+
+  // Passes each message completed by |data| to |fn(const char*, size_t)|;
+  // the pointer is only valid during the call. Returns false, now and on
+  // every later call, once the stream cannot be framed: a header without a
+  // Content-Length, or a message over the size limit.
+  template <typename Fn>
+  bool Feed(const char* data, size_t size, Fn fn) {
+    if (failed_) {
+      return false;
+    }
+    if (!buffer_.empty()) {
+      buffer_.append(data, size);
+      data = buffer_.data();
+      size = buffer_.size();
+    }
+
+    size_t offset = 0;
+    while (offset < size) {
+      const char* message = nullptr;
+      size_t length = 0;
+      const size_t consumed = framing_ == Framing::kNewline
+                                  ? NextLine(data + offset, size - offset, &message, &length)
+                                  : NextContent(data + offset, size - offset, &message, &length);
+      if (failed_) {
+        buffer_.clear();
+        return false;
+      }
+      if (consumed == 0) {
+        break;
+      }
+      offset += consumed;
+      scanned_ = 0;
+      if (message) {
+        fn(message, length);
+      }
+    }
+
+    const size_t remaining = size - offset;
+    if (remaining > max_message_ + kMaxHeader) {
+      failed_ = true;
+      buffer_.clear();
+      return false;
+    }
+    if (data == buffer_.data()) {
+      buffer_.erase(0, offset);
+    } else {
+      buffer_.assign(data + offset, remaining);
+    }
+    return true;
+  }
+
+  // Bytes held back for an incomplete message.
+  size_t buffered() const { return buffer_.size(); }
+  bool failed() const { return failed_; }
+
+ private:
+  // Each returns the bytes consumed, or 0 if no message is complete yet.
+  size_t NextLine(const char* data, size_t size, const char** message, size_t* length) {
+    // A long line arriving in pieces is only searched once.
+    const void* newline = std::memchr(data + scanned_, '\n', size - scanned_);
+    if (!newline) {
+      scanned_ = size;
+      if (size > max_message_) {
+        failed_ = true;
+      }
+      return 0;
+    }
+    size_t end = static_cast<const char*>(newline) - data;
+    const size_t consumed = end + 1;
+    if (end > 0 && data[end - 1] == '\r') {
+      end--;
+    }
+    if (end > 0) {
+      *message = data;
+      *length = end;
+    }
+    return consumed;
+  }
+
+  size_t NextContent(const char* data, size_t size, const char** message, size_t* length) {
+    const size_t header_end = FindHeaderEnd(data, size);
+    if (header_end == 0) {
+      if (size > kMaxHeader) {
+        failed_ = true;
+      }
+      return 0;
+    }
+    size_t content_length = 0;
+    if (!ParseContentLength(data, header_end, &content_length) ||
+        content_length > max_message_) {
+      failed_ = true;
+      return 0;
+    }
+    if (size - header_end < content_length) {
+      return 0;
+    }
+    *message = data + header_end;
+    *length = content_length;
+    return header_end + content_length;
+  }
+
+  // Offset just past the blank line ending the header, or 0.
+  static size_t FindHeaderEnd(const char* data, size_t size) {
+    for (size_t i = 3; i < size && i < kMaxHeader; i++) {
+      if (data[i] == '\n' && data[i - 1] == '\r' && data[i - 2] == '\n' && data[i - 3] == '\r') {
+        return i + 1;
+      }
+    }
+    return 0;
+  }
+
+  static bool ParseContentLength(const char* header, size_t size, size_t* content_length) {
+    static const char kName[] = "content-length:";
+    const size_t name_length = sizeof(kName) - 1;
+    size_t line = 0;
+    while (line < size) {
+      const char* end = static_cast<const char*>(std::memchr(header + line, '\n', size - line));
+      const size_t line_length = (end ? end - header : size) - line;
+      if (line_length > name_length && MatchesIgnoringCase(header + line, kName, name_length)) {
+        size_t i = line + name_length;
+        while (i < line + line_length && header[i] == ' ') {
+          i++;
+        }
+        size_t value = 0;
+        size_t digits = 0;
+        for (; i < line + line_length && std::isdigit(static_cast<unsigned char>(header[i]));
+             i++, digits++) {
+          value = value * 10 + static_cast<size_t>(header[i] - '0');
+          if (value > kDefaultMaxMessage * 16) {
+            return false;
+          }
+        }
+        *content_length = value;
+        return digits > 0;
+      }
+      line += line_length + 1;
+    }
+    return false;
+  }
+
+  static bool MatchesIgnoringCase(const char* text, const char* lower, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+      if (std::tolower(static_cast<unsigned char>(text[i])) != lower[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const Framing framing_;
+  const size_t max_message_;
+  std::string buffer_;
+  // Bytes of |buffer_| already searched for a newline.
+  size_t scanned_;
+  bool failed_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // MESSAGE_FRAMER_H_
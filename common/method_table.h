@@ -0,0 +1,169 @@
+#ifndef METHOD_TABLE_H_
+#define METHOD_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+// Every method the desktop plugins handle on the "flutter_mcp" channel. To
+// add one, append an entry here and a case to each platform's dispatch
+// switch; the hash table below is regenerated at compile time.
+#define FLUTTER_MCP_METHODS(X)                                  \
+  X(kGetPlatformVersion, "getPlatformVersion")                  \
+  X(kInitialize, "initialize")                                  \
+  X(kStartBackgroundService, "startBackgroundService")          \
+  X(kStopBackgroundService, "stopBackgroundService")            \
+  X(kConfigureBackgroundService, "configureBackgroundService")  \
+  X(kScheduleBackgroundTask, "scheduleBackgroundTask")          \
+  X(kScheduleRecurringTask, "scheduleRecurringTask")            \
+  X(kCancelBackgroundTask, "cancelBackgroundTask")              \
+  X(kStartHeadlessEngine, "startHeadlessEngine")                \
+  X(kStopHeadlessEngine, "stopHeadlessEngine")                  \
+  X(kShowNotification, "showNotification")                      \
+  X(kRequestNotificationPermission, "requestNotificationPermission") \
+  X(kConfigureNotifications, "configureNotifications")          \
+  X(kCancelNotification, "cancelNotification")                  \
+  X(kCancelAllNotifications, "cancelAllNotifications")          \
+  X(kSecureStore, "secureStore")                                \
+  X(kSecureRead, "secureRead")                                  \
+  X(kSecureStoreBytes, "secureStoreBytes")                      \
+  X(kSecureReadBytes, "secureReadBytes")                        \
+  X(kSecureDelete, "secureDelete")                              \
+  X(kSecureContainsKey, "secureContainsKey")                    \
+  X(kSecureDeleteAll, "secureDeleteAll")                        \
+  X(kSecureReadMany, "secureReadMany")                          \
+  X(kSecureReadPrefix, "secureReadPrefix")                      \
+  X(kSecureFlush, "secureFlush")                                \
+  X(kConfigureSecureStorage, "configureSecureStorage")          \
+  X(kShowTrayIcon, "showTrayIcon")                              \
+  X(kHideTrayIcon, "hideTrayIcon")                              \
+  X(kRegisterTrayIcons, "registerTrayIcons")                    \
+  X(kSetTrayIcon, "setTrayIcon")                                \
+  X(kSetTrayMenu, "setTrayMenu")                                \
+  X(kUpdateTrayMenuItem, "updateTrayMenuItem")                  \
+  X(kUpdateTrayTooltip, "updateTrayTooltip")                    \
+  X(kConfigureTray, "configureTray")                            \
+  X(kCheckPermission, "checkPermission")                        \
+  X(kRequestPermission, "requestPermission")                    \
+  X(kConfigureEvents, "configureEvents")                        \
+  X(kGetEventQueueStats, "getEventQueueStats")                  \
+  X(kGetNativeMetrics, "getNativeMetrics")                      \
+  X(kConfigureNativeMetrics, "configureNativeMetrics")          \
+  X(kTransportSpawn, "transportSpawn")                          \
+  X(kTransportSend, "transportSend")                            \
+  X(kTransportClose, "transportClose")                          \
+  X(kTransportConfigureRouting, "transportConfigureRouting")    \
+  X(kTransportStats, "transportStats")                          \
+  X(kStartNativeTrace, "startNativeTrace")                      \
+  X(kStopNativeTrace, "stopNativeTrace")                        \
+  X(kExecuteBatch, "executeBatch")                              \
+  X(kShutdown, "shutdown")
+
+namespace flutter_mcp {
+
+enum class Method : uint8_t {
+#define FLUTTER_MCP_METHOD_ENUM(id, name) id,
+  FLUTTER_MCP_METHODS(FLUTTER_MCP_METHOD_ENUM)
+#undef FLUTTER_MCP_METHOD_ENUM
+  kUnknown,
+};
+
+namespace method_table_internal {
+
+constexpr const char* kNames[] = {
+#define FLUTTER_MCP_METHOD_NAME(id, name) name,
+    FLUTTER_MCP_METHODS(FLUTTER_MCP_METHOD_NAME)
+#undef FLUTTER_MCP_METHOD_NAME
+};
+
+constexpr size_t kCount = sizeof(kNames) / sizeof(kNames[0]);
+
+// Sparse enough that a collision-free seed turns up within a few tries, so
+// the search stays well inside compiler constexpr step limits.
+constexpr size_t kSlotCount = 512;
+constexpr uint8_t kEmptySlot = 0xff;
+
+static_assert(kCount < kEmptySlot, "Method ids must fit in a slot");
+static_assert(kCount * 8 <= kSlotCount, "Grow kSlotCount with the method list");
+
+// FNV-1a with a seeded basis and a final avalanche so that changing the seed
+// reshuffles every slot.
+constexpr uint32_t Hash(const char* name, uint32_t seed) {
+  uint32_t hash = 2166136261u ^ seed;
+  for (size_t i = 0; name[i] != '\0'; i++) {
+    hash ^= static_cast<uint8_t>(name[i]);
+    hash *= 16777619u;
+  }
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6bu;
+  hash ^= hash >> 13;
+  return hash;
+}
+
+constexpr size_t Slot(const char* name, uint32_t seed) {
+  return Hash(name, seed) & (kSlotCount - 1);
+}
+
+struct Table {
+  uint32_t seed;
+  uint8_t slots[kSlotCount];
+};
+
+constexpr bool SeedIsPerfect(uint32_t seed) {
+  bool used[kSlotCount] = {};
+  for (size_t i = 0; i < kCount; i++) {
+    size_t slot = Slot(kNames[i], seed);
+    if (used[slot]) {
+      return false;
+    }
+    used[slot] = true;
+  }
+  return true;
+}
+
+constexpr Table Build() {
+  Table table = {};
+  uint32_t seed = 0;
+  while (!SeedIsPerfect(seed)) {
+    seed++;
+  }
+  table.seed = seed;
+  for (size_t i = 0; i < kSlotCount; i++) {
+    table.slots[i] = kEmptySlot;
+  }
+  for (size_t i = 0; i < kCount; i++) {
+    table.slots[Slot(kNames[i], seed)] = static_cast<uint8_t>(i);
+  }
+  return table;
+}
+
+constexpr Table kTable = Build();
+
+}  // namespace method_table_internal
+
+// Maps a channel method name to its Method with one hash and one string
+// compare; unregistered names return Method::kUnknown.
+inline Method LookupMethod(const char* name) {
+  using namespace method_table_internal;
+  if (name == nullptr) {
+    return Method::kUnknown;
+  }
+  uint8_t index = kTable.slots[Slot(name, kTable.seed)];
+  if (index == kEmptySlot || strcmp(kNames[index], name) != 0) {
+    return Method::kUnknown;
+  }
+  return static_cast<Method>(index);
+}
+
+inline const char* MethodName(Method method) {
+  size_t index = static_cast<size_t>(method);
+  return index < method_table_internal::kCount
+             ? method_table_internal::kNames[index]
+             : "";
+}
+
+}  // namespace flutter_mcp
+
+#endif  // METHOD_TABLE_H_
@@ -0,0 +1,89 @@
+#ifndef MPSC_QUEUE_H_
+#define MPSC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+namespace flutter_mcp {
+
+// Unbounded lock-free multi-producer/single-consumer queue.
+//
+// Producers push onto an intrusive stack with a single CAS; the consumer
+// takes the whole stack with one exchange and reverses it, so items come
+// out in push order. Push reports when it made the queue non-empty, which
+// lets callers schedule exactly one drain per batch of pushes.
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() : head_(nullptr) {}
+
+  ~MpscQueue() {
+    Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+    while (node) {
+      Node* next = node->next;
+      delete node;
+      node = next;
+    }
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  // Safe from any thread. Returns true if the queue was empty, in which case
+  // the caller is responsible for scheduling a Drain().
+  bool Push(T value) {
+    Node* node = new Node(std::move(value));
+    Node* head = head_.load(std::memory_order_relaxed);
+    do {
+      node->next = head;
+    } while (!head_.compare_exchange_weak(head, node, std::memory_order_release,
+                                          std::memory_order_relaxed));
+    return head == nullptr;
+  }
+
+  // Consumer only. Passes every queued item to |fn|, oldest first, and
+  // returns how many there were. Items pushed while draining are left for
+  // the drain their push schedules.
+  template <typename Fn>
+  size_t Drain(Fn fn) {
+    Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+
+    Node* ordered = nullptr;
+    while (node) {
+      Node* next = node->next;
+      node->next = ordered;
+      ordered = node;
+      node = next;
+    }
+
+    size_t count = 0;
+    while (ordered) {
+      Node* next = ordered->next;
+      fn(std::move(ordered->value));
+      delete ordered;
+      ordered = next;
+      count++;
+    }
+    return count;
+  }
+
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) == nullptr;
+  }
+
+ private:
+  struct Node {
+    explicit Node(T&& item) : value(std::move(item)), next(nullptr) {}
+    T value;
+    Node* next;
+  };
+
+  std::atomic<Node*> head_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // MPSC_QUEUE_H_
@@ -0,0 +1,332 @@
+#ifndef NATIVE_METRICS_H_
+#define NATIVE_METRICS_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "method_table.h"
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+namespace flutter_mcp {
+
+struct HistogramSnapshot {
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t min = 0;
+  uint64_t max = 0;
+  uint64_t p50 = 0;
+  uint64_t p90 = 0;
+  uint64_t p99 = 0;
+  uint64_t p999 = 0;
+
+  double mean() const {
+    return count > 0 ? static_cast<double>(sum) / static_cast<double>(count) : 0.0;
+  }
+};
+
+// Lock-free log-linear latency histogram, in the style of HdrHistogram.
+//
+// Values below 8 get a bucket each; above that every power of two is split
+// into 8 linear sub-buckets, so a reported percentile is within 12.5% of
+// the true value. Recording is a handful of relaxed atomic operations and
+// is safe from any thread; Snapshot() may run concurrently and then sees a
+// slightly torn but internally usable view.
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 3;
+  static constexpr uint64_t kSubBuckets = 1u << kSubBucketBits;
+  // Highest power of two tracked; larger values land in the last bucket.
+  static constexpr int kMaxMagnitude = 40;
+  static constexpr size_t kBucketCount =
+      kSubBuckets + (kMaxMagnitude - kSubBucketBits + 1) * kSubBuckets;
+
+  LatencyHistogram() { Reset(); }
+
+  LatencyHistogram(const LatencyHistogram&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  void Record(int64_t value) {
+    const uint64_t v = value > 0 ? static_cast<uint64_t>(value) : 0;
+    buckets_[BucketFor(v)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(v, std::memory_order_relaxed);
+
+    uint64_t seen = min_.load(std::memory_order_relaxed);
+    while (v < seen && !min_.compare_exchange_weak(seen, v, std::memory_order_relaxed)) {
+    }
+    seen = max_.load(std::memory_order_relaxed);
+    while (v > seen && !max_.compare_exchange_weak(seen, v, std::memory_order_relaxed)) {
+    }
+  }
+
+  HistogramSnapshot Snapshot() const {
+    HistogramSnapshot snapshot;
+    std::array<uint64_t, kBucketCount> counts;
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBucketCount; i++) {
+      counts[i] = buckets_[i].load(std::memory_order_relaxed);
+      total += counts[i];
+    }
+    if (total == 0) {
+      return snapshot;
+    }
+
+    snapshot.count = total;
+    snapshot.sum = sum_.load(std::memory_order_relaxed);
+    snapshot.min = min_.load(std::memory_order_relaxed);
+    snapshot.max = max_.load(std::memory_order_relaxed);
+
+    const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+    uint64_t* targets[] = {&snapshot.p50, &snapshot.p90, &snapshot.p99, &snapshot.p999};
+    size_t next = 0;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount && next < 4; i++) {
+      seen += counts[i];
+      while (next < 4 && static_cast<double>(seen) >= quantiles[next] * static_cast<double>(total)) {
+        // Report the bucket's upper edge, but never beyond what was seen.
+        *targets[next] = std::min(std::max(UpperBound(i), snapshot.min), snapshot.max);
+        next++;
+      }
+    }
+    return snapshot;
+  }
+
+  void Reset() {
+    for (auto& bucket : buckets_) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(UINT64_MAX, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+  }
+
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+  static size_t BucketFor(uint64_t value) {
+    if (value < kSubBuckets) {
+      return static_cast<size_t>(value);
+    }
+    int magnitude = 63;
+    while ((value >> magnitude) == 0) {
+      magnitude--;
+    }
+    if (magnitude > kMaxMagnitude) {
+      return kBucketCount - 1;
+    }
+    const uint64_t sub = (value >> (magnitude - kSubBucketBits)) & (kSubBuckets - 1);
+    return static_cast<size_t>(kSubBuckets + (magnitude - kSubBucketBits) * kSubBuckets + sub);
+  }
+
+  // Largest value that falls in |bucket|.
+  static uint64_t UpperBound(size_t bucket) {
+    if (bucket < kSubBuckets) {
+      return bucket;
+    }
+    const size_t offset = bucket - kSubBuckets;
+    const int shift = static_cast<int>(offset / kSubBuckets);
+    const uint64_t sub = offset % kSubBuckets;
+    return ((kSubBuckets + sub + 1) << shift) - 1;
+  }
+
+ private:
+  std::array<std::atomic<uint64_t>, kBucketCount> buckets_;
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> min_;
+  std::atomic<uint64_t> max_;
+};
+
+// Current and high-water value of a level such as a queue depth.
+class Gauge {
+ public:
+  void Add(int64_t delta) {
+    const int64_t now = value_.fetch_add(delta, std::memory_order_relaxed) + delta;
+    int64_t seen = max_.load(std::memory_order_relaxed);
+    while (now > seen && !max_.compare_exchange_weak(seen, now, std::memory_order_relaxed)) {
+    }
+  }
+
+  int64_t value() const { return value_.load(std::memory_order_relaxed); }
+  int64_t max() const { return max_.load(std::memory_order_relaxed); }
+  void ResetMax() { max_.store(value(), std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_{0};
+  std::atomic<int64_t> max_{0};
+};
+
+// Methods whose time is also counted as secure storage time.
+inline bool IsSecureStorageMethod(Method method) {
+  switch (method) {
+    case Method::kSecureStore:
+    case Method::kSecureRead:
+    case Method::kSecureStoreBytes:
+    case Method::kSecureReadBytes:
+    case Method::kSecureDelete:
+    case Method::kSecureContainsKey:
+    case Method::kSecureDeleteAll:
+    case Method::kSecureReadMany:
+    case Method::kSecureReadPrefix:
+    case Method::kSecureFlush:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Native subsystems the plugin creates on first use rather than at
+// registration.
+enum class Subsystem {
+  kTray,
+  kNotifications,
+  kSecureStorage,
+  kBackground,
+  kTransport,
+  kCount,
+};
+
+inline const char* SubsystemName(Subsystem subsystem) {
+  switch (subsystem) {
+    case Subsystem::kTray:
+      return "tray";
+    case Subsystem::kNotifications:
+      return "notifications";
+    case Subsystem::kSecureStorage:
+      return "secureStorage";
+    case Subsystem::kBackground:
+      return "background";
+    case Subsystem::kTransport:
+      return "transport";
+    default:
+      return "";
+  }
+}
+
+// Process-wide native hot-path measurements, recorded from any thread.
+//
+// Latencies are in microseconds. Per-method histograms are allocated the
+// first time a method is recorded, so methods never called cost nothing.
+class NativeMetrics {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  NativeMetrics() {
+    for (auto& method : methods_) {
+      method.store(nullptr, std::memory_order_relaxed);
+    }
+    for (auto& init : subsystem_init_us_) {
+      init.store(-1, std::memory_order_relaxed);
+    }
+  }
+
+  ~NativeMetrics() {
+    for (auto& method : methods_) {
+      delete method.load(std::memory_order_relaxed);
+    }
+  }
+
+  NativeMetrics(const NativeMetrics&) = delete;
+  NativeMetrics& operator=(const NativeMetrics&) = delete;
+
+  void RecordMethod(Method method, int64_t micros) {
+    const size_t index = static_cast<size_t>(method);
+    if (index >= methods_.size()) {
+      return;
+    }
+    LatencyHistogram* histogram = methods_[index].load(std::memory_order_acquire);
+    if (!histogram) {
+      LatencyHistogram* created = new LatencyHistogram();
+      if (methods_[index].compare_exchange_strong(histogram, created,
+                                                  std::memory_order_acq_rel)) {
+        histogram = created;
+      } else {
+        delete created;
+      }
+    }
+    histogram->Record(micros);
+  }
+
+  // Visits every method recorded so far.
+  template <typename Fn>
+  void ForEachMethod(Fn fn) const {
+    for (size_t i = 0; i < methods_.size(); i++) {
+      const LatencyHistogram* histogram = methods_[i].load(std::memory_order_acquire);
+      if (histogram && histogram->count() > 0) {
+        fn(MethodName(static_cast<Method>(i)), *histogram);
+      }
+    }
+  }
+
+  // Records how long |subsystem| took to create. Each subsystem is created
+  // once, so only the first recording sticks.
+  void RecordSubsystemInit(Subsystem subsystem, int64_t micros) {
+    const size_t index = static_cast<size_t>(subsystem);
+    if (index >= subsystem_init_us_.size()) {
+      return;
+    }
+    int64_t unset = -1;
+    subsystem_init_us_[index].compare_exchange_strong(unset, micros > 0 ? micros : 0,
+                                                      std::memory_order_relaxed);
+  }
+
+  // Microseconds |subsystem| took to create, or -1 if it has not been.
+  int64_t subsystem_init_us(Subsystem subsystem) const {
+    const size_t index = static_cast<size_t>(subsystem);
+    return index < subsystem_init_us_.size()
+               ? subsystem_init_us_[index].load(std::memory_order_relaxed)
+               : -1;
+  }
+
+  // Visits every subsystem created so far. Init times survive Reset(),
+  // since a subsystem is never created twice.
+  template <typename Fn>
+  void ForEachSubsystem(Fn fn) const {
+    for (size_t i = 0; i < subsystem_init_us_.size(); i++) {
+      const int64_t micros = subsystem_init_us_[i].load(std::memory_order_relaxed);
+      if (micros >= 0) {
+        fn(SubsystemName(static_cast<Subsystem>(i)), micros);
+      }
+    }
+  }
+
+  void Reset() {
+    for (auto& method : methods_) {
+      LatencyHistogram* histogram = method.load(std::memory_order_acquire);
+      if (histogram) {
+        histogram->Reset();
+      }
+    }
+    scheduler_lateness.Reset();
+    secure_storage.Reset();
+    event_post.Reset();
+    event_queue_depth.ResetMax();
+  }
+
+  static int64_t MicrosSince(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+  }
+
+  // How far past their deadline scheduled tasks were dispatched.
+  LatencyHistogram scheduler_lateness;
+  // Time spent in the platform secret store per operation.
+  LatencyHistogram secure_storage;
+  // Time to hand an event to the delivery queue, including any wait for
+  // room under the blocking overflow policy.
+  LatencyHistogram event_post;
+  // Events queued for the platform thread and not yet delivered.
+  Gauge event_queue_depth;
+
+ private:
+  std::array<std::atomic<LatencyHistogram*>, method_table_internal::kCount> methods_;
+  std::array<std::atomic<int64_t>, static_cast<size_t>(Subsystem::kCount)> subsystem_init_us_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // NATIVE_METRICS_H_
@@ -0,0 +1,299 @@
+#ifndef NATIVE_TRACE_H_
+#define NATIVE_TRACE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+namespace flutter_mcp {
+
+enum class TraceCategory {
+  kMethod,
+  kScheduler,
+  kTask,
+  kSecureStorage,
+  kEvents,
+  kTray,
+  kTransport,
+  kCount,
+};
+
+inline const char* TraceCategoryName(TraceCategory category) {
+  switch (category) {
+    case TraceCategory::kMethod:
+      return "method";
+    case TraceCategory::kScheduler:
+      return "scheduler";
+    case TraceCategory::kTask:
+      return "task";
+    case TraceCategory::kSecureStorage:
+      return "secureStorage";
+    case TraceCategory::kEvents:
+      return "events";
+    case TraceCategory::kTray:
+      return "tray";
+    case TraceCategory::kTransport:
+      return "transport";
+    default:
+      return "";
+  }
+}
+
+// One completed span. |name| must be a string literal or otherwise outlive
+// the trace.
+struct TraceRecord {
+  const char* name;
+  int64_t start_us;
+  int64_t duration_us;
+  TraceCategory category;
+};
+
+struct TraceDump {
+  // Chrome trace-event JSON, loadable by chrome://tracing and Perfetto.
+  std::string json;
+  size_t events = 0;
+  // Oldest spans overwritten because a thread's buffer wrapped.
+  uint64_t dropped = 0;
+};
+
+// Process-wide timeline of native spans, exported as Chrome trace JSON.
+//
+// Each thread records into its own ring of kRecordsPerThread preallocated
+// records, allocated the first time the thread records while tracing, so
+// recording takes no lock and never allocates after that. When tracing is
+// off a span costs one relaxed atomic load. Timestamps are steady-clock
+// microseconds, the clock the Dart timeline uses on both desktop platforms,
+// so native spans line up with DevTools. Start() and Stop() must be called
+// from one thread at a time.
+class NativeTracer {
+ public:
+  static constexpr size_t kRecordsPerThread = 16 * 1024;
+  // Threads beyond this record nothing.
+  static constexpr size_t kMaxThreads = 64;
+
+  // Never destroyed, so threads still running at exit can record safely.
+  static NativeTracer& Instance() {
+    static NativeTracer* tracer = new NativeTracer();
+    return *tracer;
+  }
+
+  static int64_t NowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  // Labels the calling thread in traces; |name| must outlive the process
+  // or the thread. Cheap enough to call at thread start whether or not
+  // tracing is on.
+  static void NameThread(const char* name) { ThreadName() = name; }
+
+  // The start time for a span, or 0 when tracing is off.
+  static int64_t Begin() {
+    return Instance().enabled() ? NowMicros() : 0;
+  }
+
+  // Ends a span started with Begin(); a no-op if it returned 0.
+  static void End(TraceCategory category, const char* name, int64_t begin_us) {
+    if (begin_us != 0) {
+      Instance().Record(category, name, begin_us, NowMicros() - begin_us);
+    }
+  }
+
+  NativeTracer(const NativeTracer&) = delete;
+  NativeTracer& operator=(const NativeTracer&) = delete;
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // Discards any earlier trace and starts recording.
+  void Start() {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    if (enabled_.load()) {
+      return;
+    }
+    // Writers only touch a buffer after seeing |enabled_|, which is set last.
+    for (auto& buffer : buffers_) {
+      buffer->written = 0;
+    }
+    enabled_.store(true);
+  }
+
+  // Stops recording and exports what was recorded, oldest first.
+  TraceDump Stop(int64_t pid) {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    enabled_.store(false);
+    // Waits out spans being written; any that start now see |enabled_|.
+    for (auto& buffer : buffers_) {
+      while (buffer->writing.load()) {
+        std::this_thread::yield();
+      }
+    }
+
+    struct Entry {
+      TraceRecord record;
+      uint32_t tid;
+    };
+    std::vector<Entry> entries;
+    TraceDump dump;
+    for (auto& buffer : buffers_) {
+      const uint64_t written = buffer->written;
+      const uint64_t kept = std::min(written, static_cast<uint64_t>(kRecordsPerThread));
+      dump.dropped += written - kept;
+      for (uint64_t i = written - kept; i < written; i++) {
+        entries.push_back({buffer->records[i % kRecordsPerThread], buffer->tid});
+      }
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+      return a.record.start_us < b.record.start_us;
+    });
+    dump.events = entries.size();
+
+    std::string& json = dump.json;
+    json.reserve(entries.size() * 96 + buffers_.size() * 80 + 64);
+    json += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    const std::string pid_text = std::to_string(pid);
+    bool first = true;
+    for (auto& buffer : buffers_) {
+      if (!buffer->name) {
+        continue;
+      }
+      json += first ? "" : ",";
+      first = false;
+      json += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" + pid_text +
+              ",\"tid\":" + std::to_string(buffer->tid) + ",\"args\":{\"name\":";
+      AppendJsonString(&json, buffer->name);
+      json += "}}";
+    }
+    for (const Entry& entry : entries) {
+      json += first ? "" : ",";
+      first = false;
+      json += "{\"ph\":\"X\",\"name\":";
+      AppendJsonString(&json, entry.record.name);
+      json += ",\"cat\":\"";
+      json += TraceCategoryName(entry.record.category);
+      json += "\",\"ts\":" + std::to_string(entry.record.start_us) +
+              ",\"dur\":" + std::to_string(entry.record.duration_us) + ",\"pid\":" + pid_text +
+              ",\"tid\":" + std::to_string(entry.tid) + "}";
+    }
+    json += "]}";
+    return dump;
+  }
+
+  void Record(TraceCategory category, const char* name, int64_t start_us, int64_t duration_us) {
+    if (!enabled()) {
+      return;
+    }
+    ThreadBuffer* buffer = ThreadBufferFor();
+    if (!buffer) {
+      return;
+    }
+    // Pairs with Stop(): either Stop() sees |writing| and waits, or this
+    // sees tracing has stopped.
+    buffer->writing.store(true);
+    if (enabled_.load()) {
+      TraceRecord& record = buffer->records[buffer->written % kRecordsPerThread];
+      record.name = name;
+      record.start_us = start_us;
+      record.duration_us = duration_us > 0 ? duration_us : 0;
+      record.category = category;
+      buffer->written++;
+    }
+    buffer->writing.store(false, std::memory_order_release);
+  }
+
+ private:
+  struct ThreadBuffer {
+    explicit ThreadBuffer(uint32_t thread_id, const char* thread_name)
+        : records(new TraceRecord[kRecordsPerThread]),
+          written(0),
+          tid(thread_id),
+          name(thread_name),
+          writing(false) {}
+
+    std::unique_ptr<TraceRecord[]> records;
+    // Only the owning thread writes, and only while |writing| is set.
+    uint64_t written;
+    const uint32_t tid;
+    const char* const name;
+    std::atomic<bool> writing;
+  };
+
+  NativeTracer() : enabled_(false) {}
+
+  static const char*& ThreadName() {
+    static thread_local const char* name = nullptr;
+    return name;
+  }
+
+  // The calling thread's buffer, created on its first span.
+  ThreadBuffer* ThreadBufferFor() {
+    static thread_local ThreadBuffer* buffer = nullptr;
+    static thread_local bool refused = false;
+    if (buffer || refused) {
+      return buffer;
+    }
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    if (buffers_.size() >= kMaxThreads) {
+      refused = true;
+      return nullptr;
+    }
+    buffers_.emplace_back(
+        new ThreadBuffer(static_cast<uint32_t>(buffers_.size() + 1), ThreadName()));
+    buffer = buffers_.back().get();
+    return buffer;
+  }
+
+  static void AppendJsonString(std::string* json, const char* text) {
+    *json += '"';
+    for (const char* c = text ? text : ""; *c; c++) {
+      const unsigned char ch = static_cast<unsigned char>(*c);
+      if (ch == '"' || ch == '\\') {
+        *json += '\\';
+        *json += *c;
+      } else if (ch < 0x20) {
+        static const char kHex[] = "0123456789abcdef";
+        *json += "\\u00";
+        *json += kHex[ch >> 4];
+        *json += kHex[ch & 0xf];
+      } else {
+        *json += *c;
+      }
+    }
+    *json += '"';
+  }
+
+  std::atomic<bool> enabled_;
+  // Guards |buffers_| itself; the buffers are written without it.
+  std::mutex buffers_mutex_;
+  // Threads keep their buffer for the life of the process
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+};
+
+// Records the enclosing scope as a span.
+class TraceSpan {
+ public:
+  TraceSpan(TraceCategory category, const char* name)
+      : category_(category), name_(name), begin_us_(NativeTracer::Begin()) {}
+  ~TraceSpan() { NativeTracer::End(category_, name_, begin_us_); }
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+ private:
+  const TraceCategory category_;
+  const char* const name_;
+  const int64_t begin_us_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // NATIVE_TRACE_H_
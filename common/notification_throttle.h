@@ -0,0 +1,328 @@
+#ifndef NOTIFICATION_THROTTLE_H_
+#define NOTIFICATION_THROTTLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+namespace flutter_mcp {
+
+struct NotificationPolicy {
+  // When false every request is shown as soon as it arrives.
+  bool enabled = true;
+  // Token bucket: up to |burst| new notifications at once, refilled at
+  // |rate_per_second|.
+  double rate_per_second = 1.0;
+  size_t burst = 5;
+  // A grouped notification stays open for this long after it was last
+  // shown; requests for its group meanwhile update it instead of popping a
+  // new one.
+  int64_t group_window_ms = 5000;
+  // Requests waiting for a token beyond this are folded into one summary.
+  size_t max_pending = 32;
+};
+
+struct NotificationRequest {
+  std::string id;
+  std::string title;
+  std::string body;
+  // Requests sharing a non-empty key are coalesced into one notification.
+  std::string group_key;
+};
+
+// Something the platform should put on screen. Shows for an |id| already
+// on screen update that notification in place.
+struct NotificationAction {
+  std::string id;
+  std::string title;
+  std::string body;
+};
+
+// Decides which notification requests reach the desktop shell, and when.
+//
+// New notifications spend a token; requests that find the bucket empty
+// wait in arrival order for Flush(). Requests for a notification that is
+// already on screen, either the same id or the same group, never pop a new
+// one: they update it in place, at most once per Flush() for a group, with
+// the group reading "N new events". Times are milliseconds from a
+// monotonic clock. Not thread-safe.
+class NotificationThrottle {
+ public:
+  static constexpr const char* kOverflowGroup = "\x1f" "overflow";
+
+  explicit NotificationThrottle(int64_t now_ms) : last_refill_ms_(now_ms) {
+    tokens_ = static_cast<double>(policy_.burst);
+  }
+
+  NotificationThrottle(const NotificationThrottle&) = delete;
+  NotificationThrottle& operator=(const NotificationThrottle&) = delete;
+
+  void Configure(const NotificationPolicy& policy, int64_t now_ms) {
+    Refill(now_ms);
+    policy_ = policy;
+    if (policy_.burst == 0) {
+      policy_.burst = 1;
+    }
+    if (tokens_ > static_cast<double>(policy_.burst)) {
+      tokens_ = static_cast<double>(policy_.burst);
+    }
+  }
+
+  const NotificationPolicy& policy() const { return policy_; }
+
+  // Returns what to show right away; anything held back comes out of a
+  // later Flush().
+  std::vector<NotificationAction> Submit(const NotificationRequest& request,
+                                         int64_t now_ms) {
+    std::vector<NotificationAction> actions;
+    if (!policy_.enabled) {
+      visible_ids_.insert(request.id);
+      actions.push_back(NotificationAction{request.id, request.title, request.body});
+      return actions;
+    }
+
+    Refill(now_ms);
+    if (!request.group_key.empty()) {
+      SubmitGrouped(request.group_key, request.title, request.body, now_ms, &actions);
+      return actions;
+    }
+
+    // Updating something already on screen adds no popup.
+    if (visible_ids_.count(request.id) > 0) {
+      DropPending(request.id);
+      actions.push_back(NotificationAction{request.id, request.title, request.body});
+      return actions;
+    }
+
+    if (pending_.empty() && TakeToken()) {
+      visible_ids_.insert(request.id);
+      actions.push_back(NotificationAction{request.id, request.title, request.body});
+      return actions;
+    }
+
+    // A newer request for the same id replaces the queued one.
+    for (auto& pending : pending_) {
+      if (pending.group_key.empty() && pending.request.id == request.id) {
+        pending.request = request;
+        return actions;
+      }
+    }
+    if (pending_.size() >= policy_.max_pending) {
+      SubmitGrouped(kOverflowGroup, request.title, request.body, now_ms, &actions);
+      return actions;
+    }
+    Pending pending;
+    pending.request = request;
+    pending_.push_back(std::move(pending));
+    return actions;
+  }
+
+  // Emits grouped updates accumulated since the last call and whatever
+  // pending notifications the refilled bucket now allows.
+  std::vector<NotificationAction> Flush(int64_t now_ms) {
+    std::vector<NotificationAction> actions;
+    Refill(now_ms);
+
+    for (auto& entry : groups_) {
+      Group& group = entry.second;
+      if (group.dirty && group.visible) {
+        group.dirty = false;
+        group.shown_ms = now_ms;
+        actions.push_back(GroupAction(entry.first, group));
+      }
+    }
+
+    while (!pending_.empty() && TakeToken()) {
+      Pending pending = std::move(pending_.front());
+      pending_.pop_front();
+      if (pending.group_key.empty()) {
+        visible_ids_.insert(pending.request.id);
+        actions.push_back(NotificationAction{pending.request.id, pending.request.title,
+                                             pending.request.body});
+        continue;
+      }
+      auto it = groups_.find(pending.group_key);
+      if (it == groups_.end()) {
+        continue;
+      }
+      Group& group = it->second;
+      group.queued = false;
+      group.visible = true;
+      group.dirty = false;
+      group.shown_ms = now_ms;
+      actions.push_back(GroupAction(pending.group_key, group));
+    }
+
+    // Groups left alone for a full window go quiet; the next request for
+    // one starts a new notification.
+    for (auto it = groups_.begin(); it != groups_.end();) {
+      Group& group = it->second;
+      if (group.visible && !group.dirty &&
+          now_ms - group.shown_ms >= policy_.group_window_ms) {
+        group.visible = false;
+        group.count = 0;
+      }
+      if (!group.visible && !group.queued) {
+        it = groups_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    return actions;
+  }
+
+  // Whether Flush() has anything to do; the caller can stop its timer
+  // while this is false.
+  bool HasPendingWork() const {
+    if (!pending_.empty()) {
+      return true;
+    }
+    for (const auto& entry : groups_) {
+      if (entry.second.dirty || entry.second.visible) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Forgets |id| once the platform has closed or cancelled it.
+  void Dismissed(const std::string& id) {
+    visible_ids_.erase(id);
+    DropPending(id);
+    for (auto it = groups_.begin(); it != groups_.end(); ++it) {
+      if (GroupId(it->first) == id) {
+        if (it->second.queued) {
+          DropGroupPending(it->first);
+        }
+        groups_.erase(it);
+        break;
+      }
+    }
+  }
+
+  void Clear() {
+    visible_ids_.clear();
+    pending_.clear();
+    groups_.clear();
+  }
+
+  size_t pending_count() const { return pending_.size(); }
+
+  // Notification id under which a group is shown.
+  static std::string GroupId(const std::string& group_key) {
+    return "group:" + group_key;
+  }
+
+ private:
+  struct Group {
+    std::string title;
+    std::string body;
+    // Requests folded into the notification since it was first shown.
+    size_t count = 0;
+    bool visible = false;
+    // Waiting in |pending_| for a token.
+    bool queued = false;
+    // Changed since it was last emitted.
+    bool dirty = false;
+    int64_t shown_ms = 0;
+  };
+
+  struct Pending {
+    NotificationRequest request;
+    // Set for a group waiting to be shown; |request| is unused then.
+    std::string group_key;
+  };
+
+  void SubmitGrouped(const std::string& key, const std::string& title,
+                     const std::string& body, int64_t now_ms,
+                     std::vector<NotificationAction>* actions) {
+    Group& group = groups_[key];
+    group.title = title;
+    group.body = body;
+    group.count++;
+
+    if (group.visible || group.queued) {
+      group.dirty = group.visible;
+      return;
+    }
+    if (pending_.empty() && TakeToken()) {
+      group.visible = true;
+      group.shown_ms = now_ms;
+      actions->push_back(GroupAction(key, group));
+      return;
+    }
+    group.queued = true;
+    Pending pending;
+    pending.group_key = key;
+    pending_.push_back(std::move(pending));
+  }
+
+  NotificationAction GroupAction(const std::string& key, const Group& group) const {
+    NotificationAction action;
+    action.id = GroupId(key);
+    action.title = group.title;
+    if (group.count > 1) {
+      action.body = std::to_string(group.count) + " new events";
+    } else {
+      action.body = group.body;
+    }
+    return action;
+  }
+
+  bool TakeToken() {
+    if (tokens_ < 1.0) {
+      return false;
+    }
+    tokens_ -= 1.0;
+    return true;
+  }
+
+  void Refill(int64_t now_ms) {
+    if (now_ms > last_refill_ms_) {
+      tokens_ += static_cast<double>(now_ms - last_refill_ms_) *
+                 policy_.rate_per_second / 1000.0;
+      const double burst = static_cast<double>(policy_.burst);
+      if (tokens_ > burst) {
+        tokens_ = burst;
+      }
+      last_refill_ms_ = now_ms;
+    }
+  }
+
+  void DropPending(const std::string& id) {
+    for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+      if (it->group_key.empty() && it->request.id == id) {
+        pending_.erase(it);
+        return;
+      }
+    }
+  }
+
+  void DropGroupPending(const std::string& key) {
+    for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+      if (it->group_key == key) {
+        pending_.erase(it);
+        return;
+      }
+    }
+  }
+
+  NotificationPolicy policy_;
+  double tokens_ = 0;
+  int64_t last_refill_ms_;
+  // Ungrouped notifications believed to be on screen.
+  std::unordered_set<std::string> visible_ids_;
+  std::deque<Pending> pending_;
+  std::unordered_map<std::string, Group> groups_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // NOTIFICATION_THROTTLE_H_
@@ -0,0 +1,80 @@
+#ifndef RECURRENCE_H_
+#define RECURRENCE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+namespace flutter_mcp {
+
+enum class RecurrenceMode {
+  // Runs are spaced |period_ms| apart from the first run's nominal time, so
+  // the schedule does not drift with run times.
+  kFixedRate,
+  // Each run starts |period_ms| after the previous one finished.
+  kFixedDelay,
+};
+
+// What a fixed-rate job does when a run finishes after the next one was due.
+enum class OverrunPolicy {
+  // Drop the missed runs and resume on the next slot still ahead.
+  kSkip,
+  // Run the missed slots back to back until the job is on schedule again.
+  kCatchUp,
+};
+
+struct Recurrence {
+  RecurrenceMode mode = RecurrenceMode::kFixedRate;
+  int64_t period_ms = 0;
+  // Each run is delayed by a uniform random [0, jitter_ms] on top of its
+  // nominal time. The delay never accumulates.
+  int64_t jitter_ms = 0;
+  OverrunPolicy overrun = OverrunPolicy::kSkip;
+};
+
+// "fixedDelay" selects kFixedDelay; anything else kFixedRate.
+inline RecurrenceMode ParseRecurrenceMode(const char* name) {
+  return name && std::strcmp(name, "fixedDelay") == 0 ? RecurrenceMode::kFixedDelay
+                                                      : RecurrenceMode::kFixedRate;
+}
+
+// "catchUp" selects kCatchUp; anything else kSkip.
+inline OverrunPolicy ParseOverrunPolicy(const char* name) {
+  return name && std::strcmp(name, "catchUp") == 0 ? OverrunPolicy::kCatchUp
+                                                   : OverrunPolicy::kSkip;
+}
+
+// Returns the nominal time of the run after the one nominally due at
+// |last| that finished at |finished|. A non-positive period is treated as
+// 1 ms so a misconfigured job cannot spin.
+template <typename TimePoint>
+TimePoint NextNominalRun(const Recurrence& recurrence, TimePoint last, TimePoint finished) {
+  const auto period = std::chrono::duration_cast<typename TimePoint::duration>(
+      std::chrono::milliseconds(recurrence.period_ms > 0 ? recurrence.period_ms : 1));
+  if (recurrence.mode == RecurrenceMode::kFixedDelay) {
+    return finished + period;
+  }
+
+  TimePoint next = last + period;
+  if (next < finished && recurrence.overrun == OverrunPolicy::kSkip) {
+    next += period * ((finished - next) / period + 1);
+  }
+  return next;
+}
+
+// Draws the extra delay for one run.
+template <typename Engine>
+std::chrono::milliseconds DrawJitter(const Recurrence& recurrence, Engine& engine) {
+  if (recurrence.jitter_ms <= 0) {
+    return std::chrono::milliseconds(0);
+  }
+  std::uniform_int_distribution<int64_t> distribution(0, recurrence.jitter_ms);
+  return std::chrono::milliseconds(distribution(engine));
+}
+
+}  // namespace flutter_mcp
+
+#endif  // RECURRENCE_H_
@@ -0,0 +1,160 @@
+#ifndef SECRET_CACHE_H_
+#define SECRET_CACHE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+namespace flutter_mcp {
+
+struct SecretCacheConfig {
+  bool enabled = false;
+  // Least recently used values are evicted beyond this many entries.
+  size_t max_entries = 64;
+  // Values older than this are dropped on their next lookup.
+  int64_t ttl_ms = 30000;
+};
+
+// Overwrites |value|'s bytes before releasing them, in a way the compiler
+// may not elide.
+inline void SecureZero(std::string& value) {
+  if (!value.empty()) {
+    volatile char* bytes = &value[0];
+    for (size_t i = 0; i < value.size(); i++) {
+      bytes[i] = 0;
+    }
+  }
+  value.clear();
+  value.shrink_to_fit();
+}
+
+// Bounded LRU cache of decrypted secure storage values.
+//
+// Disabled until configured. Every value leaving the cache through
+// eviction, expiry, invalidation or Clear() is zeroed first.
+class SecretCache {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  SecretCache() = default;
+  ~SecretCache() { Clear(); }
+
+  SecretCache(const SecretCache&) = delete;
+  SecretCache& operator=(const SecretCache&) = delete;
+
+  void Configure(const SecretCacheConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    if (config_.max_entries == 0 || config_.ttl_ms <= 0) {
+      config_.enabled = false;
+    }
+    if (!config_.enabled) {
+      ClearLocked();
+      return;
+    }
+    while (entries_.size() > config_.max_entries) {
+      EvictLocked(std::prev(entries_.end()));
+    }
+  }
+
+  // Copies a live cached value into |value| and marks it recently used.
+  bool Lookup(const std::string& key, std::string& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+      return false;
+    }
+    if (Clock::now() >= it->second->expires) {
+      EvictLocked(it->second);
+      return false;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    value = it->second->value;
+    return true;
+  }
+
+  void Put(const std::string& key, const std::string& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!config_.enabled) {
+      return;
+    }
+
+    const auto expires = Clock::now() + std::chrono::milliseconds(config_.ttl_ms);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      SecureZero(it->second->value);
+      it->second->value = value;
+      it->second->expires = expires;
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return;
+    }
+
+    entries_.push_front(Entry{key, value, expires});
+    index_[key] = entries_.begin();
+    if (entries_.size() > config_.max_entries) {
+      EvictLocked(std::prev(entries_.end()));
+    }
+  }
+
+  void Invalidate(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      EvictLocked(it->second);
+    }
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ClearLocked();
+  }
+
+  size_t size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+  }
+
+  bool enabled() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_.enabled;
+  }
+
+ private:
+  struct Entry {
+    std::string key;
+    std::string value;
+    Clock::time_point expires;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  void EvictLocked(EntryList::iterator entry) {
+    SecureZero(entry->value);
+    index_.erase(entry->key);
+    entries_.erase(entry);
+  }
+
+  void ClearLocked() {
+    for (auto& entry : entries_) {
+      SecureZero(entry.value);
+    }
+    entries_.clear();
+    index_.clear();
+  }
+
+  SecretCacheConfig config_;
+  // Most recently used first.
+  EntryList entries_;
+  std::unordered_map<std::string, EntryList::iterator> index_;
+  std::mutex mutex_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // SECRET_CACHE_H_
@@ -0,0 +1,406 @@
+#include "task_scheduler.h"
+
+#include <utility>
+
+#include "native_metrics.h"
+#include "native_trace.h"
+
+namespace flutter_mcp {
+
+TaskScheduler::TaskScheduler()
+    : next_sequence_(0),
+      next_generation_(0),
+      jitter_engine_(std::random_device()()),
+      running_(false),
+      stopping_(false),
+      lateness_(nullptr),
+      armed_(false),
+      workers_(WorkerPool::DefaultThreadCount()) {}
+
+TaskScheduler::~TaskScheduler() {
+  Stop();
+}
+
+void TaskScheduler::Schedule(const std::string& task_id, int64_t delay_millis,
+                             Task task, TaskPriority priority,
+                             WorkerPool::Completion on_complete) {
+  if (delay_millis < 0) {
+    delay_millis = 0;
+  }
+
+  Entry entry;
+  entry.deadline = Clock::now() + std::chrono::milliseconds(delay_millis);
+  entry.id = task_id;
+  entry.task = std::move(task);
+  entry.priority = priority;
+  entry.on_complete = std::move(on_complete);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // A one-shot task takes over the id from any recurring job.
+  recurring_.erase(task_id);
+  InsertLocked(std::move(entry));
+}
+
+void TaskScheduler::ScheduleRecurring(const std::string& task_id,
+                                      int64_t initial_delay_millis,
+                                      const Recurrence& recurrence, Task task,
+                                      TaskPriority priority,
+                                      WorkerPool::Completion on_complete) {
+  if (initial_delay_millis < 0) {
+    initial_delay_millis = 0;
+  }
+
+  auto job = std::make_shared<RecurringJob>();
+  job->id = task_id;
+  job->recurrence = recurrence;
+  job->task = std::move(task);
+  job->priority = priority;
+  job->on_complete = std::move(on_complete);
+  job->nominal = Clock::now() + std::chrono::milliseconds(initial_delay_millis);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  job->generation = next_generation_++;
+  recurring_[task_id] = job->generation;
+
+  Entry entry;
+  entry.deadline = job->nominal + DrawJitter(recurrence, jitter_engine_);
+  entry.id = task_id;
+  entry.priority = priority;
+  entry.job = std::move(job);
+  InsertLocked(std::move(entry));
+}
+
+void TaskScheduler::InsertLocked(Entry entry) {
+  if (!timer_) {
+    EnsureStartedLocked();
+  }
+
+  entry.sequence = next_sequence_++;
+  const uint64_t sequence = entry.sequence;
+  auto it = index_.find(entry.id);
+  size_t position;
+  if (it != index_.end()) {
+    // Reschedule in place; the new deadline may move the entry either way.
+    position = it->second;
+    heap_[position] = std::move(entry);
+    Restore(position);
+  } else {
+    position = heap_.size();
+    heap_.push_back(std::move(entry));
+    index_[heap_.back().id] = position;
+    SiftUp(position);
+  }
+
+  // Only wake the scheduler when the earliest deadline has changed.
+  if (heap_.front().sequence == sequence) {
+    if (timer_) {
+      ArmLocked();
+    } else {
+      cv_.notify_one();
+    }
+  }
+}
+
+void TaskScheduler::RescheduleRecurring(const std::shared_ptr<RecurringJob>& job) {
+  const Clock::time_point finished = Clock::now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = recurring_.find(job->id);
+  if (it == recurring_.end() || it->second != job->generation) {
+    return;
+  }
+
+  job->nominal = NextNominalRun(job->recurrence, job->nominal, finished);
+  Entry entry;
+  entry.deadline = job->nominal + DrawJitter(job->recurrence, jitter_engine_);
+  entry.id = job->id;
+  entry.priority = job->priority;
+  entry.job = job;
+  InsertLocked(std::move(entry));
+}
+
+void TaskScheduler::Dispatch(Entry entry) {
+  TraceSpan span(TraceCategory::kScheduler, "dispatch");
+  if (!entry.job) {
+    workers_.Submit(std::move(entry.task), entry.priority,
+                    std::move(entry.on_complete));
+    return;
+  }
+
+  // The job keeps its work for the next run, so each run gets a copy.
+  std::shared_ptr<RecurringJob> job = std::move(entry.job);
+  workers_.Submit(job->task, job->priority, [this, job](const TaskTiming& timing) {
+    if (job->on_complete) {
+      job->on_complete(timing);
+    }
+    RescheduleRecurring(job);
+  });
+}
+
+bool TaskScheduler::Cancel(const std::string& task_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const bool recurring = recurring_.erase(task_id) > 0;
+  auto it = index_.find(task_id);
+  if (it == index_.end()) {
+    return recurring;
+  }
+
+  // The scheduler recomputes its wait deadline when it wakes, so a
+  // cancelled head only costs one spurious wakeup.
+  RemoveAt(it->second);
+  return true;
+}
+
+void TaskScheduler::Stop() {
+  std::thread thread;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (timer_) {
+      // Nothing to join; the timer is disarmed once the heap is empty.
+      heap_.clear();
+      index_.clear();
+      recurring_.clear();
+      ArmLocked();
+    } else {
+      if (!running_ || stopping_) {
+        return;
+      }
+      heap_.clear();
+      index_.clear();
+      recurring_.clear();
+      // A task cannot join its own thread; from there Stop() only drops the
+      // pending tasks and the thread exits on the next Stop() or destruction.
+      if (thread_.get_id() == std::this_thread::get_id()) {
+        return;
+      }
+      stopping_ = true;
+      thread = std::move(thread_);
+    }
+  }
+  const bool joining = thread.joinable();
+  cv_.notify_all();
+
+  if (joining) {
+    thread.join();
+  }
+  workers_.Shutdown();
+
+  if (!joining) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  running_ = false;
+  stopping_ = false;
+  // Tasks scheduled while the old thread was shutting down still need one.
+  if (!heap_.empty()) {
+    EnsureStartedLocked();
+  }
+}
+
+void TaskScheduler::SetTimer(std::unique_ptr<SchedulerTimer> timer) {
+  std::thread thread;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (timer_ && armed_) {
+      timer_->Disarm();
+      armed_ = false;
+    }
+    if (!timer_ && running_ && !stopping_) {
+      stopping_ = true;
+      thread = std::move(thread_);
+    }
+  }
+  cv_.notify_all();
+  if (thread.joinable()) {
+    thread.join();
+  }
+
+  // Destroyed after the lock is released, since a timer may wait out a
+  // RunDue() in flight when it goes away.
+  std::unique_ptr<SchedulerTimer> previous;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stopping_) {
+    running_ = false;
+    stopping_ = false;
+  }
+  previous = std::move(timer_);
+  timer_ = std::move(timer);
+  if (timer_) {
+    ArmLocked();
+  } else if (!heap_.empty()) {
+    EnsureStartedLocked();
+  }
+}
+
+void TaskScheduler::RunDue() {
+  std::vector<Entry> due;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!timer_) {
+      return;
+    }
+    armed_ = false;
+    TakeDueLocked(Clock::now(), &due);
+    ArmLocked();
+  }
+
+  for (auto& entry : due) {
+    Dispatch(std::move(entry));
+  }
+}
+
+void TaskScheduler::TakeDueLocked(Clock::time_point now, std::vector<Entry>* due) {
+  while (!heap_.empty() && heap_.front().deadline <= now) {
+    if (lateness_) {
+      lateness_->Record(std::chrono::duration_cast<std::chrono::microseconds>(
+                            now - heap_.front().deadline)
+                            .count());
+    }
+    due->push_back(RemoveAt(0));
+  }
+}
+
+void TaskScheduler::ArmLocked() {
+  if (heap_.empty()) {
+    if (armed_) {
+      timer_->Disarm();
+      armed_ = false;
+    }
+    return;
+  }
+  const Clock::time_point deadline = heap_.front().deadline;
+  if (!armed_ || deadline != armed_deadline_) {
+    timer_->Arm(deadline);
+    armed_ = true;
+    armed_deadline_ = deadline;
+  }
+}
+
+size_t TaskScheduler::PendingCount() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return heap_.size();
+}
+
+size_t TaskScheduler::RecurringCount() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return recurring_.size();
+}
+
+void TaskScheduler::SetWorkerThreads(size_t count) {
+  workers_.SetThreadCount(count);
+}
+
+void TaskScheduler::SetLatenessHistogram(LatencyHistogram* histogram) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  lateness_ = histogram;
+}
+
+void TaskScheduler::EnsureStartedLocked() {
+  if (running_) {
+    return;
+  }
+  running_ = true;
+  stopping_ = false;
+  thread_ = std::thread(&TaskScheduler::Run, this);
+}
+
+void TaskScheduler::Run() {
+  NativeTracer::NameThread("scheduler");
+  std::vector<Entry> due;
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (!stopping_) {
+    if (heap_.empty()) {
+      cv_.wait(lock, [this] { return !heap_.empty() || stopping_; });
+      continue;
+    }
+
+    auto now = Clock::now();
+    const Clock::time_point next_deadline = heap_.front().deadline;
+    if (next_deadline > now) {
+      cv_.wait_until(lock, next_deadline);
+      continue;
+    }
+
+    // Drain every task that is due and hand them to the workers outside the
+    // lock so that tasks may schedule or cancel without deadlocking.
+    TakeDueLocked(now, &due);
+
+    lock.unlock();
+    for (auto& entry : due) {
+      Dispatch(std::move(entry));
+    }
+    due.clear();
+    lock.lock();
+  }
+}
+
+bool TaskScheduler::Earlier(size_t a, size_t b) const {
+  if (heap_[a].deadline != heap_[b].deadline) {
+    return heap_[a].deadline < heap_[b].deadline;
+  }
+  // Tasks with equal deadlines fire in scheduling order.
+  return heap_[a].sequence < heap_[b].sequence;
+}
+
+void TaskScheduler::SwapEntries(size_t a, size_t b) {
+  std::swap(heap_[a], heap_[b]);
+  index_[heap_[a].id] = a;
+  index_[heap_[b].id] = b;
+}
+
+void TaskScheduler::SiftUp(size_t i) {
+  while (i > 0) {
+    size_t parent = (i - 1) / 2;
+    if (!Earlier(i, parent)) {
+      break;
+    }
+    SwapEntries(i, parent);
+    i = parent;
+  }
+}
+
+void TaskScheduler::SiftDown(size_t i) {
+  const size_t size = heap_.size();
+  while (true) {
+    size_t smallest = i;
+    size_t left = 2 * i + 1;
+    size_t right = left + 1;
+    if (left < size && Earlier(left, smallest)) {
+      smallest = left;
+    }
+    if (right < size && Earlier(right, smallest)) {
+      smallest = right;
+    }
+    if (smallest == i) {
+      break;
+    }
+    SwapEntries(i, smallest);
+    i = smallest;
+  }
+}
+
+void TaskScheduler::Restore(size_t i) {
+  if (i > 0 && Earlier(i, (i - 1) / 2)) {
+    SiftUp(i);
+  } else {
+    SiftDown(i);
+  }
+}
+
+TaskScheduler::Entry TaskScheduler::RemoveAt(size_t i) {
+  const size_t last = heap_.size() - 1;
+  if (i != last) {
+    SwapEntries(i, last);
+  }
+
+  Entry entry = std::move(heap_.back());
+  heap_.pop_back();
+  index_.erase(entry.id);
+
+  if (i < heap_.size()) {
+    Restore(i);
+  }
+  return entry;
+}
+
+}  // namespace flutter_mcp
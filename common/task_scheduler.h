@@ -0,0 +1,171 @@
+#ifndef TASK_SCHEDULER_H_
+#define TASK_SCHEDULER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "recurrence.h"
+#include "worker_pool.h"
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+namespace flutter_mcp {
+
+class LatencyHistogram;
+
+// Wakes a TaskScheduler from the host event loop in place of its thread.
+class SchedulerTimer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  virtual ~SchedulerTimer() = default;
+
+  // Requests one call to TaskScheduler::RunDue() at or soon after
+  // |deadline|, replacing any earlier request. Called from any thread with
+  // the scheduler's lock held, so it must not call RunDue() itself.
+  virtual void Arm(Clock::time_point deadline) = 0;
+  // Drops the pending request, if any.
+  virtual void Disarm() = 0;
+};
+
+// Task scheduler backed by an indexed min-heap of deadlines.
+//
+// Tasks fire when they are due rather than on the background service's
+// periodic tick: either a SchedulerTimer arms the host event loop for the
+// earliest deadline, or, without one, a scheduler thread sleeps until it.
+// Schedule/Cancel are O(log n). Due tasks run on a WorkerPool so a slow
+// task cannot delay the ones behind it. Recurring jobs put their next run
+// back on the heap when the current one completes.
+class TaskScheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Task = std::function<void()>;
+
+  TaskScheduler();
+  ~TaskScheduler();
+
+  TaskScheduler(const TaskScheduler&) = delete;
+  TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+  // Schedules |task| to run after |delay_millis|. Scheduling an id that is
+  // already pending replaces the previous task and deadline. |on_complete|
+  // runs on the worker after |task| with its queueing delay and run time.
+  void Schedule(const std::string& task_id, int64_t delay_millis, Task task,
+                TaskPriority priority = TaskPriority::kNormal,
+                WorkerPool::Completion on_complete = nullptr);
+
+  // Runs |task| on |recurrence|, first after |initial_delay_millis|. The
+  // next run is queued once the previous one and its |on_complete| finish,
+  // so runs of one job never overlap. Replaces any task with the same id.
+  void ScheduleRecurring(const std::string& task_id, int64_t initial_delay_millis,
+                         const Recurrence& recurrence, Task task,
+                         TaskPriority priority = TaskPriority::kNormal,
+                         WorkerPool::Completion on_complete = nullptr);
+
+  // Returns true if a pending task with |task_id| was removed. A recurring
+  // job is stopped even while a run is in flight.
+  bool Cancel(const std::string& task_id);
+
+  // Stops the scheduler thread and drops all pending tasks, recurring ones
+  // included. The scheduler restarts on the next call to Schedule. With a
+  // timer, must not race RunDue().
+  void Stop();
+
+  // Dispatches through |timer| instead of the scheduler thread, or returns
+  // to the thread when nullptr. Pending tasks are kept. The previous timer
+  // is destroyed without the scheduler's lock held.
+  void SetTimer(std::unique_ptr<SchedulerTimer> timer);
+
+  // Hands every due task to the workers and re-arms the timer for the next
+  // one. Called by the timer; does nothing without one.
+  void RunDue();
+
+  size_t PendingCount();
+  // Number of registered recurring jobs, whether queued or running.
+  size_t RecurringCount();
+
+  // Number of worker threads that run due tasks. Zero runs them inline on
+  // the scheduler thread.
+  void SetWorkerThreads(size_t count);
+
+  // Records how late each due task is dispatched, in microseconds. The
+  // histogram must outlive the scheduler; nullptr stops recording.
+  void SetLatenessHistogram(LatencyHistogram* histogram);
+
+ private:
+  struct RecurringJob {
+    std::string id;
+    // Matches recurring_[id] while this registration is current.
+    uint64_t generation;
+    Recurrence recurrence;
+    Task task;
+    TaskPriority priority;
+    WorkerPool::Completion on_complete;
+    // When the current run was due, before jitter.
+    Clock::time_point nominal;
+  };
+
+  struct Entry {
+    Clock::time_point deadline;
+    uint64_t sequence;
+    std::string id;
+    Task task;
+    TaskPriority priority;
+    WorkerPool::Completion on_complete;
+    // Set for a run of a recurring job, which then owns the work.
+    std::shared_ptr<RecurringJob> job;
+  };
+
+  void Run();
+  void EnsureStartedLocked();
+  // Adds |entry| to the heap, replacing any entry with the same id, and
+  // wakes the thread or timer if it became the earliest.
+  void InsertLocked(Entry entry);
+  // Queues the next run of |job| unless it was cancelled or replaced.
+  void RescheduleRecurring(const std::shared_ptr<RecurringJob>& job);
+  void Dispatch(Entry entry);
+  // Moves every task due by |now| from the heap to |due|.
+  void TakeDueLocked(Clock::time_point now, std::vector<Entry>* due);
+  // Points the timer at the earliest deadline, or disarms it when idle.
+  void ArmLocked();
+  bool Earlier(size_t a, size_t b) const;
+  void SwapEntries(size_t a, size_t b);
+  void SiftUp(size_t i);
+  void SiftDown(size_t i);
+  void Restore(size_t i);
+  Entry RemoveAt(size_t i);
+
+  std::vector<Entry> heap_;
+  std::unordered_map<std::string, size_t> index_;
+  uint64_t next_sequence_;
+  // Current generation of every recurring job, keyed by task id.
+  std::unordered_map<std::string, uint64_t> recurring_;
+  uint64_t next_generation_;
+  std::minstd_rand jitter_engine_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread thread_;
+  bool running_;
+  bool stopping_;
+  LatencyHistogram* lateness_;
+
+  std::unique_ptr<SchedulerTimer> timer_;
+  bool armed_;
+  Clock::time_point armed_deadline_;
+
+  WorkerPool workers_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // TASK_SCHEDULER_H_
@@ -0,0 +1,93 @@
+#ifndef TIMER_WHEEL_H_
+#define TIMER_WHEEL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+namespace flutter_mcp {
+
+// Hashed timer wheel: any number of deadlines driven by one periodic tick.
+//
+// Deadlines are rounded up to whole ticks and sorted into |slot_count|
+// buckets by tick, so scheduling and cancelling are O(1) and a tick only
+// looks at one bucket. Times are plain milliseconds from any monotonic
+// clock, passed in by the caller. Not thread-safe.
+class TimerWheel {
+ public:
+  using TimerId = uint64_t;
+
+  TimerWheel(size_t slot_count, uint64_t tick_ms, uint64_t now_ms)
+      : tick_ms_(tick_ms > 0 ? tick_ms : 1),
+        current_tick_(now_ms / tick_ms_),
+        slots_(slot_count > 0 ? slot_count : 1) {}
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  // Fires on the first Advance() at or after |now_ms| + |delay_ms|.
+  TimerId Schedule(uint64_t now_ms, uint64_t delay_ms) {
+    uint64_t deadline_tick = (now_ms + delay_ms + tick_ms_ - 1) / tick_ms_;
+    if (deadline_tick <= current_tick_) {
+      deadline_tick = current_tick_ + 1;
+    }
+    const TimerId id = next_id_++;
+    timers_[id] = deadline_tick;
+    slots_[deadline_tick % slots_.size()].push_back(id);
+    return id;
+  }
+
+  // Returns false if |id| already fired or was cancelled. The bucket entry
+  // is dropped lazily when its slot next comes round.
+  bool Cancel(TimerId id) { return timers_.erase(id) > 0; }
+
+  // Moves the wheel to |now_ms| and appends the timers that came due to
+  // |expired|.
+  void Advance(uint64_t now_ms, std::vector<TimerId>* expired) {
+    const uint64_t now_tick = now_ms / tick_ms_;
+    if (now_tick <= current_tick_) {
+      return;
+    }
+
+    // After a long stall every bucket is due for a look, but only once.
+    const uint64_t ticks = now_tick - current_tick_;
+    const uint64_t visits = ticks < slots_.size() ? ticks : slots_.size();
+    for (uint64_t i = 1; i <= visits; i++) {
+      std::vector<TimerId>& slot = slots_[(current_tick_ + i) % slots_.size()];
+      size_t kept = 0;
+      for (TimerId id : slot) {
+        auto it = timers_.find(id);
+        if (it == timers_.end()) {
+          continue;
+        }
+        if (it->second <= now_tick) {
+          expired->push_back(id);
+          timers_.erase(it);
+        } else {
+          slot[kept++] = id;
+        }
+      }
+      slot.resize(kept);
+    }
+    current_tick_ = now_tick;
+  }
+
+  bool empty() const { return timers_.empty(); }
+  size_t size() const { return timers_.size(); }
+  uint64_t tick_ms() const { return tick_ms_; }
+
+ private:
+  const uint64_t tick_ms_;
+  uint64_t current_tick_;
+  TimerId next_id_ = 1;
+  // Deadline tick of every pending timer.
+  std::unordered_map<TimerId, uint64_t> timers_;
+  std::vector<std::vector<TimerId>> slots_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // TIMER_WHEEL_H_
@@ -0,0 +1,132 @@
+#ifndef TRAY_MENU_DIFF_H_
+#define TRAY_MENU_DIFF_H_
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+namespace flutter_mcp {
+
+struct TrayMenuItem {
+  std::string id;
+  std::string label;
+  bool is_separator = false;
+  bool disabled = false;
+};
+
+// One edit to a menu, applied in order to the menu as it stands after the
+// previous edits.
+struct TrayMenuOp {
+  enum class Kind {
+    // Add |item| at |index|.
+    kInsert,
+    // Remove the entry at |index|.
+    kRemove,
+    // Move the entry at |from| to |index|; |index| < |from|.
+    kMove,
+    // Relabel or re-enable the entry at |index| to match |item|.
+    kUpdate,
+  };
+
+  Kind kind;
+  size_t index;
+  size_t from;
+  // Points into the |next| list given to DiffTrayMenu.
+  const TrayMenuItem* item;
+};
+
+inline bool SameTrayMenuContent(const TrayMenuItem& a, const TrayMenuItem& b) {
+  return a.is_separator == b.is_separator && a.label == b.label &&
+         a.disabled == b.disabled;
+}
+
+// Identifies each entry across menu versions: by id, else by its ordinal
+// among the id-less entries of its kind. Duplicates get a suffix so that
+// every key is unique.
+inline std::vector<std::string> TrayMenuKeys(const std::vector<TrayMenuItem>& items) {
+  std::vector<std::string> keys;
+  keys.reserve(items.size());
+  std::unordered_map<std::string, size_t> seen;
+  for (const auto& item : items) {
+    std::string key = !item.id.empty()
+                          ? item.id
+                          : std::string(item.is_separator ? "\x1fseparator" : "\x1fitem");
+    size_t& count = seen[key];
+    if (count++ > 0 || item.id.empty()) {
+      key += "\x1f" + std::to_string(count);
+    }
+    keys.push_back(key);
+  }
+  return keys;
+}
+
+// Returns the edits that turn |current| into |next|, keeping the entries
+// whose key survives: removals first, then one pass that moves, inserts
+// and updates entries into place.
+inline std::vector<TrayMenuOp> DiffTrayMenu(const std::vector<TrayMenuItem>& current,
+                                            const std::vector<TrayMenuItem>& next) {
+  std::vector<TrayMenuOp> ops;
+  std::vector<std::string> keys = TrayMenuKeys(current);
+  const std::vector<std::string> next_keys = TrayMenuKeys(next);
+  std::vector<const TrayMenuItem*> items;
+  for (const auto& item : current) {
+    items.push_back(&item);
+  }
+
+  const std::unordered_set<std::string> wanted(next_keys.begin(), next_keys.end());
+  for (size_t i = keys.size(); i-- > 0;) {
+    if (wanted.count(keys[i]) == 0) {
+      ops.push_back(TrayMenuOp{TrayMenuOp::Kind::kRemove, i, 0, nullptr});
+      keys.erase(keys.begin() + i);
+      items.erase(items.begin() + i);
+    }
+  }
+
+  // An entry that turned into or out of a separator is replaced; anything
+  // else changes in place.
+  auto reconcile = [&](size_t i) {
+    if (SameTrayMenuContent(*items[i], next[i])) {
+      return;
+    }
+    if (items[i]->is_separator != next[i].is_separator) {
+      ops.push_back(TrayMenuOp{TrayMenuOp::Kind::kRemove, i, 0, nullptr});
+      ops.push_back(TrayMenuOp{TrayMenuOp::Kind::kInsert, i, 0, &next[i]});
+    } else {
+      ops.push_back(TrayMenuOp{TrayMenuOp::Kind::kUpdate, i, 0, &next[i]});
+    }
+    items[i] = &next[i];
+  };
+
+  for (size_t i = 0; i < next.size(); i++) {
+    if (i < keys.size() && keys[i] == next_keys[i]) {
+      reconcile(i);
+      continue;
+    }
+
+    size_t from = i + 1;
+    while (from < keys.size() && keys[from] != next_keys[i]) {
+      from++;
+    }
+    if (from < keys.size()) {
+      ops.push_back(TrayMenuOp{TrayMenuOp::Kind::kMove, i, from, &next[i]});
+      keys.insert(keys.begin() + i, keys[from]);
+      keys.erase(keys.begin() + from + 1);
+      items.insert(items.begin() + i, items[from]);
+      items.erase(items.begin() + from + 1);
+      reconcile(i);
+    } else {
+      ops.push_back(TrayMenuOp{TrayMenuOp::Kind::kInsert, i, 0, &next[i]});
+      keys.insert(keys.begin() + i, next_keys[i]);
+      items.insert(items.begin() + i, &next[i]);
+    }
+  }
+  return ops;
+}
+
+}  // namespace flutter_mcp
+
+#endif  // TRAY_MENU_DIFF_H_
@@ -0,0 +1,237 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "native_trace.h"
+
+namespace flutter_mcp {
+
+TaskPriority ParseTaskPriority(const char* name) {
+  if (name == nullptr) {
+    return TaskPriority::kNormal;
+  }
+  if (strcmp(name, "high") == 0) {
+    return TaskPriority::kHigh;
+  }
+  if (strcmp(name, "low") == 0) {
+    return TaskPriority::kLow;
+  }
+  return TaskPriority::kNormal;
+}
+
+WorkerPool::WorkerPool(size_t thread_count)
+    : thread_count_(thread_count), next_queue_(0) {}
+
+WorkerPool::~WorkerPool() {
+  Shutdown();
+}
+
+size_t WorkerPool::DefaultThreadCount() {
+  size_t hardware = std::thread::hardware_concurrency();
+  return (std::max)(static_cast<size_t>(1), (std::min)(static_cast<size_t>(4), hardware / 2));
+}
+
+void WorkerPool::Submit(Work work, TaskPriority priority,
+                        Completion on_complete) {
+  Job job;
+  job.work = std::move(work);
+  job.on_complete = std::move(on_complete);
+  job.priority = priority;
+  job.submit_time = Clock::now();
+
+  {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    if (thread_count_ > 0) {
+      // Workers start on first use so an idle pool costs no threads.
+      if (!crew_) {
+        StartLocked();
+      }
+      EnqueueLocked(std::move(job));
+      return;
+    }
+  }
+
+  // No workers configured: run inline on the caller.
+  RunJob(job);
+}
+
+void WorkerPool::SetThreadCount(size_t thread_count) {
+  Retired retired;
+  {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    if (thread_count == thread_count_) {
+      return;
+    }
+    retired = DetachLocked();
+    thread_count_ = thread_count;
+  }
+
+  // Joined and run without the lock, so jobs finishing meanwhile may Submit.
+  std::vector<Job> queued = Join(retired);
+  if (queued.empty()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    if (thread_count_ > 0) {
+      if (!crew_) {
+        StartLocked();
+      }
+      for (auto& job : queued) {
+        EnqueueLocked(std::move(job));
+      }
+      return;
+    }
+  }
+  for (auto& job : queued) {
+    RunJob(job);
+  }
+}
+
+size_t WorkerPool::thread_count() {
+  std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+  return thread_count_;
+}
+
+void WorkerPool::Shutdown() {
+  Retired retired;
+  {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    retired = DetachLocked();
+  }
+  Join(retired);
+}
+
+void WorkerPool::StartLocked() {
+  crew_ = std::make_shared<Crew>();
+  for (size_t i = 0; i < thread_count_; i++) {
+    crew_->queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+  }
+  for (size_t i = 0; i < thread_count_; i++) {
+    threads_.emplace_back(&WorkerPool::WorkerLoop, crew_, i);
+  }
+}
+
+void WorkerPool::EnqueueLocked(Job job) {
+  Crew& crew = *crew_;
+  {
+    std::lock_guard<std::mutex> idle_lock(crew.idle_mutex);
+    crew.pending++;
+  }
+  WorkerQueue& queue = *crew.queues[next_queue_++ % crew.queues.size()];
+  {
+    std::lock_guard<std::mutex> queue_lock(queue.mutex);
+    queue.jobs[static_cast<int>(job.priority)].push_back(std::move(job));
+  }
+  crew.idle_cv.notify_one();
+}
+
+WorkerPool::Retired WorkerPool::DetachLocked() {
+  Retired retired;
+  if (!crew_) {
+    return retired;
+  }
+  {
+    std::lock_guard<std::mutex> idle_lock(crew_->idle_mutex);
+    crew_->stopping = true;
+  }
+  crew_->idle_cv.notify_all();
+  retired.crew = std::move(crew_);
+  retired.threads = std::move(threads_);
+  crew_.reset();
+  threads_.clear();
+  return retired;
+}
+
+std::vector<WorkerPool::Job> WorkerPool::Join(Retired& retired) {
+  std::vector<Job> queued;
+  if (!retired.crew) {
+    return queued;
+  }
+  for (auto& thread : retired.threads) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+  for (auto& queue : retired.crew->queues) {
+    for (auto& jobs : queue->jobs) {
+      for (auto& job : jobs) {
+        queued.push_back(std::move(job));
+      }
+    }
+  }
+  return queued;
+}
+
+void WorkerPool::WorkerLoop(std::shared_ptr<Crew> crew, size_t worker_index) {
+  NativeTracer::NameThread("worker");
+  while (true) {
+    Job job;
+    if (PopLocal(*crew, worker_index, job) || Steal(*crew, worker_index, job)) {
+      crew->pending--;
+      RunJob(job);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(crew->idle_mutex);
+    crew->idle_cv.wait(lock, [&crew] { return crew->stopping || crew->pending > 0; });
+    if (crew->stopping) {
+      return;
+    }
+  }
+}
+
+bool WorkerPool::PopLocal(Crew& crew, size_t worker_index, Job& job) {
+  WorkerQueue& queue = *crew.queues[worker_index];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  for (auto& jobs : queue.jobs) {
+    if (!jobs.empty()) {
+      job = std::move(jobs.front());
+      jobs.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+bool WorkerPool::Steal(Crew& crew, size_t worker_index, Job& job) {
+  // Scan priorities first so a high-priority job anywhere wins over a
+  // low-priority job in a nearby queue.
+  const size_t count = crew.queues.size();
+  for (int priority = 0; priority < 3; priority++) {
+    for (size_t offset = 1; offset < count; offset++) {
+      WorkerQueue& victim = *crew.queues[(worker_index + offset) % count];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      auto& jobs = victim.jobs[priority];
+      if (!jobs.empty()) {
+        job = std::move(jobs.back());
+        jobs.pop_back();
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void WorkerPool::RunJob(Job& job) {
+  auto start = Clock::now();
+  if (job.work) {
+    TraceSpan span(TraceCategory::kTask, "run");
+    job.work();
+  }
+  auto end = Clock::now();
+
+  if (job.on_complete) {
+    TaskTiming timing;
+    timing.queue_delay_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        start - job.submit_time).count();
+    timing.run_time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        end - start).count();
+    job.on_complete(timing);
+  }
+}
+
+}  // namespace flutter_mcp
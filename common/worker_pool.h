@@ -0,0 +1,119 @@
+#ifndef WORKER_POOL_H_
+#define WORKER_POOL_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+namespace flutter_mcp {
+
+enum class TaskPriority { kHigh = 0, kNormal = 1, kLow = 2 };
+
+// Parses "high"/"normal"/"low"; anything else maps to kNormal.
+TaskPriority ParseTaskPriority(const char* name);
+
+struct TaskTiming {
+  // Time between the job being submitted and a worker starting it.
+  int64_t queue_delay_us = 0;
+  // Time spent running the job's work.
+  int64_t run_time_us = 0;
+};
+
+// Fixed-size pool of work-stealing workers.
+//
+// Each worker owns a deque per priority. Submitted jobs are spread across
+// workers round-robin; a worker drains its own deques front-first and, when
+// empty, steals from the back of the others, preferring higher priorities.
+// Workers are started lazily on the first Submit. With zero threads, Submit
+// runs the job on the caller.
+class WorkerPool {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Work = std::function<void()>;
+  using Completion = std::function<void(const TaskTiming&)>;
+
+  explicit WorkerPool(size_t thread_count);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  // Queues |work|. |on_complete| runs on the same worker right after it,
+  // with the measured queueing delay and run time.
+  void Submit(Work work, TaskPriority priority, Completion on_complete);
+
+  // Restarts the pool with |thread_count| workers, keeping queued jobs.
+  // Submit() stays available while the old workers finish their jobs.
+  void SetThreadCount(size_t thread_count);
+  size_t thread_count();
+
+  // Joins the workers once they have run every job already queued, so
+  // nothing submitted before the call is lost. The workers are started
+  // again by the next Submit. Must not be called from a job running on
+  // this pool.
+  void Shutdown();
+
+  static size_t DefaultThreadCount();
+
+ private:
+  struct Job {
+    Work work;
+    Completion on_complete;
+    TaskPriority priority;
+    Clock::time_point submit_time;
+  };
+
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Job> jobs[3];
+  };
+
+  // One started set of workers and their queues. A crew that is being
+  // stopped keeps its own state, so a new crew can start alongside it.
+  struct Crew {
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::mutex idle_mutex;
+    std::condition_variable idle_cv;
+    std::atomic<size_t> pending{0};
+    bool stopping = false;
+  };
+
+  // A crew taken off the pool, to be joined without lifecycle_mutex_ held.
+  struct Retired {
+    std::shared_ptr<Crew> crew;
+    std::vector<std::thread> threads;
+  };
+
+  void StartLocked();
+  void EnqueueLocked(Job job);
+  // Detaches the current crew and tells its workers to stop.
+  Retired DetachLocked();
+  // Joins |retired|'s workers after their current job and returns the jobs
+  // they left queued. Jobs must not stop their own pool; a worker cannot
+  // join itself.
+  static std::vector<Job> Join(Retired& retired);
+  static void WorkerLoop(std::shared_ptr<Crew> crew, size_t worker_index);
+  static bool PopLocal(Crew& crew, size_t worker_index, Job& job);
+  static bool Steal(Crew& crew, size_t worker_index, Job& job);
+  static void RunJob(Job& job);
+
+  // Guards the fields below; never held while joining or running a job.
+  std::mutex lifecycle_mutex_;
+  size_t thread_count_;
+  std::shared_ptr<Crew> crew_;
+  std::vector<std::thread> threads_;
+  std::atomic<size_t> next_queue_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // WORKER_POOL_H_
@@ -0,0 +1,177 @@
+#ifndef WRITE_BEHIND_BUFFER_H_
+#define WRITE_BEHIND_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "secret_cache.h"
+
+// Shared by the Linux and Windows plugins. Must stay valid C++14.
+
+namespace flutter_mcp {
+
+struct WriteBehindConfig {
+  bool enabled = false;
+  // A buffered write is flushed at most this long after it was made.
+  int64_t delay_ms = 250;
+  // Flush at once when this many keys are waiting.
+  size_t max_pending = 256;
+};
+
+// The newest write to one key that has not been persisted yet.
+struct PendingWrite {
+  enum class Kind { kText, kBytes, kDelete };
+
+  std::string key;
+  Kind kind = Kind::kText;
+  // Empty for kDelete.
+  std::string value;
+};
+
+// Secure storage writes held in memory until they are flushed.
+//
+// Only the newest write to each key is kept, so a key rewritten many times
+// between flushes is encrypted and persisted once. Take() hands the writes
+// out in the order of each key's newest write: of two keys, the one written
+// last is also persisted last. Buffered writes live only in memory until
+// they are flushed; values are zeroed when superseded or cleared.
+class WriteBehindBuffer {
+ public:
+  WriteBehindBuffer() = default;
+  ~WriteBehindBuffer() { Clear(); }
+
+  WriteBehindBuffer(const WriteBehindBuffer&) = delete;
+  WriteBehindBuffer& operator=(const WriteBehindBuffer&) = delete;
+
+  // Disabling stops new writes from being buffered; whatever is already
+  // buffered stays until it is taken or cleared.
+  void Configure(const WriteBehindConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    if (config_.delay_ms < 0) {
+      config_.delay_ms = 0;
+    }
+    if (config_.max_pending == 0) {
+      config_.enabled = false;
+    }
+  }
+
+  WriteBehindConfig config() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_;
+  }
+
+  bool enabled() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_.enabled;
+  }
+
+  // Buffers a write to |key|, replacing any pending one. True once
+  // max_pending keys are waiting and the buffer should be flushed now.
+  bool Put(const std::string& key, PendingWrite::Kind kind, const char* data, size_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      // The superseded write is dropped and this one moves to the back.
+      SecureZero(it->second->value);
+      it->second->kind = kind;
+      it->second->value.assign(data, size);
+      writes_.splice(writes_.end(), writes_, it->second);
+    } else {
+      writes_.push_back(PendingWrite());
+      PendingWrite& write = writes_.back();
+      write.key = key;
+      write.kind = kind;
+      write.value.assign(data, size);
+      index_[key] = std::prev(writes_.end());
+    }
+    return writes_.size() >= config_.max_pending;
+  }
+
+  // Finds the pending write to |key|. |value|, which may be null, receives
+  // a copy of its value.
+  bool Lookup(const std::string& key, PendingWrite::Kind* kind, std::string* value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+      return false;
+    }
+    *kind = it->second->kind;
+    if (value) {
+      *value = it->second->value;
+    }
+    return true;
+  }
+
+  // Calls |visit(const PendingWrite&)| for each pending write, oldest
+  // first. |visit| must not call back into the buffer.
+  template <typename Visit>
+  void ForEach(Visit visit) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const PendingWrite& write : writes_) {
+      visit(write);
+    }
+  }
+
+  // Empties the buffer, handing out its writes in flush order. The caller
+  // zeroes the values once they are persisted.
+  std::vector<PendingWrite> Take() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<PendingWrite> writes;
+    writes.reserve(writes_.size());
+    for (PendingWrite& write : writes_) {
+      writes.push_back(std::move(write));
+    }
+    writes_.clear();
+    index_.clear();
+    return writes;
+  }
+
+  // Drops every pending write unpersisted.
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (PendingWrite& write : writes_) {
+      SecureZero(write.value);
+    }
+    writes_.clear();
+    index_.clear();
+  }
+
+  size_t size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return writes_.size();
+  }
+
+  // Flushed writes that could not be persisted, kept until reported.
+  void RecordFailures(size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    failures_ += count;
+  }
+
+  size_t TakeFailures() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t failures = failures_;
+    failures_ = 0;
+    return failures;
+  }
+
+ private:
+  using WriteList = std::list<PendingWrite>;
+
+  WriteBehindConfig config_;
+  // In the order of each key's newest write.
+  WriteList writes_;
+  std::unordered_map<std::string, WriteList::iterator> index_;
+  size_t failures_ = 0;
+  std::mutex mutex_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // WRITE_BEHIND_BUFFER_H_
@@ -67,6 +67,8 @@ export 'src/plugins/plugin_system.dart'
         MCPNotificationPlugin,
         MCPPromptPlugin;
 export 'src/platform/tray/tray_manager.dart' show TrayMenuItem;
+export 'src/platform/background/headless_dispatcher.dart'
+    show HeadlessTaskCallback, runHeadlessDispatcher;
 // Health monitoring exports removed - using simple implementation
 export 'src/security/oauth_manager.dart' show OAuthConfig, OAuthToken;
 export 'src/core/client_manager.dart' show MCPClientManager;
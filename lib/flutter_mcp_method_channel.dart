@@ -1,4 +1,5 @@
 import 'dart:async';
+import 'dart:ui' show PluginUtilities;
 import 'package:flutter/foundation.dart';
 import 'package:flutter/services.dart';
 
@@ -7,7 +8,9 @@ import 'src/config/mcp_config.dart';
 import 'src/config/background_config.dart';
 import 'src/config/notification_config.dart';
 import 'src/config/tray_config.dart';
+import 'src/platform/background/headless_dispatcher.dart';
 import 'src/utils/exceptions.dart';
+import 'src/utils/platform_events.dart';
 import 'src/utils/typed_platform_channel.dart';
 import 'src/models/platform_messages.dart';
 
@@ -39,21 +42,46 @@ class MethodChannelFlutterMcp extends FlutterMcpPlatform {
     // Set up method call handler for native -> Flutter calls
     methodChannel.setMethodCallHandler(_handleMethodCall);
 
+    _listenToPlatformEvents(null);
+  }
+
+  /// Subscription forwarding platform events to the controller
+  StreamSubscription<Map<String, dynamic>>? _platformEventSubscription;
+
+  void _listenToPlatformEvents(Map<String, dynamic>? arguments) {
+    _platformEventSubscription?.cancel();
+
     // Set up event stream
     _eventStream = eventChannel
-        .receiveBroadcastStream()
-        .map((event) => Map<String, dynamic>.from(event as Map))
+        .receiveBroadcastStream(arguments)
+        .expand(unpackPlatformEvents)
         .handleError((error) {
       _eventStreamController.addError(error);
     });
 
     // Forward events to controller
-    _eventStream!.listen(
+    _platformEventSubscription = _eventStream!.listen(
       (event) => _eventStreamController.add(event),
       onError: (error) => _eventStreamController.addError(error),
     );
   }
 
+  /// Restricts which platform events the native side sends.
+  ///
+  /// Only the event [types] listed are sent (all types when null), and a
+  /// type in [sampling] sends only that fraction of its events, e.g.
+  /// `{'backgroundEvent': 0.1}`. Events dropped here are never built
+  /// natively. Call with no arguments to receive everything again.
+  void setEventSubscription({
+    List<String>? types,
+    Map<String, double>? sampling,
+  }) {
+    _listenToPlatformEvents({
+      if (types != null) 'types': types,
+      if (sampling != null) 'sampling': sampling,
+    });
+  }
+
   /// Handle method calls from native
   Future<dynamic> _handleMethodCall(MethodCall call) async {
     switch (call.method) {
@@ -90,6 +118,299 @@ class MethodChannelFlutterMcp extends FlutterMcpPlatform {
   /// Platform event stream
   Stream<Map<String, dynamic>> get eventStream => _eventStreamController.stream;
 
+  /// Configure native event delivery (desktop only)
+  ///
+  /// With [batching] enabled, events are buffered per type and sent as one
+  /// channel message once [maxBatchSize] events are queued or the oldest has
+  /// waited [maxBatchDelay]. [coalescePeriodic] keeps only the latest of
+  /// consecutive periodic background ticks. Batches are expanded again
+  /// before reaching [eventStream].
+  ///
+  /// On Windows, [overflowPolicy] (`dropOldest`, `dropNewest` or `block`)
+  /// decides what happens when the native event queue is full.
+  Future<void> configureEvents({
+    bool batching = false,
+    int? maxBatchSize,
+    Duration? maxBatchDelay,
+    bool coalescePeriodic = false,
+    String? overflowPolicy,
+  }) async {
+    try {
+      await methodChannel.invokeMethod<void>('configureEvents', {
+        'batching': batching,
+        if (maxBatchSize != null) 'maxBatchSize': maxBatchSize,
+        if (maxBatchDelay != null)
+          'maxBatchDelayMs': maxBatchDelay.inMilliseconds,
+        'coalescePeriodic': coalescePeriodic,
+        if (overflowPolicy != null) 'overflowPolicy': overflowPolicy,
+      });
+    } on PlatformException catch (e) {
+      throw MCPPlatformException(
+          'Failed to configure events', e.code, e.details);
+    }
+  }
+
+  /// Configure native secure storage (desktop only)
+  ///
+  /// With [cache] enabled, up to [cacheMaxEntries] recently read values are
+  /// kept decrypted in native memory for [cacheTtl] and served without
+  /// touching the keystore. Writes and deletes invalidate cached values, and
+  /// evicted values are zeroed.
+  ///
+  /// On Windows, [backend] selects where values are kept: `files` (one
+  /// encrypted file per key, the default) or `recordFile` (encrypted records
+  /// in a single memory-mapped file). Values are not migrated between them.
+  /// [encryption] selects how new values are encrypted: `dpapi` (one DPAPI
+  /// call per value, the default) or `masterKey` (AES-GCM under a
+  /// DPAPI-protected master key unwrapped once). Both remain readable.
+  ///
+  /// With [writeBehind] enabled, [secureStore], [secureStoreBytes] and
+  /// [secureDelete] complete as soon as the newest value per key is held in
+  /// native memory, and reads see it at once. Buffered writes are persisted
+  /// at most [writeBehindDelay] (250 ms by default) after the first of them,
+  /// each key's newest write in the order those writes were made, so a key
+  /// rewritten many times in that window is encrypted and written once.
+  /// Until then they live only in memory and are lost if the process dies;
+  /// call [secureFlush] where durability matters. Turning it off flushes.
+  /// Omitting [writeBehind] leaves the current setting.
+  Future<void> configureSecureStorage({
+    bool cache = false,
+    int? cacheMaxEntries,
+    Duration? cacheTtl,
+    String? backend,
+    String? encryption,
+    bool? writeBehind,
+    Duration? writeBehindDelay,
+  }) async {
+    try {
+      await methodChannel.invokeMethod<void>('configureSecureStorage', {
+        'cache': cache,
+        if (cacheMaxEntries != null) 'cacheMaxEntries': cacheMaxEntries,
+        if (cacheTtl != null) 'cacheTtlMs': cacheTtl.inMilliseconds,
+        if (backend != null) 'backend': backend,
+        if (encryption != null) 'encryption': encryption,
+        if (writeBehind != null) 'writeBehind': writeBehind,
+        if (writeBehindDelay != null)
+          'writeBehindDelayMs': writeBehindDelay.inMilliseconds,
+      });
+    } on PlatformException catch (e) {
+      throw MCPPlatformException(
+          'Failed to configure secure storage', e.code, e.details);
+    }
+  }
+
+  /// Run several method calls in one platform channel round trip (desktop only)
+  ///
+  /// Each operation is `{'method': name, 'args': arguments}`. Returns one
+  /// entry per operation, in order: `{'success': true, 'result': value}` or
+  /// `{'success': false, 'error': {'code', 'message', 'details'}}`. A failing
+  /// operation does not stop the ones after it.
+  Future<List<Map<String, dynamic>>> executeBatch(
+      List<Map<String, dynamic>> operations) async {
+    try {
+      final results = await methodChannel.invokeMethod<List>(
+          'executeBatch', {'operations': operations});
+      return (results ?? [])
+          .map((entry) => Map<String, dynamic>.from(entry as Map))
+          .toList();
+    } on PlatformException catch (e) {
+      throw MCPPlatformException(
+          'Failed to execute batch', e.code, e.details);
+    }
+  }
+
+  /// Native event queue capacity and drop counters (Windows only)
+  Future<Map<String, dynamic>> getEventQueueStats() async {
+    try {
+      final stats =
+          await methodChannel.invokeMethod<Map>('getEventQueueStats');
+      return Map<String, dynamic>.from(stats ?? {});
+    } on PlatformException catch (e) {
+      throw MCPPlatformException(
+          'Failed to get event queue stats', e.code, e.details);
+    }
+  }
+
+  /// Native per-method latency histograms, scheduler lateness, secure
+  /// storage and event queue timings (Linux and Windows). Latencies are in
+  /// microseconds. With [reset] the counters restart after this snapshot.
+  Future<Map<String, dynamic>> getNativeMetrics({bool reset = false}) async {
+    try {
+      final metrics = await methodChannel
+          .invokeMethod<Map>('getNativeMetrics', {'reset': reset});
+      return _deepCast(metrics ?? {});
+    } on PlatformException catch (e) {
+      throw MCPPlatformException(
+          'Failed to get native metrics', e.code, e.details);
+    }
+  }
+
+  /// Emit a `metrics` event with the native snapshot every [eventInterval];
+  /// null stops the events
+  Future<void> configureNativeMetrics({Duration? eventInterval}) async {
+    try {
+      await methodChannel.invokeMethod('configureNativeMetrics', {
+        'eventIntervalMs': eventInterval?.inMilliseconds ?? 0,
+      });
+    } on PlatformException catch (e) {
+      throw MCPPlatformException(
+          'Failed to configure native metrics', e.code, e.details);
+    }
+  }
+
+  /// The event channel for stdio transport output (desktop only)
+  @visibleForTesting
+  final transportChannel = const EventChannel('flutter_mcp/transport');
+
+  /// Output and exits of servers started with [transportSpawn]
+  ///
+  /// Each event has `serverId` and `type`: `messages` and `stderr` carry a
+  /// `messages` list of complete messages or lines, `exit` an `exitCode`.
+  late final Stream<Map<String, dynamic>> transportEvents = transportChannel
+      .receiveBroadcastStream()
+      .expand((batch) => (batch as List)
+          .map((event) => _deepCast(event as Map)));
+
+  /// Start a local MCP server whose stdio is pumped natively
+  ///
+  /// [framing] is `newline` (the MCP stdio default) or `contentLength`.
+  /// The routing options are those of [transportConfigureRouting].
+  /// Returns the server's process id.
+  Future<int> transportSpawn(
+    String serverId,
+    String command, {
+    List<String> arguments = const [],
+    Map<String, String>? environment,
+    String? workingDirectory,
+    String framing = 'newline',
+    List<String> dropNotifications = const [],
+    bool coalesceProgress = true,
+    bool matchResponses = true,
+  }) async {
+    try {
+      final result =
+          await methodChannel.invokeMethod<Map>('transportSpawn', {
+        'serverId': serverId,
+        'command': command,
+        'arguments': arguments,
+        if (environment != null) 'environment': environment,
+        if (workingDirectory != null) 'workingDirectory': workingDirectory,
+        'framing': framing,
+        'dropNotifications': dropNotifications,
+        'coalesceProgress': coalesceProgress,
+        'matchResponses': matchResponses,
+      });
+      return result!['pid'] as int;
+    } on PlatformException catch (e) {
+      throw MCPPlatformException(
+          'Failed to start MCP server', e.code, e.details);
+    }
+  }
+
+  /// Send one message to a server; [message] is a String or Uint8List
+  ///
+  /// Returns false if the server is no longer running.
+  Future<bool> transportSend(String serverId, Object message) async {
+    try {
+      final sent = await methodChannel.invokeMethod<bool>('transportSend', {
+        'serverId': serverId,
+        'message': message,
+      });
+      return sent ?? false;
+    } on PlatformException catch (e) {
+      throw MCPPlatformException(
+          'Failed to send to MCP server', e.code, e.details);
+    }
+  }
+
+  /// Close a server's stdin and terminate it
+  Future<bool> transportClose(String serverId) async {
+    try {
+      final closed = await methodChannel
+          .invokeMethod<bool>('transportClose', {'serverId': serverId});
+      return closed ?? false;
+    } on PlatformException catch (e) {
+      throw MCPPlatformException(
+          'Failed to close MCP server', e.code, e.details);
+    }
+  }
+
+  /// Change how a running server's output is trimmed before it reaches Dart
+  ///
+  /// Notifications whose method is in [dropNotifications] are dropped
+  /// natively. With [coalesceProgress], each batch keeps only the newest
+  /// `notifications/progress` per progress token. With [matchResponses],
+  /// responses to requests that were never sent, already answered, or
+  /// cancelled with `notifications/cancelled` are dropped.
+  Future<bool> transportConfigureRouting(
+    String serverId, {
+    List<String> dropNotifications = const [],
+    bool coalesceProgress = true,
+    bool matchResponses = true,
+  }) async {
+    try {
+      final configured =
+          await methodChannel.invokeMethod<bool>('transportConfigureRouting', {
+        'serverId': serverId,
+        'dropNotifications': dropNotifications,
+        'coalesceProgress': coalesceProgress,
+        'matchResponses': matchResponses,
+      });
+      return configured ?? false;
+    } on PlatformException catch (e) {
+      throw MCPPlatformException(
+          'Failed to configure MCP server routing', e.code, e.details);
+    }
+  }
+
+  /// Transport totals: `servers`, `pendingWriteBytes`,
+  /// `droppedNotifications`, `coalescedProgress` and `unmatchedResponses`
+  Future<Map<String, dynamic>> transportStats() async {
+    try {
+      final result = await methodChannel.invokeMethod<Map>('transportStats');
+      return _deepCast(result ?? {});
+    } on PlatformException catch (e) {
+      throw MCPPlatformException(
+          'Failed to get transport stats', e.code, e.details);
+    }
+  }
+
+  /// Start recording native spans: method calls, scheduler ticks, background
+  /// tasks, secure storage, event delivery, tray updates and transport I/O
+  ///
+  /// Any earlier trace is discarded.
+  Future<void> startNativeTrace() async {
+    try {
+      await methodChannel.invokeMethod('startNativeTrace');
+    } on PlatformException catch (e) {
+      throw MCPPlatformException(
+          'Failed to start native trace', e.code, e.details);
+    }
+  }
+
+  /// Stop recording and export the trace as Chrome trace-event JSON, which
+  /// chrome://tracing and Perfetto load directly
+  ///
+  /// With [path] the trace is written there and the result carries `path`;
+  /// otherwise it carries the JSON as `trace`. Either way it has `events`
+  /// and `dropped`, the oldest spans a thread's full buffer overwrote.
+  Future<Map<String, dynamic>> stopNativeTrace({String? path}) async {
+    try {
+      final result = await methodChannel.invokeMethod<Map>('stopNativeTrace', {
+        if (path != null) 'path': path,
+      });
+      return _deepCast(result ?? {});
+    } on PlatformException catch (e) {
+      throw MCPPlatformException(
+          'Failed to stop native trace', e.code, e.details);
+    }
+  }
+
+  static Map<String, dynamic> _deepCast(Map map) {
+    return map.map((key, value) => MapEntry(
+        key as String, value is Map ? _deepCast(value) : value));
+  }
+
   @override
   Future<String?> getPlatformVersion() async {
     try {
@@ -153,16 +474,22 @@ class MethodChannelFlutterMcp extends FlutterMcpPlatform {
   }
 
   /// Schedule a background task
+  ///
+  /// [priority] (`high`, `normal` or `low`) orders the task on the native
+  /// worker pool once it is due. Desktop platforms report `queueDelayMicros`
+  /// and `runTimeMicros` in the resulting `backgroundTaskResult` event.
   Future<void> scheduleBackgroundTask({
     required String taskId,
     required Duration delay,
     Map<String, dynamic>? data,
+    String? priority,
   }) async {
     try {
       await methodChannel.invokeMethod<void>('scheduleBackgroundTask', {
         'taskId': taskId,
         'delayMillis': delay.inMilliseconds,
         'data': data,
+        if (priority != null) 'priority': priority,
       });
     } on PlatformException catch (e) {
       throw MCPBackgroundExecutionException(
@@ -170,6 +497,41 @@ class MethodChannelFlutterMcp extends FlutterMcpPlatform {
     }
   }
 
+  /// Schedule a recurring background task (desktop)
+  ///
+  /// The native scheduler re-queues each run itself, so a job registered
+  /// once sends a `backgroundTaskResult` event per run with no further
+  /// channel calls. [mode] is `fixedRate` (the default; runs stay on a grid
+  /// of [period]) or `fixedDelay` ([period] between the end of one run and
+  /// the start of the next). Each run is delayed by up to [jitter]. When a
+  /// fixed-rate run overruns, [overrun] `skip` (the default) drops the missed
+  /// slots and `catchUp` runs them back to back. The first run is after
+  /// [initialDelay], or one [period]. Cancel with [cancelBackgroundTask].
+  Future<void> scheduleRecurringTask({
+    required String taskId,
+    required Duration period,
+    Duration? initialDelay,
+    String? mode,
+    Duration? jitter,
+    String? overrun,
+    String? priority,
+  }) async {
+    try {
+      await methodChannel.invokeMethod<void>('scheduleRecurringTask', {
+        'taskId': taskId,
+        'periodMs': period.inMilliseconds,
+        if (initialDelay != null) 'initialDelayMs': initialDelay.inMilliseconds,
+        if (mode != null) 'mode': mode,
+        if (jitter != null) 'jitterMs': jitter.inMilliseconds,
+        if (overrun != null) 'overrun': overrun,
+        if (priority != null) 'priority': priority,
+      });
+    } on PlatformException catch (e) {
+      throw MCPBackgroundExecutionException(
+          'Failed to schedule recurring task: ${e.message}', e.details);
+    }
+  }
+
   /// Cancel a scheduled background task
   Future<void> cancelBackgroundTask(String taskId) async {
     try {
@@ -181,6 +543,47 @@ class MethodChannelFlutterMcp extends FlutterMcpPlatform {
     }
   }
 
+  /// Start a headless engine for Dart-scheduled tasks (Windows)
+  ///
+  /// The engine is started once and kept warm: every task scheduled with
+  /// `scheduleBackgroundTask` afterwards runs [callback] in it with the
+  /// task's `data`, and its `backgroundTaskResult` event carries the
+  /// callback's `result` or `error` along with `headlessRunMicros`. This
+  /// keeps tasks running while the app only shows its tray icon.
+  /// [callback] must be a top-level or static
+  /// function, and the app must define [entrypoint] as described on
+  /// [runHeadlessDispatcher]. Calling this again while the engine runs keeps
+  /// the first callback. Fails with `UNSUPPORTED` on Linux.
+  Future<void> startHeadlessEngine(
+    HeadlessTaskCallback callback, {
+    String entrypoint = 'flutterMcpHeadlessMain',
+  }) async {
+    final handle = PluginUtilities.getCallbackHandle(callback);
+    if (handle == null) {
+      throw MCPBackgroundExecutionException(
+          'Headless callback must be a top-level or static function');
+    }
+    try {
+      await methodChannel.invokeMethod<void>('startHeadlessEngine', {
+        'callbackHandle': handle.toRawHandle(),
+        'entrypoint': entrypoint,
+      });
+    } on PlatformException catch (e) {
+      throw MCPBackgroundExecutionException(
+          'Failed to start headless engine: ${e.message}', e.details);
+    }
+  }
+
+  /// Stop the headless engine; later tasks report their timings only
+  Future<void> stopHeadlessEngine() async {
+    try {
+      await methodChannel.invokeMethod<void>('stopHeadlessEngine');
+    } on PlatformException catch (e) {
+      throw MCPBackgroundExecutionException(
+          'Failed to stop headless engine: ${e.message}', e.details);
+    }
+  }
+
   // Notification Methods
   @override
   Future<void> showNotification({
@@ -188,6 +591,7 @@ class MethodChannelFlutterMcp extends FlutterMcpPlatform {
     required String body,
     String? icon,
     String id = 'mcp_notification',
+    String? groupKey,
   }) async {
     try {
       await methodChannel.invokeMethod<void>('showNotification', {
@@ -195,6 +599,7 @@ class MethodChannelFlutterMcp extends FlutterMcpPlatform {
         'body': body,
         'icon': icon,
         'id': id,
+        if (groupKey != null) 'groupKey': groupKey,
       });
     } on PlatformException catch (e) {
       throw MCPPlatformException(
@@ -267,6 +672,86 @@ class MethodChannelFlutterMcp extends FlutterMcpPlatform {
     }
   }
 
+  /// Store binary data securely
+  ///
+  /// The bytes travel as a Uint8List and reach the platform store unchanged,
+  /// with no base64 round trip.
+  Future<void> secureStoreBytes(String key, Uint8List value) async {
+    try {
+      await methodChannel.invokeMethod<void>('secureStoreBytes', {
+        'key': key,
+        'value': value,
+      });
+    } on PlatformException catch (e) {
+      throw MCPSecureStorageException(
+          'Failed to store secure value: ${e.message}', e.details);
+    }
+  }
+
+  /// Read binary data stored with [secureStoreBytes]
+  Future<Uint8List?> secureReadBytes(String key) async {
+    try {
+      return await methodChannel
+          .invokeMethod<Uint8List>('secureReadBytes', {'key': key});
+    } on PlatformException catch (e) {
+      if (e.code == 'KEY_NOT_FOUND') {
+        return null;
+      }
+      throw MCPSecureStorageException(
+          'Failed to read secure value: ${e.message}', e.details);
+    }
+  }
+
+  /// Read several secure values in one call
+  ///
+  /// Returns the keys that exist with their values; missing keys are left
+  /// out. On Linux this is a single Secret Service search.
+  Future<Map<String, String>> secureReadMany(List<String> keys) async {
+    try {
+      final result = await methodChannel
+          .invokeMethod<Map>('secureReadMany', {'keys': keys});
+      return Map<String, String>.from(result ?? {});
+    } on PlatformException catch (e) {
+      throw MCPSecureStorageException(
+          'Failed to read secure values: ${e.message}', e.details);
+    }
+  }
+
+  /// Read every secure value whose key starts with [prefix]
+  ///
+  /// On Windows this requires the `recordFile` storage backend (see
+  /// [configureSecureStorage]). The default `files` backend only keeps a
+  /// hash of each key, so there it throws an [MCPPlatformException] with
+  /// code `UNSUPPORTED`.
+  Future<Map<String, String>> secureReadPrefix(String prefix) async {
+    try {
+      final result = await methodChannel
+          .invokeMethod<Map>('secureReadPrefix', {'prefix': prefix});
+      return Map<String, String>.from(result ?? {});
+    } on PlatformException catch (e) {
+      if (e.code == 'UNSUPPORTED') {
+        throw MCPPlatformException(
+            e.message ?? 'Prefix reads are not supported', e.code, e.details);
+      }
+      throw MCPSecureStorageException(
+          'Failed to read secure values: ${e.message}', e.details);
+    }
+  }
+
+  /// Persist every secure storage write buffered by write-behind
+  ///
+  /// Completes once everything written before the call is persisted. Throws
+  /// if any buffered write since the previous flush could not be persisted;
+  /// those values are gone from the buffer. A no-op without write-behind.
+  Future<void> secureFlush() async {
+    try {
+      await methodChannel.invokeMethod<void>('secureFlush');
+    } on PlatformException catch (e) {
+      throw MCPSecureStorageException(
+          'Failed to flush secure storage: ${e.message}', e.details);
+    }
+  }
+
   /// Delete a secure storage entry
   Future<void> secureDelete(String key) async {
     try {
@@ -301,13 +786,18 @@ class MethodChannelFlutterMcp extends FlutterMcpPlatform {
 
   // System Tray Methods (Desktop only)
   /// Show system tray icon
+  ///
+  /// [iconName] refers to an icon registered with [registerTrayIcons] and
+  /// takes precedence over [iconPath].
   Future<void> showTrayIcon({
     String? iconPath,
+    String? iconName,
     String? tooltip,
   }) async {
     try {
       await methodChannel.invokeMethod<void>('showTrayIcon', {
         'iconPath': iconPath,
+        if (iconName != null) 'iconName': iconName,
         'tooltip': tooltip,
       });
     } on PlatformException catch (e) {
@@ -315,6 +805,39 @@ class MethodChannelFlutterMcp extends FlutterMcpPlatform {
     }
   }
 
+  /// Preload tray icons by name so [setTrayIcon] can switch between them
+  /// without reading files
+  ///
+  /// [bytes] holds PNG or ICO data; [paths] names icon files on disk.
+  /// Registering a name again replaces its icon.
+  Future<void> registerTrayIcons({
+    Map<String, Uint8List> bytes = const {},
+    Map<String, String> paths = const {},
+  }) async {
+    try {
+      await methodChannel.invokeMethod<void>('registerTrayIcons', {
+        'icons': [
+          for (final entry in bytes.entries)
+            {'name': entry.key, 'bytes': entry.value},
+          for (final entry in paths.entries)
+            {'name': entry.key, 'iconPath': entry.value},
+        ],
+      });
+    } on PlatformException catch (e) {
+      throw MCPPlatformException(
+          'Failed to register tray icons', e.code, e.details);
+    }
+  }
+
+  /// Switch the tray icon to one registered with [registerTrayIcons]
+  Future<void> setTrayIcon(String name) async {
+    try {
+      await methodChannel.invokeMethod<void>('setTrayIcon', {'name': name});
+    } on PlatformException catch (e) {
+      throw MCPPlatformException('Failed to set tray icon', e.code, e.details);
+    }
+  }
+
   /// Hide system tray icon
   Future<void> hideTrayIcon() async {
     try {
@@ -325,14 +848,34 @@ class MethodChannelFlutterMcp extends FlutterMcpPlatform {
   }
 
   /// Set tray menu items
-  Future<void> setTrayMenu(List<Map<String, dynamic>> items) async {
+  ///
+  /// By default only the items that changed are touched; items are matched
+  /// by `id`. Pass [incremental] false to rebuild the whole menu.
+  Future<void> setTrayMenu(List<Map<String, dynamic>> items,
+      {bool incremental = true}) async {
     try {
-      await methodChannel.invokeMethod<void>('setTrayMenu', {'items': items});
+      await methodChannel.invokeMethod<void>(
+          'setTrayMenu', {'items': items, 'incremental': incremental});
     } on PlatformException catch (e) {
       throw MCPPlatformException('Failed to set tray menu', e.code, e.details);
     }
   }
 
+  /// Update the label and/or enabled state of one tray menu item
+  Future<void> updateTrayMenuItem(String id,
+      {String? label, bool? disabled}) async {
+    try {
+      await methodChannel.invokeMethod<void>('updateTrayMenuItem', {
+        'id': id,
+        if (label != null) 'label': label,
+        if (disabled != null) 'disabled': disabled,
+      });
+    } on PlatformException catch (e) {
+      throw MCPPlatformException(
+          'Failed to update tray menu item', e.code, e.details);
+    }
+  }
+
   /// Update tray tooltip
   Future<void> updateTrayTooltip(String tooltip) async {
     try {
@@ -56,6 +56,7 @@ abstract class FlutterMcpPlatform extends PlatformInterface {
     required String body,
     String? icon,
     String id = 'mcp_notification',
+    String? groupKey,
   }) {
     throw UnimplementedError('showNotification() has not been implemented.');
   }
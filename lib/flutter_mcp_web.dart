@@ -157,6 +157,7 @@ class FlutterMcpWeb extends FlutterMcpPlatform {
     required String body,
     String? icon,
     String id = 'mcp_notification',
+    String? groupKey,
   }) async {
     if (!_initialized) {
       throw MCPException('Web platform is not initialized');
@@ -36,6 +36,28 @@ class BackgroundConfig {
   /// Keep connection alive
   final bool keepAlive;
 
+  /// Number of native worker threads that run scheduled tasks (desktop).
+  /// `null` keeps the platform default; `0` runs tasks on the scheduler thread.
+  final int? workerThreads;
+
+  /// What drives the native periodic tick and task dispatch (desktop):
+  /// `'eventLoop'` uses the host's timers and needs no dedicated threads,
+  /// `'thread'` the older sleeping threads. `null` keeps the default,
+  /// `'eventLoop'`.
+  final String? timerBackend;
+
+  /// Keep pending native tasks in an on-disk journal so they are rescheduled
+  /// when the app starts again (desktop). They are planned before Dart runs
+  /// and scheduled once Dart listens for events, and a task leaves the
+  /// journal only once its result has been delivered. `false` deletes the
+  /// journal; `null` leaves the current setting.
+  final bool? persistTasks;
+
+  /// What replay does with journaled tasks that came due while the app was
+  /// not running: `'fire'` (the default) runs them at startup, `'skip'` drops
+  /// one-shot tasks and moves recurring ones to their next slot.
+  final String? overduePolicy;
+
   BackgroundConfig({
     this.notificationChannelId,
     this.notificationChannelName,
@@ -49,6 +71,10 @@ class BackgroundConfig {
     this.autoStartOnBoot = false,
     this.intervalMs = 5000,
     this.keepAlive = true,
+    this.workerThreads,
+    this.timerBackend,
+    this.persistTasks,
+    this.overduePolicy,
   });
 
   /// Create default configuration
@@ -83,6 +109,10 @@ class BackgroundConfig {
       'autoStartOnBoot': autoStartOnBoot,
       'intervalMs': intervalMs,
       'keepAlive': keepAlive,
+      'workerThreads': workerThreads,
+      'timerBackend': timerBackend,
+      'persistTasks': persistTasks,
+      'overduePolicy': overduePolicy,
     };
   }
 
@@ -27,6 +27,22 @@ class NotificationConfig {
   /// Default notification icon
   final String? defaultIcon;
 
+  /// Whether desktop platforms rate limit and coalesce notifications
+  final bool throttle;
+
+  /// New notifications allowed per second once [burst] is used up (desktop)
+  final double rateLimitPerSecond;
+
+  /// Notifications that may be shown at once before rate limiting (desktop)
+  final int burst;
+
+  /// How long a grouped notification keeps absorbing requests with the same
+  /// group key after it was last updated (desktop)
+  final Duration groupWindow;
+
+  /// Requests held back beyond this are folded into one summary (desktop)
+  final int maxPending;
+
   NotificationConfig({
     this.channelId,
     this.channelName,
@@ -37,6 +53,11 @@ class NotificationConfig {
     this.priority = NotificationPriority.normal,
     this.requestPermissionOnInit = true,
     this.defaultIcon,
+    this.throttle = true,
+    this.rateLimitPerSecond = 1.0,
+    this.burst = 5,
+    this.groupWindow = const Duration(seconds: 5),
+    this.maxPending = 32,
   });
 
   /// Default configuration
@@ -63,6 +84,11 @@ class NotificationConfig {
         'priority': priority.name,
         'requestPermissionOnInit': requestPermissionOnInit,
         'defaultIcon': defaultIcon,
+        'throttle': throttle,
+        'rateLimitPerSecond': rateLimitPerSecond,
+        'burst': burst,
+        'groupWindowMs': groupWindow.inMilliseconds,
+        'maxPending': maxPending,
       };
 
   /// Convert to Map (for platform channel)
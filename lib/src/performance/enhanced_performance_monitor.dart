@@ -257,6 +257,9 @@ class EnhancedPerformanceMonitor {
   // Performance trends
   final Map<String, _PerformanceTrend> _trends = {};
 
+  // Latest native metrics snapshot from the desktop plugins
+  Map<String, dynamic>? _nativeMetrics;
+
   // Singleton instance
   static EnhancedPerformanceMonitor? _instance;
 
@@ -544,6 +547,15 @@ class EnhancedPerformanceMonitor {
     _logger.finest('Performing auto-detection cycle');
   }
 
+  /// Record a native metrics snapshot (from getNativeMetrics or a
+  /// `metrics` platform event) for inclusion in the detailed report
+  void updateNativeMetrics(Map<String, dynamic> snapshot) {
+    _nativeMetrics = snapshot;
+  }
+
+  /// Latest native metrics snapshot, if any has been recorded
+  Map<String, dynamic>? get nativeMetrics => _nativeMetrics;
+
   /// Get detailed performance report
   Map<String, dynamic> getDetailedReport() {
     // Get base report from base monitor
@@ -586,6 +598,10 @@ class EnhancedPerformanceMonitor {
     }
     report['threshold_violations'] = violations;
 
+    if (_nativeMetrics != null) {
+      report['native'] = _nativeMetrics;
+    }
+
     return report;
   }
 
@@ -608,6 +624,7 @@ class EnhancedPerformanceMonitor {
 
     _thresholdTrackers.clear();
     _trends.clear();
+    _nativeMetrics = null;
   }
 
   /// Dispose resources
@@ -2,6 +2,7 @@ import 'dart:async';
 import 'package:flutter/services.dart';
 import '../../config/background_config.dart';
 import '../../utils/logger.dart';
+import '../../utils/platform_events.dart';
 import '../../utils/performance_monitor.dart';
 import '../../events/event_system.dart';
 import 'background_service.dart';
@@ -46,8 +47,8 @@ class DesktopBackgroundService implements BackgroundService {
     // Initialize event listener
     _eventSubscription = _eventChannel.receiveBroadcastStream().listen(
       (dynamic event) {
-        if (event is Map) {
-          _handleEvent(Map<String, dynamic>.from(event));
+        for (final platformEvent in unpackPlatformEvents(event)) {
+          _handleEvent(platformEvent);
         }
       },
       onError: (error) {
@@ -81,6 +82,14 @@ class DesktopBackgroundService implements BackgroundService {
     await _channel.invokeMethod('configureBackgroundService', {
       'intervalMs': _config?.intervalMs ?? 60000,
       'keepAlive': _config?.keepAlive ?? true,
+      if (_config?.workerThreads != null)
+        'workerThreads': _config!.workerThreads,
+      if (_config?.timerBackend != null)
+        'timerBackend': _config!.timerBackend,
+      if (_config?.persistTasks != null)
+        'persistTasks': _config!.persistTasks,
+      if (_config?.overduePolicy != null)
+        'overduePolicy': _config!.overduePolicy,
     });
   }
 
@@ -0,0 +1,55 @@
+import 'dart:async';
+import 'dart:ui';
+
+import 'package:flutter/services.dart';
+import 'package:flutter/widgets.dart';
+
+/// Runs one Dart-scheduled background task in the headless engine.
+///
+/// [data] is the `data` passed to `scheduleBackgroundTask`. The returned
+/// value is sent back as the `result` of the task's `backgroundTaskResult`
+/// event, so it must be encodable by the standard message codec; a thrown
+/// error is sent as its `error`.
+typedef HeadlessTaskCallback = FutureOr<Object?> Function(
+    String taskId, Object? data);
+
+const MethodChannel _headlessChannel = MethodChannel('flutter_mcp/headless');
+
+/// Entry point body for the headless engine started by
+/// `startHeadlessEngine`.
+///
+/// The app's main library must define the entry point the engine runs,
+/// `flutterMcpHeadlessMain` unless another name is given:
+///
+/// ```dart
+/// @pragma('vm:entry-point')
+/// void flutterMcpHeadlessMain(List<String> args) => runHeadlessDispatcher(args);
+/// ```
+///
+/// [args] holds the raw callback handle of the [HeadlessTaskCallback]. The
+/// callback must be a top-level or static function. Only Dart plugins are
+/// registered in this isolate.
+Future<void> runHeadlessDispatcher(List<String> args) async {
+  WidgetsFlutterBinding.ensureInitialized();
+  DartPluginRegistrant.ensureInitialized();
+
+  final handle = args.isEmpty ? null : int.tryParse(args.first);
+  final callback = handle == null
+      ? null
+      : PluginUtilities.getCallbackFromHandle(
+          CallbackHandle.fromRawHandle(handle)) as HeadlessTaskCallback?;
+
+  _headlessChannel.setMethodCallHandler((call) async {
+    if (call.method != 'runTask' || callback == null) {
+      throw MissingPluginException();
+    }
+    final arguments = call.arguments as Map;
+    try {
+      return await callback(arguments['taskId'] as String, arguments['data']);
+    } catch (e) {
+      throw PlatformException(code: 'TASK_FAILED', message: e.toString());
+    }
+  });
+  // Native runs nothing here until this arrives
+  await _headlessChannel.invokeMethod<void>('ready', callback != null);
+}
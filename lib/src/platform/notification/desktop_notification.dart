@@ -3,6 +3,7 @@ import 'dart:io';
 import 'package:flutter/services.dart';
 import '../../config/notification_config.dart' hide NotificationPriority;
 import '../../utils/logger.dart';
+import '../../utils/platform_events.dart';
 import '../../utils/exceptions.dart';
 import 'notification_manager.dart';
 import 'notification_models.dart';
@@ -51,8 +52,8 @@ class DesktopNotificationManager implements NotificationManager {
     // Initialize event listener for notification responses
     _eventSubscription = _eventChannel.receiveBroadcastStream().listen(
       (dynamic event) {
-        if (event is Map) {
-          _handleEvent(Map<String, dynamic>.from(event));
+        for (final platformEvent in unpackPlatformEvents(event)) {
+          _handleEvent(platformEvent);
         }
       },
       onError: (error) {
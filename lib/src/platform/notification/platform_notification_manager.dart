@@ -3,6 +3,7 @@ import 'package:flutter/foundation.dart';
 import 'package:flutter/services.dart';
 import '../../config/notification_config.dart' hide NotificationPriority;
 import '../../utils/logger.dart';
+import '../../utils/platform_events.dart';
 import '../../events/event_system.dart';
 import 'notification_manager.dart';
 import 'notification_models.dart';
@@ -48,8 +49,8 @@ class PlatformNotificationManager implements NotificationManager {
       // Set up event listener for notification interactions
       _eventChannel.receiveBroadcastStream().listen(
         (dynamic event) {
-          if (event is Map) {
-            _handleNotificationEvent(Map<String, dynamic>.from(event));
+          for (final platformEvent in unpackPlatformEvents(event)) {
+            _handleNotificationEvent(platformEvent);
           }
         },
         onError: (error) {
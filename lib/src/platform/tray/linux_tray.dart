@@ -2,6 +2,7 @@ import 'dart:async';
 import 'package:flutter/services.dart';
 import '../../config/tray_config.dart';
 import '../../utils/logger.dart';
+import '../../utils/platform_events.dart';
 import '../../utils/exceptions.dart';
 import 'tray_manager.dart';
 
@@ -32,8 +33,8 @@ class LinuxTrayManager implements TrayManager {
     // Initialize event listener
     _eventSubscription = _eventChannel.receiveBroadcastStream().listen(
       (dynamic event) {
-        if (event is Map) {
-          _handleEvent(Map<String, dynamic>.from(event));
+        for (final platformEvent in unpackPlatformEvents(event)) {
+          _handleEvent(platformEvent);
         }
       },
       onError: (error) {
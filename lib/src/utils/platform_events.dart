@@ -0,0 +1,22 @@
+/// Expands a raw event channel message into individual `{type, data}` events.
+///
+/// When native batching is enabled (see `configureEvents`), the desktop
+/// plugins deliver `{type, batch: true, data: [...], coalesced: n}` instead
+/// of one message per event. Listeners can iterate the result without caring
+/// which mode is active.
+Iterable<Map<String, dynamic>> unpackPlatformEvents(dynamic event) sync* {
+  if (event is! Map) {
+    return;
+  }
+
+  final type = event['type'];
+  final data = event['data'];
+  if (event['batch'] == true && data is List) {
+    for (final item in data) {
+      yield <String, dynamic>{'type': type, 'data': item};
+    }
+    return;
+  }
+
+  yield Map<String, dynamic>.from(event);
+}
@@ -0,0 +1,60 @@
+#include "main_loop_timer.h"
+
+#include <utility>
+
+namespace flutter_mcp {
+
+MainLoopTimer::MainLoopTimer(std::function<void()> fire)
+    : fire_(std::move(fire)), source_(nullptr) {}
+
+MainLoopTimer::~MainLoopTimer() {
+  Disarm();
+}
+
+void MainLoopTimer::Arm(Clock::time_point deadline) {
+  // Round up so the timeout never lands before the deadline.
+  const auto delay = deadline - Clock::now();
+  int64_t delay_ms = std::chrono::duration_cast<std::chrono::milliseconds>(delay).count();
+  if (delay > std::chrono::milliseconds(delay_ms)) {
+    delay_ms++;
+  }
+  if (delay_ms < 0) {
+    delay_ms = 0;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (source_) {
+    g_source_destroy(source_);
+    g_source_unref(source_);
+  }
+  source_ = g_timeout_source_new(static_cast<guint>(delay_ms));
+  g_source_set_callback(source_, OnTimeout, this, nullptr);
+  // Attaching wakes the main context if it is blocked in poll.
+  g_source_attach(source_, nullptr);
+}
+
+void MainLoopTimer::Disarm() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (source_) {
+    g_source_destroy(source_);
+    g_source_unref(source_);
+    source_ = nullptr;
+  }
+}
+
+// static
+gboolean MainLoopTimer::OnTimeout(gpointer user_data) {
+  MainLoopTimer* timer = static_cast<MainLoopTimer*>(user_data);
+  {
+    // An Arm() racing with this dispatch may already have replaced it.
+    std::lock_guard<std::mutex> lock(timer->mutex_);
+    if (timer->source_ == g_main_current_source()) {
+      g_source_unref(timer->source_);
+      timer->source_ = nullptr;
+    }
+  }
+  timer->fire_();
+  return G_SOURCE_REMOVE;
+}
+
+}  // namespace flutter_mcp
@@ -0,0 +1,40 @@
+#ifndef MAIN_LOOP_TIMER_H_
+#define MAIN_LOOP_TIMER_H_
+
+#include <glib.h>
+
+#include <functional>
+#include <mutex>
+
+#include "task_scheduler.h"
+
+namespace flutter_mcp {
+
+// SchedulerTimer backed by a GLib timeout source on the default main
+// context, so waiting for the next task costs no thread of its own.
+//
+// Arm() may be called from any thread; |fire| always runs on the main
+// context. Must be destroyed on the main thread.
+class MainLoopTimer : public SchedulerTimer {
+ public:
+  explicit MainLoopTimer(std::function<void()> fire);
+  ~MainLoopTimer() override;
+
+  MainLoopTimer(const MainLoopTimer&) = delete;
+  MainLoopTimer& operator=(const MainLoopTimer&) = delete;
+
+  void Arm(Clock::time_point deadline) override;
+  void Disarm() override;
+
+ private:
+  static gboolean OnTimeout(gpointer user_data);
+
+  std::function<void()> fire_;
+  std::mutex mutex_;
+  // The pending timeout, or nullptr.
+  GSource* source_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // MAIN_LOOP_TIMER_H_
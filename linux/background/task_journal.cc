@@ -0,0 +1,355 @@
+#include "task_journal.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace flutter_mcp {
+
+namespace {
+
+constexpr char kFileMagic[8] = {'F', 'M', 'C', 'P', 'T', 'S', 'K', '1'};
+constexpr uint32_t kRecordMagic = 0x52434d46;  // "FMCR"
+constexpr uint32_t kTombstone = 0xffffffff;
+// Keys and values are tiny; anything larger marks a corrupt header.
+constexpr uint32_t kMaxFieldLength = 64 * 1024;
+// Files below this size are never compacted.
+constexpr uint64_t kCompactMinBytes = 64 * 1024;
+
+struct RecordHeader {
+  uint32_t magic;
+  uint32_t key_length;
+  // kTombstone for an erased key.
+  uint32_t value_length;
+  uint32_t checksum;
+};
+
+uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t length) {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> entries = {};
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; k++) {
+        c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      }
+      entries[i] = c;
+    }
+    return entries;
+  }();
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++) {
+    crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+uint32_t RecordChecksum(const RecordHeader& header, const uint8_t* key,
+                        const uint8_t* value) {
+  uint32_t crc = Crc32(0, reinterpret_cast<const uint8_t*>(&header.key_length),
+                       sizeof(header.key_length) + sizeof(header.value_length));
+  crc = Crc32(crc, key, header.key_length);
+  if (header.value_length != kTombstone) {
+    crc = Crc32(crc, value, header.value_length);
+  }
+  return crc;
+}
+
+std::string EncodeRecord(const std::string& key, const std::string* value) {
+  RecordHeader header;
+  header.magic = kRecordMagic;
+  header.key_length = static_cast<uint32_t>(key.size());
+  header.value_length = value ? static_cast<uint32_t>(value->size()) : kTombstone;
+  header.checksum =
+      RecordChecksum(header, reinterpret_cast<const uint8_t*>(key.data()),
+                     value ? reinterpret_cast<const uint8_t*>(value->data()) : nullptr);
+
+  std::string record(reinterpret_cast<const char*>(&header), sizeof(header));
+  record += key;
+  if (value) {
+    record += *value;
+  }
+  return record;
+}
+
+bool WriteAll(int fd, const char* data, size_t length) {
+  while (length > 0) {
+    const ssize_t written = write(fd, data, length);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    length -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+}  // namespace
+
+TaskJournal::TaskJournal(std::string path)
+    : path_(std::move(path)), fd_(-1), end_(0), live_bytes_(0) {}
+
+TaskJournal::~TaskJournal() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CloseLocked();
+}
+
+bool TaskJournal::Open() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CloseLocked();
+
+  // A leftover temporary file is an interrupted compaction; the original
+  // is still intact because the rename never happened.
+  unlink((path_ + ".tmp").c_str());
+
+  fd_ = open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (fd_ < 0) {
+    return false;
+  }
+  if (!LoadLocked()) {
+    CloseLocked();
+    return false;
+  }
+  return true;
+}
+
+bool TaskJournal::LoadLocked() {
+  struct stat info;
+  if (fstat(fd_, &info) != 0) {
+    return false;
+  }
+
+  if (info.st_size == 0) {
+    end_ = sizeof(kFileMagic);
+    return WriteAll(fd_, kFileMagic, sizeof(kFileMagic));
+  }
+
+  std::vector<uint8_t> contents(static_cast<size_t>(info.st_size));
+  size_t read_bytes = 0;
+  while (read_bytes < contents.size()) {
+    const ssize_t count = pread(fd_, contents.data() + read_bytes,
+                                contents.size() - read_bytes,
+                                static_cast<off_t>(read_bytes));
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    read_bytes += static_cast<size_t>(count);
+  }
+  if (contents.size() < sizeof(kFileMagic) ||
+      memcmp(contents.data(), kFileMagic, sizeof(kFileMagic)) != 0) {
+    return false;
+  }
+
+  uint64_t offset = sizeof(kFileMagic);
+  while (offset + sizeof(RecordHeader) <= contents.size()) {
+    RecordHeader header;
+    memcpy(&header, contents.data() + offset, sizeof(header));
+    const bool tombstone = header.value_length == kTombstone;
+    const uint64_t value_length = tombstone ? 0 : header.value_length;
+    if (header.magic != kRecordMagic || header.key_length > kMaxFieldLength ||
+        value_length > kMaxFieldLength) {
+      break;
+    }
+    const uint64_t record_size = sizeof(RecordHeader) + header.key_length + value_length;
+    if (offset + record_size > contents.size()) {
+      break;
+    }
+
+    const uint8_t* key = contents.data() + offset + sizeof(RecordHeader);
+    if (RecordChecksum(header, key, key + header.key_length) != header.checksum) {
+      break;
+    }
+
+    std::string name(reinterpret_cast<const char*>(key), header.key_length);
+    auto it = values_.find(name);
+    if (it != values_.end()) {
+      live_bytes_ -= sizeof(RecordHeader) + it->first.size() + it->second.size();
+      values_.erase(it);
+    }
+    if (!tombstone) {
+      values_[name].assign(reinterpret_cast<const char*>(key + header.key_length),
+                           header.value_length);
+      live_bytes_ += record_size;
+    }
+    offset += record_size;
+  }
+
+  // Drop a torn tail so the next append starts on a record boundary.
+  end_ = offset;
+  if (offset < contents.size() && ftruncate(fd_, static_cast<off_t>(offset)) != 0) {
+    return false;
+  }
+  return lseek(fd_, static_cast<off_t>(end_), SEEK_SET) >= 0;
+}
+
+bool TaskJournal::Record(const std::string& task_id, const JournaledTask& task) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return PutLocked(task_id, EncodeJournaledTask(task));
+}
+
+bool TaskJournal::Complete(const std::string& task_id, int64_t due_unix_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = values_.find(task_id);
+  JournaledTask task;
+  if (it == values_.end() ||
+      !DecodeJournaledTask(reinterpret_cast<const uint8_t*>(it->second.data()),
+                           it->second.size(), &task) ||
+      task.recurring || task.due_unix_ms != due_unix_ms) {
+    return false;
+  }
+  return EraseLocked(task_id);
+}
+
+bool TaskJournal::Erase(const std::string& task_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return EraseLocked(task_id);
+}
+
+bool TaskJournal::SetOverduePolicy(OverduePolicy policy) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return PutLocked(kJournalPolicyKey,
+                   std::string(1, policy == OverduePolicy::kSkip ? 's' : 'f'));
+}
+
+OverduePolicy TaskJournal::overdue_policy() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = values_.find(kJournalPolicyKey);
+  return it != values_.end() && it->second == "s" ? OverduePolicy::kSkip
+                                                   : OverduePolicy::kFire;
+}
+
+void TaskJournal::ForEachTask(
+    const std::function<void(const std::string& task_id, const JournaledTask& task)>& visit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& entry : values_) {
+    JournaledTask task;
+    if (entry.first != kJournalPolicyKey &&
+        DecodeJournaledTask(reinterpret_cast<const uint8_t*>(entry.second.data()),
+                            entry.second.size(), &task)) {
+      visit(entry.first, task);
+    }
+  }
+}
+
+void TaskJournal::Remove() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CloseLocked();
+  unlink(path_.c_str());
+}
+
+size_t TaskJournal::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return values_.size() - values_.count(kJournalPolicyKey);
+}
+
+uint64_t TaskJournal::file_size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return end_;
+}
+
+bool TaskJournal::PutLocked(const std::string& key, const std::string& value) {
+  if (fd_ < 0 || key.size() > kMaxFieldLength || value.size() > kMaxFieldLength) {
+    return false;
+  }
+  if (!AppendLocked(key, &value)) {
+    return false;
+  }
+
+  auto it = values_.find(key);
+  if (it != values_.end()) {
+    live_bytes_ -= sizeof(RecordHeader) + key.size() + it->second.size();
+    it->second = value;
+  } else {
+    values_[key] = value;
+  }
+  live_bytes_ += sizeof(RecordHeader) + key.size() + value.size();
+
+  MaybeCompactLocked();
+  return true;
+}
+
+bool TaskJournal::EraseLocked(const std::string& key) {
+  auto it = values_.find(key);
+  if (it == values_.end()) {
+    return true;
+  }
+  if (fd_ < 0 || !AppendLocked(key, nullptr)) {
+    return false;
+  }
+  live_bytes_ -= sizeof(RecordHeader) + key.size() + it->second.size();
+  values_.erase(it);
+
+  MaybeCompactLocked();
+  return true;
+}
+
+bool TaskJournal::AppendLocked(const std::string& key, const std::string* value) {
+  // One write per record, so a crash leaves at most one torn record.
+  const std::string record = EncodeRecord(key, value);
+  if (!WriteAll(fd_, record.data(), record.size())) {
+    // Cut off whatever part made it out so later records stay readable.
+    if (ftruncate(fd_, static_cast<off_t>(end_)) == 0) {
+      lseek(fd_, static_cast<off_t>(end_), SEEK_SET);
+    }
+    return false;
+  }
+  end_ += record.size();
+  return true;
+}
+
+void TaskJournal::MaybeCompactLocked() {
+  const uint64_t dead_bytes = end_ - sizeof(kFileMagic) - live_bytes_;
+  if (end_ < kCompactMinBytes || dead_bytes <= live_bytes_) {
+    return;
+  }
+
+  // Write a snapshot of the live records beside the journal and rename it
+  // over the original, so a crash leaves one or the other intact.
+  const std::string temp_path = path_ + ".tmp";
+  const int temp = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (temp < 0) {
+    return;
+  }
+  std::string snapshot(kFileMagic, sizeof(kFileMagic));
+  for (const auto& entry : values_) {
+    snapshot += EncodeRecord(entry.first, &entry.second);
+  }
+  if (!WriteAll(temp, snapshot.data(), snapshot.size()) || fsync(temp) != 0 ||
+      rename(temp_path.c_str(), path_.c_str()) != 0) {
+    close(temp);
+    unlink(temp_path.c_str());
+    return;
+  }
+
+  close(fd_);
+  fd_ = open(path_.c_str(), O_RDWR | O_CLOEXEC);
+  end_ = snapshot.size();
+  if (fd_ >= 0) {
+    lseek(fd_, static_cast<off_t>(end_), SEEK_SET);
+  }
+  close(temp);
+}
+
+void TaskJournal::CloseLocked() {
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+  values_.clear();
+  end_ = 0;
+  live_bytes_ = 0;
+}
+
+}  // namespace flutter_mcp
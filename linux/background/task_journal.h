@@ -0,0 +1,75 @@
+#ifndef TASK_JOURNAL_H_
+#define TASK_JOURNAL_H_
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "journaled_task.h"
+
+namespace flutter_mcp {
+
+// Append-only journal of the Dart-scheduled tasks still pending, replayed
+// at plugin registration so they survive restarts.
+//
+// Every change appends one checksummed record, in the same layout as the
+// Windows RecordStore; the live records are also kept in memory. A torn
+// record at the end of the file (a crash mid-append) fails its checksum and
+// is truncated away on Open. Once superseded records outweigh live ones, a
+// snapshot of the live records atomically replaces the file.
+//
+// Thread-safe; completions are recorded from worker threads.
+class TaskJournal {
+ public:
+  explicit TaskJournal(std::string path);
+  ~TaskJournal();
+
+  TaskJournal(const TaskJournal&) = delete;
+  TaskJournal& operator=(const TaskJournal&) = delete;
+
+  // Opens or creates the file and loads it. The directory must exist.
+  bool Open();
+
+  // Records |task| as pending under |task_id|, replacing any earlier entry.
+  bool Record(const std::string& task_id, const JournaledTask& task);
+  // Drops |task_id| if it is still the one-shot task due at |due_unix_ms|,
+  // so a run that finishes after a reschedule keeps the new entry.
+  bool Complete(const std::string& task_id, int64_t due_unix_ms);
+  bool Erase(const std::string& task_id);
+
+  bool SetOverduePolicy(OverduePolicy policy);
+  OverduePolicy overdue_policy();
+
+  // Visits every pending task, in no particular order.
+  void ForEachTask(
+      const std::function<void(const std::string& task_id, const JournaledTask& task)>& visit);
+
+  // Closes and deletes the file.
+  void Remove();
+
+  size_t size();
+  uint64_t file_size();
+
+ private:
+  bool PutLocked(const std::string& key, const std::string& value);
+  bool EraseLocked(const std::string& key);
+  bool AppendLocked(const std::string& key, const std::string* value);
+  bool LoadLocked();
+  void MaybeCompactLocked();
+  void CloseLocked();
+
+  std::string path_;
+  std::mutex mutex_;
+  int fd_;
+  // Offset just past the last valid record
+  uint64_t end_;
+  // Bytes taken by records that are still current
+  uint64_t live_bytes_;
+  std::unordered_map<std::string, std::string> values_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // TASK_JOURNAL_H_
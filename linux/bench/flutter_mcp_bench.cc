@@ -0,0 +1,365 @@
+#include <benchmark/benchmark.h>
+#include <flutter_linux/flutter_linux.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "task_scheduler.h"
+#include "mpsc_queue.h"
+#include "jsonrpc_router.h"
+#include "method_table.h"
+#include "secret_cache.h"
+
+// Microbenchmarks for the plugin's native hot paths.
+//
+// Run with --benchmark_format=json, or --benchmark_out=<file>
+// --benchmark_out_format=json, for machine-readable results that can be
+// compared between builds.
+
+namespace flutter_mcp {
+namespace bench {
+
+namespace {
+
+constexpr int64_t kEventsPerProducer = 100000;
+
+struct FlValueUnref {
+  void operator()(FlValue* value) const { fl_value_unref(value); }
+};
+using FlValuePtr = std::unique_ptr<FlValue, FlValueUnref>;
+
+// Built the way send_event() wraps a periodic background event.
+FlValue* NewPeriodicEvent(int64_t timestamp) {
+  FlValue* data = fl_value_new_map();
+  fl_value_set_string_take(data, "type", fl_value_new_string("periodic"));
+  fl_value_set_string_take(data, "timestamp", fl_value_new_int(timestamp));
+
+  FlValue* event = fl_value_new_map();
+  fl_value_set_string_take(event, "type", fl_value_new_string("backgroundEvent"));
+  fl_value_set_string_take(event, "data", data);
+  return event;
+}
+
+// Counts completed tasks and lets the benchmark wait for a given total.
+class Countdown {
+ public:
+  explicit Countdown(int64_t count) : remaining_(count) {}
+
+  void Done() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--remaining_ == 0) {
+      cv_.notify_all();
+    }
+  }
+
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return remaining_ == 0; });
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  int64_t remaining_;
+};
+
+// Stands in for the Secret Service so that the cache in front of it can be
+// measured without a D-Bus session: a plain map, optionally with a fixed
+// per-call delay to model a round trip.
+class MemorySecretBackend {
+ public:
+  explicit MemorySecretBackend(std::chrono::microseconds delay) : delay_(delay) {}
+
+  void Store(const std::string& key, const std::string& value) {
+    Wait();
+    values_[key] = value;
+  }
+
+  bool Read(const std::string& key, std::string& value) {
+    Wait();
+    auto it = values_.find(key);
+    if (it == values_.end()) {
+      return false;
+    }
+    value = it->second;
+    return true;
+  }
+
+ private:
+  void Wait() const {
+    if (delay_.count() == 0) {
+      return;
+    }
+    const auto until = std::chrono::steady_clock::now() + delay_;
+    while (std::chrono::steady_clock::now() < until) {
+    }
+  }
+
+  std::chrono::microseconds delay_;
+  std::unordered_map<std::string, std::string> values_;
+};
+
+// The read path of SecretStore: cache first, then the backend.
+bool CachedRead(SecretCache& cache, MemorySecretBackend& backend,
+                const std::string& key, std::string& value) {
+  if (cache.Lookup(key, value)) {
+    return true;
+  }
+  if (!backend.Read(key, value)) {
+    return false;
+  }
+  cache.Put(key, value);
+  return true;
+}
+
+// Holds as many values as the benchmarks' small key set, and never expires
+// them mid-run.
+SecretCacheConfig BenchCacheConfig() {
+  SecretCacheConfig config;
+  config.enabled = true;
+  config.max_entries = 256;
+  config.ttl_ms = 3600000;
+  return config;
+}
+
+std::vector<std::string> MakeKeys(size_t count) {
+  std::vector<std::string> keys;
+  keys.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    keys.push_back("mcp.credential." + std::to_string(i));
+  }
+  return keys;
+}
+
+}  // namespace
+
+// Method dispatch
+
+static void BM_LookupMethod(benchmark::State& state) {
+  const size_t count = static_cast<size_t>(Method::kUnknown);
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LookupMethod(MethodName(static_cast<Method>(i))));
+    i = i + 1 < count ? i + 1 : 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LookupMethod);
+
+static void BM_LookupUnknownMethod(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LookupMethod("secureReadEverything"));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LookupUnknownMethod);
+
+// Event construction
+
+static void BM_BuildEventMap(benchmark::State& state) {
+  int64_t timestamp = 0;
+  for (auto _ : state) {
+    FlValuePtr event(NewPeriodicEvent(timestamp++));
+    benchmark::DoNotOptimize(event.get());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BuildEventMap);
+
+static void BM_EncodeEventMap(benchmark::State& state) {
+  g_autoptr(FlStandardMessageCodec) codec = fl_standard_message_codec_new();
+  FlValuePtr event(NewPeriodicEvent(1));
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    g_autoptr(GBytes) message =
+        fl_message_codec_encode_message(FL_MESSAGE_CODEC(codec), event.get(), nullptr);
+    bytes += static_cast<int64_t>(g_bytes_get_size(message));
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_EncodeEventMap);
+
+// Scheduler
+
+static void BM_SchedulerInsertCancel(benchmark::State& state) {
+  const int64_t count = state.range(0);
+  for (auto _ : state) {
+    TaskScheduler scheduler;
+    // Far enough out that nothing fires while the heap is being built.
+    for (int64_t i = 0; i < count; i++) {
+      scheduler.Schedule("task-" + std::to_string(i), 3600000 + (i * 7919) % 60000,
+                         [] {});
+    }
+    for (int64_t i = 0; i < count; i++) {
+      scheduler.Cancel("task-" + std::to_string(i));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_SchedulerInsertCancel)
+    ->RangeMultiplier(10)
+    ->Range(10000, 1000000)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_SchedulerFire(benchmark::State& state) {
+  const int64_t count = state.range(0);
+  for (auto _ : state) {
+    TaskScheduler scheduler;
+    // Inline on the scheduler thread, so this measures dispatch alone.
+    scheduler.SetWorkerThreads(0);
+    Countdown countdown(count);
+    for (int64_t i = 0; i < count; i++) {
+      scheduler.Schedule("task-" + std::to_string(i), 0, [&countdown] { countdown.Done(); });
+    }
+    countdown.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_SchedulerFire)
+    ->RangeMultiplier(10)
+    ->Range(10000, 1000000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Secure storage
+
+static void BM_SecureWrite(benchmark::State& state) {
+  SecretCache cache;
+  cache.Configure(BenchCacheConfig());
+  MemorySecretBackend backend(std::chrono::microseconds(state.range(0)));
+  const std::vector<std::string> keys = MakeKeys(1024);
+  const std::string value(256, 'v');
+  size_t i = 0;
+  for (auto _ : state) {
+    const std::string& key = keys[i++ & 1023];
+    backend.Store(key, value);
+    cache.Put(key, value);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SecureWrite)->Arg(0)->Arg(50);
+
+// Arg 0 is the backend delay in microseconds; arg 1 the number of distinct
+// keys read, against a 256-entry cache.
+static void BM_SecureRead(benchmark::State& state) {
+  SecretCache cache;
+  cache.Configure(BenchCacheConfig());
+  MemorySecretBackend backend(std::chrono::microseconds(state.range(0)));
+  const size_t key_count = static_cast<size_t>(state.range(1));
+  const std::vector<std::string> keys = MakeKeys(key_count);
+  for (const auto& key : keys) {
+    backend.Store(key, std::string(256, 'v'));
+  }
+  std::string value;
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(CachedRead(cache, backend, keys[i++ % key_count], value));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SecureRead)->Args({0, 128})->Args({0, 4096})->Args({50, 128})->Args({50, 4096});
+
+// Event delivery
+
+// One thread pushes a batch and drains it, as a burst of events followed
+// by the main-loop drain would.
+static void BM_EventQueuePushDrain(benchmark::State& state) {
+  const int64_t batch = state.range(0);
+  MpscQueue<FlValuePtr> queue;
+  for (auto _ : state) {
+    for (int64_t i = 0; i < batch; i++) {
+      queue.Push(FlValuePtr(NewPeriodicEvent(i)));
+    }
+    queue.Drain([](FlValuePtr event) { benchmark::DoNotOptimize(event.get()); });
+  }
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_EventQueuePushDrain)->Arg(1)->Arg(64)->Arg(1024);
+
+// Several producer threads post events while one consumer drains them.
+static void BM_EventQueueContended(benchmark::State& state) {
+  const int producers = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    MpscQueue<FlValuePtr> queue;
+    std::atomic<int> running(producers);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+      threads.emplace_back([&queue, &running] {
+        for (int64_t i = 0; i < kEventsPerProducer; i++) {
+          queue.Push(FlValuePtr(NewPeriodicEvent(i)));
+        }
+        running--;
+      });
+    }
+    int64_t drained = 0;
+    while (running > 0 || !queue.empty()) {
+      drained += static_cast<int64_t>(
+          queue.Drain([](FlValuePtr event) { benchmark::DoNotOptimize(event.get()); }));
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    benchmark::DoNotOptimize(drained);
+  }
+  state.SetItemsProcessed(state.iterations() * producers * kEventsPerProducer);
+}
+BENCHMARK(BM_EventQueueContended)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Transport routing
+
+static std::string ResponseWithText(size_t text_size) {
+  return "{\"jsonrpc\":\"2.0\",\"id\":7,\"result\":{\"content\":[{\"type\":\"text\","
+         "\"text\":\"" + std::string(text_size, 'x') + "\"}]}}";
+}
+
+// The envelope scan every server message pays, skipping a result of the
+// given size.
+static void BM_ParseEnvelope(benchmark::State& state) {
+  const std::string message = ResponseWithText(static_cast<size_t>(state.range(0)));
+  JsonRpcEnvelope envelope;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ParseJsonRpcEnvelope(message.data(), message.size(), &envelope));
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(message.size()));
+}
+BENCHMARK(BM_ParseEnvelope)->Arg(64)->Arg(4096)->Arg(1 << 20);
+
+// A read's worth of progress notifications for a few tokens, coalesced to
+// one per token.
+static void BM_RouteProgressBatch(benchmark::State& state) {
+  const int64_t batch_size = state.range(0);
+  std::vector<std::string> messages;
+  for (int64_t i = 0; i < batch_size; i++) {
+    messages.push_back(
+        "{\"jsonrpc\":\"2.0\",\"method\":\"notifications/progress\",\"params\":{"
+        "\"progressToken\":" + std::to_string(i % 4) + ",\"progress\":" + std::to_string(i) + "}}");
+  }
+  JsonRpcRouter router;
+  for (auto _ : state) {
+    RoutedBatch batch;
+    for (const auto& message : messages) {
+      router.Route(message.data(), message.size(), &batch);
+    }
+    benchmark::DoNotOptimize(batch.Take());
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+}
+BENCHMARK(BM_RouteProgressBatch)->Arg(16)->Arg(256);
+
+}  // namespace bench
+}  // namespace flutter_mcp
+
+BENCHMARK_MAIN();
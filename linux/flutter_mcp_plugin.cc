@@ -3,11 +3,13 @@
 #include <flutter_linux/flutter_linux.h>
 #include <gtk/gtk.h>
 #include <sys/utsname.h>
+#include <unistd.h>
 #include <libnotify/notify.h>
 #include <libsecret/secret.h>
 #include <appindicator3-0.1/libappindicator/app-indicator.h>
 
 #include <cstring>
+#include <functional>
 #include <memory>
 #include <map>
 #include <string>
@@ -15,8 +17,23 @@
 #include <mutex>
 #include <condition_variable>
 #include <chrono>
+#include <vector>
 
 #include "flutter_mcp_plugin_private.h"
+#include "event_batcher.h"
+#include "event_filter.h"
+#include "method_table.h"
+#include "mpsc_queue.h"
+#include "native_metrics.h"
+#include "native_trace.h"
+#include "notification_throttle.h"
+#include "task_scheduler.h"
+#include "background/main_loop_timer.h"
+#include "background/task_journal.h"
+#include "storage/secret_store.h"
+#include "transport/stdio_transport.h"
+#include "tray/tray_icon_atlas.h"
+#include "tray_menu_diff.h"
 
 #define FLUTTER_MCP_PLUGIN(obj) \
   (G_TYPE_CHECK_INSTANCE_CAST((obj), flutter_mcp_plugin_get_type(), \
@@ -32,30 +49,91 @@ static const SecretSchema flutter_mcp_schema = {
     }
 };
 
+// Owning FlValue reference for containers that outlive the caller's scope.
+struct FlValueUnref {
+  void operator()(FlValue* value) const { fl_value_unref(value); }
+};
+using FlValuePtr = std::unique_ptr<FlValue, FlValueUnref>;
+
+// An event waiting for the main thread, and what to run once it has reached
+// a listener.
+struct QueuedEvent {
+  FlValuePtr event;
+  std::function<void()> on_delivered;
+};
+
 struct _FlutterMcpPlugin {
   GObject parent_instance;
   
   FlMethodChannel* channel;
   FlEventChannel* event_channel;
+  // Only touched on the main thread; see post_event().
   FlEventSink* event_sink;
+  // Whether event_sink is set, for producers on other threads.
+  std::atomic<bool> event_listening;
   
-  // Tray icon
+  // Tray icon. The icon atlas, scheduler, secret store and notification
+  // state below are created on first use; see ensure_*().
   AppIndicator* app_indicator;
   GtkWidget* tray_menu;
-  std::map<std::string, std::string> menu_item_map;
-  
-  // Background service
+  std::unique_ptr<flutter_mcp::TrayIconAtlas> tray_icons;
+  // Whether the indicator has been pointed at the atlas directory.
+  gboolean tray_theme_path_set;
+  // What the menu currently shows, and the widget for each entry.
+  std::unique_ptr<std::vector<flutter_mcp::TrayMenuItem>> tray_menu_items;
+  std::unique_ptr<std::vector<GtkWidget*>> tray_menu_widgets;
+  
+  // Background service. Periodic ticks come from a main loop timeout, or
+  // from a dedicated thread when the thread timer backend is selected.
   std::unique_ptr<std::thread> background_thread;
   std::atomic<bool> background_running;
   std::atomic<int> background_interval_ms;
   std::mutex background_mutex;
   std::condition_variable background_cv;
+  guint background_source;
+  gboolean background_use_thread;
   
   // Scheduled tasks
-  std::map<std::string, std::pair<std::chrono::steady_clock::time_point, std::function<void()>>> scheduled_tasks;
-  std::mutex tasks_mutex;
+  std::unique_ptr<flutter_mcp::TaskScheduler> task_scheduler;
+  // Pending Dart-scheduled tasks on disk, when enabled; shared with the
+  // completions that retire them
+  std::shared_ptr<flutter_mcp::TaskJournal> task_journal;
+  // Journaled tasks waiting for the first listener; see replay_task_journal().
+  std::unique_ptr<flutter_mcp::HeldReplay> held_replay;
+  
+  // Event batching
+  std::unique_ptr<flutter_mcp::EventBatcher<FlValuePtr>> event_batcher;
+  
+  // Events built on any thread, delivered on the main thread
+  std::unique_ptr<flutter_mcp::MpscQueue<QueuedEvent>> event_queue;
+  // Event types and sampling rates the Dart listener subscribed to
+  std::unique_ptr<flutter_mcp::EventFilter> event_filter;
+  
+  // Secure storage
+  std::unique_ptr<flutter_mcp::SecretStore> secret_store;
+  
+  // Notifications, keyed by id while on screen
+  std::unique_ptr<flutter_mcp::NotificationThrottle> notification_throttle;
+  std::unique_ptr<std::map<std::string, NotifyNotification*>> notifications;
+  guint notification_flush_source;
+  
+  // Native timings; shared with responses that complete after dispose
+  std::shared_ptr<flutter_mcp::NativeMetrics> metrics;
+  // Periodic "metrics" event, 0 when disabled
+  guint metrics_source;
+  
+  // MCP server processes, created on first use. Their output goes out on
+  // its own event channel, queued and drained like the events above.
+  std::unique_ptr<flutter_mcp::StdioTransport> transport;
+  FlEventChannel* transport_channel;
+  FlEventSink* transport_sink;
+  std::unique_ptr<flutter_mcp::MpscQueue<FlValuePtr>> transport_queue;
 };
 
+// Completes a method call. Called exactly once, possibly after the handler
+// has returned; |response| is borrowed.
+using ResponseCallback = std::function<void(FlMethodResponse* response)>;
+
 G_DEFINE_TYPE(FlutterMcpPlugin, flutter_mcp_plugin, g_object_get_type())
 
 // Forward declarations
@@ -69,8 +147,34 @@ static void event_cancel_cb(FlEventChannel* channel,
                             gpointer user_data);
 static void send_event(FlutterMcpPlugin* self, const gchar* event_type,
                        FlValue* data);
+static void send_event_batch(FlutterMcpPlugin* self,
+                             const std::string& event_type,
+                             std::vector<FlValuePtr>&& events,
+                             size_t coalesced);
+static void post_event(FlutterMcpPlugin* self, FlValue* event,
+                       std::function<void()> on_delivered = nullptr);
+static void release_task_journal(FlutterMcpPlugin* self);
+
+// Producers ask before building an event, so events no listener subscribed
+// to, or sent while nobody listens, cost nothing. Counts as one event for
+// sampling while a listener is attached.
+static bool event_wanted(FlutterMcpPlugin* self, const gchar* event_type) {
+  return self->event_listening && self->event_filter->Admit(event_type);
+}
 
-// Background service worker
+static void send_periodic_event(FlutterMcpPlugin* self) {
+  if (!event_wanted(self, "backgroundEvent")) {
+    return;
+  }
+  g_autoptr(FlValue) data = fl_value_new_map();
+  fl_value_set_string_take(data, "type", fl_value_new_string("periodic"));
+  fl_value_set_string_take(data, "timestamp", 
+      fl_value_new_int(std::chrono::system_clock::now().time_since_epoch().count()));
+  
+  send_event(self, "backgroundEvent", data);
+}
+
+// Background service worker, used with the thread timer backend
 static void background_worker(FlutterMcpPlugin* self) {
   while (self->background_running) {
     {
@@ -81,41 +185,182 @@ static void background_worker(FlutterMcpPlugin* self) {
     }
     
     if (self->background_running) {
-      // Send periodic event
-      g_autoptr(FlValue) data = fl_value_new_map();
-      fl_value_set_string_take(data, "type", fl_value_new_string("periodic"));
-      fl_value_set_string_take(data, "timestamp", 
-          fl_value_new_int(std::chrono::system_clock::now().time_since_epoch().count()));
-      
-      send_event(self, "backgroundEvent", data);
+      send_periodic_event(self);
     }
-    
-    // Check scheduled tasks
+  }
+}
+
+static gboolean background_tick_cb(gpointer user_data) {
+  send_periodic_event(FLUTTER_MCP_PLUGIN(user_data));
+  return G_SOURCE_CONTINUE;
+}
+
+// Whole-second intervals use a seconds timeout, which GLib batches with
+// other such timeouts so the process wakes up less often.
+static void arm_background_tick(FlutterMcpPlugin* self) {
+  if (self->background_source) {
+    g_source_remove(self->background_source);
+  }
+  const int interval_ms = self->background_interval_ms > 0 ? self->background_interval_ms : 1;
+  self->background_source = interval_ms % 1000 == 0
+      ? g_timeout_add_seconds(static_cast<guint>(interval_ms / 1000), background_tick_cb, self)
+      : g_timeout_add(static_cast<guint>(interval_ms), background_tick_cb, self);
+}
+
+static void start_background_ticks(FlutterMcpPlugin* self) {
+  if (self->background_running) {
+    return;
+  }
+  self->background_running = true;
+  if (self->background_use_thread) {
+    self->background_thread = std::make_unique<std::thread>(background_worker, self);
+  } else {
+    arm_background_tick(self);
+  }
+}
+
+static void stop_background_ticks(FlutterMcpPlugin* self) {
+  if (self->background_source) {
+    g_source_remove(self->background_source);
+    self->background_source = 0;
+  }
+  if (self->background_thread) {
     {
-      std::lock_guard<std::mutex> lock(self->tasks_mutex);
-      auto now = std::chrono::steady_clock::now();
-      
-      for (auto it = self->scheduled_tasks.begin(); it != self->scheduled_tasks.end(); ) {
-        if (it->second.first <= now) {
-          // Execute task
-          if (it->second.second) {
-            it->second.second();
-          }
-          it = self->scheduled_tasks.erase(it);
-        } else {
-          ++it;
-        }
-      }
+      // Taken so the worker cannot miss the wakeup between its check and wait
+      std::lock_guard<std::mutex> lock(self->background_mutex);
+      self->background_running = false;
+    }
+    self->background_cv.notify_all();
+    self->background_thread->join();
+    self->background_thread.reset();
+  }
+  self->background_running = false;
+}
+
+static void use_scheduler_timer(FlutterMcpPlugin* self, bool event_loop) {
+  flutter_mcp::TaskScheduler* scheduler = self->task_scheduler.get();
+  scheduler->SetTimer(event_loop
+      ? std::make_unique<flutter_mcp::MainLoopTimer>([scheduler] { scheduler->RunDue(); })
+      : nullptr);
+}
+
+// Subsystems are created the first time a method needs them, or up front
+// when initialize asks for them, so registration costs nothing for the
+// ones an app never uses. Each records how long it took to create.
+
+static flutter_mcp::TaskScheduler* ensure_task_scheduler(FlutterMcpPlugin* self) {
+  if (!self->task_scheduler) {
+    const auto start = flutter_mcp::NativeMetrics::Clock::now();
+    self->task_scheduler = std::make_unique<flutter_mcp::TaskScheduler>();
+    self->task_scheduler->SetLatenessHistogram(&self->metrics->scheduler_lateness);
+    use_scheduler_timer(self, !self->background_use_thread);
+    self->metrics->RecordSubsystemInit(flutter_mcp::Subsystem::kBackground,
+                                       flutter_mcp::NativeMetrics::MicrosSince(start));
+  }
+  return self->task_scheduler.get();
+}
+
+// Also connects to the Secret Service, so the first secure storage call
+// does not pay for session setup and unlocking.
+static flutter_mcp::SecretStore* ensure_secret_store(FlutterMcpPlugin* self) {
+  if (!self->secret_store) {
+    const auto start = flutter_mcp::NativeMetrics::Clock::now();
+    self->secret_store = std::make_unique<flutter_mcp::SecretStore>(&flutter_mcp_schema);
+    self->secret_store->Warm(nullptr);
+    self->metrics->RecordSubsystemInit(flutter_mcp::Subsystem::kSecureStorage,
+                                       flutter_mcp::NativeMetrics::MicrosSince(start));
+  }
+  return self->secret_store.get();
+}
+
+static flutter_mcp::TrayIconAtlas* ensure_tray_icons(FlutterMcpPlugin* self) {
+  if (!self->tray_icons) {
+    const auto start = flutter_mcp::NativeMetrics::Clock::now();
+    self->tray_icons = std::make_unique<flutter_mcp::TrayIconAtlas>();
+    self->metrics->RecordSubsystemInit(flutter_mcp::Subsystem::kTray,
+                                       flutter_mcp::NativeMetrics::MicrosSince(start));
+  }
+  return self->tray_icons.get();
+}
+
+// notify_init() opens the session bus connection, the costliest part.
+static flutter_mcp::NotificationThrottle* ensure_notifications(FlutterMcpPlugin* self) {
+  if (!self->notification_throttle) {
+    const auto start = flutter_mcp::NativeMetrics::Clock::now();
+    if (!notify_is_initted()) {
+      notify_init("flutter_mcp");
     }
+    self->notification_throttle = std::make_unique<flutter_mcp::NotificationThrottle>(
+        g_get_monotonic_time() / 1000);
+    self->notifications = std::make_unique<std::map<std::string, NotifyNotification*>>();
+    self->metrics->RecordSubsystemInit(flutter_mcp::Subsystem::kNotifications,
+                                       flutter_mcp::NativeMetrics::MicrosSince(start));
+  }
+  return self->notification_throttle.get();
+}
+
+// Everything queued goes out as one list, so a burst of server output costs
+// a single platform message; runs on the main thread.
+static gboolean drain_transport_cb(gpointer user_data) {
+  FlutterMcpPlugin* self = FLUTTER_MCP_PLUGIN(user_data);
+  flutter_mcp::TraceSpan span(flutter_mcp::TraceCategory::kTransport, "deliver");
+  if (!self->transport_queue) {
+    return G_SOURCE_REMOVE;
+  }
+  g_autoptr(FlValue) events = fl_value_new_list();
+  self->transport_queue->Drain([events](FlValuePtr event) {
+    fl_value_append_take(events, event.release());
+  });
+  if (self->transport_sink && fl_value_get_length(events) > 0) {
+    fl_event_sink_add(self->transport_sink, events);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+// Called on the transport's reactor thread.
+static void post_transport_event(FlutterMcpPlugin* self, FlValue* event) {
+  if (self->transport_queue->Push(FlValuePtr(fl_value_ref(event)))) {
+    g_main_context_invoke_full(nullptr, G_PRIORITY_DEFAULT, drain_transport_cb,
+                               g_object_ref(self), g_object_unref);
   }
 }
 
+static flutter_mcp::StdioTransport* ensure_transport(FlutterMcpPlugin* self) {
+  if (!self->transport) {
+    const auto start = flutter_mcp::NativeMetrics::Clock::now();
+    self->transport = std::make_unique<flutter_mcp::StdioTransport>(
+        [self](const std::string& server_id, flutter_mcp::StdioTransport::Stream stream,
+               std::vector<std::string>&& messages) {
+          g_autoptr(FlValue) event = fl_value_new_map();
+          fl_value_set_string_take(event, "serverId", fl_value_new_string(server_id.c_str()));
+          fl_value_set_string_take(event, "type", fl_value_new_string(
+              stream == flutter_mcp::StdioTransport::Stream::kStdout ? "messages" : "stderr"));
+          FlValue* list = fl_value_new_list();
+          for (const auto& message : messages) {
+            fl_value_append_take(list, fl_value_new_string_sized(message.data(), message.size()));
+          }
+          fl_value_set_string_take(event, "messages", list);
+          post_transport_event(self, event);
+        },
+        [self](const std::string& server_id, int exit_code) {
+          g_autoptr(FlValue) event = fl_value_new_map();
+          fl_value_set_string_take(event, "serverId", fl_value_new_string(server_id.c_str()));
+          fl_value_set_string_take(event, "type", fl_value_new_string("exit"));
+          fl_value_set_string_take(event, "exitCode", fl_value_new_int(exit_code));
+          post_transport_event(self, event);
+        });
+    self->metrics->RecordSubsystemInit(flutter_mcp::Subsystem::kTransport,
+                                       flutter_mcp::NativeMetrics::MicrosSince(start));
+  }
+  return self->transport.get();
+}
+
 // Tray menu item callback
 static void tray_menu_item_cb(GtkMenuItem* item, gpointer user_data) {
   FlutterMcpPlugin* self = FLUTTER_MCP_PLUGIN(user_data);
   
   const gchar* item_id = (const gchar*)g_object_get_data(G_OBJECT(item), "item_id");
-  if (item_id) {
+  if (item_id && event_wanted(self, "trayEvent")) {
     g_autoptr(FlValue) data = fl_value_new_map();
     fl_value_set_string_take(data, "action", fl_value_new_string("menuItemClicked"));
     fl_value_set_string_take(data, "itemId", fl_value_new_string(item_id));
@@ -127,12 +372,38 @@ static void tray_menu_item_cb(GtkMenuItem* item, gpointer user_data) {
 static void flutter_mcp_plugin_dispose(GObject* object) {
   FlutterMcpPlugin* self = FLUTTER_MCP_PLUGIN(object);
   
+  if (self->metrics_source) {
+    g_source_remove(self->metrics_source);
+    self->metrics_source = 0;
+  }
+  
   // Stop background service
-  if (self->background_thread) {
-    self->background_running = false;
-    self->background_cv.notify_all();
-    self->background_thread->join();
+  stop_background_ticks(self);
+  self->task_scheduler.reset();
+  self->task_journal.reset();
+  self->held_replay.reset();
+  // Joins the reactor, so nothing is posted to the queue after this.
+  self->transport.reset();
+  self->transport_queue.reset();
+  // Flushes anything still buffered once no producers are left.
+  self->event_batcher.reset();
+  self->event_queue.reset();
+  self->event_filter.reset();
+  self->secret_store.reset();
+  
+  // Leave shown notifications on screen; just stop tracking them
+  if (self->notification_flush_source) {
+    g_source_remove(self->notification_flush_source);
+    self->notification_flush_source = 0;
+  }
+  if (self->notifications) {
+    for (auto& entry : *self->notifications) {
+      g_signal_handlers_disconnect_by_data(entry.second, self);
+      g_object_unref(entry.second);
+    }
+    self->notifications.reset();
   }
+  self->notification_throttle.reset();
   
   // Clean up tray icon
   if (self->app_indicator) {
@@ -141,9 +412,15 @@ static void flutter_mcp_plugin_dispose(GObject* object) {
   if (self->tray_menu) {
     gtk_widget_destroy(self->tray_menu);
   }
+  self->tray_menu_widgets.reset();
+  self->tray_menu_items.reset();
+  self->tray_icons.reset();
+  
+  self->metrics.reset();
   
   g_clear_object(&self->channel);
   g_clear_object(&self->event_channel);
+  g_clear_object(&self->transport_channel);
   
   G_OBJECT_CLASS(flutter_mcp_plugin_parent_class)->dispose(object);
 }
@@ -155,9 +432,28 @@ static void flutter_mcp_plugin_class_init(FlutterMcpPluginClass* klass) {
 static void flutter_mcp_plugin_init(FlutterMcpPlugin* self) {
   self->app_indicator = nullptr;
   self->tray_menu = nullptr;
+  self->tray_theme_path_set = FALSE;
+  self->tray_menu_items = std::make_unique<std::vector<flutter_mcp::TrayMenuItem>>();
+  self->tray_menu_widgets = std::make_unique<std::vector<GtkWidget*>>();
   self->event_sink = nullptr;
+  self->event_listening = false;
   self->background_running = false;
   self->background_interval_ms = 60000; // Default 1 minute
+  self->background_source = 0;
+  self->background_use_thread = FALSE;
+  self->metrics = std::make_shared<flutter_mcp::NativeMetrics>();
+  self->metrics_source = 0;
+  self->held_replay = std::make_unique<flutter_mcp::HeldReplay>();
+  self->event_queue = std::make_unique<flutter_mcp::MpscQueue<QueuedEvent>>();
+  self->event_filter = std::make_unique<flutter_mcp::EventFilter>();
+  self->transport_sink = nullptr;
+  self->transport_queue = std::make_unique<flutter_mcp::MpscQueue<FlValuePtr>>();
+  self->notification_flush_source = 0;
+  self->event_batcher = std::make_unique<flutter_mcp::EventBatcher<FlValuePtr>>(
+      [self](const std::string& type, std::vector<FlValuePtr>&& events,
+             size_t coalesced) {
+        send_event_batch(self, type, std::move(events), coalesced);
+      });
 }
 
 // Method implementations
@@ -169,27 +465,53 @@ static FlMethodResponse* get_platform_version() {
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
-static FlMethodResponse* initialize(FlValue* args) {
-  // Initialize components based on config
-  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+static gboolean lookup_flag(FlValue* args, const gchar* key) {
+  FlValue* value = fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                       ? fl_value_lookup_string(args, key)
+                       : nullptr;
+  return value && fl_value_get_type(value) == FL_VALUE_TYPE_BOOL && fl_value_get_bool(value);
 }
 
-static FlMethodResponse* start_background_service(FlutterMcpPlugin* self) {
-  if (!self->background_running) {
-    self->background_running = true;
-    self->background_thread = std::make_unique<std::thread>(background_worker, self);
+static FlValue* subsystem_timings_new(const flutter_mcp::NativeMetrics& metrics) {
+  FlValue* timings = fl_value_new_map();
+  metrics.ForEachSubsystem([timings](const char* name, int64_t micros) {
+    fl_value_set_string_take(timings, name, fl_value_new_int(micros));
+  });
+  return timings;
+}
+
+// Creates the subsystems the MCPConfig flags ask for now rather than on
+// first use, and answers with every subsystem's init time so far.
+static FlMethodResponse* initialize(FlutterMcpPlugin* self, FlValue* args) {
+  if (lookup_flag(args, "useTray")) {
+    ensure_tray_icons(self);
+  }
+  if (lookup_flag(args, "useNotification")) {
+    ensure_notifications(self);
+  }
+  if (lookup_flag(args, "secure")) {
+    ensure_secret_store(self);
   }
+  if (lookup_flag(args, "useBackgroundService")) {
+    ensure_task_scheduler(self);
+  }
+  
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(result, "subsystemInitUs", subsystem_timings_new(*self->metrics));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* start_background_service(FlutterMcpPlugin* self) {
+  start_background_ticks(self);
   
   g_autoptr(FlValue) result = fl_value_new_bool(TRUE);
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
 static FlMethodResponse* stop_background_service(FlutterMcpPlugin* self) {
-  if (self->background_thread) {
-    self->background_running = false;
-    self->background_cv.notify_all();
-    self->background_thread->join();
-    self->background_thread.reset();
+  stop_background_ticks(self);
+  if (self->task_scheduler) {
+    self->task_scheduler->Stop();
   }
   
   g_autoptr(FlValue) result = fl_value_new_bool(TRUE);
@@ -201,12 +523,122 @@ static FlMethodResponse* configure_background_service(FlutterMcpPlugin* self, Fl
     FlValue* interval_value = fl_value_lookup_string(args, "intervalMs");
     if (interval_value && fl_value_get_type(interval_value) == FL_VALUE_TYPE_INT) {
       self->background_interval_ms = fl_value_get_int(interval_value);
+      if (self->background_source) {
+        arm_background_tick(self);
+      }
+    }
+    
+    // Keeps pending tasks on disk so they come back after a restart; turning
+    // it off deletes the journal
+    FlValue* journal_value = fl_value_lookup_string(args, "persistTasks");
+    if (journal_value && fl_value_get_type(journal_value) == FL_VALUE_TYPE_BOOL) {
+      if (fl_value_get_bool(journal_value) && !self->task_journal) {
+        self->task_journal = open_task_journal();
+      } else if (!fl_value_get_bool(journal_value) && self->task_journal) {
+        self->task_journal->Remove();
+        self->task_journal.reset();
+      }
+    }
+    FlValue* overdue_value = fl_value_lookup_string(args, "overduePolicy");
+    if (overdue_value && fl_value_get_type(overdue_value) == FL_VALUE_TYPE_STRING &&
+        self->task_journal) {
+      self->task_journal->SetOverduePolicy(
+          flutter_mcp::ParseOverduePolicy(fl_value_get_string(overdue_value)));
+    }
+    
+    // "eventLoop" (the default) or "thread"; a running service switches over
+    FlValue* backend_value = fl_value_lookup_string(args, "timerBackend");
+    if (backend_value && fl_value_get_type(backend_value) == FL_VALUE_TYPE_STRING) {
+      const gboolean use_thread = strcmp(fl_value_get_string(backend_value), "thread") == 0;
+      if (use_thread != self->background_use_thread) {
+        const bool running = self->background_running;
+        stop_background_ticks(self);
+        self->background_use_thread = use_thread;
+        if (self->task_scheduler) {
+          use_scheduler_timer(self, !use_thread);
+        }
+        if (running) {
+          start_background_ticks(self);
+        }
+      }
+    }
+    
+    FlValue* workers_value = fl_value_lookup_string(args, "workerThreads");
+    if (workers_value && fl_value_get_type(workers_value) == FL_VALUE_TYPE_INT) {
+      int64_t workers = fl_value_get_int(workers_value);
+      if (workers >= 0) {
+        ensure_task_scheduler(self)->SetWorkerThreads(static_cast<size_t>(workers));
+      }
     }
   }
   
   return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
 }
 
+static int64_t unix_ms() {
+  return g_get_real_time() / 1000;
+}
+
+// Per application, so two apps using the plugin keep separate journals.
+static gchar* task_journal_path() {
+  const gchar* app = g_get_prgname();
+  return g_build_filename(g_get_user_data_dir(), "flutter_mcp", app ? app : "default",
+                          "tasks.journal", nullptr);
+}
+
+static std::shared_ptr<flutter_mcp::TaskJournal> open_task_journal() {
+  g_autofree gchar* path = task_journal_path();
+  g_autofree gchar* dir = g_path_get_dirname(path);
+  if (g_mkdir_with_parents(dir, 0700) != 0) {
+    return nullptr;
+  }
+  auto journal = std::make_shared<flutter_mcp::TaskJournal>(path);
+  if (!journal->Open()) {
+    g_warning("Could not open the task journal at %s", path);
+    return nullptr;
+  }
+  return journal;
+}
+
+// Builds the backgroundTaskResult event for one run of a Dart-scheduled task.
+// With |journal_due_ms| set, a journaled one-shot task is retired once a
+// listener has its result or has filtered the result out. One that finishes
+// while nobody listens stays journaled and runs again on the next start.
+static flutter_mcp::WorkerPool::Completion task_result_sender(FlutterMcpPlugin* self,
+                                                              const gchar* task_id,
+                                                              int64_t journal_due_ms = -1) {
+  std::shared_ptr<flutter_mcp::TaskJournal> journal =
+      journal_due_ms >= 0 ? self->task_journal : nullptr;
+  return [self, task_id = std::string(task_id), journal,
+          journal_due_ms](const flutter_mcp::TaskTiming& timing) {
+    if (!event_wanted(self, "backgroundTaskResult")) {
+      if (journal && self->event_listening) {
+        journal->Complete(task_id, journal_due_ms);
+      }
+      return;
+    }
+
+    g_autoptr(FlValue) data = fl_value_new_map();
+    fl_value_set_string_take(data, "taskId", fl_value_new_string(task_id.c_str()));
+    fl_value_set_string_take(data, "timestamp", 
+        fl_value_new_int(std::chrono::system_clock::now().time_since_epoch().count()));
+    fl_value_set_string_take(data, "queueDelayMicros", fl_value_new_int(timing.queue_delay_us));
+    fl_value_set_string_take(data, "runTimeMicros", fl_value_new_int(timing.run_time_us));
+    
+    if (!journal) {
+      send_event(self, "backgroundTaskResult", data);
+      return;
+    }
+    // Skips the batcher, which would lose track of when it is delivered.
+    g_autoptr(FlValue) event = fl_value_new_map();
+    fl_value_set_string_take(event, "type", fl_value_new_string("backgroundTaskResult"));
+    fl_value_set_string_take(event, "data", fl_value_ref(data));
+    post_event(self, event, [journal, task_id, journal_due_ms] {
+      journal->Complete(task_id, journal_due_ms);
+    });
+  };
+}
+
 static FlMethodResponse* schedule_background_task(FlutterMcpPlugin* self, FlValue* args) {
   if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
     return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
@@ -222,17 +654,87 @@ static FlMethodResponse* schedule_background_task(FlutterMcpPlugin* self, FlValu
   const gchar* task_id = fl_value_get_string(task_id_value);
   int64_t delay_millis = fl_value_get_int(delay_value);
   
-  std::lock_guard<std::mutex> lock(self->tasks_mutex);
+  flutter_mcp::TaskPriority priority = flutter_mcp::TaskPriority::kNormal;
+  FlValue* priority_value = fl_value_lookup_string(args, "priority");
+  if (priority_value && fl_value_get_type(priority_value) == FL_VALUE_TYPE_STRING) {
+    priority = flutter_mcp::ParseTaskPriority(fl_value_get_string(priority_value));
+  }
   
-  auto execute_time = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay_millis);
-  self->scheduled_tasks[task_id] = std::make_pair(execute_time, [self, task_id = std::string(task_id)]() {
-    g_autoptr(FlValue) data = fl_value_new_map();
-    fl_value_set_string_take(data, "taskId", fl_value_new_string(task_id.c_str()));
-    fl_value_set_string_take(data, "timestamp", 
-        fl_value_new_int(std::chrono::system_clock::now().time_since_epoch().count()));
-    
-    send_event(self, "backgroundTaskResult", data);
-  });
+  int64_t journal_due_ms = -1;
+  if (self->task_journal) {
+    flutter_mcp::JournaledTask journaled;
+    journaled.due_unix_ms = unix_ms() + (delay_millis > 0 ? delay_millis : 0);
+    journaled.priority = static_cast<uint8_t>(priority);
+    self->task_journal->Record(task_id, journaled);
+    journal_due_ms = journaled.due_unix_ms;
+  }
+  self->held_replay->Forget(task_id);
+  
+  // Dart-scheduled tasks have no native work; the result event is built on
+  // the worker once the task completes so it can report its timings.
+  ensure_task_scheduler(self)->Schedule(task_id, delay_millis, nullptr, priority,
+                                        task_result_sender(self, task_id, journal_due_ms));
+  
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+// Registered once; every run sends its own backgroundTaskResult event.
+static FlMethodResponse* schedule_recurring_task(FlutterMcpPlugin* self, FlValue* args) {
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
+  }
+  
+  FlValue* task_id_value = fl_value_lookup_string(args, "taskId");
+  FlValue* period_value = fl_value_lookup_string(args, "periodMs");
+  if (!task_id_value || fl_value_get_type(task_id_value) != FL_VALUE_TYPE_STRING ||
+      !period_value || fl_value_get_type(period_value) != FL_VALUE_TYPE_INT) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing required arguments", nullptr));
+  }
+  
+  flutter_mcp::Recurrence recurrence;
+  recurrence.period_ms = fl_value_get_int(period_value);
+  if (recurrence.period_ms <= 0) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "periodMs must be positive", nullptr));
+  }
+  
+  FlValue* mode_value = fl_value_lookup_string(args, "mode");
+  if (mode_value && fl_value_get_type(mode_value) == FL_VALUE_TYPE_STRING) {
+    recurrence.mode = flutter_mcp::ParseRecurrenceMode(fl_value_get_string(mode_value));
+  }
+  FlValue* jitter_value = fl_value_lookup_string(args, "jitterMs");
+  if (jitter_value && fl_value_get_type(jitter_value) == FL_VALUE_TYPE_INT) {
+    recurrence.jitter_ms = fl_value_get_int(jitter_value);
+  }
+  FlValue* overrun_value = fl_value_lookup_string(args, "overrun");
+  if (overrun_value && fl_value_get_type(overrun_value) == FL_VALUE_TYPE_STRING) {
+    recurrence.overrun = flutter_mcp::ParseOverrunPolicy(fl_value_get_string(overrun_value));
+  }
+  
+  int64_t initial_delay_millis = recurrence.period_ms;
+  FlValue* initial_value = fl_value_lookup_string(args, "initialDelayMs");
+  if (initial_value && fl_value_get_type(initial_value) == FL_VALUE_TYPE_INT) {
+    initial_delay_millis = fl_value_get_int(initial_value);
+  }
+  
+  flutter_mcp::TaskPriority priority = flutter_mcp::TaskPriority::kNormal;
+  FlValue* priority_value = fl_value_lookup_string(args, "priority");
+  if (priority_value && fl_value_get_type(priority_value) == FL_VALUE_TYPE_STRING) {
+    priority = flutter_mcp::ParseTaskPriority(fl_value_get_string(priority_value));
+  }
+  
+  const gchar* task_id = fl_value_get_string(task_id_value);
+  if (self->task_journal) {
+    flutter_mcp::JournaledTask journaled;
+    journaled.due_unix_ms = unix_ms() + (initial_delay_millis > 0 ? initial_delay_millis : 0);
+    journaled.priority = static_cast<uint8_t>(priority);
+    journaled.recurring = true;
+    journaled.recurrence = recurrence;
+    self->task_journal->Record(task_id, journaled);
+  }
+  self->held_replay->Forget(task_id);
+  ensure_task_scheduler(self)->ScheduleRecurring(task_id, initial_delay_millis, recurrence,
+                                                 nullptr, priority,
+                                                 task_result_sender(self, task_id));
   
   return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
 }
@@ -249,13 +751,93 @@ static FlMethodResponse* cancel_background_task(FlutterMcpPlugin* self, FlValue*
   
   const gchar* task_id = fl_value_get_string(task_id_value);
   
-  std::lock_guard<std::mutex> lock(self->tasks_mutex);
-  self->scheduled_tasks.erase(task_id);
+  if (self->task_scheduler) {
+    self->task_scheduler->Cancel(task_id);
+  }
+  if (self->task_journal) {
+    self->task_journal->Erase(task_id);
+  }
+  self->held_replay->Forget(task_id);
   
   return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
 }
 
-static FlMethodResponse* show_notification(FlValue* args) {
+// Not implemented on Linux yet, so Dart-scheduled tasks keep running on the
+// app's own isolate. A port of the Windows HeadlessEngine would host them in
+// an engine from fl_engine_new_headless().
+static FlMethodResponse* start_headless_engine() {
+  return FL_METHOD_RESPONSE(fl_method_error_response_new(
+      "UNSUPPORTED", "Headless engines are not implemented on Linux yet", nullptr));
+}
+
+// Nothing to stop, since start_headless_engine() never starts one.
+static FlMethodResponse* stop_headless_engine() {
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+static int64_t monotonic_ms() {
+  return g_get_monotonic_time() / 1000;
+}
+
+static void notification_closed_cb(NotifyNotification* notification, gpointer user_data) {
+  FlutterMcpPlugin* self = FLUTTER_MCP_PLUGIN(user_data);
+  const gchar* id = static_cast<const gchar*>(
+      g_object_get_data(G_OBJECT(notification), "notification_id"));
+  if (!id) return;
+  
+  std::string key = id;
+  auto it = self->notifications->find(key);
+  if (it != self->notifications->end() && it->second == notification) {
+    self->notifications->erase(it);
+    self->notification_throttle->Dismissed(key);
+    g_object_unref(notification);
+  }
+}
+
+// Shows |action|, updating the notification with the same id in place if
+// one is still open so the shell does not stack another popup.
+static void present_notification(FlutterMcpPlugin* self,
+                                 const flutter_mcp::NotificationAction& action) {
+  auto it = self->notifications->find(action.id);
+  NotifyNotification* notification;
+  if (it != self->notifications->end()) {
+    notification = it->second;
+    notify_notification_update(notification, action.title.c_str(), action.body.c_str(), nullptr);
+  } else {
+    notification = notify_notification_new(action.title.c_str(), action.body.c_str(), nullptr);
+    g_object_set_data_full(G_OBJECT(notification), "notification_id",
+                           g_strdup(action.id.c_str()), g_free);
+    g_signal_connect(notification, "closed", G_CALLBACK(notification_closed_cb), self);
+    (*self->notifications)[action.id] = notification;
+  }
+  notify_notification_show(notification, nullptr);
+}
+
+static void present_notifications(FlutterMcpPlugin* self,
+                                  const std::vector<flutter_mcp::NotificationAction>& actions) {
+  for (const auto& action : actions) {
+    present_notification(self, action);
+  }
+}
+
+static gboolean notification_flush_cb(gpointer user_data) {
+  FlutterMcpPlugin* self = FLUTTER_MCP_PLUGIN(user_data);
+  present_notifications(self, self->notification_throttle->Flush(monotonic_ms()));
+  if (self->notification_throttle->HasPendingWork()) {
+    return G_SOURCE_CONTINUE;
+  }
+  self->notification_flush_source = 0;
+  return G_SOURCE_REMOVE;
+}
+
+// Runs the throttle's flush tick only while it has something queued.
+static void schedule_notification_flush(FlutterMcpPlugin* self) {
+  if (!self->notification_flush_source && self->notification_throttle->HasPendingWork()) {
+    self->notification_flush_source = g_timeout_add(250, notification_flush_cb, self);
+  }
+}
+
+static FlMethodResponse* show_notification(FlutterMcpPlugin* self, FlValue* args) {
   if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
     return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
   }
@@ -268,32 +850,119 @@ static FlMethodResponse* show_notification(FlValue* args) {
     return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing required arguments", nullptr));
   }
   
-  const gchar* title = fl_value_get_string(title_value);
-  const gchar* body = fl_value_get_string(body_value);
+  flutter_mcp::NotificationRequest request;
+  request.title = fl_value_get_string(title_value);
+  request.body = fl_value_get_string(body_value);
+  request.id = fl_value_get_string(id_value);
   
-  NotifyNotification* notification = notify_notification_new(title, body, nullptr);
-  notify_notification_show(notification, nullptr);
-  g_object_unref(G_OBJECT(notification));
+  FlValue* group_value = fl_value_lookup_string(args, "groupKey");
+  if (group_value && fl_value_get_type(group_value) == FL_VALUE_TYPE_STRING) {
+    request.group_key = fl_value_get_string(group_value);
+  }
+  
+  present_notifications(self, ensure_notifications(self)->Submit(request, monotonic_ms()));
+  schedule_notification_flush(self);
   
   return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
 }
 
-static FlMethodResponse* cancel_notification(FlValue* args) {
-  // Linux doesn't provide a way to cancel specific notifications
+static void close_notification(FlutterMcpPlugin* self, const std::string& id) {
+  if (!self->notification_throttle) return;
+  self->notification_throttle->Dismissed(id);
+  auto it = self->notifications->find(id);
+  if (it == self->notifications->end()) return;
+  
+  NotifyNotification* notification = it->second;
+  self->notifications->erase(it);
+  g_signal_handlers_disconnect_by_data(notification, self);
+  notify_notification_close(notification, nullptr);
+  g_object_unref(notification);
+}
+
+static FlMethodResponse* cancel_notification(FlutterMcpPlugin* self, FlValue* args) {
+  FlValue* id_value = fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                          ? fl_value_lookup_string(args, "id")
+                          : nullptr;
+  if (!id_value || fl_value_get_type(id_value) != FL_VALUE_TYPE_STRING) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing notification ID", nullptr));
+  }
+  
+  close_notification(self, fl_value_get_string(id_value));
   return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
 }
 
-static FlMethodResponse* cancel_all_notifications() {
-  // Linux doesn't provide a way to cancel all notifications
+static FlMethodResponse* cancel_all_notifications(FlutterMcpPlugin* self) {
+  if (!self->notification_throttle) {
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  std::vector<std::string> ids;
+  for (const auto& entry : *self->notifications) {
+    ids.push_back(entry.first);
+  }
+  for (const auto& id : ids) {
+    close_notification(self, id);
+  }
+  self->notification_throttle->Clear();
   return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
 }
 
-static FlMethodResponse* configure_notifications(FlValue* args) {
-  // Configuration can be extended as needed
+static bool lookup_number(FlValue* args, const gchar* key, double* value) {
+  FlValue* number = fl_value_lookup_string(args, key);
+  if (!number) return false;
+  if (fl_value_get_type(number) == FL_VALUE_TYPE_INT) {
+    *value = static_cast<double>(fl_value_get_int(number));
+    return true;
+  }
+  if (fl_value_get_type(number) == FL_VALUE_TYPE_FLOAT) {
+    *value = fl_value_get_float(number);
+    return true;
+  }
+  return false;
+}
+
+static FlMethodResponse* configure_notifications(FlutterMcpPlugin* self, FlValue* args) {
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  
+  flutter_mcp::NotificationThrottle* throttle = ensure_notifications(self);
+  flutter_mcp::NotificationPolicy policy = throttle->policy();
+  FlValue* throttle_value = fl_value_lookup_string(args, "throttle");
+  if (throttle_value && fl_value_get_type(throttle_value) == FL_VALUE_TYPE_BOOL) {
+    policy.enabled = fl_value_get_bool(throttle_value);
+  }
+  double number;
+  if (lookup_number(args, "rateLimitPerSecond", &number)) {
+    if (number < 0) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "rateLimitPerSecond must not be negative", nullptr));
+    }
+    policy.rate_per_second = number;
+  }
+  if (lookup_number(args, "burst", &number)) {
+    if (number < 1) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "burst must be at least 1", nullptr));
+    }
+    policy.burst = static_cast<size_t>(number);
+  }
+  if (lookup_number(args, "groupWindowMs", &number) && number >= 0) {
+    policy.group_window_ms = static_cast<int64_t>(number);
+  }
+  if (lookup_number(args, "maxPending", &number) && number >= 0) {
+    policy.max_pending = static_cast<size_t>(number);
+  }
+  
+  throttle->Configure(policy, monotonic_ms());
   return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
 }
 
-static FlMethodResponse* secure_store(FlValue* args) {
+static FlMethodResponse* storage_error_response(const GError* error) {
+  return FL_METHOD_RESPONSE(fl_method_error_response_new("STORAGE_ERROR", error->message, nullptr));
+}
+
+// Secure storage handlers validate synchronously and return an error
+// response, or return nullptr and answer |done| once libsecret completes.
+static FlMethodResponse* secure_store(FlutterMcpPlugin* self, FlValue* args,
+                                      const ResponseCallback& done) {
   if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
     return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
   }
@@ -308,26 +977,17 @@ static FlMethodResponse* secure_store(FlValue* args) {
   const gchar* key = fl_value_get_string(key_value);
   const gchar* value = fl_value_get_string(value_value);
   
-  GError* error = nullptr;
-  gboolean result = secret_password_store_sync(&flutter_mcp_schema,
-                                               SECRET_COLLECTION_DEFAULT,
-                                               key,
-                                               value,
-                                               nullptr,
-                                               &error,
-                                               "key", key,
-                                               nullptr);
-  
-  if (error) {
-    g_autofree gchar* error_msg = g_strdup(error->message);
-    g_error_free(error);
-    return FL_METHOD_RESPONSE(fl_method_error_response_new("STORAGE_ERROR", error_msg, nullptr));
-  }
-  
-  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  ensure_secret_store(self)->Store(key, value, [done](const GError* error) {
+    g_autoptr(FlMethodResponse) response = error
+        ? storage_error_response(error)
+        : FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    done(response);
+  });
+  return nullptr;
 }
 
-static FlMethodResponse* secure_read(FlValue* args) {
+static FlMethodResponse* secure_read(FlutterMcpPlugin* self, FlValue* args,
+                                     const ResponseCallback& done) {
   if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
     return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
   }
@@ -339,30 +999,79 @@ static FlMethodResponse* secure_read(FlValue* args) {
   
   const gchar* key = fl_value_get_string(key_value);
   
-  GError* error = nullptr;
-  gchar* password = secret_password_lookup_sync(&flutter_mcp_schema,
-                                                nullptr,
-                                                &error,
-                                                "key", key,
-                                                nullptr);
-  
-  if (error) {
-    g_autofree gchar* error_msg = g_strdup(error->message);
-    g_error_free(error);
-    return FL_METHOD_RESPONSE(fl_method_error_response_new("STORAGE_ERROR", error_msg, nullptr));
+  ensure_secret_store(self)->Read(key,
+      [done](bool found, const std::string& value, const GError* error) {
+    g_autoptr(FlMethodResponse) response = nullptr;
+    if (error) {
+      response = storage_error_response(error);
+    } else if (!found) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("KEY_NOT_FOUND", "Key not found", nullptr));
+    } else {
+      g_autoptr(FlValue) result = fl_value_new_string(value.c_str());
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    }
+    done(response);
+  });
+  return nullptr;
+}
+
+// Binary-safe: the uint8 list is handed to libsecret as is, with no
+// string conversion on the way.
+static FlMethodResponse* secure_store_bytes(FlutterMcpPlugin* self, FlValue* args,
+                                            const ResponseCallback& done) {
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
   }
   
-  if (!password) {
-    return FL_METHOD_RESPONSE(fl_method_error_response_new("KEY_NOT_FOUND", "Key not found", nullptr));
+  FlValue* key_value = fl_value_lookup_string(args, "key");
+  FlValue* value_value = fl_value_lookup_string(args, "value");
+  if (!key_value || fl_value_get_type(key_value) != FL_VALUE_TYPE_STRING ||
+      !value_value || fl_value_get_type(value_value) != FL_VALUE_TYPE_UINT8_LIST) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing required arguments", nullptr));
   }
   
-  g_autoptr(FlValue) result = fl_value_new_string(password);
-  secret_password_free(password);
+  // Borrows the list's buffer; the ref keeps it alive until libsecret has it.
+  g_autoptr(GBytes) bytes = g_bytes_new_with_free_func(
+      fl_value_get_uint8_list(value_value), fl_value_get_length(value_value),
+      reinterpret_cast<GDestroyNotify>(fl_value_unref), fl_value_ref(value_value));
+  ensure_secret_store(self)->StoreBytes(fl_value_get_string(key_value), bytes,
+                                        [done](const GError* error) {
+    g_autoptr(FlMethodResponse) response = error
+        ? storage_error_response(error)
+        : FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    done(response);
+  });
+  return nullptr;
+}
+
+static FlMethodResponse* secure_read_bytes(FlutterMcpPlugin* self, FlValue* args,
+                                           const ResponseCallback& done) {
+  FlValue* key_value = fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                           ? fl_value_lookup_string(args, "key")
+                           : nullptr;
+  if (!key_value || fl_value_get_type(key_value) != FL_VALUE_TYPE_STRING) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing key", nullptr));
+  }
   
-  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  ensure_secret_store(self)->ReadBytes(fl_value_get_string(key_value),
+      [done](bool found, const uint8_t* data, size_t length, const GError* error) {
+    g_autoptr(FlMethodResponse) response = nullptr;
+    if (error) {
+      response = storage_error_response(error);
+    } else if (!found) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("KEY_NOT_FOUND", "Key not found", nullptr));
+    } else {
+      // The one copy: out of the secret into the reply.
+      g_autoptr(FlValue) result = fl_value_new_uint8_list(data, length);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    }
+    done(response);
+  });
+  return nullptr;
 }
 
-static FlMethodResponse* secure_delete(FlValue* args) {
+static FlMethodResponse* secure_delete(FlutterMcpPlugin* self, FlValue* args,
+                                       const ResponseCallback& done) {
   if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
     return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
   }
@@ -374,23 +1083,17 @@ static FlMethodResponse* secure_delete(FlValue* args) {
   
   const gchar* key = fl_value_get_string(key_value);
   
-  GError* error = nullptr;
-  secret_password_clear_sync(&flutter_mcp_schema,
-                             nullptr,
-                             &error,
-                             "key", key,
-                             nullptr);
-  
-  if (error) {
-    g_autofree gchar* error_msg = g_strdup(error->message);
-    g_error_free(error);
-    return FL_METHOD_RESPONSE(fl_method_error_response_new("STORAGE_ERROR", error_msg, nullptr));
-  }
-  
-  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  ensure_secret_store(self)->Delete(key, [done](const GError* error) {
+    g_autoptr(FlMethodResponse) response = error
+        ? storage_error_response(error)
+        : FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    done(response);
+  });
+  return nullptr;
 }
 
-static FlMethodResponse* secure_contains_key(FlValue* args) {
+static FlMethodResponse* secure_contains_key(FlutterMcpPlugin* self, FlValue* args,
+                                             const ResponseCallback& done) {
   if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
     return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
   }
@@ -402,52 +1105,185 @@ static FlMethodResponse* secure_contains_key(FlValue* args) {
   
   const gchar* key = fl_value_get_string(key_value);
   
-  GError* error = nullptr;
-  gchar* password = secret_password_lookup_sync(&flutter_mcp_schema,
-                                                nullptr,
-                                                &error,
-                                                "key", key,
-                                                nullptr);
-  
-  if (error) {
-    g_error_free(error);
-    g_autoptr(FlValue) result = fl_value_new_bool(FALSE);
-    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
-  }
-  
-  gboolean exists = (password != nullptr);
-  if (password) {
-    secret_password_free(password);
-  }
+  // Shares the lookup with any secureRead of the same key in flight.
+  ensure_secret_store(self)->Read(key,
+      [done](bool found, const std::string& value, const GError* error) {
+    g_autoptr(FlValue) result = fl_value_new_bool(found && !error);
+    g_autoptr(FlMethodResponse) response =
+        FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    done(response);
+  });
+  return nullptr;
+}
+
+static FlMethodResponse* secure_delete_all(FlutterMcpPlugin* self,
+                                           const ResponseCallback& done) {
+  ensure_secret_store(self)->DeleteAll([done](const GError* error) {
+    g_autoptr(FlMethodResponse) response =
+        FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    done(response);
+  });
+  return nullptr;
+}
+
+// Answers a bulk read with a {key: value} map of the keys that were found.
+static void respond_entries(const ResponseCallback& done,
+                            const std::vector<std::pair<std::string, std::string>>& entries,
+                            const GError* error) {
+  if (error) {
+    g_autoptr(FlMethodResponse) response = storage_error_response(error);
+    done(response);
+    return;
+  }
   
-  g_autoptr(FlValue) result = fl_value_new_bool(exists);
-  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  g_autoptr(FlValue) result = fl_value_new_map();
+  for (const auto& entry : entries) {
+    fl_value_set_string_take(result, entry.first.c_str(),
+                             fl_value_new_string(entry.second.c_str()));
+  }
+  g_autoptr(FlMethodResponse) response =
+      FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  done(response);
 }
 
-static FlMethodResponse* secure_delete_all() {
-  GError* error = nullptr;
-  secret_password_clear_sync(&flutter_mcp_schema,
-                             nullptr,
-                             &error,
-                             nullptr);
+static FlMethodResponse* secure_read_many(FlutterMcpPlugin* self, FlValue* args,
+                                          const ResponseCallback& done) {
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
+  }
   
-  if (error) {
-    g_error_free(error);
+  FlValue* keys_value = fl_value_lookup_string(args, "keys");
+  if (!keys_value || fl_value_get_type(keys_value) != FL_VALUE_TYPE_LIST) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing keys", nullptr));
+  }
+  
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < fl_value_get_length(keys_value); i++) {
+    FlValue* key_value = fl_value_get_list_value(keys_value, i);
+    if (fl_value_get_type(key_value) == FL_VALUE_TYPE_STRING) {
+      keys.push_back(fl_value_get_string(key_value));
+    }
+  }
+  
+  ensure_secret_store(self)->ReadMany(keys, [done](
+      const std::vector<std::pair<std::string, std::string>>& entries, const GError* error) {
+    respond_entries(done, entries, error);
+  });
+  return nullptr;
+}
+
+static FlMethodResponse* secure_read_prefix(FlutterMcpPlugin* self, FlValue* args,
+                                            const ResponseCallback& done) {
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
+  }
+  
+  FlValue* prefix_value = fl_value_lookup_string(args, "prefix");
+  if (!prefix_value || fl_value_get_type(prefix_value) != FL_VALUE_TYPE_STRING) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing prefix", nullptr));
+  }
+  
+  ensure_secret_store(self)->ReadPrefix(fl_value_get_string(prefix_value), [done](
+      const std::vector<std::pair<std::string, std::string>>& entries, const GError* error) {
+    respond_entries(done, entries, error);
+  });
+  return nullptr;
+}
+
+static FlMethodResponse* configure_secure_storage(FlutterMcpPlugin* self, FlValue* args) {
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
+  }
+  
+  flutter_mcp::SecretCacheConfig config;
+  
+  FlValue* cache_value = fl_value_lookup_string(args, "cache");
+  if (cache_value && fl_value_get_type(cache_value) == FL_VALUE_TYPE_BOOL) {
+    config.enabled = fl_value_get_bool(cache_value);
+  }
+  
+  FlValue* entries_value = fl_value_lookup_string(args, "cacheMaxEntries");
+  if (entries_value && fl_value_get_type(entries_value) == FL_VALUE_TYPE_INT &&
+      fl_value_get_int(entries_value) > 0) {
+    config.max_entries = static_cast<size_t>(fl_value_get_int(entries_value));
+  }
+  
+  FlValue* ttl_value = fl_value_lookup_string(args, "cacheTtlMs");
+  if (ttl_value && fl_value_get_type(ttl_value) == FL_VALUE_TYPE_INT) {
+    config.ttl_ms = fl_value_get_int(ttl_value);
+  }
+  
+  ensure_secret_store(self)->ConfigureCache(config);
+  
+  FlValue* write_behind_value = fl_value_lookup_string(args, "writeBehind");
+  if (write_behind_value && fl_value_get_type(write_behind_value) == FL_VALUE_TYPE_BOOL) {
+    flutter_mcp::WriteBehindConfig write_behind;
+    write_behind.enabled = fl_value_get_bool(write_behind_value);
+    FlValue* delay_value = fl_value_lookup_string(args, "writeBehindDelayMs");
+    if (delay_value && fl_value_get_type(delay_value) == FL_VALUE_TYPE_INT) {
+      write_behind.delay_ms = fl_value_get_int(delay_value);
+    }
+    ensure_secret_store(self)->ConfigureWriteBehind(write_behind);
   }
   
   return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
 }
 
+// Answers once every write buffered so far has been persisted; fails if any
+// buffered write since the last flush could not be.
+static FlMethodResponse* secure_flush(FlutterMcpPlugin* self, const ResponseCallback& done) {
+  if (!self->secret_store) {
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  self->secret_store->Flush([done](size_t failures) {
+    g_autoptr(FlMethodResponse) response = nullptr;
+    if (failures > 0) {
+      g_autofree gchar* message =
+          g_strdup_printf("%zu buffered writes could not be persisted", failures);
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("STORAGE_ERROR", message, nullptr));
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+    done(response);
+  });
+  return nullptr;
+}
+
+// Points the indicator at the registered icons. The theme path is set once;
+// icons registered later land in the same directory.
+static void attach_tray_icon_theme(FlutterMcpPlugin* self) {
+  if (self->app_indicator && !self->tray_theme_path_set && self->tray_icons &&
+      !self->tray_icons->empty()) {
+    app_indicator_set_icon_theme_path(self->app_indicator,
+                                      self->tray_icons->theme_path().c_str());
+    self->tray_theme_path_set = TRUE;
+  }
+}
+
 static FlMethodResponse* show_tray_icon(FlutterMcpPlugin* self, FlValue* args) {
+  flutter_mcp::TrayIconAtlas* tray_icons = ensure_tray_icons(self);
   if (!self->app_indicator) {
     self->app_indicator = app_indicator_new("flutter-mcp",
                                             "application-default-icon",
                                             APP_INDICATOR_CATEGORY_APPLICATION_STATUS);
+    if (self->tray_menu) {
+      app_indicator_set_menu(self->app_indicator, GTK_MENU(self->tray_menu));
+    }
+    attach_tray_icon_theme(self);
   }
   
   if (fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    FlValue* icon_name_value = fl_value_lookup_string(args, "iconName");
+    const std::string* theme_name = nullptr;
+    if (icon_name_value && fl_value_get_type(icon_name_value) == FL_VALUE_TYPE_STRING) {
+      theme_name = tray_icons->Find(fl_value_get_string(icon_name_value));
+    }
+    
     FlValue* icon_path_value = fl_value_lookup_string(args, "iconPath");
-    if (icon_path_value && fl_value_get_type(icon_path_value) == FL_VALUE_TYPE_STRING) {
+    if (theme_name) {
+      app_indicator_set_icon_full(self->app_indicator, theme_name->c_str(),
+                                  fl_value_get_string(icon_name_value));
+    } else if (icon_path_value && fl_value_get_type(icon_path_value) == FL_VALUE_TYPE_STRING) {
       const gchar* icon_path = fl_value_get_string(icon_path_value);
       app_indicator_set_icon(self->app_indicator, icon_path);
     }
@@ -472,6 +1308,143 @@ static FlMethodResponse* hide_tray_icon(FlutterMcpPlugin* self) {
   return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
 }
 
+static FlMethodResponse* register_tray_icons(FlutterMcpPlugin* self, FlValue* args) {
+  FlValue* icons_value = fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                             ? fl_value_lookup_string(args, "icons")
+                             : nullptr;
+  if (!icons_value || fl_value_get_type(icons_value) != FL_VALUE_TYPE_LIST) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing icons", nullptr));
+  }
+  
+  // Decode everything up front so switching icons later is a name lookup.
+  flutter_mcp::TrayIconAtlas* tray_icons = ensure_tray_icons(self);
+  size_t icon_count = fl_value_get_length(icons_value);
+  for (size_t i = 0; i < icon_count; i++) {
+    FlValue* icon = fl_value_get_list_value(icons_value, i);
+    FlValue* name_value = fl_value_get_type(icon) == FL_VALUE_TYPE_MAP
+                              ? fl_value_lookup_string(icon, "name")
+                              : nullptr;
+    if (!name_value || fl_value_get_type(name_value) != FL_VALUE_TYPE_STRING ||
+        fl_value_get_string(name_value)[0] == '\0') {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing icon name", nullptr));
+    }
+    const gchar* name = fl_value_get_string(name_value);
+    
+    FlValue* bytes_value = fl_value_lookup_string(icon, "bytes");
+    FlValue* path_value = fl_value_lookup_string(icon, "iconPath");
+    g_autoptr(GError) error = nullptr;
+    gboolean registered;
+    if (bytes_value && fl_value_get_type(bytes_value) == FL_VALUE_TYPE_UINT8_LIST) {
+      registered = tray_icons->AddFromBytes(name, fl_value_get_uint8_list(bytes_value),
+                                            fl_value_get_length(bytes_value), &error);
+    } else if (path_value && fl_value_get_type(path_value) == FL_VALUE_TYPE_STRING) {
+      registered = tray_icons->AddFromFile(name, fl_value_get_string(path_value), &error);
+    } else {
+      g_autofree gchar* message = g_strdup_printf("Icon %s needs bytes or iconPath", name);
+      return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", message, nullptr));
+    }
+    
+    if (!registered) {
+      g_autofree gchar* message = g_strdup_printf("Could not decode icon %s: %s", name,
+                                                  error ? error->message : "unknown error");
+      return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ICON", message, nullptr));
+    }
+  }
+  
+  attach_tray_icon_theme(self);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+static FlMethodResponse* set_tray_icon(FlutterMcpPlugin* self, FlValue* args) {
+  FlValue* name_value = fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                            ? fl_value_lookup_string(args, "name")
+                            : nullptr;
+  if (!name_value || fl_value_get_type(name_value) != FL_VALUE_TYPE_STRING) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing icon name", nullptr));
+  }
+  const gchar* name = fl_value_get_string(name_value);
+  
+  const std::string* theme_name = ensure_tray_icons(self)->Find(name);
+  if (!theme_name) {
+    g_autofree gchar* message = g_strdup_printf("No tray icon registered as %s", name);
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("ICON_NOT_FOUND", message, nullptr));
+  }
+  
+  if (self->app_indicator) {
+    app_indicator_set_icon_full(self->app_indicator, theme_name->c_str(), name);
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+static GtkWidget* tray_menu_widget_new(FlutterMcpPlugin* self,
+                                       const flutter_mcp::TrayMenuItem& item) {
+  if (item.is_separator) {
+    return gtk_separator_menu_item_new();
+  }
+
+  GtkWidget* menu_item = gtk_menu_item_new_with_label(item.label.c_str());
+
+  // Store item ID
+  g_object_set_data_full(G_OBJECT(menu_item), "item_id",
+                         g_strdup(item.id.c_str()), g_free);
+
+  // Connect click handler
+  g_signal_connect(menu_item, "activate",
+                   G_CALLBACK(tray_menu_item_cb), self);
+
+  gtk_widget_set_sensitive(menu_item, !item.disabled);
+  return menu_item;
+}
+
+static void tray_menu_widget_update(GtkWidget* widget,
+                                    const flutter_mcp::TrayMenuItem& item) {
+  gtk_menu_item_set_label(GTK_MENU_ITEM(widget), item.label.c_str());
+  gtk_widget_set_sensitive(widget, !item.disabled);
+}
+
+// Edits the live menu into |next| entry by entry, so unchanged items are
+// left alone and an open menu does not collapse.
+static void apply_tray_menu(FlutterMcpPlugin* self,
+                            const std::vector<flutter_mcp::TrayMenuItem>& next) {
+  flutter_mcp::TraceSpan span(flutter_mcp::TraceCategory::kTray, "applyMenu");
+  auto& items = *self->tray_menu_items;
+  auto& widgets = *self->tray_menu_widgets;
+  GtkMenuShell* shell = GTK_MENU_SHELL(self->tray_menu);
+
+  for (const auto& op : flutter_mcp::DiffTrayMenu(items, next)) {
+    switch (op.kind) {
+      case flutter_mcp::TrayMenuOp::Kind::kInsert: {
+        GtkWidget* widget = tray_menu_widget_new(self, *op.item);
+        gtk_menu_shell_insert(shell, widget, static_cast<gint>(op.index));
+        gtk_widget_show(widget);
+        items.insert(items.begin() + op.index, *op.item);
+        widgets.insert(widgets.begin() + op.index, widget);
+        break;
+      }
+      case flutter_mcp::TrayMenuOp::Kind::kRemove:
+        gtk_widget_destroy(widgets[op.index]);
+        items.erase(items.begin() + op.index);
+        widgets.erase(widgets.begin() + op.index);
+        break;
+      case flutter_mcp::TrayMenuOp::Kind::kMove: {
+        GtkWidget* widget = widgets[op.from];
+        flutter_mcp::TrayMenuItem moved = items[op.from];
+        gtk_menu_reorder_child(GTK_MENU(self->tray_menu), widget,
+                               static_cast<gint>(op.index));
+        items.erase(items.begin() + op.from);
+        widgets.erase(widgets.begin() + op.from);
+        items.insert(items.begin() + op.index, moved);
+        widgets.insert(widgets.begin() + op.index, widget);
+        break;
+      }
+      case flutter_mcp::TrayMenuOp::Kind::kUpdate:
+        items[op.index] = *op.item;
+        tray_menu_widget_update(widgets[op.index], items[op.index]);
+        break;
+    }
+  }
+}
+
 static FlMethodResponse* set_tray_menu(FlutterMcpPlugin* self, FlValue* args) {
   if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
     return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
@@ -482,63 +1455,89 @@ static FlMethodResponse* set_tray_menu(FlutterMcpPlugin* self, FlValue* args) {
     return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing menu items", nullptr));
   }
   
-  // Clear old menu
-  if (self->tray_menu) {
-    gtk_widget_destroy(self->tray_menu);
-  }
-  self->menu_item_map.clear();
-  
-  // Create new menu
-  self->tray_menu = gtk_menu_new();
-  
+  std::vector<flutter_mcp::TrayMenuItem> next;
   size_t item_count = fl_value_get_length(items_value);
   for (size_t i = 0; i < item_count; i++) {
     FlValue* item = fl_value_get_list_value(items_value, i);
     if (fl_value_get_type(item) != FL_VALUE_TYPE_MAP) continue;
     
+    flutter_mcp::TrayMenuItem menu_item;
     FlValue* separator_value = fl_value_lookup_string(item, "isSeparator");
-    gboolean is_separator = separator_value && fl_value_get_bool(separator_value);
+    menu_item.is_separator = separator_value && fl_value_get_bool(separator_value);
     
-    GtkWidget* menu_item;
-    if (is_separator) {
-      menu_item = gtk_separator_menu_item_new();
-    } else {
+    if (!menu_item.is_separator) {
       FlValue* label_value = fl_value_lookup_string(item, "label");
       FlValue* id_value = fl_value_lookup_string(item, "id");
       
       if (!label_value || !id_value) continue;
       
-      const gchar* label = fl_value_get_string(label_value);
-      const gchar* item_id = fl_value_get_string(id_value);
-      
-      menu_item = gtk_menu_item_new_with_label(label);
-      
-      // Store item ID
-      g_object_set_data_full(G_OBJECT(menu_item), "item_id", 
-                             g_strdup(item_id), g_free);
-      
-      // Connect click handler
-      g_signal_connect(menu_item, "activate",
-                       G_CALLBACK(tray_menu_item_cb), self);
+      menu_item.label = fl_value_get_string(label_value);
+      menu_item.id = fl_value_get_string(id_value);
       
       FlValue* disabled_value = fl_value_lookup_string(item, "disabled");
-      if (disabled_value && fl_value_get_bool(disabled_value)) {
-        gtk_widget_set_sensitive(menu_item, FALSE);
-      }
+      menu_item.disabled = disabled_value && fl_value_get_bool(disabled_value);
     }
     
-    gtk_menu_shell_append(GTK_MENU_SHELL(self->tray_menu), menu_item);
+    next.push_back(menu_item);
   }
   
-  gtk_widget_show_all(self->tray_menu);
+  FlValue* incremental_value = fl_value_lookup_string(args, "incremental");
+  bool incremental = !incremental_value ||
+                     fl_value_get_type(incremental_value) != FL_VALUE_TYPE_BOOL ||
+                     fl_value_get_bool(incremental_value);
   
-  if (self->app_indicator) {
-    app_indicator_set_menu(self->app_indicator, GTK_MENU(self->tray_menu));
+  // Start over on request; the indicator then needs the new menu.
+  if (self->tray_menu && !incremental) {
+    gtk_widget_destroy(self->tray_menu);
+    self->tray_menu = nullptr;
+    self->tray_menu_items->clear();
+    self->tray_menu_widgets->clear();
+  }
+  
+  if (!self->tray_menu) {
+    self->tray_menu = gtk_menu_new();
+    apply_tray_menu(self, next);
+    if (self->app_indicator) {
+      app_indicator_set_menu(self->app_indicator, GTK_MENU(self->tray_menu));
+    }
+  } else {
+    apply_tray_menu(self, next);
   }
   
   return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
 }
 
+static FlMethodResponse* update_tray_menu_item(FlutterMcpPlugin* self, FlValue* args) {
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
+  }
+  
+  FlValue* id_value = fl_value_lookup_string(args, "id");
+  if (!id_value || fl_value_get_type(id_value) != FL_VALUE_TYPE_STRING) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing item id", nullptr));
+  }
+  const gchar* id = fl_value_get_string(id_value);
+  
+  auto& items = *self->tray_menu_items;
+  for (size_t i = 0; i < items.size(); i++) {
+    if (items[i].is_separator || items[i].id != id) continue;
+    
+    FlValue* label_value = fl_value_lookup_string(args, "label");
+    if (label_value && fl_value_get_type(label_value) == FL_VALUE_TYPE_STRING) {
+      items[i].label = fl_value_get_string(label_value);
+    }
+    FlValue* disabled_value = fl_value_lookup_string(args, "disabled");
+    if (disabled_value && fl_value_get_type(disabled_value) == FL_VALUE_TYPE_BOOL) {
+      items[i].disabled = fl_value_get_bool(disabled_value);
+    }
+    tray_menu_widget_update((*self->tray_menu_widgets)[i], items[i]);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  
+  g_autofree gchar* message = g_strdup_printf("No tray menu item with id %s", id);
+  return FL_METHOD_RESPONSE(fl_method_error_response_new("ITEM_NOT_FOUND", message, nullptr));
+}
+
 static FlMethodResponse* update_tray_tooltip(FlutterMcpPlugin* self, FlValue* args) {
   if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
     return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
@@ -563,7 +1562,7 @@ static FlMethodResponse* configure_tray(FlValue* args) {
   return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
 }
 
-static FlMethodResponse* check_permission(FlValue* args) {
+static FlMethodResponse* check_permission(FlutterMcpPlugin* self, FlValue* args) {
   if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
     return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
   }
@@ -579,6 +1578,7 @@ static FlMethodResponse* check_permission(FlValue* args) {
   // Handle Linux-specific permissions
   if (g_strcmp0(permission, "notification") == 0) {
     // Check if notification daemon is available
+    ensure_notifications(self);
     GList* capabilities = notify_get_server_caps();
     granted = (capabilities != NULL);
     g_list_free_full(capabilities, g_free);
@@ -586,15 +1586,21 @@ static FlMethodResponse* check_permission(FlValue* args) {
     // Linux allows background execution
     granted = TRUE;
   } else if (g_strcmp0(permission, "storage") == 0) {
-    // Check if secret service is available
-    GError* error = nullptr;
-    SecretService* service = secret_service_get_sync(SECRET_SERVICE_NONE, nullptr, &error);
-    if (service) {
+    // Check if secret service is available; once the store holds a
+    // connection no D-Bus round trip is needed.
+    if (self->secret_store && self->secret_store->available()) {
       granted = TRUE;
-      g_object_unref(service);
-    }
-    if (error) {
-      g_error_free(error);
+    } else {
+      GError* error = nullptr;
+      SecretService* service = secret_service_get_sync(SECRET_SERVICE_NONE, nullptr, &error);
+      if (service) {
+        granted = TRUE;
+        g_object_unref(service);
+        ensure_secret_store(self);
+      }
+      if (error) {
+        g_error_free(error);
+      }
     }
   } else if (g_strcmp0(permission, "systemTray") == 0) {
     // Check if system tray is available (AppIndicator)
@@ -654,11 +1660,9 @@ static FlMethodResponse* request_permission(FlValue* args) {
 
 static FlMethodResponse* shutdown(FlutterMcpPlugin* self) {
   // Stop background service
-  if (self->background_thread) {
-    self->background_running = false;
-    self->background_cv.notify_all();
-    self->background_thread->join();
-    self->background_thread.reset();
+  stop_background_ticks(self);
+  if (self->task_scheduler) {
+    self->task_scheduler->Stop();
   }
   
   // Hide tray icon
@@ -666,9 +1670,629 @@ static FlMethodResponse* shutdown(FlutterMcpPlugin* self) {
     app_indicator_set_status(self->app_indicator, APP_INDICATOR_STATUS_PASSIVE);
   }
   
+  // Start persisting buffered secure storage writes
+  if (self->secret_store) {
+    self->secret_store->Flush(nullptr);
+  }
+  
+  // Terminate MCP servers
+  self->transport.reset();
+  
   return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
 }
 
+// Reads dropNotifications, coalesceProgress and matchResponses from |args|;
+// missing entries keep their defaults.
+static flutter_mcp::RoutingRules parse_routing_rules(FlValue* args) {
+  flutter_mcp::RoutingRules rules;
+  FlValue* dropped_value = fl_value_lookup_string(args, "dropNotifications");
+  if (dropped_value && fl_value_get_type(dropped_value) == FL_VALUE_TYPE_LIST) {
+    for (size_t i = 0; i < fl_value_get_length(dropped_value); i++) {
+      FlValue* method = fl_value_get_list_value(dropped_value, i);
+      if (fl_value_get_type(method) == FL_VALUE_TYPE_STRING) {
+        rules.dropped_notifications.insert(fl_value_get_string(method));
+      }
+    }
+  }
+  FlValue* coalesce_value = fl_value_lookup_string(args, "coalesceProgress");
+  if (coalesce_value && fl_value_get_type(coalesce_value) == FL_VALUE_TYPE_BOOL) {
+    rules.coalesce_progress = fl_value_get_bool(coalesce_value);
+  }
+  FlValue* match_value = fl_value_lookup_string(args, "matchResponses");
+  if (match_value && fl_value_get_type(match_value) == FL_VALUE_TYPE_BOOL) {
+    rules.match_responses = fl_value_get_bool(match_value);
+  }
+  return rules;
+}
+
+static FlMethodResponse* transport_spawn(FlutterMcpPlugin* self, FlValue* args) {
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
+  }
+  
+  FlValue* id_value = fl_value_lookup_string(args, "serverId");
+  FlValue* command_value = fl_value_lookup_string(args, "command");
+  if (!id_value || fl_value_get_type(id_value) != FL_VALUE_TYPE_STRING ||
+      !command_value || fl_value_get_type(command_value) != FL_VALUE_TYPE_STRING) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing serverId or command", nullptr));
+  }
+  
+  flutter_mcp::StdioTransport::Options options;
+  options.argv.push_back(fl_value_get_string(command_value));
+  FlValue* arguments_value = fl_value_lookup_string(args, "arguments");
+  if (arguments_value && fl_value_get_type(arguments_value) == FL_VALUE_TYPE_LIST) {
+    for (size_t i = 0; i < fl_value_get_length(arguments_value); i++) {
+      FlValue* argument = fl_value_get_list_value(arguments_value, i);
+      if (fl_value_get_type(argument) == FL_VALUE_TYPE_STRING) {
+        options.argv.push_back(fl_value_get_string(argument));
+      }
+    }
+  }
+  FlValue* env_value = fl_value_lookup_string(args, "environment");
+  if (env_value && fl_value_get_type(env_value) == FL_VALUE_TYPE_MAP) {
+    for (size_t i = 0; i < fl_value_get_length(env_value); i++) {
+      FlValue* name = fl_value_get_map_key(env_value, i);
+      FlValue* value = fl_value_get_map_value(env_value, i);
+      if (fl_value_get_type(name) == FL_VALUE_TYPE_STRING &&
+          fl_value_get_type(value) == FL_VALUE_TYPE_STRING) {
+        options.env.push_back(std::string(fl_value_get_string(name)) + "=" +
+                              fl_value_get_string(value));
+      }
+    }
+  }
+  FlValue* directory_value = fl_value_lookup_string(args, "workingDirectory");
+  if (directory_value && fl_value_get_type(directory_value) == FL_VALUE_TYPE_STRING) {
+    options.working_directory = fl_value_get_string(directory_value);
+  }
+  FlValue* framing_value = fl_value_lookup_string(args, "framing");
+  if (framing_value && fl_value_get_type(framing_value) == FL_VALUE_TYPE_STRING) {
+    options.framing = flutter_mcp::ParseFraming(fl_value_get_string(framing_value));
+  }
+  options.routing = parse_routing_rules(args);
+  
+  pid_t pid = 0;
+  std::string error;
+  if (!ensure_transport(self)->Spawn(fl_value_get_string(id_value), options, &pid, &error)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("SPAWN_FAILED", error.c_str(), nullptr));
+  }
+  
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(result, "pid", fl_value_new_int(pid));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Writes straight from the message's buffer; false if the server is not
+// running.
+static FlMethodResponse* transport_send(FlutterMcpPlugin* self, FlValue* args) {
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
+  }
+  
+  FlValue* id_value = fl_value_lookup_string(args, "serverId");
+  FlValue* message_value = fl_value_lookup_string(args, "message");
+  if (!id_value || fl_value_get_type(id_value) != FL_VALUE_TYPE_STRING || !message_value) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing serverId or message", nullptr));
+  }
+  
+  const uint8_t* data;
+  size_t size;
+  if (fl_value_get_type(message_value) == FL_VALUE_TYPE_UINT8_LIST) {
+    data = fl_value_get_uint8_list(message_value);
+    size = fl_value_get_length(message_value);
+  } else if (fl_value_get_type(message_value) == FL_VALUE_TYPE_STRING) {
+    data = reinterpret_cast<const uint8_t*>(fl_value_get_string(message_value));
+    size = strlen(fl_value_get_string(message_value));
+  } else {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "message must be a String or Uint8List", nullptr));
+  }
+  
+  const bool sent = self->transport &&
+                    self->transport->Send(fl_value_get_string(id_value), data, size);
+  g_autoptr(FlValue) result = fl_value_new_bool(sent);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* transport_close(FlutterMcpPlugin* self, FlValue* args) {
+  FlValue* id_value = fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                          ? fl_value_lookup_string(args, "serverId")
+                          : nullptr;
+  if (!id_value || fl_value_get_type(id_value) != FL_VALUE_TYPE_STRING) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing serverId", nullptr));
+  }
+  
+  const bool closed = self->transport && self->transport->Close(fl_value_get_string(id_value));
+  g_autoptr(FlValue) result = fl_value_new_bool(closed);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* transport_configure_routing(FlutterMcpPlugin* self, FlValue* args) {
+  FlValue* id_value = fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                          ? fl_value_lookup_string(args, "serverId")
+                          : nullptr;
+  if (!id_value || fl_value_get_type(id_value) != FL_VALUE_TYPE_STRING) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing serverId", nullptr));
+  }
+  
+  const bool configured = self->transport &&
+                          self->transport->ConfigureRouting(fl_value_get_string(id_value),
+                                                            parse_routing_rules(args));
+  g_autoptr(FlValue) result = fl_value_new_bool(configured);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* transport_stats(FlutterMcpPlugin* self) {
+  const flutter_mcp::RoutingCounts counts =
+      self->transport ? self->transport->routing_counts() : flutter_mcp::RoutingCounts();
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(result, "servers",
+                           fl_value_new_int(self->transport ? self->transport->server_count() : 0));
+  fl_value_set_string_take(result, "pendingWriteBytes",
+                           fl_value_new_int(self->transport ? self->transport->pending_write_bytes() : 0));
+  fl_value_set_string_take(result, "droppedNotifications",
+                           fl_value_new_int(counts.dropped_notifications));
+  fl_value_set_string_take(result, "coalescedProgress", fl_value_new_int(counts.coalesced_progress));
+  fl_value_set_string_take(result, "unmatchedResponses",
+                           fl_value_new_int(counts.unmatched_responses));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* configure_events(FlutterMcpPlugin* self, FlValue* args) {
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
+  }
+  
+  flutter_mcp::EventBatchingConfig config;
+  
+  FlValue* batching_value = fl_value_lookup_string(args, "batching");
+  if (batching_value && fl_value_get_type(batching_value) == FL_VALUE_TYPE_BOOL) {
+    config.enabled = fl_value_get_bool(batching_value);
+  }
+  
+  FlValue* size_value = fl_value_lookup_string(args, "maxBatchSize");
+  if (size_value && fl_value_get_type(size_value) == FL_VALUE_TYPE_INT &&
+      fl_value_get_int(size_value) > 0) {
+    config.max_batch_size = static_cast<size_t>(fl_value_get_int(size_value));
+  }
+  
+  FlValue* delay_value = fl_value_lookup_string(args, "maxBatchDelayMs");
+  if (delay_value && fl_value_get_type(delay_value) == FL_VALUE_TYPE_INT) {
+    config.max_delay_ms = fl_value_get_int(delay_value);
+  }
+  
+  FlValue* coalesce_value = fl_value_lookup_string(args, "coalescePeriodic");
+  if (coalesce_value && fl_value_get_type(coalesce_value) == FL_VALUE_TYPE_BOOL) {
+    config.coalesce_periodic = fl_value_get_bool(coalesce_value);
+  }
+  
+  self->event_batcher->Configure(config);
+  
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+static FlValue* histogram_value_new(const flutter_mcp::LatencyHistogram& histogram) {
+  const flutter_mcp::HistogramSnapshot snapshot = histogram.Snapshot();
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, "count", fl_value_new_int(static_cast<int64_t>(snapshot.count)));
+  fl_value_set_string_take(value, "sumUs", fl_value_new_int(static_cast<int64_t>(snapshot.sum)));
+  fl_value_set_string_take(value, "meanUs", fl_value_new_float(snapshot.mean()));
+  fl_value_set_string_take(value, "minUs", fl_value_new_int(static_cast<int64_t>(snapshot.min)));
+  fl_value_set_string_take(value, "maxUs", fl_value_new_int(static_cast<int64_t>(snapshot.max)));
+  fl_value_set_string_take(value, "p50Us", fl_value_new_int(static_cast<int64_t>(snapshot.p50)));
+  fl_value_set_string_take(value, "p90Us", fl_value_new_int(static_cast<int64_t>(snapshot.p90)));
+  fl_value_set_string_take(value, "p99Us", fl_value_new_int(static_cast<int64_t>(snapshot.p99)));
+  fl_value_set_string_take(value, "p999Us", fl_value_new_int(static_cast<int64_t>(snapshot.p999)));
+  return value;
+}
+
+// Everything recorded so far, in the shape getNativeMetrics returns.
+static FlValue* metrics_snapshot_new(const flutter_mcp::NativeMetrics& metrics) {
+  FlValue* methods = fl_value_new_map();
+  metrics.ForEachMethod([methods](const char* name,
+                                  const flutter_mcp::LatencyHistogram& histogram) {
+    fl_value_set_string_take(methods, name, histogram_value_new(histogram));
+  });
+  
+  FlValue* queue = fl_value_new_map();
+  fl_value_set_string_take(queue, "depth", fl_value_new_int(metrics.event_queue_depth.value()));
+  fl_value_set_string_take(queue, "maxDepth", fl_value_new_int(metrics.event_queue_depth.max()));
+  
+  FlValue* snapshot = fl_value_new_map();
+  fl_value_set_string_take(snapshot, "methods", methods);
+  fl_value_set_string_take(snapshot, "schedulerLatenessUs",
+                           histogram_value_new(metrics.scheduler_lateness));
+  fl_value_set_string_take(snapshot, "secureStorageUs",
+                           histogram_value_new(metrics.secure_storage));
+  fl_value_set_string_take(snapshot, "eventPostUs", histogram_value_new(metrics.event_post));
+  fl_value_set_string_take(snapshot, "eventQueue", queue);
+  fl_value_set_string_take(snapshot, "subsystemInitUs", subsystem_timings_new(metrics));
+  return snapshot;
+}
+
+static FlMethodResponse* get_native_metrics(FlutterMcpPlugin* self, FlValue* args) {
+  g_autoptr(FlValue) result = metrics_snapshot_new(*self->metrics);
+  
+  if (args && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    FlValue* reset_value = fl_value_lookup_string(args, "reset");
+    if (reset_value && fl_value_get_type(reset_value) == FL_VALUE_TYPE_BOOL &&
+        fl_value_get_bool(reset_value)) {
+      self->metrics->Reset();
+    }
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static gboolean metrics_event_cb(gpointer user_data) {
+  FlutterMcpPlugin* self = FLUTTER_MCP_PLUGIN(user_data);
+  if (!event_wanted(self, "metrics")) {
+    return G_SOURCE_CONTINUE;
+  }
+  g_autoptr(FlValue) snapshot = metrics_snapshot_new(*self->metrics);
+  send_event(self, "metrics", snapshot);
+  return G_SOURCE_CONTINUE;
+}
+
+static FlMethodResponse* configure_native_metrics(FlutterMcpPlugin* self, FlValue* args) {
+  if (fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing arguments", nullptr));
+  }
+  
+  FlValue* interval_value = fl_value_lookup_string(args, "eventIntervalMs");
+  if (!interval_value || fl_value_get_type(interval_value) != FL_VALUE_TYPE_INT ||
+      fl_value_get_int(interval_value) < 0) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Invalid eventIntervalMs", nullptr));
+  }
+  
+  if (self->metrics_source) {
+    g_source_remove(self->metrics_source);
+    self->metrics_source = 0;
+  }
+  const int64_t interval_ms = fl_value_get_int(interval_value);
+  if (interval_ms > 0) {
+    self->metrics_source = g_timeout_add(static_cast<guint>(interval_ms), metrics_event_cb, self);
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+// Names the calling thread, the platform thread, before recording so its
+// spans are labelled.
+static FlMethodResponse* start_native_trace() {
+  flutter_mcp::NativeTracer::NameThread("platform");
+  flutter_mcp::NativeTracer::Instance().Start();
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+}
+
+// Writes the trace to "path" when given, otherwise returns it as "trace".
+static FlMethodResponse* stop_native_trace(FlValue* args) {
+  const flutter_mcp::TraceDump dump = flutter_mcp::NativeTracer::Instance().Stop(getpid());
+  
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(result, "events", fl_value_new_int(static_cast<int64_t>(dump.events)));
+  fl_value_set_string_take(result, "dropped", fl_value_new_int(static_cast<int64_t>(dump.dropped)));
+  FlValue* path_value = fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                            ? fl_value_lookup_string(args, "path")
+                            : nullptr;
+  if (path_value && fl_value_get_type(path_value) == FL_VALUE_TYPE_STRING) {
+    g_autoptr(GError) error = nullptr;
+    if (!g_file_set_contents(fl_value_get_string(path_value), dump.json.data(),
+                             static_cast<gssize>(dump.json.size()), &error)) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new("TRACE_WRITE_FAILED", error->message, nullptr));
+    }
+    fl_value_set_string_take(result, "path", fl_value_new_string(fl_value_get_string(path_value)));
+  } else {
+    fl_value_set_string_take(result, "trace",
+                             fl_value_new_string_sized(dump.json.data(), dump.json.size()));
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+static FlMethodResponse* execute_batch(FlutterMcpPlugin* self, FlValue* args,
+                                       const ResponseCallback& done);
+
+// Runs one method and answers |done|, either before returning or once an
+// asynchronous handler completes.
+static void dispatch_method(FlutterMcpPlugin* self,
+                            const gchar* method,
+                            FlValue* args,
+                            const ResponseCallback& respond) {
+  FlMethodResponse* response = nullptr;
+  const flutter_mcp::Method id = flutter_mcp::LookupMethod(method);
+  
+  // Times the call through to its response, so asynchronous handlers are
+  // measured until they complete.
+  const auto start = flutter_mcp::NativeMetrics::Clock::now();
+  const int64_t trace_begin = flutter_mcp::NativeTracer::Begin();
+  ResponseCallback done = [metrics = self->metrics, id, start, trace_begin,
+                           storage = flutter_mcp::IsSecureStorageMethod(id),
+                           respond](FlMethodResponse* reply) {
+    flutter_mcp::NativeTracer::End(flutter_mcp::TraceCategory::kMethod,
+                                   flutter_mcp::MethodName(id), trace_begin);
+    const int64_t micros = flutter_mcp::NativeMetrics::MicrosSince(start);
+    metrics->RecordMethod(id, micros);
+    if (storage) {
+      metrics->secure_storage.Record(micros);
+    }
+    respond(reply);
+  };
+  
+  switch (id) {
+    case flutter_mcp::Method::kGetPlatformVersion:
+      response = get_platform_version();
+      break;
+    case flutter_mcp::Method::kInitialize:
+      response = initialize(self, args);
+      break;
+    case flutter_mcp::Method::kStartBackgroundService:
+      response = start_background_service(self);
+      break;
+    case flutter_mcp::Method::kStopBackgroundService:
+      response = stop_background_service(self);
+      break;
+    case flutter_mcp::Method::kConfigureBackgroundService:
+      response = configure_background_service(self, args);
+      break;
+    case flutter_mcp::Method::kScheduleBackgroundTask:
+      response = schedule_background_task(self, args);
+      break;
+    case flutter_mcp::Method::kScheduleRecurringTask:
+      response = schedule_recurring_task(self, args);
+      break;
+    case flutter_mcp::Method::kCancelBackgroundTask:
+      response = cancel_background_task(self, args);
+      break;
+    case flutter_mcp::Method::kStartHeadlessEngine:
+      response = start_headless_engine();
+      break;
+    case flutter_mcp::Method::kStopHeadlessEngine:
+      response = stop_headless_engine();
+      break;
+    case flutter_mcp::Method::kShowNotification:
+      response = show_notification(self, args);
+      break;
+    case flutter_mcp::Method::kRequestNotificationPermission: {
+      g_autoptr(FlValue) result = fl_value_new_bool(TRUE);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+      break;
+    }
+    case flutter_mcp::Method::kConfigureNotifications:
+      response = configure_notifications(self, args);
+      break;
+    case flutter_mcp::Method::kCancelNotification:
+      response = cancel_notification(self, args);
+      break;
+    case flutter_mcp::Method::kCancelAllNotifications:
+      response = cancel_all_notifications(self);
+      break;
+    case flutter_mcp::Method::kSecureStore:
+      response = secure_store(self, args, done);
+      break;
+    case flutter_mcp::Method::kSecureRead:
+      response = secure_read(self, args, done);
+      break;
+    case flutter_mcp::Method::kSecureStoreBytes:
+      response = secure_store_bytes(self, args, done);
+      break;
+    case flutter_mcp::Method::kSecureReadBytes:
+      response = secure_read_bytes(self, args, done);
+      break;
+    case flutter_mcp::Method::kSecureDelete:
+      response = secure_delete(self, args, done);
+      break;
+    case flutter_mcp::Method::kSecureContainsKey:
+      response = secure_contains_key(self, args, done);
+      break;
+    case flutter_mcp::Method::kSecureDeleteAll:
+      response = secure_delete_all(self, done);
+      break;
+    case flutter_mcp::Method::kSecureReadMany:
+      response = secure_read_many(self, args, done);
+      break;
+    case flutter_mcp::Method::kSecureReadPrefix:
+      response = secure_read_prefix(self, args, done);
+      break;
+    case flutter_mcp::Method::kConfigureSecureStorage:
+      response = configure_secure_storage(self, args);
+      break;
+    case flutter_mcp::Method::kSecureFlush:
+      response = secure_flush(self, done);
+      break;
+    case flutter_mcp::Method::kShowTrayIcon:
+      response = show_tray_icon(self, args);
+      break;
+    case flutter_mcp::Method::kHideTrayIcon:
+      response = hide_tray_icon(self);
+      break;
+    case flutter_mcp::Method::kRegisterTrayIcons:
+      response = register_tray_icons(self, args);
+      break;
+    case flutter_mcp::Method::kSetTrayIcon:
+      response = set_tray_icon(self, args);
+      break;
+    case flutter_mcp::Method::kSetTrayMenu:
+      response = set_tray_menu(self, args);
+      break;
+    case flutter_mcp::Method::kUpdateTrayMenuItem:
+      response = update_tray_menu_item(self, args);
+      break;
+    case flutter_mcp::Method::kUpdateTrayTooltip:
+      response = update_tray_tooltip(self, args);
+      break;
+    case flutter_mcp::Method::kConfigureTray:
+      response = configure_tray(args);
+      break;
+    case flutter_mcp::Method::kCheckPermission:
+      response = check_permission(self, args);
+      break;
+    case flutter_mcp::Method::kRequestPermission:
+      response = request_permission(args);
+      break;
+    case flutter_mcp::Method::kConfigureEvents:
+      response = configure_events(self, args);
+      break;
+    case flutter_mcp::Method::kGetNativeMetrics:
+      response = get_native_metrics(self, args);
+      break;
+    case flutter_mcp::Method::kConfigureNativeMetrics:
+      response = configure_native_metrics(self, args);
+      break;
+    case flutter_mcp::Method::kTransportSpawn:
+      response = transport_spawn(self, args);
+      break;
+    case flutter_mcp::Method::kTransportSend:
+      response = transport_send(self, args);
+      break;
+    case flutter_mcp::Method::kTransportClose:
+      response = transport_close(self, args);
+      break;
+    case flutter_mcp::Method::kTransportConfigureRouting:
+      response = transport_configure_routing(self, args);
+      break;
+    case flutter_mcp::Method::kTransportStats:
+      response = transport_stats(self);
+      break;
+    case flutter_mcp::Method::kStartNativeTrace:
+      response = start_native_trace();
+      break;
+    case flutter_mcp::Method::kStopNativeTrace:
+      response = stop_native_trace(args);
+      break;
+    case flutter_mcp::Method::kExecuteBatch:
+      response = execute_batch(self, args, done);
+      break;
+    case flutter_mcp::Method::kShutdown:
+      response = shutdown(self);
+      break;
+    default:
+      response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+      break;
+  }
+  
+  // Asynchronous handlers return nullptr and answer |done| themselves.
+  if (response) {
+    done(response);
+    g_object_unref(response);
+  }
+}
+
+// Converts one operation's response into its executeBatch result entry.
+static FlValue* batch_entry_new(FlMethodResponse* response, const gchar* method) {
+  FlValue* entry = fl_value_new_map();
+  if (FL_IS_METHOD_SUCCESS_RESPONSE(response)) {
+    FlValue* result = fl_method_success_response_get_result(FL_METHOD_SUCCESS_RESPONSE(response));
+    fl_value_set_string_take(entry, "success", fl_value_new_bool(TRUE));
+    fl_value_set_string_take(entry, "result", result ? fl_value_ref(result) : fl_value_new_null());
+    return entry;
+  }
+  
+  FlValue* error = fl_value_new_map();
+  if (FL_IS_METHOD_ERROR_RESPONSE(response)) {
+    FlMethodErrorResponse* error_response = FL_METHOD_ERROR_RESPONSE(response);
+    const gchar* message = fl_method_error_response_get_message(error_response);
+    FlValue* details = fl_method_error_response_get_details(error_response);
+    fl_value_set_string_take(error, "code",
+        fl_value_new_string(fl_method_error_response_get_code(error_response)));
+    fl_value_set_string_take(error, "message",
+        message ? fl_value_new_string(message) : fl_value_new_null());
+    fl_value_set_string_take(error, "details",
+        details ? fl_value_ref(details) : fl_value_new_null());
+  } else {
+    fl_value_set_string_take(error, "code", fl_value_new_string("NOT_IMPLEMENTED"));
+    fl_value_set_string_take(error, "message", fl_value_new_string(method));
+    fl_value_set_string_take(error, "details", fl_value_new_null());
+  }
+  fl_value_set_string_take(entry, "success", fl_value_new_bool(FALSE));
+  fl_value_set_string_take(entry, "error", error);
+  return entry;
+}
+
+// An executeBatch call whose operations may complete in any order.
+struct BatchState {
+  ~BatchState() { g_object_unref(self); }
+  
+  FlutterMcpPlugin* self;
+  FlValuePtr operations;
+  std::vector<FlValuePtr> entries;
+  // Operations still running, plus one held until all have been started.
+  size_t pending;
+  ResponseCallback done;
+};
+
+static void batch_operation_done(const std::shared_ptr<BatchState>& batch) {
+  if (--batch->pending > 0) {
+    return;
+  }
+  
+  g_autoptr(FlValue) results = fl_value_new_list();
+  for (auto& entry : batch->entries) {
+    fl_value_append_take(results, entry.release());
+  }
+  g_autoptr(FlMethodResponse) response =
+      FL_METHOD_RESPONSE(fl_method_success_response_new(results));
+  batch->done(response);
+}
+
+static void run_batch(const std::shared_ptr<BatchState>& batch) {
+  FlValue* operations = batch->operations.get();
+  const size_t count = fl_value_get_length(operations);
+  for (size_t i = 0; i < count; i++) {
+    FlValue* operation = fl_value_get_list_value(operations, i);
+    FlValue* method_value = nullptr;
+    FlValue* op_args = nullptr;
+    if (fl_value_get_type(operation) == FL_VALUE_TYPE_MAP) {
+      method_value = fl_value_lookup_string(operation, "method");
+      op_args = fl_value_lookup_string(operation, "args");
+    }
+    
+    if (!method_value || fl_value_get_type(method_value) != FL_VALUE_TYPE_STRING) {
+      g_autoptr(FlMethodResponse) response =
+          FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing method", nullptr));
+      batch->entries[i] = FlValuePtr(batch_entry_new(response, ""));
+      batch_operation_done(batch);
+      continue;
+    }
+    
+    const gchar* method = fl_value_get_string(method_value);
+    if (flutter_mcp::LookupMethod(method) == flutter_mcp::Method::kExecuteBatch) {
+      g_autoptr(FlMethodResponse) response =
+          FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Batches cannot be nested", nullptr));
+      batch->entries[i] = FlValuePtr(batch_entry_new(response, method));
+      batch_operation_done(batch);
+      continue;
+    }
+    
+    g_autoptr(FlValue) null_args = fl_value_new_null();
+    dispatch_method(batch->self, method, op_args ? op_args : null_args,
+        [batch, i, name = std::string(method)](FlMethodResponse* response) {
+      batch->entries[i] = FlValuePtr(batch_entry_new(response, name.c_str()));
+      batch_operation_done(batch);
+    });
+  }
+  batch_operation_done(batch);
+}
+
+// Runs a list of {method, args} operations in one channel round trip and
+// returns one {success, result} or {success, error} entry per operation,
+// in order.
+static FlMethodResponse* execute_batch(FlutterMcpPlugin* self, FlValue* args,
+                                       const ResponseCallback& done) {
+  FlValue* operations = nullptr;
+  if (fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    operations = fl_value_lookup_string(args, "operations");
+  }
+  if (!operations || fl_value_get_type(operations) != FL_VALUE_TYPE_LIST) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing operations", nullptr));
+  }
+  
+  auto batch = std::make_shared<BatchState>();
+  batch->self = FLUTTER_MCP_PLUGIN(g_object_ref(self));
+  batch->operations = FlValuePtr(fl_value_ref(operations));
+  batch->entries.resize(fl_value_get_length(operations));
+  batch->pending = batch->entries.size() + 1;
+  batch->done = done;
+  
+  run_batch(batch);
+  return nullptr;
+}
+
 // Method channel handler
 static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
                            gpointer user_data) {
@@ -677,97 +2301,218 @@ static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
   const gchar* method = fl_method_call_get_name(method_call);
   FlValue* args = fl_method_call_get_args(method_call);
   
-  g_autoptr(FlMethodResponse) response = nullptr;
-  
-  if (strcmp(method, "getPlatformVersion") == 0) {
-    response = get_platform_version();
-  } else if (strcmp(method, "initialize") == 0) {
-    response = initialize(args);
-  } else if (strcmp(method, "startBackgroundService") == 0) {
-    response = start_background_service(self);
-  } else if (strcmp(method, "stopBackgroundService") == 0) {
-    response = stop_background_service(self);
-  } else if (strcmp(method, "configureBackgroundService") == 0) {
-    response = configure_background_service(self, args);
-  } else if (strcmp(method, "scheduleBackgroundTask") == 0) {
-    response = schedule_background_task(self, args);
-  } else if (strcmp(method, "cancelBackgroundTask") == 0) {
-    response = cancel_background_task(self, args);
-  } else if (strcmp(method, "showNotification") == 0) {
-    response = show_notification(args);
-  } else if (strcmp(method, "requestNotificationPermission") == 0) {
-    g_autoptr(FlValue) result = fl_value_new_bool(TRUE);
-    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
-  } else if (strcmp(method, "configureNotifications") == 0) {
-    response = configure_notifications(args);
-  } else if (strcmp(method, "cancelNotification") == 0) {
-    response = cancel_notification(args);
-  } else if (strcmp(method, "cancelAllNotifications") == 0) {
-    response = cancel_all_notifications();
-  } else if (strcmp(method, "secureStore") == 0) {
-    response = secure_store(args);
-  } else if (strcmp(method, "secureRead") == 0) {
-    response = secure_read(args);
-  } else if (strcmp(method, "secureDelete") == 0) {
-    response = secure_delete(args);
-  } else if (strcmp(method, "secureContainsKey") == 0) {
-    response = secure_contains_key(args);
-  } else if (strcmp(method, "secureDeleteAll") == 0) {
-    response = secure_delete_all();
-  } else if (strcmp(method, "showTrayIcon") == 0) {
-    response = show_tray_icon(self, args);
-  } else if (strcmp(method, "hideTrayIcon") == 0) {
-    response = hide_tray_icon(self);
-  } else if (strcmp(method, "setTrayMenu") == 0) {
-    response = set_tray_menu(self, args);
-  } else if (strcmp(method, "updateTrayTooltip") == 0) {
-    response = update_tray_tooltip(self, args);
-  } else if (strcmp(method, "configureTray") == 0) {
-    response = configure_tray(args);
-  } else if (strcmp(method, "checkPermission") == 0) {
-    response = check_permission(args);
-  } else if (strcmp(method, "requestPermission") == 0) {
-    response = request_permission(args);
-  } else if (strcmp(method, "shutdown") == 0) {
-    response = shutdown(self);
-  } else {
-    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  // Held until the response is sent, which may be after this returns.
+  g_object_ref(method_call);
+  dispatch_method(self, method, args,
+      [method_call](FlMethodResponse* response) {
+    fl_method_call_respond(method_call, response, nullptr);
+    g_object_unref(method_call);
+  });
+}
+
+// Event channel handlers
+// Listen arguments may narrow the stream: {types: [...]} sends only those
+// types, and {sampling: {type: rate}} sends that fraction of a type.
+static flutter_mcp::EventSubscription parse_event_subscription(FlValue* args) {
+  flutter_mcp::EventSubscription subscription;
+  if (!args || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return subscription;
+  }
+  
+  FlValue* types_value = fl_value_lookup_string(args, "types");
+  if (types_value && fl_value_get_type(types_value) == FL_VALUE_TYPE_LIST) {
+    subscription.all_types = false;
+    for (size_t i = 0; i < fl_value_get_length(types_value); i++) {
+      FlValue* type = fl_value_get_list_value(types_value, i);
+      if (fl_value_get_type(type) == FL_VALUE_TYPE_STRING) {
+        subscription.rates[fl_value_get_string(type)] = 1.0;
+      }
+    }
   }
   
-  fl_method_call_respond(method_call, response, nullptr);
+  FlValue* sampling_value = fl_value_lookup_string(args, "sampling");
+  if (sampling_value && fl_value_get_type(sampling_value) == FL_VALUE_TYPE_MAP) {
+    for (size_t i = 0; i < fl_value_get_length(sampling_value); i++) {
+      FlValue* type = fl_value_get_map_key(sampling_value, i);
+      if (fl_value_get_type(type) != FL_VALUE_TYPE_STRING) continue;
+      const gchar* name = fl_value_get_string(type);
+      // Sampling a type the list left out does not subscribe to it.
+      if (!subscription.all_types && subscription.rates.count(name) == 0) continue;
+      double rate;
+      if (lookup_number(sampling_value, name, &rate)) {
+        subscription.rates[name] = rate;
+      }
+    }
+  }
+  return subscription;
 }
 
-// Event channel handlers
 static void event_listen_cb(FlEventChannel* channel,
                             FlValue* args,
                             gpointer user_data) {
   FlutterMcpPlugin* self = FLUTTER_MCP_PLUGIN(user_data);
+  self->event_filter->Subscribe(parse_event_subscription(args));
   self->event_sink = fl_event_channel_get_event_sink(channel);
+  self->event_listening = true;
+  release_task_journal(self);
 }
 
 static void event_cancel_cb(FlEventChannel* channel,
                             FlValue* args,
                             gpointer user_data) {
   FlutterMcpPlugin* self = FLUTTER_MCP_PLUGIN(user_data);
+  self->event_listening = false;
   self->event_sink = nullptr;
+  self->event_filter->Reset();
+}
+
+static void transport_listen_cb(FlEventChannel* channel,
+                                FlValue* args,
+                                gpointer user_data) {
+  FlutterMcpPlugin* self = FLUTTER_MCP_PLUGIN(user_data);
+  self->transport_sink = fl_event_channel_get_event_sink(channel);
+}
+
+static void transport_cancel_cb(FlEventChannel* channel,
+                                FlValue* args,
+                                gpointer user_data) {
+  FlutterMcpPlugin* self = FLUTTER_MCP_PLUGIN(user_data);
+  self->transport_sink = nullptr;
+}
+
+// Deliver everything queued so far; runs on the main thread
+static gboolean drain_events_cb(gpointer user_data) {
+  FlutterMcpPlugin* self = FLUTTER_MCP_PLUGIN(user_data);
+  flutter_mcp::TraceSpan span(flutter_mcp::TraceCategory::kEvents, "deliver");
+  if (self->event_queue) {
+    self->event_queue->Drain([self](QueuedEvent queued) {
+      self->metrics->event_queue_depth.Add(-1);
+      if (self->event_sink) {
+        fl_event_sink_add(self->event_sink, queued.event.get());
+        if (queued.on_delivered) {
+          queued.on_delivered();
+        }
+      }
+    });
+  }
+  return G_SOURCE_REMOVE;
+}
+
+// Queue a fully built event for the main thread. Safe to call from any
+// thread and never blocks; only the push that finds the queue empty adds a
+// main-context source, so a burst of events costs a single wakeup.
+// |on_delivered| runs on the main thread only if a listener gets the event.
+static void post_event(FlutterMcpPlugin* self, FlValue* event,
+                       std::function<void()> on_delivered) {
+  if (!self->event_queue) {
+    return;
+  }
+  flutter_mcp::TraceSpan span(flutter_mcp::TraceCategory::kEvents, "post");
+  const auto start = flutter_mcp::NativeMetrics::Clock::now();
+  self->metrics->event_queue_depth.Add(1);
+  if (self->event_queue->Push(QueuedEvent{FlValuePtr(fl_value_ref(event)),
+                                          std::move(on_delivered)})) {
+    g_main_context_invoke_full(nullptr, G_PRIORITY_DEFAULT, drain_events_cb,
+                               g_object_ref(self), g_object_unref);
+  }
+  self->metrics->event_post.Record(flutter_mcp::NativeMetrics::MicrosSince(start));
+}
+
+// Only periodic background ticks are safe to fold into the latest one.
+static bool is_coalescible_event(const gchar* event_type, FlValue* data) {
+  if (strcmp(event_type, "backgroundEvent") != 0 ||
+      fl_value_get_type(data) != FL_VALUE_TYPE_MAP) {
+    return false;
+  }
+  FlValue* type_value = fl_value_lookup_string(data, "type");
+  return type_value && fl_value_get_type(type_value) == FL_VALUE_TYPE_STRING &&
+         strcmp(fl_value_get_string(type_value), "periodic") == 0;
 }
 
 // Send event to Flutter
+// Callers check event_wanted() first.
 static void send_event(FlutterMcpPlugin* self, const gchar* event_type,
                        FlValue* data) {
-  if (self->event_sink) {
-    g_autoptr(FlValue) event = fl_value_new_map();
-    fl_value_set_string_take(event, "type", fl_value_new_string(event_type));
-    fl_value_set_string_take(event, "data", fl_value_ref(data));
-    
-    fl_event_sink_add(self->event_sink, event);
+  if (self->event_batcher &&
+      self->event_batcher->Add(event_type, FlValuePtr(fl_value_ref(data)),
+                               is_coalescible_event(event_type, data))) {
+    return;
   }
+  
+  g_autoptr(FlValue) event = fl_value_new_map();
+  fl_value_set_string_take(event, "type", fl_value_new_string(event_type));
+  fl_value_set_string_take(event, "data", fl_value_ref(data));
+  
+  post_event(self, event);
 }
 
-void flutter_mcp_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
-  // Initialize libraries
-  notify_init("flutter_mcp");
+// Send a flushed batch as a single event: {type, batch: true, data: [...]}
+static void send_event_batch(FlutterMcpPlugin* self,
+                             const std::string& event_type,
+                             std::vector<FlValuePtr>&& events,
+                             size_t coalesced) {
+  g_autoptr(FlValue) list = fl_value_new_list();
+  for (auto& data : events) {
+    fl_value_append_take(list, data.release());
+  }
+  
+  g_autoptr(FlValue) event = fl_value_new_map();
+  fl_value_set_string_take(event, "type", fl_value_new_string(event_type.c_str()));
+  fl_value_set_string_take(event, "batch", fl_value_new_bool(TRUE));
+  fl_value_set_string_take(event, "data", fl_value_ref(list));
+  fl_value_set_string_take(event, "coalesced", fl_value_new_int(static_cast<int64_t>(coalesced)));
   
+  post_event(self, event);
+}
+
+// Plans the journaled tasks at registration, before Dart is running, and
+// holds them until release_task_journal(). A journal only exists if an
+// earlier run turned it on.
+static void replay_task_journal(FlutterMcpPlugin* self) {
+  g_autofree gchar* path = task_journal_path();
+  if (!g_file_test(path, G_FILE_TEST_EXISTS)) {
+    return;
+  }
+  self->task_journal = open_task_journal();
+  if (!self->task_journal) {
+    return;
+  }
+  
+  const int64_t now = unix_ms();
+  const flutter_mcp::OverduePolicy policy = self->task_journal->overdue_policy();
+  std::vector<std::string> dropped;
+  self->task_journal->ForEachTask([&](const std::string& task_id,
+                                      const flutter_mcp::JournaledTask& task) {
+    if (!self->held_replay->Hold(task_id, task, now, policy)) {
+      dropped.push_back(task_id);
+    }
+  });
+  for (const auto& task_id : dropped) {
+    self->task_journal->Erase(task_id);
+  }
+}
+
+// Puts the held tasks on the scheduler once Dart listens for their results.
+static void release_task_journal(FlutterMcpPlugin* self) {
+  if (self->held_replay->size() == 0) {
+    return;
+  }
+  flutter_mcp::TaskScheduler* scheduler = ensure_task_scheduler(self);
+  self->held_replay->Release(unix_ms(), [self, scheduler](const std::string& task_id,
+                                                          const flutter_mcp::JournaledTask& task,
+                                                          int64_t delay_ms) {
+    const auto priority = static_cast<flutter_mcp::TaskPriority>(task.priority);
+    if (task.recurring) {
+      scheduler->ScheduleRecurring(task_id, delay_ms, task.recurrence, nullptr, priority,
+                                   task_result_sender(self, task_id.c_str()));
+    } else {
+      scheduler->Schedule(task_id, delay_ms, nullptr, priority,
+                          task_result_sender(self, task_id.c_str(), task.due_unix_ms));
+    }
+  });
+}
+
+void flutter_mcp_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
   FlutterMcpPlugin* plugin = FLUTTER_MCP_PLUGIN(
       g_object_new(flutter_mcp_plugin_get_type(), nullptr));
   
@@ -791,5 +2536,17 @@ void flutter_mcp_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
                                        g_object_ref(plugin),
                                        g_object_unref);
   
+  // MCP server traffic, kept off the general event channel
+  plugin->transport_channel = fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                                                    "flutter_mcp/transport",
+                                                    FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(plugin->transport_channel,
+                                       transport_listen_cb,
+                                       transport_cancel_cb,
+                                       g_object_ref(plugin),
+                                       g_object_unref);
+  
+  replay_task_journal(plugin);
+  
   fl_plugin_registrar_set_destroy_notify(registrar, G_OBJECT(plugin), g_object_unref);
 }
\ No newline at end of file
@@ -0,0 +1,739 @@
+#include "secret_store.h"
+
+#include <unordered_set>
+#include <utility>
+
+#include "native_trace.h"
+
+namespace flutter_mcp {
+
+namespace {
+
+// Compared by address to tell text and bytes values apart.
+constexpr char kTextContentType[] = "text/plain";
+constexpr char kBytesContentType[] = "application/octet-stream";
+
+}  // namespace
+
+struct SecretStore::LookupRequest {
+  std::shared_ptr<State> state;
+  std::string key;
+  std::shared_ptr<Lookup> lookup;
+  SecretService* service;
+  // Set while loading the secret of a remembered item.
+  SecretItem* item;
+  // Each request is traced from issue to answer.
+  int64_t trace_begin = NativeTracer::Begin();
+};
+
+struct SecretStore::WriteRequest {
+  Callback done;
+  int64_t trace_begin = NativeTracer::Begin();
+};
+
+struct SecretStore::SearchRequest {
+  std::shared_ptr<State> state;
+  KeyFilter match;
+  EntriesCallback done;
+  uint64_t generation;
+  int64_t trace_begin = NativeTracer::Begin();
+};
+
+struct SecretStore::WarmRequest {
+  std::shared_ptr<State> state;
+  // Published to |state| only once the collection is ready, so operations
+  // never run against a half-initialized connection.
+  SecretService* service;
+};
+
+SecretStore::State::~State() {
+  for (auto& entry : items) {
+    g_object_unref(entry.second);
+  }
+  if (collection) {
+    g_object_unref(collection);
+  }
+  if (service) {
+    g_object_unref(service);
+  }
+  g_object_unref(cancellable);
+}
+
+SecretStore::SecretStore(const SecretSchema* schema)
+    : state_(std::make_shared<State>()) {
+  state_->schema = schema;
+  state_->cancellable = g_cancellable_new();
+}
+
+SecretStore::~SecretStore() {
+  if (state_->flush_source) {
+    g_source_remove(state_->flush_source);
+    state_->flush_source = 0;
+  }
+  FlushSync();
+  // Pending callbacks still run, with G_IO_ERROR_CANCELLED; they only touch
+  // the shared state, which they keep alive.
+  g_cancellable_cancel(state_->cancellable);
+}
+
+void SecretStore::Warm(WarmCallback done) {
+  WithService(state_, [done](SecretService* service) {
+    if (done) {
+      done(service != nullptr);
+    }
+  });
+}
+
+void SecretStore::Store(const std::string& key, const std::string& value,
+                        Callback done) {
+  g_autoptr(GBytes) bytes = g_bytes_new(value.data(), value.size());
+  StoreSecret(key, bytes, kTextContentType, std::move(done));
+}
+
+void SecretStore::StoreBytes(const std::string& key, GBytes* value, Callback done) {
+  StoreSecret(key, value, kBytesContentType, std::move(done));
+}
+
+void SecretStore::StoreSecret(const std::string& key, GBytes* value,
+                              const char* content_type, Callback done) {
+  // Reads issued from now on must see this value, not a lookup started
+  // before it.
+  state_->lookups.erase(key);
+  state_->cache.Invalidate(key);
+  state_->generation++;
+
+  if (state_->write_behind.enabled()) {
+    gsize length = 0;
+    const char* data = static_cast<const char*>(g_bytes_get_data(value, &length));
+    BufferWrite(key,
+                content_type == kBytesContentType ? PendingWrite::Kind::kBytes
+                                                  : PendingWrite::Kind::kText,
+                data, length);
+    if (done) {
+      done(nullptr);
+    }
+    return;
+  }
+  IssueStore(state_, key, std::shared_ptr<GBytes>(g_bytes_ref(value), g_bytes_unref),
+             content_type, std::move(done));
+}
+
+// static
+void SecretStore::IssueStore(const std::shared_ptr<State>& state, const std::string& key,
+                             std::shared_ptr<GBytes> bytes, const char* content_type,
+                             Callback done) {
+  WithService(state, [state, key, bytes, content_type, done](SecretService* service) {
+    g_autoptr(GHashTable) attributes =
+        secret_attributes_build(state->schema, "key", key.c_str(), nullptr);
+    gsize length = 0;
+    const gchar* data = static_cast<const gchar*>(g_bytes_get_data(bytes.get(), &length));
+    SecretValue* secret = secret_value_new(data, static_cast<gssize>(length), content_type);
+    const gchar* collection =
+        state->collection
+            ? g_dbus_proxy_get_object_path(G_DBUS_PROXY(state->collection))
+            : SECRET_COLLECTION_DEFAULT;
+    // Stores replace the item in place, so a remembered item stays valid.
+    secret_service_store(service, state->schema, attributes, collection,
+                         key.c_str(), secret, state->cancellable, OnStoreDone,
+                         new WriteRequest{done});
+    secret_value_unref(secret);
+  });
+}
+
+void SecretStore::Read(const std::string& key, ReadCallback done) {
+  ReadBytes(key, [done](bool found, const uint8_t* data, size_t length, const GError* error) {
+    std::string value(reinterpret_cast<const char*>(data), length);
+    done(found, value, error);
+    SecureZero(value);
+  });
+}
+
+void SecretStore::ReadBytes(const std::string& key, BytesCallback done) {
+  PendingWrite::Kind kind;
+  std::string buffered;
+  if (state_->write_behind.Lookup(key, &kind, &buffered)) {
+    if (kind == PendingWrite::Kind::kDelete) {
+      done(false, nullptr, 0, nullptr);
+    } else {
+      done(true, reinterpret_cast<const uint8_t*>(buffered.data()), buffered.size(), nullptr);
+    }
+    SecureZero(buffered);
+    return;
+  }
+
+  std::string cached;
+  if (state_->cache.Lookup(key, cached)) {
+    done(true, reinterpret_cast<const uint8_t*>(cached.data()), cached.size(), nullptr);
+    SecureZero(cached);
+    return;
+  }
+
+  auto it = state_->lookups.find(key);
+  if (it != state_->lookups.end()) {
+    it->second->waiters.push_back(std::move(done));
+    return;
+  }
+
+  auto lookup = std::make_shared<Lookup>();
+  lookup->waiters.push_back(std::move(done));
+  state_->lookups[key] = lookup;
+
+  std::shared_ptr<State> state = state_;
+  WithService(state_, [state, key, lookup](SecretService* service) {
+    StartLookup(std::unique_ptr<LookupRequest>(
+        new LookupRequest{state, key, lookup, service, nullptr}));
+  });
+}
+
+void SecretStore::Delete(const std::string& key, Callback done) {
+  state_->lookups.erase(key);
+  state_->cache.Invalidate(key);
+  state_->generation++;
+  ForgetItem(state_.get(), key);
+
+  if (state_->write_behind.enabled()) {
+    BufferWrite(key, PendingWrite::Kind::kDelete, "", 0);
+    if (done) {
+      done(nullptr);
+    }
+    return;
+  }
+  IssueClear(state_, key, std::move(done));
+}
+
+// static
+void SecretStore::IssueClear(const std::shared_ptr<State>& state, const std::string& key,
+                             Callback done) {
+  WithService(state, [state, key, done](SecretService* service) {
+    g_autoptr(GHashTable) attributes =
+        secret_attributes_build(state->schema, "key", key.c_str(), nullptr);
+    secret_service_clear(service, state->schema, attributes,
+                         state->cancellable, OnClearDone,
+                         new WriteRequest{done});
+  });
+}
+
+void SecretStore::DeleteAll(Callback done) {
+  // Buffered writes would only be cleared again.
+  state_->write_behind.Clear();
+  state_->lookups.clear();
+  state_->cache.Clear();
+  state_->generation++;
+  for (auto& entry : state_->items) {
+    g_object_unref(entry.second);
+  }
+  state_->items.clear();
+
+  std::shared_ptr<State> state = state_;
+  WithService(state_, [state, done](SecretService* service) {
+    g_autoptr(GHashTable) attributes =
+        secret_attributes_build(state->schema, nullptr);
+    secret_service_clear(service, state->schema, attributes,
+                         state->cancellable, OnClearDone,
+                         new WriteRequest{done});
+  });
+}
+
+void SecretStore::ReadMany(const std::vector<std::string>& keys,
+                           EntriesCallback done) {
+  // Served from memory when every key is buffered or cached.
+  std::vector<std::pair<std::string, std::string>> entries;
+  size_t resolved = 0;
+  for (const auto& key : keys) {
+    std::string value;
+    PendingWrite::Kind kind;
+    if (state_->write_behind.Lookup(key, &kind, &value)) {
+      if (kind != PendingWrite::Kind::kDelete) {
+        entries.emplace_back(key, std::move(value));
+      }
+    } else if (state_->cache.Lookup(key, value)) {
+      entries.emplace_back(key, std::move(value));
+    } else {
+      break;
+    }
+    resolved++;
+  }
+  if (resolved == keys.size()) {
+    done(entries, nullptr);
+    for (auto& entry : entries) {
+      SecureZero(entry.second);
+    }
+    return;
+  }
+  for (auto& entry : entries) {
+    SecureZero(entry.second);
+  }
+
+  auto wanted = std::make_shared<std::unordered_set<std::string>>(keys.begin(), keys.end());
+  Search([wanted](const std::string& key) { return wanted->count(key) > 0; },
+         std::move(done));
+}
+
+void SecretStore::ReadPrefix(const std::string& prefix, EntriesCallback done) {
+  Search([prefix](const std::string& key) {
+    return key.compare(0, prefix.size(), prefix) == 0;
+  }, std::move(done));
+}
+
+void SecretStore::Search(KeyFilter match, EntriesCallback done) {
+  std::shared_ptr<State> state = state_;
+  if (state_->write_behind.enabled() || state_->write_behind.size() > 0) {
+    // Writes still buffered when the search answers are newer than
+    // anything it found.
+    done = [state, match, done](
+        const std::vector<std::pair<std::string, std::string>>& found, const GError* error) {
+      std::vector<std::pair<std::string, std::string>> entries;
+      PendingWrite::Kind kind;
+      for (const auto& entry : found) {
+        if (!state->write_behind.Lookup(entry.first, &kind, nullptr)) {
+          entries.push_back(entry);
+        }
+      }
+      state->write_behind.ForEach([&](const PendingWrite& write) {
+        if (write.kind != PendingWrite::Kind::kDelete && match(write.key)) {
+          entries.emplace_back(write.key, write.value);
+        }
+      });
+      done(entries, error);
+      for (auto& entry : entries) {
+        SecureZero(entry.second);
+      }
+    };
+  }
+  auto request = std::make_shared<std::unique_ptr<SearchRequest>>(
+      new SearchRequest{state_, std::move(match), std::move(done),
+                        state_->generation});
+  WithService(state_, [state, request](SecretService* service) {
+    // Every item of the schema; keys are filtered here since the Secret
+    // Service only matches attributes exactly.
+    g_autoptr(GHashTable) attributes =
+        secret_attributes_build(state->schema, nullptr);
+    secret_service_search(service, state->schema, attributes,
+                          static_cast<SecretSearchFlags>(
+                              SECRET_SEARCH_ALL | SECRET_SEARCH_UNLOCK |
+                              SECRET_SEARCH_LOAD_SECRETS),
+                          state->cancellable, OnSearchAllDone,
+                          request->release());
+  });
+}
+
+void SecretStore::ConfigureCache(const SecretCacheConfig& config) {
+  state_->cache.Configure(config);
+}
+
+void SecretStore::ConfigureWriteBehind(const WriteBehindConfig& config) {
+  state_->write_behind.Configure(config);
+  if (!config.enabled) {
+    Flush(nullptr);
+  }
+}
+
+void SecretStore::BufferWrite(const std::string& key, PendingWrite::Kind kind,
+                              const char* data, size_t size) {
+  if (state_->write_behind.Put(key, kind, data, size)) {
+    Flush(nullptr);
+    return;
+  }
+  // Armed by the first buffered write and not pushed back by later ones, so
+  // a steady stream of writes is still flushed every delay_ms.
+  if (!state_->flush_source) {
+    state_->flush_source = g_timeout_add(
+        static_cast<guint>(state_->write_behind.config().delay_ms), OnFlushTimeout, this);
+  }
+}
+
+void SecretStore::Flush(FlushCallback done) {
+  if (state_->flush_source) {
+    g_source_remove(state_->flush_source);
+    state_->flush_source = 0;
+  }
+  if (done) {
+    state_->flush_waiters.push_back(std::move(done));
+  }
+
+  std::vector<PendingWrite> writes = state_->write_behind.Take();
+  std::shared_ptr<State> state = state_;
+  // Answers the waiters once nothing flushed is left unanswered.
+  auto settle = [state]() {
+    if (state->flushing > 0 || state->flush_waiters.empty()) {
+      return;
+    }
+    std::vector<FlushCallback> waiters;
+    waiters.swap(state->flush_waiters);
+    const size_t failures = state->write_behind.TakeFailures();
+    for (auto& waiter : waiters) {
+      waiter(failures);
+    }
+  };
+  Callback finished = [state, settle](const GError* error) {
+    if (error) {
+      state->write_behind.RecordFailures(1);
+    }
+    state->flushing--;
+    settle();
+  };
+
+  state_->flushing += writes.size();
+  for (PendingWrite& write : writes) {
+    if (write.kind == PendingWrite::Kind::kDelete) {
+      IssueClear(state_, write.key, finished);
+    } else {
+      std::shared_ptr<GBytes> bytes(g_bytes_new(write.value.data(), write.value.size()),
+                                    g_bytes_unref);
+      IssueStore(state_, write.key, bytes,
+                 write.kind == PendingWrite::Kind::kBytes ? kBytesContentType
+                                                          : kTextContentType,
+                 finished);
+      SecureZero(write.value);
+    }
+  }
+  settle();
+}
+
+void SecretStore::FlushSync() {
+  for (PendingWrite& write : state_->write_behind.Take()) {
+    g_autoptr(GHashTable) attributes =
+        secret_attributes_build(state_->schema, "key", write.key.c_str(), nullptr);
+    GError* error = nullptr;
+    if (write.kind == PendingWrite::Kind::kDelete) {
+      secret_service_clear_sync(state_->service, state_->schema, attributes, nullptr, &error);
+    } else {
+      SecretValue* secret = secret_value_new(
+          write.value.data(), static_cast<gssize>(write.value.size()),
+          write.kind == PendingWrite::Kind::kBytes ? kBytesContentType : kTextContentType);
+      const gchar* collection =
+          state_->collection
+              ? g_dbus_proxy_get_object_path(G_DBUS_PROXY(state_->collection))
+              : SECRET_COLLECTION_DEFAULT;
+      secret_service_store_sync(state_->service, state_->schema, attributes, collection,
+                                write.key.c_str(), secret, nullptr, &error);
+      secret_value_unref(secret);
+      SecureZero(write.value);
+    }
+    g_clear_error(&error);
+  }
+}
+
+size_t SecretStore::PendingWrites() const {
+  return state_->write_behind.size();
+}
+
+size_t SecretStore::PendingLookups() const {
+  return state_->lookups.size();
+}
+
+// static
+void SecretStore::WithService(const std::shared_ptr<State>& state,
+                              std::function<void(SecretService* service)> body) {
+  if (state->service) {
+    body(state->service);
+    return;
+  }
+
+  state->waiting.push_back(std::move(body));
+  if (state->warming) {
+    return;
+  }
+  state->warming = true;
+  secret_service_get(static_cast<SecretServiceFlags>(
+                         SECRET_SERVICE_OPEN_SESSION |
+                         SECRET_SERVICE_LOAD_COLLECTIONS),
+                     state->cancellable, OnServiceReady,
+                     new WarmRequest{state, nullptr});
+}
+
+// static
+void SecretStore::FinishWarm(const std::shared_ptr<State>& state,
+                             SecretService* service) {
+  state->service = service;
+  state->warming = false;
+  // Without a service each operation falls back to libsecret's default
+  // lookup, reports its own error, and the next one tries to warm up again.
+  std::vector<std::function<void(SecretService* service)>> waiting;
+  waiting.swap(state->waiting);
+  for (auto& body : waiting) {
+    body(state->service);
+  }
+}
+
+// static
+void SecretStore::OnServiceReady(GObject* source, GAsyncResult* result,
+                                 gpointer user_data) {
+  std::unique_ptr<WarmRequest> request(static_cast<WarmRequest*>(user_data));
+  State* state = request->state.get();
+
+  GError* error = nullptr;
+  SecretService* service = secret_service_get_finish(result, &error);
+  if (error) {
+    g_error_free(error);
+  }
+  if (!service) {
+    FinishWarm(request->state, nullptr);
+    return;
+  }
+
+  request->service = service;
+  secret_collection_for_alias(service, SECRET_COLLECTION_DEFAULT,
+                              SECRET_COLLECTION_NONE, state->cancellable,
+                              OnCollectionReady, request.release());
+}
+
+// static
+void SecretStore::OnCollectionReady(GObject* source, GAsyncResult* result,
+                                    gpointer user_data) {
+  std::unique_ptr<WarmRequest> request(static_cast<WarmRequest*>(user_data));
+  State* state = request->state.get();
+
+  GError* error = nullptr;
+  SecretCollection* collection = secret_collection_for_alias_finish(result, &error);
+  if (error) {
+    g_error_free(error);
+  }
+  // No default collection yet: stores create it through the alias.
+  if (!collection) {
+    FinishWarm(request->state, request->service);
+    return;
+  }
+
+  state->collection = collection;
+  if (!secret_collection_get_locked(collection)) {
+    FinishWarm(request->state, request->service);
+    return;
+  }
+
+  // Unlock now so the first read does not wait on a prompt.
+  GList* objects = g_list_append(nullptr, collection);
+  secret_service_unlock(request->service, objects, state->cancellable,
+                        OnUnlocked, request.release());
+  g_list_free(objects);
+}
+
+// static
+void SecretStore::OnUnlocked(GObject* source, GAsyncResult* result,
+                             gpointer user_data) {
+  std::unique_ptr<WarmRequest> request(static_cast<WarmRequest*>(user_data));
+
+  GError* error = nullptr;
+  GList* unlocked = nullptr;
+  secret_service_unlock_finish(SECRET_SERVICE(source), result, &unlocked, &error);
+  g_list_free_full(unlocked, g_object_unref);
+  // A refused unlock surfaces again, per item, on the first search.
+  if (error) {
+    g_error_free(error);
+  }
+  FinishWarm(request->state, request->service);
+}
+
+// static
+void SecretStore::StartLookup(std::unique_ptr<LookupRequest> request) {
+  State* state = request->state.get();
+  auto it = state->items.find(request->key);
+  if (it != state->items.end()) {
+    request->item = SECRET_ITEM(g_object_ref(it->second));
+    SecretItem* item = request->item;
+    secret_item_load_secret(item, state->cancellable, OnItemLoaded,
+                            request.release());
+    return;
+  }
+
+  g_autoptr(GHashTable) attributes = secret_attributes_build(
+      state->schema, "key", request->key.c_str(), nullptr);
+  SecretService* service = request->service;
+  secret_service_search(service, state->schema, attributes,
+                        static_cast<SecretSearchFlags>(
+                            SECRET_SEARCH_UNLOCK | SECRET_SEARCH_LOAD_SECRETS),
+                        state->cancellable, OnSearchDone, request.release());
+}
+
+// static
+void SecretStore::OnSearchDone(GObject* source, GAsyncResult* result,
+                               gpointer user_data) {
+  std::unique_ptr<LookupRequest> request(static_cast<LookupRequest*>(user_data));
+
+  GError* error = nullptr;
+  GList* items = secret_service_search_finish(
+      source ? SECRET_SERVICE(source) : nullptr, result, &error);
+
+  SecretValue* secret = nullptr;
+  if (items) {
+    SecretItem* item = SECRET_ITEM(items->data);
+    secret = secret_item_get_secret(item);
+    // Only remember the item if no write raced this search.
+    State* state = request->state.get();
+    auto it = state->lookups.find(request->key);
+    if (secret && it != state->lookups.end() && it->second == request->lookup) {
+      ForgetItem(state, request->key);
+      state->items[request->key] = SECRET_ITEM(g_object_ref(item));
+    }
+    g_list_free_full(items, g_object_unref);
+  }
+
+  FinishLookup(std::move(request), secret, error);
+  if (secret) {
+    secret_value_unref(secret);
+  }
+  if (error) {
+    g_error_free(error);
+  }
+}
+
+// static
+void SecretStore::OnSearchAllDone(GObject* source, GAsyncResult* result,
+                                  gpointer user_data) {
+  std::unique_ptr<SearchRequest> request(static_cast<SearchRequest*>(user_data));
+  NativeTracer::End(TraceCategory::kSecureStorage, "search", request->trace_begin);
+  State* state = request->state.get();
+
+  GError* error = nullptr;
+  GList* items = secret_service_search_finish(
+      source ? SECRET_SERVICE(source) : nullptr, result, &error);
+
+  // Results that raced a write are returned but not remembered.
+  const bool current = request->generation == state->generation;
+  std::vector<std::pair<std::string, std::string>> entries;
+  for (GList* link = items; link != nullptr; link = link->next) {
+    SecretItem* item = SECRET_ITEM(link->data);
+    GHashTable* attributes = secret_item_get_attributes(item);
+    const gchar* key = static_cast<const gchar*>(g_hash_table_lookup(attributes, "key"));
+    SecretValue* secret = key && request->match(key) ? secret_item_get_secret(item) : nullptr;
+    if (secret) {
+      gsize length = 0;
+      const gchar* data = secret_value_get(secret, &length);
+      entries.emplace_back(key, std::string(data, length));
+      if (current) {
+        ForgetItem(state, key);
+        state->items[key] = SECRET_ITEM(g_object_ref(item));
+        state->cache.Put(key, entries.back().second);
+      }
+      secret_value_unref(secret);
+    }
+    g_hash_table_unref(attributes);
+  }
+  g_list_free_full(items, g_object_unref);
+
+  if (request->done) {
+    request->done(entries, error);
+  }
+  for (auto& entry : entries) {
+    SecureZero(entry.second);
+  }
+  if (error) {
+    g_error_free(error);
+  }
+}
+
+// static
+void SecretStore::OnItemLoaded(GObject* source, GAsyncResult* result,
+                               gpointer user_data) {
+  std::unique_ptr<LookupRequest> request(static_cast<LookupRequest*>(user_data));
+  SecretItem* item = request->item;
+  request->item = nullptr;
+
+  GError* error = nullptr;
+  secret_item_load_secret_finish(item, result, &error);
+  SecretValue* secret = error ? nullptr : secret_item_get_secret(item);
+
+  if (!secret && !g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    // The item was deleted or replaced behind our back: search afresh.
+    State* state = request->state.get();
+    auto it = state->items.find(request->key);
+    if (it != state->items.end() && it->second == item) {
+      ForgetItem(state, request->key);
+    }
+    g_clear_error(&error);
+    g_object_unref(item);
+    StartLookup(std::move(request));
+    return;
+  }
+
+  FinishLookup(std::move(request), secret, error);
+  if (secret) {
+    secret_value_unref(secret);
+  }
+  if (error) {
+    g_error_free(error);
+  }
+  g_object_unref(item);
+}
+
+// static
+void SecretStore::FinishLookup(std::unique_ptr<LookupRequest> request,
+                               SecretValue* secret, const GError* error) {
+  NativeTracer::End(TraceCategory::kSecureStorage, "lookup", request->trace_begin);
+  gsize length = 0;
+  const gchar* data = secret ? secret_value_get(secret, &length) : nullptr;
+
+  // Detach before answering so a waiter that reads again starts afresh.
+  // A lookup that was already detached raced a write and must not be cached.
+  State* state = request->state.get();
+  auto it = state->lookups.find(request->key);
+  if (it != state->lookups.end() && it->second == request->lookup) {
+    state->lookups.erase(it);
+    if (secret && state->cache.enabled()) {
+      std::string value(data, length);
+      state->cache.Put(request->key, value);
+      SecureZero(value);
+    }
+  }
+
+  // Waiters read straight out of the secret, which libsecret keeps in
+  // non-pageable memory and wipes on release.
+  for (auto& waiter : request->lookup->waiters) {
+    if (waiter) {
+      waiter(secret != nullptr, reinterpret_cast<const uint8_t*>(data), length, error);
+    }
+  }
+}
+
+// static
+void SecretStore::ForgetItem(State* state, const std::string& key) {
+  auto it = state->items.find(key);
+  if (it != state->items.end()) {
+    g_object_unref(it->second);
+    state->items.erase(it);
+  }
+}
+
+// static
+void SecretStore::OnStoreDone(GObject* source, GAsyncResult* result,
+                              gpointer user_data) {
+  std::unique_ptr<WriteRequest> request(static_cast<WriteRequest*>(user_data));
+  NativeTracer::End(TraceCategory::kSecureStorage, "store", request->trace_begin);
+
+  GError* error = nullptr;
+  secret_service_store_finish(source ? SECRET_SERVICE(source) : nullptr,
+                              result, &error);
+  if (request->done) {
+    request->done(error);
+  }
+  if (error) {
+    g_error_free(error);
+  }
+}
+
+// static
+void SecretStore::OnClearDone(GObject* source, GAsyncResult* result,
+                              gpointer user_data) {
+  std::unique_ptr<WriteRequest> request(static_cast<WriteRequest*>(user_data));
+  NativeTracer::End(TraceCategory::kSecureStorage, "clear", request->trace_begin);
+
+  GError* error = nullptr;
+  secret_service_clear_finish(source ? SECRET_SERVICE(source) : nullptr,
+                              result, &error);
+  if (request->done) {
+    request->done(error);
+  }
+  if (error) {
+    g_error_free(error);
+  }
+}
+
+// static
+gboolean SecretStore::OnFlushTimeout(gpointer user_data) {
+  SecretStore* store = static_cast<SecretStore*>(user_data);
+  store->state_->flush_source = 0;
+  store->Flush(nullptr);
+  return G_SOURCE_REMOVE;
+}
+
+}  // namespace flutter_mcp
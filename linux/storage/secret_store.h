@@ -0,0 +1,193 @@
+#ifndef SECRET_STORE_H_
+#define SECRET_STORE_H_
+
+#include <libsecret/secret.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "secret_cache.h"
+#include "write_behind_buffer.h"
+
+namespace flutter_mcp {
+
+// Asynchronous wrapper around the Secret Service items of one schema.
+//
+// Nothing here blocks: every operation is issued with libsecret's async API
+// and its callback runs on the main context once D-Bus answers. The service
+// connection, its session and the default collection are set up once, on
+// Warm() or the first operation, and kept for the store's lifetime; the
+// collection is unlocked up front. Items found by a read are remembered so
+// later reads load the secret straight from the item instead of searching.
+//
+// Concurrent reads of the same key share a single lookup; a write to a key
+// detaches the lookup in flight so later reads observe the write. Once the
+// cache is enabled, found values are kept decrypted in memory and served
+// without a D-Bus round trip until they expire or are written.
+//
+// With write-behind on, writes and deletes only replace the key's buffered
+// write and complete at once; reads see buffered writes. The buffer is
+// flushed delay_ms after the first write into it, immediately once
+// max_pending keys are waiting, and by Flush(). A flush issues each key's
+// newest write in the order those writes were made, and D-Bus delivers
+// them in that order. Buffered writes exist only in memory until flushed;
+// any still buffered when the store is destroyed are written synchronously.
+//
+// Must be used from the main thread.
+class SecretStore {
+ public:
+  // |found| is false when no item matches. |error| is nullptr on success.
+  using ReadCallback = std::function<void(bool found, const std::string& value,
+                                          const GError* error)>;
+  // Like ReadCallback, but |data| points into the secret itself and is only
+  // valid during the call.
+  using BytesCallback = std::function<void(bool found, const uint8_t* data, size_t length,
+                                           const GError* error)>;
+  using Callback = std::function<void(const GError* error)>;
+  // Matching keys and their values, in no particular order.
+  using EntriesCallback = std::function<void(
+      const std::vector<std::pair<std::string, std::string>>& entries,
+      const GError* error)>;
+  // |available| is false if the Secret Service could not be reached.
+  using WarmCallback = std::function<void(bool available)>;
+  // |failures| counts buffered writes that could not be persisted since the
+  // previous Flush() answered.
+  using FlushCallback = std::function<void(size_t failures)>;
+
+  explicit SecretStore(const SecretSchema* schema);
+  ~SecretStore();
+
+  SecretStore(const SecretStore&) = delete;
+  SecretStore& operator=(const SecretStore&) = delete;
+
+  // Connects to the service, opens a session and unlocks the default
+  // collection ahead of the first operation. |done| may be empty.
+  void Warm(WarmCallback done);
+
+  // Whether a warmed-up service connection is held.
+  bool available() const { return state_->service != nullptr; }
+
+  void Store(const std::string& key, const std::string& value, Callback done);
+  void Read(const std::string& key, ReadCallback done);
+  // Binary-safe variants. |value| is referenced, not copied, until it has
+  // been handed to libsecret.
+  void StoreBytes(const std::string& key, GBytes* value, Callback done);
+  void ReadBytes(const std::string& key, BytesCallback done);
+  void Delete(const std::string& key, Callback done);
+  void DeleteAll(Callback done);
+
+  // Reads several keys, or every key starting with |prefix|, with a single
+  // search over the schema. Missing keys are left out of the result.
+  void ReadMany(const std::vector<std::string>& keys, EntriesCallback done);
+  void ReadPrefix(const std::string& prefix, EntriesCallback done);
+
+  void ConfigureCache(const SecretCacheConfig& config);
+
+  // Turning write-behind off flushes whatever is buffered.
+  void ConfigureWriteBehind(const WriteBehindConfig& config);
+
+  // Persists every buffered write and answers |done|, which may be empty,
+  // once those and any earlier flushed writes have completed.
+  void Flush(FlushCallback done);
+
+  // Number of keys with a buffered write.
+  size_t PendingWrites() const;
+
+  // Number of distinct keys with a lookup in flight.
+  size_t PendingLookups() const;
+
+ private:
+  struct Lookup {
+    std::vector<BytesCallback> waiters;
+  };
+
+  struct State {
+    ~State();
+
+    const SecretSchema* schema = nullptr;
+    // Cancels whatever is still in flight when the store goes away.
+    GCancellable* cancellable = nullptr;
+
+    // Held once warm-up has finished; nullptr if the service is unreachable.
+    SecretService* service = nullptr;
+    SecretCollection* collection = nullptr;
+    bool warming = false;
+    // Operations waiting for warm-up to finish.
+    std::vector<std::function<void(SecretService* service)>> waiting;
+
+    // Items located by earlier reads, keyed by storage key.
+    std::unordered_map<std::string, SecretItem*> items;
+    std::unordered_map<std::string, std::shared_ptr<Lookup>> lookups;
+    SecretCache cache;
+    WriteBehindBuffer write_behind;
+    // The write-behind flush timeout, or 0.
+    guint flush_source = 0;
+    // Flushed writes not answered yet, and the Flush() callers waiting on
+    // them.
+    size_t flushing = 0;
+    std::vector<FlushCallback> flush_waiters;
+    // Bumped by every write so a search can tell whether it raced one.
+    uint64_t generation = 0;
+  };
+
+  struct LookupRequest;
+  struct WriteRequest;
+  struct WarmRequest;
+  struct SearchRequest;
+
+  using KeyFilter = std::function<bool(const std::string& key)>;
+
+  void Search(KeyFilter match, EntriesCallback done);
+  void StoreSecret(const std::string& key, GBytes* value, const char* content_type,
+                   Callback done);
+  // Replaces the buffered write to |key|, arming or running the flush.
+  void BufferWrite(const std::string& key, PendingWrite::Kind kind, const char* data,
+                   size_t size);
+  // Writes what is still buffered without returning to the main loop.
+  void FlushSync();
+
+  static void IssueStore(const std::shared_ptr<State>& state, const std::string& key,
+                         std::shared_ptr<GBytes> bytes, const char* content_type,
+                         Callback done);
+  static void IssueClear(const std::shared_ptr<State>& state, const std::string& key,
+                         Callback done);
+
+  // Runs |body| with the warmed-up service, warming up first if needed.
+  static void WithService(const std::shared_ptr<State>& state,
+                          std::function<void(SecretService* service)> body);
+  static void FinishWarm(const std::shared_ptr<State>& state,
+                         SecretService* service);
+  static void StartLookup(std::unique_ptr<LookupRequest> request);
+  static void FinishLookup(std::unique_ptr<LookupRequest> request,
+                           SecretValue* secret, const GError* error);
+  static void ForgetItem(State* state, const std::string& key);
+
+  static void OnServiceReady(GObject* source, GAsyncResult* result,
+                             gpointer user_data);
+  static void OnCollectionReady(GObject* source, GAsyncResult* result,
+                                gpointer user_data);
+  static void OnUnlocked(GObject* source, GAsyncResult* result,
+                         gpointer user_data);
+  static void OnSearchDone(GObject* source, GAsyncResult* result,
+                           gpointer user_data);
+  static void OnSearchAllDone(GObject* source, GAsyncResult* result,
+                              gpointer user_data);
+  static void OnItemLoaded(GObject* source, GAsyncResult* result,
+                           gpointer user_data);
+  static void OnStoreDone(GObject* source, GAsyncResult* result,
+                          gpointer user_data);
+  static void OnClearDone(GObject* source, GAsyncResult* result,
+                          gpointer user_data);
+  static gboolean OnFlushTimeout(gpointer user_data);
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // SECRET_STORE_H_
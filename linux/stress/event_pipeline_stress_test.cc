@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "event_batcher.h"
+#include "mpsc_queue.h"
+#include "native_metrics.h"
+#include "stress_support.h"
+
+namespace flutter_mcp {
+namespace stress {
+
+namespace {
+
+struct Event {
+  uint32_t producer = 0;
+  uint32_t sequence = 0;
+  Clock::time_point posted;
+};
+
+// The main-thread half of the plugin's event path: which events reached
+// the sink, and whether each producer's arrived in order.
+class Sink {
+ public:
+  explicit Sink(size_t producers) : next_(producers, 0) {}
+
+  void Deliver(const Event& event) {
+    if (event.sequence != next_[event.producer]) {
+      out_of_order_++;
+    }
+    next_[event.producer] = event.sequence + 1;
+    if (listening_) {
+      delivered_++;
+      latency_.Record(MicrosBetween(event.posted, Clock::now()));
+    } else {
+      dropped_++;
+    }
+  }
+
+  void set_listening(bool listening) { listening_ = listening; }
+
+  size_t delivered() const { return delivered_; }
+  size_t dropped() const { return dropped_; }
+  size_t out_of_order() const { return out_of_order_; }
+  const LatencyHistogram& latency() const { return latency_; }
+
+ private:
+  // Only touched on the main loop, like the plugin's event_sink.
+  std::vector<uint32_t> next_;
+  bool listening_ = true;
+  size_t delivered_ = 0;
+  size_t dropped_ = 0;
+  size_t out_of_order_ = 0;
+  LatencyHistogram latency_;
+};
+
+}  // namespace
+
+// post_event() and drain_events_cb() with the listener cancelling and
+// re-listening throughout: every event is drained exactly once, in order,
+// and the push that finds the queue empty always schedules a drain.
+TEST(EventPipelineStress, DrainsEveryEventWhileTheListenerComesAndGoes) {
+  const size_t producers = StressThreads();
+  const size_t per_producer = Scaled(50000);
+  SimulatedMainLoop loop;
+  MpscQueue<Event> queue;
+  Sink sink(producers);
+  LatencyHistogram post_time;
+  std::atomic<size_t> drains{0};
+  std::atomic<bool> producing{true};
+
+  auto drain = [&] {
+    drains++;
+    queue.Drain([&](Event event) { sink.Deliver(event); });
+  };
+
+  std::thread listener([&] {
+    bool listening = true;
+    while (producing) {
+      listening = !listening;
+      loop.Post([&sink, listening] { sink.set_listening(listening); });
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    loop.Post([&sink] { sink.set_listening(true); });
+  });
+
+  const auto start = Clock::now();
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < producers; p++) {
+    threads.emplace_back([&, p] {
+      for (size_t i = 0; i < per_producer; i++) {
+        Event event;
+        event.producer = static_cast<uint32_t>(p);
+        event.sequence = static_cast<uint32_t>(i);
+        event.posted = Clock::now();
+        if (queue.Push(event)) {
+          loop.Post(drain);
+        }
+        post_time.Record(MicrosBetween(event.posted, Clock::now()));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  producing = false;
+  listener.join();
+  loop.Quiesce();
+  ReportThroughput("events_posted", producers * per_producer, Clock::now() - start);
+
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(sink.delivered() + sink.dropped(), producers * per_producer);
+  EXPECT_EQ(sink.out_of_order(), 0u);
+  std::printf("[ STRESS   ] %zu drains, %zu events dropped while cancelled\n", drains.load(),
+              sink.dropped());
+  ReportLatency("event_post", post_time);
+  ReportLatency("event_delivery", sink.latency());
+}
+
+// Producers add while another thread keeps reconfiguring batching: every
+// event is either flushed once or handed back for direct delivery, and
+// each type's flushed events stay in order.
+TEST(EventPipelineStress, BatcherLosesNothingWhileReconfigured) {
+  const size_t producers = StressThreads();
+  const size_t per_producer = Scaled(20000);
+  std::mutex flushed_mutex;
+  std::vector<uint32_t> next(producers, 0);
+  size_t flushed = 0;
+  size_t out_of_order = 0;
+  std::atomic<size_t> direct{0};
+
+  EventBatcher<Event> batcher(
+      [&](const std::string&, std::vector<Event>&& events, size_t) {
+        std::lock_guard<std::mutex> lock(flushed_mutex);
+        for (const auto& event : events) {
+          if (event.sequence < next[event.producer]) {
+            out_of_order++;
+          }
+          next[event.producer] = event.sequence + 1;
+          flushed++;
+        }
+      });
+  EventBatchingConfig config;
+  config.enabled = true;
+  batcher.Configure(config);
+
+  std::atomic<bool> producing{true};
+  std::thread configurer([&] {
+    std::minstd_rand random(7);
+    while (producing) {
+      EventBatchingConfig next_config;
+      next_config.enabled = random() % 4 != 0;
+      next_config.max_batch_size = 1 + random() % 64;
+      next_config.max_delay_ms = random() % 5;
+      batcher.Configure(next_config);
+      std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+  });
+
+  const auto start = Clock::now();
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < producers; p++) {
+    threads.emplace_back([&, p] {
+      const std::string type = "type-" + std::to_string(p);
+      for (size_t i = 0; i < per_producer; i++) {
+        Event event;
+        event.producer = static_cast<uint32_t>(p);
+        event.sequence = static_cast<uint32_t>(i);
+        if (!batcher.Add(type, std::move(event), false)) {
+          direct++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  producing = false;
+  configurer.join();
+  batcher.Configure(EventBatchingConfig());
+  ReportThroughput("events_batched", producers * per_producer, Clock::now() - start);
+
+  std::lock_guard<std::mutex> lock(flushed_mutex);
+  EXPECT_EQ(flushed + direct, producers * per_producer);
+  EXPECT_EQ(out_of_order, 0u);
+}
+
+}  // namespace stress
+}  // namespace flutter_mcp
@@ -0,0 +1,296 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "task_scheduler.h"
+#include "native_metrics.h"
+#include "stress_support.h"
+
+namespace flutter_mcp {
+namespace stress {
+
+namespace {
+
+// Per-task outcome flags, indexed by the task's slot.
+class Outcomes {
+ public:
+  explicit Outcomes(size_t count)
+      : fired_(new std::atomic<uint32_t>[count]()),
+        cancelled_(new std::atomic<bool>[count]()),
+        count_(count) {}
+
+  void Fire(size_t slot) {
+    if (fired_[slot].fetch_add(1) > 0) {
+      duplicates_++;
+    }
+    total_fired_++;
+  }
+  void Cancel(size_t slot) {
+    cancelled_[slot] = true;
+    total_cancelled_++;
+  }
+
+  size_t fired() const { return total_fired_; }
+  size_t cancelled() const { return total_cancelled_; }
+  size_t duplicates() const { return duplicates_; }
+
+  // Tasks that ran even though Cancel() reported them removed.
+  size_t FiredAfterCancel() const {
+    size_t count = 0;
+    for (size_t i = 0; i < count_; i++) {
+      if (cancelled_[i] && fired_[i] > 0) {
+        count++;
+      }
+    }
+    return count;
+  }
+
+ private:
+  std::unique_ptr<std::atomic<uint32_t>[]> fired_;
+  std::unique_ptr<std::atomic<bool>[]> cancelled_;
+  size_t count_;
+  std::atomic<size_t> total_fired_{0};
+  std::atomic<size_t> total_cancelled_{0};
+  std::atomic<size_t> duplicates_{0};
+};
+
+// Ids scheduled most recently, for cancellers to pick from.
+class RecentIds {
+ public:
+  void Add(const std::string& id, size_t slot) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (ids_.size() < kWindow) {
+      ids_.emplace_back(id, slot);
+    } else {
+      ids_[next_++ % kWindow] = std::make_pair(id, slot);
+    }
+  }
+
+  bool Pick(std::minstd_rand& random, std::pair<std::string, size_t>* picked) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (ids_.empty()) {
+      return false;
+    }
+    *picked = ids_[random() % ids_.size()];
+    return true;
+  }
+
+ private:
+  static constexpr size_t kWindow = 1024;
+  std::mutex mutex_;
+  std::vector<std::pair<std::string, size_t>> ids_;
+  size_t next_ = 0;
+};
+
+}  // namespace
+
+TEST(SchedulerStress, FiresEveryTaskOnceWithLowLateness) {
+  const size_t count = Scaled(100000);
+  const size_t threads = StressThreads();
+  TaskScheduler scheduler;
+  scheduler.SetWorkerThreads(4);
+  Outcomes outcomes(count);
+  LatencyHistogram lateness;
+  std::unique_ptr<Clock::time_point[]> due(new Clock::time_point[count]);
+
+  const auto start = Clock::now();
+  std::vector<std::thread> schedulers;
+  for (size_t t = 0; t < threads; t++) {
+    schedulers.emplace_back([&, t] {
+      std::minstd_rand random(static_cast<uint32_t>(t + 1));
+      for (size_t slot = t; slot < count; slot += threads) {
+        const int64_t delay_ms = random() % 500;
+        due[slot] = Clock::now() + std::chrono::milliseconds(delay_ms);
+        scheduler.Schedule("task-" + std::to_string(slot), delay_ms, [&, slot] {
+          lateness.Record(MicrosBetween(due[slot], Clock::now()));
+          outcomes.Fire(slot);
+        });
+      }
+    });
+  }
+  for (auto& thread : schedulers) {
+    thread.join();
+  }
+  ReportThroughput("schedule", count, Clock::now() - start);
+
+  EXPECT_TRUE(WaitUntil([&] { return outcomes.fired() >= count; },
+                        std::chrono::milliseconds(60000)));
+  EXPECT_EQ(outcomes.fired(), count);
+  EXPECT_EQ(outcomes.duplicates(), 0u);
+  EXPECT_EQ(scheduler.PendingCount(), 0u);
+  ReportLatency("fire_lateness", lateness);
+}
+
+TEST(SchedulerStress, DrainsABurstOfDueTasks) {
+  const size_t count = Scaled(100000);
+  TaskScheduler scheduler;
+  scheduler.SetWorkerThreads(4);
+  Outcomes outcomes(count);
+
+  const auto start = Clock::now();
+  for (size_t slot = 0; slot < count; slot++) {
+    scheduler.Schedule("burst-" + std::to_string(slot), 0, [&, slot] { outcomes.Fire(slot); });
+  }
+  EXPECT_TRUE(WaitUntil([&] { return outcomes.fired() >= count; },
+                        std::chrono::milliseconds(60000)));
+  ReportThroughput("burst_fired", outcomes.fired(), Clock::now() - start);
+  EXPECT_EQ(outcomes.duplicates(), 0u);
+}
+
+// Every task ends exactly one way: it fires, or Cancel() removes it.
+TEST(SchedulerStress, CancelChurnNeverLosesOrRevivesATask) {
+  const size_t threads = StressThreads();
+  const size_t per_thread = Scaled(20000) / threads;
+  const size_t count = per_thread * threads;
+  TaskScheduler scheduler;
+  scheduler.SetWorkerThreads(4);
+  Outcomes outcomes(count);
+  RecentIds recent;
+  std::atomic<bool> scheduling{true};
+
+  std::vector<std::thread> cancellers;
+  std::atomic<size_t> cancel_calls{0};
+  for (size_t t = 0; t < threads / 2; t++) {
+    cancellers.emplace_back([&, t] {
+      std::minstd_rand random(static_cast<uint32_t>(1000 + t));
+      std::pair<std::string, size_t> picked;
+      while (scheduling) {
+        if (!recent.Pick(random, &picked)) {
+          std::this_thread::yield();
+          continue;
+        }
+        cancel_calls++;
+        if (scheduler.Cancel(picked.first)) {
+          outcomes.Cancel(picked.second);
+        }
+      }
+    });
+  }
+
+  const auto start = Clock::now();
+  std::vector<std::thread> schedulers;
+  for (size_t t = 0; t < threads; t++) {
+    schedulers.emplace_back([&, t] {
+      std::minstd_rand random(static_cast<uint32_t>(t + 1));
+      for (size_t i = 0; i < per_thread; i++) {
+        const size_t slot = t * per_thread + i;
+        const std::string id = "churn-" + std::to_string(slot);
+        scheduler.Schedule(id, random() % 20, [&, slot] { outcomes.Fire(slot); });
+        recent.Add(id, slot);
+      }
+    });
+  }
+  for (auto& thread : schedulers) {
+    thread.join();
+  }
+  scheduling = false;
+  for (auto& thread : cancellers) {
+    thread.join();
+  }
+  ReportThroughput("schedule_and_cancel", count + cancel_calls, Clock::now() - start);
+
+  EXPECT_TRUE(WaitUntil([&] { return outcomes.fired() + outcomes.cancelled() >= count; },
+                        std::chrono::milliseconds(30000)));
+  EXPECT_EQ(outcomes.fired() + outcomes.cancelled(), count);
+  EXPECT_EQ(outcomes.duplicates(), 0u);
+  EXPECT_EQ(outcomes.FiredAfterCancel(), 0u);
+  EXPECT_EQ(scheduler.PendingCount(), 0u);
+}
+
+// Stop() drops whatever is pending while other threads keep scheduling;
+// nothing may run twice and the scheduler must come back afterwards.
+TEST(SchedulerStress, StopRacingScheduleKeepsTheSchedulerUsable) {
+  const size_t threads = StressThreads();
+  const size_t per_thread = Scaled(5000);
+  const size_t count = per_thread * threads;
+  TaskScheduler scheduler;
+  scheduler.SetWorkerThreads(2);
+  Outcomes outcomes(count);
+  std::atomic<bool> scheduling{true};
+  std::atomic<size_t> stops{0};
+
+  std::thread stopper([&] {
+    while (scheduling) {
+      scheduler.Stop();
+      stops++;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  std::vector<std::thread> schedulers;
+  for (size_t t = 0; t < threads; t++) {
+    schedulers.emplace_back([&, t] {
+      std::minstd_rand random(static_cast<uint32_t>(t + 1));
+      for (size_t i = 0; i < per_thread; i++) {
+        const size_t slot = t * per_thread + i;
+        scheduler.Schedule("stop-" + std::to_string(slot), random() % 5,
+                           [&, slot] { outcomes.Fire(slot); });
+      }
+    });
+  }
+  for (auto& thread : schedulers) {
+    thread.join();
+  }
+  scheduling = false;
+  stopper.join();
+  scheduler.Stop();
+  std::printf("[ STRESS   ] %zu stops, %zu of %zu tasks fired\n", stops.load(),
+              outcomes.fired(), count);
+
+  EXPECT_EQ(outcomes.duplicates(), 0u);
+  EXPECT_EQ(scheduler.PendingCount(), 0u);
+
+  std::atomic<bool> fired_after{false};
+  scheduler.Schedule("after-stop", 0, [&] { fired_after = true; });
+  EXPECT_TRUE(WaitUntil([&] { return fired_after.load(); }, std::chrono::milliseconds(5000)));
+}
+
+// Recurring jobs registered and cancelled from many threads all stop.
+TEST(SchedulerStress, RecurringChurnLeavesNoJobRunning) {
+  constexpr size_t kJobs = 64;
+  const size_t threads = StressThreads();
+  const size_t per_thread = Scaled(2000);
+  TaskScheduler scheduler;
+  scheduler.SetWorkerThreads(4);
+  std::atomic<size_t> runs{0};
+  Recurrence recurrence;
+  recurrence.period_ms = 1;
+
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      std::minstd_rand random(static_cast<uint32_t>(t + 1));
+      for (size_t i = 0; i < per_thread; i++) {
+        const std::string id = "job-" + std::to_string(random() % kJobs);
+        if (random() % 2) {
+          scheduler.ScheduleRecurring(id, 0, recurrence, [&] { runs++; });
+        } else {
+          scheduler.Cancel(id);
+        }
+      }
+    });
+  }
+  for (auto& thread : workers) {
+    thread.join();
+  }
+  for (size_t job = 0; job < kJobs; job++) {
+    scheduler.Cancel("job-" + std::to_string(job));
+  }
+
+  EXPECT_EQ(scheduler.RecurringCount(), 0u);
+  // Runs already in flight when their job was cancelled may still finish.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  const size_t settled = runs;
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(runs.load(), settled);
+  EXPECT_EQ(scheduler.PendingCount(), 0u);
+}
+
+}  // namespace stress
+}  // namespace flutter_mcp
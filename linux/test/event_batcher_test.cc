@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "event_batcher.h"
+
+namespace flutter_mcp {
+namespace test {
+
+namespace {
+
+struct Flushed {
+  std::string type;
+  std::vector<int> events;
+  size_t coalesced;
+};
+
+class FlushLog {
+ public:
+  EventBatcher<int>::FlushCallback Callback() {
+    return [this](const std::string& type, std::vector<int>&& events,
+                  size_t coalesced) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      flushes_.push_back(Flushed{type, std::move(events), coalesced});
+      cv_.notify_all();
+    };
+  }
+
+  bool WaitFor(size_t count, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cv_.wait_for(lock, timeout,
+                        [&] { return flushes_.size() >= count; });
+  }
+
+  std::vector<Flushed> flushes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return flushes_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<Flushed> flushes_;
+};
+
+EventBatchingConfig BatchingConfig(size_t size, int64_t delay_ms) {
+  EventBatchingConfig config;
+  config.enabled = true;
+  config.max_batch_size = size;
+  config.max_delay_ms = delay_ms;
+  return config;
+}
+
+}  // namespace
+
+TEST(EventBatcher, DisabledBatcherDoesNotTakeEvents) {
+  FlushLog log;
+  EventBatcher<int> batcher(log.Callback());
+  EXPECT_FALSE(batcher.Add("trayEvent", 1, false));
+  EXPECT_TRUE(log.flushes().empty());
+}
+
+TEST(EventBatcher, FlushesPerTypeWhenBatchIsFull) {
+  FlushLog log;
+  EventBatcher<int> batcher(log.Callback());
+  batcher.Configure(BatchingConfig(3, 60000));
+
+  EXPECT_TRUE(batcher.Add("a", 1, false));
+  EXPECT_TRUE(batcher.Add("b", 10, false));
+  EXPECT_TRUE(batcher.Add("a", 2, false));
+  EXPECT_TRUE(log.flushes().empty());
+  EXPECT_TRUE(batcher.Add("a", 3, false));
+
+  auto flushes = log.flushes();
+  ASSERT_EQ(flushes.size(), 1u);
+  EXPECT_EQ(flushes[0].type, "a");
+  EXPECT_EQ(flushes[0].events, (std::vector<int>{1, 2, 3}));
+}
+
+TEST(EventBatcher, FlushesAfterMaxDelay) {
+  FlushLog log;
+  EventBatcher<int> batcher(log.Callback());
+  batcher.Configure(BatchingConfig(100, 20));
+
+  batcher.Add("backgroundTaskResult", 1, false);
+  batcher.Add("backgroundTaskResult", 2, false);
+  ASSERT_TRUE(log.WaitFor(1, std::chrono::seconds(5)));
+
+  auto flushes = log.flushes();
+  EXPECT_EQ(flushes[0].events, (std::vector<int>{1, 2}));
+}
+
+TEST(EventBatcher, CoalescesConsecutivePeriodicEvents) {
+  FlushLog log;
+  EventBatcher<int> batcher(log.Callback());
+  EventBatchingConfig config = BatchingConfig(100, 60000);
+  config.coalesce_periodic = true;
+  batcher.Configure(config);
+
+  batcher.Add("backgroundEvent", 1, true);
+  batcher.Add("backgroundEvent", 2, true);
+  batcher.Add("backgroundEvent", 3, true);
+  batcher.Add("backgroundEvent", 4, false);
+  batcher.Add("backgroundEvent", 5, true);
+  batcher.FlushAll();
+
+  auto flushes = log.flushes();
+  ASSERT_EQ(flushes.size(), 1u);
+  EXPECT_EQ(flushes[0].events, (std::vector<int>{3, 4, 5}));
+  EXPECT_EQ(flushes[0].coalesced, 2u);
+}
+
+TEST(EventBatcher, DisablingFlushesBufferedEvents) {
+  FlushLog log;
+  EventBatcher<int> batcher(log.Callback());
+  batcher.Configure(BatchingConfig(100, 60000));
+  batcher.Add("a", 1, false);
+
+  batcher.Configure(EventBatchingConfig());
+  auto flushes = log.flushes();
+  ASSERT_EQ(flushes.size(), 1u);
+  EXPECT_EQ(flushes[0].events, (std::vector<int>{1}));
+  EXPECT_FALSE(batcher.Add("a", 2, false));
+}
+
+TEST(EventBatcher, KeepsOrderUnderConcurrentProducers) {
+  FlushLog log;
+  std::vector<int> received;
+  {
+    EventBatcher<int> batcher(log.Callback());
+    batcher.Configure(BatchingConfig(16, 1));
+
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < 4; producer++) {
+      producers.emplace_back([&batcher, producer] {
+        for (int i = 0; i < 1000; i++) {
+          batcher.Add("p" + std::to_string(producer), int(i), false);
+        }
+      });
+    }
+    for (auto& thread : producers) {
+      thread.join();
+    }
+  }
+
+  // Every producer's events arrive complete and in order.
+  for (int producer = 0; producer < 4; producer++) {
+    std::vector<int> events;
+    for (const auto& flush : log.flushes()) {
+      if (flush.type == "p" + std::to_string(producer)) {
+        events.insert(events.end(), flush.events.begin(), flush.events.end());
+      }
+    }
+    ASSERT_EQ(events.size(), 1000u);
+    for (int i = 0; i < 1000; i++) {
+      EXPECT_EQ(events[i], i);
+    }
+  }
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "event_filter.h"
+
+namespace flutter_mcp {
+namespace test {
+
+namespace {
+
+int CountAdmitted(EventFilter& filter, const char* type, int events) {
+  int admitted = 0;
+  for (int i = 0; i < events; i++) {
+    if (filter.Admit(type)) {
+      admitted++;
+    }
+  }
+  return admitted;
+}
+
+}  // namespace
+
+TEST(EventFilter, SendsEverythingUntilSubscribed) {
+  EventFilter filter;
+  EXPECT_EQ(CountAdmitted(filter, "backgroundEvent", 10), 10);
+  EXPECT_EQ(filter.filtered(), 0u);
+}
+
+TEST(EventFilter, OnlyListedTypesPass) {
+  EventFilter filter;
+  EventSubscription subscription;
+  subscription.all_types = false;
+  subscription.rates["trayEvent"] = 1.0;
+  filter.Subscribe(subscription);
+
+  EXPECT_TRUE(filter.Admit("trayEvent"));
+  EXPECT_FALSE(filter.Admit("backgroundEvent"));
+  EXPECT_FALSE(filter.Admit("metrics"));
+  EXPECT_EQ(filter.filtered(), 2u);
+
+  filter.Reset();
+  EXPECT_TRUE(filter.Admit("backgroundEvent"));
+}
+
+TEST(EventFilter, SamplesAtTheConfiguredRate) {
+  EventFilter filter;
+  EventSubscription subscription;
+  subscription.rates["backgroundEvent"] = 0.25;
+  subscription.rates["metrics"] = 0.0;
+  filter.Subscribe(subscription);
+
+  // Every fourth event, starting with the fourth.
+  EXPECT_FALSE(filter.Admit("backgroundEvent"));
+  EXPECT_FALSE(filter.Admit("backgroundEvent"));
+  EXPECT_FALSE(filter.Admit("backgroundEvent"));
+  EXPECT_TRUE(filter.Admit("backgroundEvent"));
+  EXPECT_EQ(CountAdmitted(filter, "backgroundEvent", 400), 100);
+
+  EXPECT_EQ(CountAdmitted(filter, "metrics", 5), 0);
+  // Unlisted types still pass when all types are subscribed.
+  EXPECT_TRUE(filter.Admit("trayEvent"));
+}
+
+TEST(EventFilter, SamplingHoldsAcrossThreads) {
+  EventFilter filter;
+  EventSubscription subscription;
+  subscription.rates["backgroundTaskResult"] = 0.1;
+  filter.Subscribe(subscription);
+
+  std::atomic<int> admitted(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&filter, &admitted] {
+      admitted += CountAdmitted(filter, "backgroundTaskResult", 2500);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(admitted, 1000);
+  EXPECT_EQ(filter.filtered(), 9000u);
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
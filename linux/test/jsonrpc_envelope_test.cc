@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "jsonrpc_envelope.h"
+
+namespace flutter_mcp {
+namespace test {
+
+namespace {
+
+// The envelope's slices point into |message|, so it must outlive them;
+// temporaries are rejected at compile time.
+JsonRpcEnvelope Parse(const std::string& message) {
+  JsonRpcEnvelope envelope;
+  ParseJsonRpcEnvelope(message.data(), message.size(), &envelope);
+  return envelope;
+}
+JsonRpcEnvelope Parse(std::string&& message) = delete;
+
+}  // namespace
+
+TEST(JsonRpcEnvelope, ClassifiesRequestsNotificationsAndResponses) {
+  const std::string request_message =
+      "{\"jsonrpc\":\"2.0\",\"id\":7,\"method\":\"tools/list\",\"params\":{}}";
+  const JsonRpcEnvelope request = Parse(request_message);
+  EXPECT_EQ(request.kind, JsonRpcEnvelope::Kind::kRequest);
+  EXPECT_EQ(request.id.str(), "7");
+  EXPECT_EQ(request.method.str(), "tools/list");
+  EXPECT_EQ(request.params.str(), "{}");
+
+  const std::string notification_message =
+      "{\"jsonrpc\":\"2.0\",\"method\":\"notifications/initialized\"}";
+  const JsonRpcEnvelope notification = Parse(notification_message);
+  EXPECT_EQ(notification.kind, JsonRpcEnvelope::Kind::kNotification);
+  EXPECT_TRUE(notification.id.empty());
+
+  const std::string response_message = "{\"jsonrpc\":\"2.0\",\"id\":\"a\",\"result\":{}}";
+  const JsonRpcEnvelope response = Parse(response_message);
+  EXPECT_EQ(response.kind, JsonRpcEnvelope::Kind::kResponse);
+  EXPECT_EQ(response.id.str(), "\"a\"");
+  EXPECT_FALSE(response.has_error);
+
+  const std::string error_message =
+      "{\"jsonrpc\":\"2.0\",\"id\":null,\"error\":{\"code\":-32700,\"message\":\"x\"}}";
+  const JsonRpcEnvelope error = Parse(error_message);
+  EXPECT_EQ(error.kind, JsonRpcEnvelope::Kind::kResponse);
+  EXPECT_EQ(error.id.str(), "null");
+  EXPECT_TRUE(error.has_error);
+}
+
+TEST(JsonRpcEnvelope, SkipsNestedValuesWhateverTheMemberOrder) {
+  // Long enough that the vector loops, not just their tails, find the
+  // quotes and brackets; the decoys only match at the top level.
+  const std::string message =
+      "{ \"result\" : {\"content\":[{\"type\":\"text\",\"text\":\"{\\\"id\\\":1, [\\\"method\\\"]"
+      " \\\\\"}, {\"nested\":[[[{\"id\":2,\"method\":\"decoy\"}]]]}]},\n"
+      "  \"jsonrpc\" : \"2.0\" ,\r\n  \"id\" : 42 }";
+  const JsonRpcEnvelope envelope = Parse(message);
+  EXPECT_EQ(envelope.kind, JsonRpcEnvelope::Kind::kResponse);
+  EXPECT_EQ(envelope.id.str(), "42");
+  EXPECT_TRUE(envelope.method.empty());
+}
+
+TEST(JsonRpcEnvelope, RejectsWhatIsNotOneJsonRpcObject) {
+  const std::vector<std::string> messages = {
+      "[{\"id\":1,\"method\":\"a\"}]",
+      "{\"id\":1,\"method\":\"a\"",
+      "{\"id\":1,\"method\":\"unterminated}",
+      "{\"id\":1,\"method\":3}",
+      "{\"id\":1}",
+      "",
+  };
+  for (const auto& message : messages) {
+    EXPECT_EQ(Parse(message).kind, JsonRpcEnvelope::Kind::kInvalid) << message;
+  }
+}
+
+TEST(JsonRpcEnvelope, FindsMembersOfParams) {
+  const std::string message =
+      "{\"method\":\"notifications/progress\",\"params\":{\"progress\":0.5,"
+      "\"progressToken\":\"upload-1\"}}";
+  const JsonRpcEnvelope envelope = Parse(message);
+  JsonSlice token;
+  ASSERT_TRUE(FindJsonMember(envelope.params, "progressToken", &token));
+  EXPECT_EQ(token.str(), "\"upload-1\"");
+  EXPECT_FALSE(FindJsonMember(envelope.params, "total", &token));
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "jsonrpc_router.h"
+
+namespace flutter_mcp {
+namespace test {
+
+namespace {
+
+void Route(JsonRpcRouter& router, const std::string& message, RoutedBatch* batch) {
+  router.Route(message.data(), message.size(), batch);
+}
+
+void Send(JsonRpcRouter& router, const std::string& message) {
+  router.OnOutgoing(message.data(), message.size());
+}
+
+std::string Progress(const std::string& token, int progress) {
+  return "{\"jsonrpc\":\"2.0\",\"method\":\"notifications/progress\",\"params\":{"
+         "\"progressToken\":" + token + ",\"progress\":" + std::to_string(progress) + "}}";
+}
+
+}  // namespace
+
+TEST(JsonRpcRouter, DropsUnsubscribedNotifications) {
+  RoutingRules rules;
+  rules.dropped_notifications = {"notifications/message"};
+  JsonRpcRouter router(rules);
+  RoutedBatch batch;
+  Route(router, "{\"method\":\"notifications/message\",\"params\":{}}", &batch);
+  Route(router, "{\"method\":\"notifications/tools/list_changed\"}", &batch);
+
+  EXPECT_EQ(batch.Take(),
+            std::vector<std::string>{"{\"method\":\"notifications/tools/list_changed\"}"});
+  EXPECT_EQ(router.counts().dropped_notifications, 1u);
+}
+
+TEST(JsonRpcRouter, KeepsTheNewestProgressPerToken) {
+  JsonRpcRouter router;
+  RoutedBatch batch;
+  for (int i = 1; i <= 50; i++) {
+    Route(router, Progress("\"a\"", i), &batch);
+    Route(router, Progress("7", i), &batch);
+  }
+  Route(router, "{\"method\":\"notifications/initialized\"}", &batch);
+
+  EXPECT_EQ(batch.Take(), (std::vector<std::string>{Progress("\"a\"", 50), Progress("7", 50),
+                                                    "{\"method\":\"notifications/initialized\"}"}));
+  EXPECT_EQ(router.counts().coalesced_progress, 98u);
+
+  // Each batch is coalesced on its own.
+  Route(router, Progress("\"a\"", 51), &batch);
+  EXPECT_EQ(batch.Take(), std::vector<std::string>{Progress("\"a\"", 51)});
+}
+
+TEST(JsonRpcRouter, MatchesResponsesToPendingRequests) {
+  JsonRpcRouter router;
+  Send(router, "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"tools/call\"}");
+  Send(router, "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"tools/call\"}");
+  Send(router, "{\"method\":\"notifications/cancelled\",\"params\":{\"requestId\":2}}");
+  EXPECT_EQ(router.pending_requests(), 1u);
+
+  RoutedBatch batch;
+  Route(router, "{\"id\":1,\"result\":{}}", &batch);
+  // Cancelled, then a duplicate, then never sent.
+  Route(router, "{\"id\":2,\"result\":{}}", &batch);
+  Route(router, "{\"id\":1,\"result\":{}}", &batch);
+  Route(router, "{\"id\":\"1\",\"result\":{}}", &batch);
+  Route(router, "{\"id\":null,\"error\":{\"code\":-32700}}", &batch);
+
+  EXPECT_EQ(batch.Take(), (std::vector<std::string>{"{\"id\":1,\"result\":{}}",
+                                                    "{\"id\":null,\"error\":{\"code\":-32700}}"}));
+  EXPECT_EQ(router.counts().unmatched_responses, 3u);
+  EXPECT_EQ(router.pending_requests(), 0u);
+}
+
+TEST(JsonRpcRouter, PassesThroughWhatItCannotRoute) {
+  RoutingRules rules;
+  rules.coalesce_progress = false;
+  rules.match_responses = false;
+  JsonRpcRouter router(rules);
+  RoutedBatch batch;
+  Route(router, "[{\"id\":1,\"result\":{}}]", &batch);
+  Route(router, "not json", &batch);
+  Route(router, "{\"id\":9,\"result\":{}}", &batch);
+  Route(router, Progress("1", 1), &batch);
+  Route(router, Progress("1", 2), &batch);
+
+  EXPECT_EQ(batch.Take().size(), 5u);
+  EXPECT_EQ(router.counts().unmatched_responses, 0u);
+  EXPECT_EQ(router.counts().coalesced_progress, 0u);
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "message_framer.h"
+
+namespace flutter_mcp {
+namespace test {
+
+namespace {
+
+std::vector<std::string> FeedAll(MessageFramer& framer, const std::string& bytes,
+                                 bool* ok = nullptr) {
+  std::vector<std::string> messages;
+  const bool fed = framer.Feed(bytes.data(), bytes.size(), [&messages](const char* data,
+                                                                       size_t length) {
+    messages.emplace_back(data, length);
+  });
+  if (ok) {
+    *ok = fed;
+  }
+  return messages;
+}
+
+}  // namespace
+
+TEST(MessageFramer, SplitsNewlineDelimitedMessages) {
+  MessageFramer framer(Framing::kNewline);
+
+  EXPECT_EQ(FeedAll(framer, "{\"id\":1}\n{\"id\":2}\r\n\n{\"id\""),
+            (std::vector<std::string>{"{\"id\":1}", "{\"id\":2}"}));
+  EXPECT_EQ(framer.buffered(), 5u);
+  EXPECT_EQ(FeedAll(framer, ":3}\n"), std::vector<std::string>{"{\"id\":3}"});
+  EXPECT_EQ(framer.buffered(), 0u);
+}
+
+TEST(MessageFramer, JoinsALineSplitAcrossManyReads) {
+  MessageFramer framer(Framing::kNewline);
+  const std::string line(10000, 'x');
+
+  for (size_t i = 0; i < line.size(); i += 7) {
+    EXPECT_TRUE(FeedAll(framer, line.substr(i, 7)).empty());
+  }
+  EXPECT_EQ(FeedAll(framer, "\n"), std::vector<std::string>{line});
+}
+
+TEST(MessageFramer, SplitsContentLengthMessages) {
+  MessageFramer framer(Framing::kContentLength);
+
+  EXPECT_EQ(FeedAll(framer, "Content-Length: 2\r\n\r\n{}content-length:5\r\n"
+                            "Content-Type: application/json\r\n\r\n[1,"),
+            std::vector<std::string>{"{}"});
+  EXPECT_EQ(FeedAll(framer, "2]Content-Length: 0\r\n\r\n"),
+            (std::vector<std::string>{"[1,2]", ""}));
+}
+
+TEST(MessageFramer, FailsOnAHeaderWithoutLength) {
+  MessageFramer framer(Framing::kContentLength);
+  bool ok = true;
+
+  FeedAll(framer, "Content-Type: application/json\r\n\r\n{}", &ok);
+
+  EXPECT_FALSE(ok);
+  EXPECT_TRUE(framer.failed());
+  FeedAll(framer, "Content-Length: 2\r\n\r\n{}", &ok);
+  EXPECT_FALSE(ok);
+}
+
+TEST(MessageFramer, FailsOnAnOversizedMessage) {
+  MessageFramer lines(Framing::kNewline, 16);
+  MessageFramer content(Framing::kContentLength, 16);
+  bool ok = true;
+
+  FeedAll(lines, std::string(40000, 'x'), &ok);
+  EXPECT_FALSE(ok);
+  FeedAll(content, "Content-Length: 17\r\n\r\n", &ok);
+  EXPECT_FALSE(ok);
+}
+
+TEST(MessageFramer, FramesOutgoingMessages) {
+  EXPECT_EQ(FramePrefix(Framing::kNewline, 5), "");
+  EXPECT_STREQ(FrameSuffix(Framing::kNewline), "\n");
+  EXPECT_EQ(FramePrefix(Framing::kContentLength, 5), "Content-Length: 5\r\n\r\n");
+  EXPECT_STREQ(FrameSuffix(Framing::kContentLength), "");
+  EXPECT_EQ(ParseFraming("contentLength"), Framing::kContentLength);
+  EXPECT_EQ(ParseFraming(nullptr), Framing::kNewline);
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
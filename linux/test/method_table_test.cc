@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "method_table.h"
+
+namespace flutter_mcp {
+namespace test {
+
+TEST(MethodTable, EveryRegisteredNameRoundTrips) {
+  for (size_t i = 0; i < static_cast<size_t>(Method::kUnknown); i++) {
+    Method method = static_cast<Method>(i);
+    EXPECT_EQ(LookupMethod(MethodName(method)), method) << MethodName(method);
+  }
+}
+
+TEST(MethodTable, KnownNamesMapToTheirMethods) {
+  EXPECT_EQ(LookupMethod("secureRead"), Method::kSecureRead);
+  EXPECT_EQ(LookupMethod("scheduleBackgroundTask"),
+            Method::kScheduleBackgroundTask);
+  EXPECT_STREQ(MethodName(Method::kShutdown), "shutdown");
+}
+
+TEST(MethodTable, UnknownNamesAreRejected) {
+  EXPECT_EQ(LookupMethod(nullptr), Method::kUnknown);
+  EXPECT_EQ(LookupMethod(""), Method::kUnknown);
+  EXPECT_EQ(LookupMethod("secureReadX"), Method::kUnknown);
+  EXPECT_EQ(LookupMethod("SECUREREAD"), Method::kUnknown);
+  EXPECT_STREQ(MethodName(Method::kUnknown), "");
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "mpsc_queue.h"
+
+namespace flutter_mcp {
+namespace test {
+
+TEST(MpscQueue, DrainsInPushOrder) {
+  MpscQueue<int> queue;
+  EXPECT_TRUE(queue.Push(1));
+  EXPECT_FALSE(queue.Push(2));
+  EXPECT_FALSE(queue.Push(3));
+
+  std::vector<int> drained;
+  EXPECT_EQ(queue.Drain([&](int value) { drained.push_back(value); }), 3u);
+  EXPECT_EQ(drained, (std::vector<int>{1, 2, 3}));
+  EXPECT_TRUE(queue.empty());
+
+  // The next push after a drain must schedule another one.
+  EXPECT_TRUE(queue.Push(4));
+}
+
+TEST(MpscQueue, DestructorReleasesQueuedItems) {
+  auto item = std::make_shared<int>(7);
+  {
+    MpscQueue<std::shared_ptr<int>> queue;
+    queue.Push(item);
+    queue.Push(item);
+    EXPECT_EQ(item.use_count(), 3);
+  }
+  EXPECT_EQ(item.use_count(), 1);
+}
+
+TEST(MpscQueue, ConcurrentProducersKeepPerProducerOrder) {
+  constexpr int kProducers = 4;
+  constexpr int kPerProducer = 20000;
+  MpscQueue<std::pair<int, int>> queue;
+  std::atomic<int> drains_scheduled(0);
+  std::atomic<bool> done(false);
+
+  std::vector<int> next(kProducers, 0);
+  size_t received = 0;
+  bool in_order = true;
+  std::thread consumer([&] {
+    auto consume = [&](std::pair<int, int> item) {
+      in_order = in_order && item.second == next[item.first];
+      next[item.first] = item.second + 1;
+      received++;
+    };
+    while (!done) {
+      queue.Drain(consume);
+    }
+    queue.Drain(consume);
+  });
+
+  std::vector<std::thread> producers;
+  for (int producer = 0; producer < kProducers; producer++) {
+    producers.emplace_back([&, producer] {
+      for (int i = 0; i < kPerProducer; i++) {
+        if (queue.Push(std::make_pair(producer, i))) {
+          drains_scheduled++;
+        }
+      }
+    });
+  }
+  for (auto& thread : producers) {
+    thread.join();
+  }
+  done = true;
+  consumer.join();
+
+  EXPECT_TRUE(in_order);
+  EXPECT_EQ(received, static_cast<size_t>(kProducers * kPerProducer));
+  EXPECT_GE(drains_scheduled, 1);
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "native_metrics.h"
+
+namespace flutter_mcp {
+namespace test {
+
+TEST(LatencyHistogram, BucketsCoverValuesWithBoundedError) {
+  for (uint64_t value : {0ull, 1ull, 7ull, 8ull, 9ull, 15ull, 16ull, 100ull,
+                         1000ull, 123456ull, 1ull << 30}) {
+    const size_t bucket = LatencyHistogram::BucketFor(value);
+    const uint64_t upper = LatencyHistogram::UpperBound(bucket);
+    EXPECT_GE(upper, value) << value;
+    EXPECT_LE(static_cast<double>(upper), value * 1.125 + 1) << value;
+    if (bucket > 0) {
+      EXPECT_LT(LatencyHistogram::UpperBound(bucket - 1), value) << value;
+    }
+  }
+  EXPECT_EQ(LatencyHistogram::BucketFor(UINT64_MAX), LatencyHistogram::kBucketCount - 1);
+}
+
+TEST(LatencyHistogram, PercentilesTrackTheDistribution) {
+  LatencyHistogram histogram;
+  for (int i = 1; i <= 1000; i++) {
+    histogram.Record(i);
+  }
+
+  const HistogramSnapshot snapshot = histogram.Snapshot();
+  EXPECT_EQ(snapshot.count, 1000u);
+  EXPECT_EQ(snapshot.min, 1u);
+  EXPECT_EQ(snapshot.max, 1000u);
+  EXPECT_DOUBLE_EQ(snapshot.mean(), 500.5);
+  EXPECT_NEAR(static_cast<double>(snapshot.p50), 500, 500 * 0.125);
+  EXPECT_NEAR(static_cast<double>(snapshot.p90), 900, 900 * 0.125);
+  EXPECT_NEAR(static_cast<double>(snapshot.p99), 990, 990 * 0.125);
+  EXPECT_LE(snapshot.p999, 1000u);
+}
+
+TEST(LatencyHistogram, EmptyAndReset) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.Snapshot().count, 0u);
+
+  histogram.Record(-5);
+  histogram.Record(42);
+  EXPECT_EQ(histogram.Snapshot().min, 0u);
+
+  histogram.Reset();
+  const HistogramSnapshot snapshot = histogram.Snapshot();
+  EXPECT_EQ(snapshot.count, 0u);
+  EXPECT_EQ(snapshot.max, 0u);
+}
+
+TEST(NativeMetrics, MethodHistogramsAreCreatedOnFirstUse) {
+  NativeMetrics metrics;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&metrics] {
+      for (int i = 0; i < 1000; i++) {
+        metrics.RecordMethod(Method::kSecureRead, i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  metrics.RecordMethod(Method::kUnknown, 1);
+
+  std::vector<std::string> names;
+  uint64_t count = 0;
+  metrics.ForEachMethod([&](const char* name, const LatencyHistogram& histogram) {
+    names.push_back(name);
+    count = histogram.Snapshot().count;
+  });
+  EXPECT_EQ(names, std::vector<std::string>{"secureRead"});
+  EXPECT_EQ(count, 4000u);
+}
+
+TEST(NativeMetrics, SubsystemInitIsRecordedOnce) {
+  NativeMetrics metrics;
+  EXPECT_EQ(metrics.subsystem_init_us(Subsystem::kTray), -1);
+
+  metrics.RecordSubsystemInit(Subsystem::kSecureStorage, 1500);
+  metrics.RecordSubsystemInit(Subsystem::kSecureStorage, 9000);
+  metrics.RecordSubsystemInit(Subsystem::kBackground, -5);
+  metrics.Reset();
+
+  std::vector<std::string> names;
+  std::vector<int64_t> micros;
+  metrics.ForEachSubsystem([&](const char* name, int64_t init_us) {
+    names.push_back(name);
+    micros.push_back(init_us);
+  });
+  EXPECT_EQ(names, (std::vector<std::string>{"secureStorage", "background"}));
+  EXPECT_EQ(micros, (std::vector<int64_t>{1500, 0}));
+}
+
+TEST(Gauge, TracksHighWaterMark) {
+  Gauge gauge;
+  gauge.Add(3);
+  gauge.Add(-2);
+  gauge.Add(1);
+  EXPECT_EQ(gauge.value(), 2);
+  EXPECT_EQ(gauge.max(), 3);
+  gauge.ResetMax();
+  EXPECT_EQ(gauge.max(), 2);
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
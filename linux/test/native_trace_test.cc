@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "native_trace.h"
+
+namespace flutter_mcp {
+namespace test {
+
+namespace {
+
+size_t CountOf(const std::string& text, const std::string& needle) {
+  size_t count = 0;
+  for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1)) {
+    count++;
+  }
+  return count;
+}
+
+}  // namespace
+
+TEST(NativeTracer, RecordsNothingWhileStopped) {
+  NativeTracer& tracer = NativeTracer::Instance();
+  EXPECT_EQ(NativeTracer::Begin(), 0);
+  { TraceSpan span(TraceCategory::kMethod, "ignored"); }
+
+  tracer.Start();
+  const TraceDump dump = tracer.Stop(1);
+  EXPECT_EQ(dump.events, 0u);
+  EXPECT_EQ(CountOf(dump.json, "ignored"), 0u);
+}
+
+TEST(NativeTracer, ExportsCompleteEventsPerThread) {
+  NativeTracer& tracer = NativeTracer::Instance();
+  tracer.Start();
+  { TraceSpan span(TraceCategory::kMethod, "showNotification"); }
+  std::thread worker([] {
+    NativeTracer::NameThread("test \"worker\"");
+    TraceSpan span(TraceCategory::kTask, "run");
+  });
+  worker.join();
+  const TraceDump dump = tracer.Stop(4242);
+
+  EXPECT_EQ(dump.events, 2u);
+  EXPECT_EQ(dump.dropped, 0u);
+  EXPECT_EQ(dump.json.find("{\"displayTimeUnit\""), 0u);
+  EXPECT_EQ(CountOf(dump.json, "\"ph\":\"X\""), 2u);
+  EXPECT_EQ(CountOf(dump.json, "\"name\":\"showNotification\",\"cat\":\"method\""), 1u);
+  EXPECT_EQ(CountOf(dump.json, "\"name\":\"run\",\"cat\":\"task\""), 1u);
+  EXPECT_EQ(CountOf(dump.json, "\"args\":{\"name\":\"test \\\"worker\\\"\"}"), 1u);
+  EXPECT_EQ(CountOf(dump.json, "\"pid\":4242"), 3u);
+}
+
+TEST(NativeTracer, KeepsTheNewestSpansWhenABufferWraps) {
+  NativeTracer& tracer = NativeTracer::Instance();
+  tracer.Start();
+  const size_t extra = 10;
+  for (size_t i = 0; i < NativeTracer::kRecordsPerThread + extra; i++) {
+    tracer.Record(TraceCategory::kEvents, "post", static_cast<int64_t>(i + 1), 1);
+  }
+  const TraceDump dump = tracer.Stop(1);
+
+  EXPECT_EQ(dump.events, static_cast<size_t>(NativeTracer::kRecordsPerThread));
+  EXPECT_EQ(dump.dropped, extra);
+  EXPECT_EQ(CountOf(dump.json, "\"ts\":1,"), 0u);
+  EXPECT_EQ(CountOf(dump.json, "\"ts\":" + std::to_string(extra + 1) + ","), 1u);
+}
+
+TEST(NativeTracer, StartDiscardsTheEarlierTrace) {
+  NativeTracer& tracer = NativeTracer::Instance();
+  tracer.Start();
+  { TraceSpan span(TraceCategory::kTray, "first"); }
+  tracer.Stop(1);
+
+  tracer.Start();
+  { TraceSpan span(TraceCategory::kTray, "second"); }
+  const TraceDump dump = tracer.Stop(1);
+  EXPECT_EQ(dump.events, 1u);
+  EXPECT_EQ(CountOf(dump.json, "first"), 0u);
+}
+
+TEST(NativeTracer, StopsWhileOtherThreadsRecord) {
+  NativeTracer& tracer = NativeTracer::Instance();
+  std::atomic<bool> running(true);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&running] {
+      while (running) {
+        TraceSpan span(TraceCategory::kScheduler, "dispatch");
+      }
+    });
+  }
+  for (int round = 0; round < 5; round++) {
+    tracer.Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    const TraceDump dump = tracer.Stop(1);
+    EXPECT_EQ(CountOf(dump.json, "\"ph\":\"X\""), dump.events);
+  }
+  running = false;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "notification_throttle.h"
+
+namespace flutter_mcp {
+namespace test {
+
+namespace {
+
+NotificationRequest Request(const std::string& id, const std::string& group = "") {
+  NotificationRequest request;
+  request.id = id;
+  request.title = "title " + id;
+  request.body = "body " + id;
+  request.group_key = group;
+  return request;
+}
+
+NotificationPolicy Policy(size_t burst, double rate_per_second) {
+  NotificationPolicy policy;
+  policy.burst = burst;
+  policy.rate_per_second = rate_per_second;
+  policy.group_window_ms = 1000;
+  policy.max_pending = 4;
+  return policy;
+}
+
+std::vector<std::string> Ids(const std::vector<NotificationAction>& actions) {
+  std::vector<std::string> ids;
+  for (const auto& action : actions) {
+    ids.push_back(action.id);
+  }
+  return ids;
+}
+
+}  // namespace
+
+TEST(NotificationThrottle, BurstThenRefillInArrivalOrder) {
+  NotificationThrottle throttle(0);
+  throttle.Configure(Policy(2, 1.0), 0);
+
+  EXPECT_EQ(Ids(throttle.Submit(Request("a"), 0)), std::vector<std::string>{"a"});
+  EXPECT_EQ(Ids(throttle.Submit(Request("b"), 0)), std::vector<std::string>{"b"});
+  EXPECT_TRUE(throttle.Submit(Request("c"), 0).empty());
+  EXPECT_TRUE(throttle.Submit(Request("d"), 0).empty());
+  EXPECT_EQ(throttle.pending_count(), 2u);
+
+  EXPECT_TRUE(throttle.Flush(500).empty());
+  EXPECT_EQ(Ids(throttle.Flush(1000)), std::vector<std::string>{"c"});
+  EXPECT_EQ(Ids(throttle.Flush(2000)), std::vector<std::string>{"d"});
+  EXPECT_FALSE(throttle.HasPendingWork());
+}
+
+TEST(NotificationThrottle, SameIdUpdatesInPlaceWithoutToken) {
+  NotificationThrottle throttle(0);
+  throttle.Configure(Policy(1, 0.0), 0);
+
+  EXPECT_EQ(throttle.Submit(Request("job"), 0).size(), 1u);
+  for (int i = 0; i < 10; i++) {
+    auto actions = throttle.Submit(Request("job"), 0);
+    ASSERT_EQ(actions.size(), 1u);
+    EXPECT_EQ(actions[0].id, "job");
+  }
+  // The bucket is empty, so a different id has to wait.
+  EXPECT_TRUE(throttle.Submit(Request("other"), 0).empty());
+}
+
+TEST(NotificationThrottle, GroupCoalescesIntoOneSummary) {
+  NotificationThrottle throttle(0);
+  throttle.Configure(Policy(5, 1.0), 0);
+
+  auto first = throttle.Submit(Request("1", "builds"), 0);
+  ASSERT_EQ(first.size(), 1u);
+  EXPECT_EQ(first[0].id, NotificationThrottle::GroupId("builds"));
+  EXPECT_EQ(first[0].body, "body 1");
+
+  for (int i = 2; i <= 50; i++) {
+    EXPECT_TRUE(throttle.Submit(Request(std::to_string(i), "builds"), 10).empty());
+  }
+
+  auto summary = throttle.Flush(100);
+  ASSERT_EQ(summary.size(), 1u);
+  EXPECT_EQ(summary[0].id, NotificationThrottle::GroupId("builds"));
+  EXPECT_EQ(summary[0].body, "50 new events");
+  EXPECT_EQ(summary[0].title, "title 50");
+
+  // Nothing new, nothing to update.
+  EXPECT_TRUE(throttle.Flush(200).empty());
+}
+
+TEST(NotificationThrottle, QuietGroupStartsANewNotification) {
+  NotificationThrottle throttle(0);
+  throttle.Configure(Policy(5, 1.0), 0);
+
+  EXPECT_EQ(throttle.Submit(Request("1", "sync"), 0).size(), 1u);
+  EXPECT_TRUE(throttle.Flush(1500).empty());
+  EXPECT_FALSE(throttle.HasPendingWork());
+
+  auto again = throttle.Submit(Request("2", "sync"), 1600);
+  ASSERT_EQ(again.size(), 1u);
+  EXPECT_EQ(again[0].body, "body 2");
+}
+
+TEST(NotificationThrottle, OverflowFoldsIntoSummary) {
+  NotificationThrottle throttle(0);
+  throttle.Configure(Policy(1, 1.0), 0);
+
+  EXPECT_EQ(throttle.Submit(Request("first"), 0).size(), 1u);
+  for (int i = 0; i < 20; i++) {
+    throttle.Submit(Request("n" + std::to_string(i)), 0);
+  }
+  // Four individual requests plus one overflow summary.
+  EXPECT_EQ(throttle.pending_count(), 5u);
+
+  std::vector<NotificationAction> shown;
+  for (int64_t t = 1000; t <= 5000; t += 1000) {
+    auto actions = throttle.Flush(t);
+    shown.insert(shown.end(), actions.begin(), actions.end());
+  }
+  ASSERT_EQ(shown.size(), 5u);
+  EXPECT_EQ(shown.back().id,
+            NotificationThrottle::GroupId(NotificationThrottle::kOverflowGroup));
+  EXPECT_EQ(shown.back().body, "16 new events");
+}
+
+TEST(NotificationThrottle, DisabledShowsEverything) {
+  NotificationThrottle throttle(0);
+  NotificationPolicy policy = Policy(1, 0.0);
+  policy.enabled = false;
+  throttle.Configure(policy, 0);
+
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(throttle.Submit(Request(std::to_string(i), "g"), 0).size(), 1u);
+  }
+}
+
+TEST(NotificationThrottle, DismissedGroupPopsAgain) {
+  NotificationThrottle throttle(0);
+  throttle.Configure(Policy(5, 1.0), 0);
+
+  EXPECT_EQ(throttle.Submit(Request("1", "g"), 0).size(), 1u);
+  throttle.Dismissed(NotificationThrottle::GroupId("g"));
+  EXPECT_EQ(throttle.Submit(Request("2", "g"), 10).size(), 1u);
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
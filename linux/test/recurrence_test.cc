@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <random>
+
+#include "recurrence.h"
+
+namespace flutter_mcp {
+namespace test {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+Recurrence Every(int64_t period_ms, RecurrenceMode mode, OverrunPolicy overrun) {
+  Recurrence recurrence;
+  recurrence.mode = mode;
+  recurrence.period_ms = period_ms;
+  recurrence.overrun = overrun;
+  return recurrence;
+}
+
+}  // namespace
+
+TEST(Recurrence, FixedRateKeepsItsSlotsRegardlessOfRunTime) {
+  const Recurrence recurrence =
+      Every(100, RecurrenceMode::kFixedRate, OverrunPolicy::kSkip);
+  const Clock::time_point start = Clock::now();
+
+  EXPECT_EQ(NextNominalRun(recurrence, start, start + milliseconds(30)),
+            start + milliseconds(100));
+}
+
+TEST(Recurrence, FixedRateSkipsMissedSlots) {
+  const Recurrence recurrence =
+      Every(100, RecurrenceMode::kFixedRate, OverrunPolicy::kSkip);
+  const Clock::time_point start = Clock::now();
+
+  EXPECT_EQ(NextNominalRun(recurrence, start, start + milliseconds(350)),
+            start + milliseconds(400));
+}
+
+TEST(Recurrence, FixedRateCatchesUpMissedSlots) {
+  const Recurrence recurrence =
+      Every(100, RecurrenceMode::kFixedRate, OverrunPolicy::kCatchUp);
+  const Clock::time_point start = Clock::now();
+
+  Clock::time_point next = NextNominalRun(recurrence, start, start + milliseconds(350));
+  EXPECT_EQ(next, start + milliseconds(100));
+  next = NextNominalRun(recurrence, next, start + milliseconds(351));
+  EXPECT_EQ(next, start + milliseconds(200));
+}
+
+TEST(Recurrence, FixedDelayCountsFromTheEndOfTheRun) {
+  const Recurrence recurrence =
+      Every(100, RecurrenceMode::kFixedDelay, OverrunPolicy::kSkip);
+  const Clock::time_point start = Clock::now();
+
+  EXPECT_EQ(NextNominalRun(recurrence, start, start + milliseconds(30)),
+            start + milliseconds(130));
+}
+
+TEST(Recurrence, NonPositivePeriodStillAdvances) {
+  const Recurrence recurrence =
+      Every(0, RecurrenceMode::kFixedRate, OverrunPolicy::kCatchUp);
+  const Clock::time_point start = Clock::now();
+
+  EXPECT_EQ(NextNominalRun(recurrence, start, start), start + milliseconds(1));
+}
+
+TEST(Recurrence, JitterStaysInRange) {
+  Recurrence recurrence;
+  std::minstd_rand engine(7);
+  EXPECT_EQ(DrawJitter(recurrence, engine), milliseconds(0));
+
+  recurrence.jitter_ms = 25;
+  for (int i = 0; i < 1000; i++) {
+    const milliseconds jitter = DrawJitter(recurrence, engine);
+    EXPECT_GE(jitter, milliseconds(0));
+    EXPECT_LE(jitter, milliseconds(25));
+  }
+}
+
+TEST(Recurrence, ParsesNames) {
+  EXPECT_EQ(ParseRecurrenceMode("fixedDelay"), RecurrenceMode::kFixedDelay);
+  EXPECT_EQ(ParseRecurrenceMode("fixedRate"), RecurrenceMode::kFixedRate);
+  EXPECT_EQ(ParseRecurrenceMode(nullptr), RecurrenceMode::kFixedRate);
+  EXPECT_EQ(ParseOverrunPolicy("catchUp"), OverrunPolicy::kCatchUp);
+  EXPECT_EQ(ParseOverrunPolicy("skip"), OverrunPolicy::kSkip);
+  EXPECT_EQ(ParseOverrunPolicy(""), OverrunPolicy::kSkip);
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "secret_cache.h"
+
+namespace flutter_mcp {
+namespace test {
+
+namespace {
+
+SecretCacheConfig Enabled(size_t max_entries, int64_t ttl_ms) {
+  SecretCacheConfig config;
+  config.enabled = true;
+  config.max_entries = max_entries;
+  config.ttl_ms = ttl_ms;
+  return config;
+}
+
+}  // namespace
+
+TEST(SecretCache, DisabledCacheStoresNothing) {
+  SecretCache cache;
+  cache.Put("token", "secret");
+
+  std::string value;
+  EXPECT_FALSE(cache.Lookup("token", value));
+  EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(SecretCache, EvictsLeastRecentlyUsed) {
+  SecretCache cache;
+  cache.Configure(Enabled(2, 60000));
+  cache.Put("a", "1");
+  cache.Put("b", "2");
+
+  // Touching "a" leaves "b" as the eviction candidate.
+  std::string value;
+  ASSERT_TRUE(cache.Lookup("a", value));
+  cache.Put("c", "3");
+
+  EXPECT_TRUE(cache.Lookup("a", value));
+  EXPECT_EQ(value, "1");
+  EXPECT_FALSE(cache.Lookup("b", value));
+  EXPECT_TRUE(cache.Lookup("c", value));
+  EXPECT_EQ(cache.size(), 2u);
+}
+
+TEST(SecretCache, ExpiredValuesAreDropped) {
+  SecretCache cache;
+  cache.Configure(Enabled(8, 20));
+  cache.Put("token", "secret");
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(40));
+  std::string value;
+  EXPECT_FALSE(cache.Lookup("token", value));
+  EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(SecretCache, InvalidateAndClearRemoveValues) {
+  SecretCache cache;
+  cache.Configure(Enabled(8, 60000));
+  cache.Put("a", "1");
+  cache.Put("b", "2");
+  cache.Put("a", "updated");
+
+  std::string value;
+  ASSERT_TRUE(cache.Lookup("a", value));
+  EXPECT_EQ(value, "updated");
+
+  cache.Invalidate("a");
+  EXPECT_FALSE(cache.Lookup("a", value));
+  EXPECT_TRUE(cache.Lookup("b", value));
+
+  cache.Clear();
+  EXPECT_FALSE(cache.Lookup("b", value));
+}
+
+TEST(SecretCache, ShrinkingAndDisablingEvict) {
+  SecretCache cache;
+  cache.Configure(Enabled(4, 60000));
+  cache.Put("a", "1");
+  cache.Put("b", "2");
+  cache.Put("c", "3");
+
+  cache.Configure(Enabled(1, 60000));
+  EXPECT_EQ(cache.size(), 1u);
+  std::string value;
+  EXPECT_TRUE(cache.Lookup("c", value));
+
+  cache.Configure(SecretCacheConfig());
+  EXPECT_EQ(cache.size(), 0u);
+  EXPECT_FALSE(cache.enabled());
+}
+
+TEST(SecretCache, HoldsBinaryValues) {
+  SecretCache cache;
+  cache.Configure(Enabled(8, 60000));
+  EXPECT_TRUE(cache.enabled());
+  const std::string blob("\x00\xff\x00key", 6);
+  cache.Put("blob", blob);
+
+  std::string value;
+  ASSERT_TRUE(cache.Lookup("blob", value));
+  EXPECT_EQ(value, blob);
+}
+
+TEST(SecretCache, SecureZeroClearsValue) {
+  std::string value = "a long enough secret to live on the heap";
+  SecureZero(value);
+  EXPECT_TRUE(value.empty());
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
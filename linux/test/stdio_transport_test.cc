@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+
+#include <signal.h>
+
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "transport/stdio_transport.h"
+
+namespace flutter_mcp {
+namespace test {
+
+namespace {
+
+// Collects what the reactor reports and lets the test wait for it.
+class Recorder {
+ public:
+  StdioTransport::MessagesCallback OnMessages() {
+    return [this](const std::string& server_id, StdioTransport::Stream stream,
+                  std::vector<std::string>&& messages) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto& into = stream == StdioTransport::Stream::kStdout ? messages_ : lines_;
+      into[server_id].insert(into[server_id].end(), messages.begin(), messages.end());
+      batches_++;
+      cv_.notify_all();
+    };
+  }
+
+  StdioTransport::ExitCallback OnExit() {
+    return [this](const std::string& server_id, int exit_code) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      exit_codes_[server_id] = exit_code;
+      cv_.notify_all();
+    };
+  }
+
+  std::vector<std::string> WaitForMessages(const std::string& server_id, size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait_for(lock, std::chrono::seconds(5),
+                 [&] { return messages_[server_id].size() >= count; });
+    return messages_[server_id];
+  }
+
+  std::vector<std::string> WaitForLines(const std::string& server_id, size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait_for(lock, std::chrono::seconds(5),
+                 [&] { return lines_[server_id].size() >= count; });
+    return lines_[server_id];
+  }
+
+  // INT_MIN if the server did not exit in time.
+  int WaitForExit(const std::string& server_id) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait_for(lock, std::chrono::seconds(5),
+                 [&] { return exit_codes_.count(server_id) > 0; });
+    return exit_codes_.count(server_id) > 0 ? exit_codes_[server_id] : INT_MIN;
+  }
+
+  size_t batches() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return batches_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::map<std::string, std::vector<std::string>> messages_;
+  std::map<std::string, std::vector<std::string>> lines_;
+  std::map<std::string, int> exit_codes_;
+  size_t batches_ = 0;
+};
+
+StdioTransport::Options Shell(const std::string& script, Framing framing = Framing::kNewline) {
+  StdioTransport::Options options;
+  options.argv = {"/bin/sh", "-c", script};
+  options.framing = framing;
+  return options;
+}
+
+bool SendString(StdioTransport& transport, const std::string& server_id,
+                const std::string& message) {
+  return transport.Send(server_id, reinterpret_cast<const uint8_t*>(message.data()),
+                        message.size());
+}
+
+}  // namespace
+
+TEST(StdioTransport, EchoesNewlineFramedMessages) {
+  Recorder recorder;
+  StdioTransport transport(recorder.OnMessages(), recorder.OnExit());
+  pid_t pid = 0;
+  std::string error;
+  ASSERT_TRUE(transport.Spawn("echo", Shell("exec cat"), &pid, &error)) << error;
+  EXPECT_GT(pid, 0);
+
+  EXPECT_TRUE(SendString(transport, "echo", "{\"id\":1}"));
+  EXPECT_TRUE(SendString(transport, "echo", "{\"id\":2}"));
+
+  EXPECT_EQ(recorder.WaitForMessages("echo", 2),
+            (std::vector<std::string>{"{\"id\":1}", "{\"id\":2}"}));
+  EXPECT_TRUE(transport.Close("echo"));
+  EXPECT_NE(recorder.WaitForExit("echo"), INT_MIN);
+  EXPECT_EQ(transport.server_count(), 0u);
+}
+
+TEST(StdioTransport, EchoesContentLengthFramedMessages) {
+  Recorder recorder;
+  StdioTransport transport(recorder.OnMessages(), recorder.OnExit());
+  pid_t pid = 0;
+  std::string error;
+  ASSERT_TRUE(transport.Spawn("lsp", Shell("exec cat", Framing::kContentLength), &pid, &error));
+
+  // Newlines inside a message survive this framing.
+  EXPECT_TRUE(SendString(transport, "lsp", "{\n\"id\":1}"));
+
+  EXPECT_EQ(recorder.WaitForMessages("lsp", 1), std::vector<std::string>{"{\n\"id\":1}"});
+}
+
+TEST(StdioTransport, BatchesMessagesThatArriveTogether) {
+  Recorder recorder;
+  StdioTransport transport(recorder.OnMessages(), recorder.OnExit());
+  pid_t pid = 0;
+  std::string error;
+  ASSERT_TRUE(transport.Spawn(
+      "burst", Shell("i=0; out=; while [ $i -lt 100 ]; do out=\"$out$i\n\"; i=$((i+1)); done; "
+                     "printf \"$out\""),
+      &pid, &error));
+
+  EXPECT_EQ(recorder.WaitForMessages("burst", 100).size(), 100u);
+  EXPECT_EQ(recorder.WaitForExit("burst"), 0);
+  EXPECT_LT(recorder.batches(), 100u);
+}
+
+TEST(StdioTransport, ReportsStderrLinesAndExitCode) {
+  Recorder recorder;
+  StdioTransport transport(recorder.OnMessages(), recorder.OnExit());
+  pid_t pid = 0;
+  std::string error;
+  ASSERT_TRUE(transport.Spawn("failing", Shell("echo starting >&2; exit 3"), &pid, &error));
+
+  EXPECT_EQ(recorder.WaitForLines("failing", 1), std::vector<std::string>{"starting"});
+  EXPECT_EQ(recorder.WaitForExit("failing"), 3);
+  EXPECT_FALSE(SendString(transport, "failing", "{}"));
+}
+
+TEST(StdioTransport, PassesEnvironmentAndWorkingDirectory) {
+  Recorder recorder;
+  StdioTransport transport(recorder.OnMessages(), recorder.OnExit());
+  StdioTransport::Options options = Shell("echo \"$MCP_TEST_VALUE $(pwd)\"");
+  options.env = {"MCP_TEST_VALUE=hello"};
+  options.working_directory = "/";
+  pid_t pid = 0;
+  std::string error;
+  ASSERT_TRUE(transport.Spawn("env", options, &pid, &error)) << error;
+
+  EXPECT_EQ(recorder.WaitForMessages("env", 1), std::vector<std::string>{"hello /"});
+}
+
+TEST(StdioTransport, QueuesWritesTheServerIsNotReadingYet) {
+  Recorder recorder;
+  StdioTransport transport(recorder.OnMessages(), recorder.OnExit());
+  pid_t pid = 0;
+  std::string error;
+  // Reads nothing until the writes below have backed up.
+  ASSERT_TRUE(transport.Spawn("slow", Shell("sleep 0.3; exec cat"), &pid, &error));
+
+  const std::string message(64 * 1024, 'x');
+  const int count = 32;
+  for (int i = 0; i < count; i++) {
+    ASSERT_TRUE(SendString(transport, "slow", message));
+  }
+  EXPECT_GT(transport.pending_write_bytes(), 0u);
+
+  const std::vector<std::string> echoed = recorder.WaitForMessages("slow", count);
+  ASSERT_EQ(echoed.size(), static_cast<size_t>(count));
+  EXPECT_EQ(echoed.back(), message);
+  EXPECT_EQ(transport.pending_write_bytes(), 0u);
+}
+
+TEST(StdioTransport, RoutesServerOutputBeforeReportingIt) {
+  Recorder recorder;
+  StdioTransport transport(recorder.OnMessages(), recorder.OnExit());
+  StdioTransport::Options options = Shell("exec cat");
+  options.routing.dropped_notifications = {"notifications/message"};
+  pid_t pid = 0;
+  std::string error;
+  ASSERT_TRUE(transport.Spawn("routed", options, &pid, &error));
+
+  // cat echoes each of these back as if the server had sent it.
+  EXPECT_TRUE(SendString(transport, "routed", "{\"method\":\"notifications/message\"}"));
+  EXPECT_TRUE(SendString(transport, "routed", "{\"id\":5,\"result\":{}}"));
+  EXPECT_TRUE(SendString(transport, "routed", "{\"id\":6,\"method\":\"ping\"}"));
+
+  EXPECT_EQ(recorder.WaitForMessages("routed", 1),
+            std::vector<std::string>{"{\"id\":6,\"method\":\"ping\"}"});
+  EXPECT_TRUE(transport.ConfigureRouting("routed", RoutingRules()));
+  EXPECT_TRUE(SendString(transport, "routed", "{\"method\":\"notifications/message\"}"));
+  EXPECT_EQ(recorder.WaitForMessages("routed", 2).back(),
+            "{\"method\":\"notifications/message\"}");
+
+  const RoutingCounts counts = transport.routing_counts();
+  EXPECT_EQ(counts.dropped_notifications, 1u);
+  EXPECT_EQ(counts.unmatched_responses, 1u);
+  EXPECT_FALSE(transport.ConfigureRouting("none", RoutingRules()));
+}
+
+TEST(StdioTransport, RejectsADuplicateOrMissingServer) {
+  Recorder recorder;
+  StdioTransport transport(recorder.OnMessages(), recorder.OnExit());
+  pid_t pid = 0;
+  std::string error;
+  ASSERT_TRUE(transport.Spawn("one", Shell("exec cat"), &pid, &error));
+
+  EXPECT_FALSE(transport.Spawn("one", Shell("exec cat"), &pid, &error));
+  EXPECT_FALSE(error.empty());
+  EXPECT_FALSE(transport.Spawn("missing", StdioTransport::Options(), &pid, &error));
+  EXPECT_FALSE(SendString(transport, "none", "{}"));
+  EXPECT_FALSE(transport.Close("none"));
+}
+
+TEST(StdioTransport, TerminatesServersOnDestruction) {
+  Recorder recorder;
+  pid_t pid = 0;
+  {
+    StdioTransport transport(recorder.OnMessages(), recorder.OnExit());
+    std::string error;
+    ASSERT_TRUE(transport.Spawn("long", Shell("exec sleep 30"), &pid, &error));
+  }
+  EXPECT_EQ(kill(pid, 0), -1);
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
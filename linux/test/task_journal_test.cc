@@ -0,0 +1,256 @@
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "background/task_journal.h"
+
+namespace flutter_mcp {
+namespace test {
+
+namespace {
+
+// A journal path in a scratch directory removed with the fixture.
+class TaskJournalTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    char pattern[] = "/tmp/task_journal_test_XXXXXX";
+    ASSERT_NE(mkdtemp(pattern), nullptr);
+    dir_ = pattern;
+    path_ = dir_ + "/tasks.journal";
+  }
+
+  void TearDown() override {
+    unlink(path_.c_str());
+    unlink((path_ + ".tmp").c_str());
+    rmdir(dir_.c_str());
+  }
+
+  std::map<std::string, JournaledTask> Load() {
+    TaskJournal journal(path_);
+    EXPECT_TRUE(journal.Open());
+    std::map<std::string, JournaledTask> tasks;
+    journal.ForEachTask([&](const std::string& id, const JournaledTask& task) {
+      tasks[id] = task;
+    });
+    return tasks;
+  }
+
+  std::string dir_;
+  std::string path_;
+};
+
+JournaledTask OneShot(int64_t due_unix_ms) {
+  JournaledTask task;
+  task.due_unix_ms = due_unix_ms;
+  return task;
+}
+
+JournaledTask Every(int64_t first_unix_ms, int64_t period_ms) {
+  JournaledTask task;
+  task.due_unix_ms = first_unix_ms;
+  task.recurring = true;
+  task.recurrence.period_ms = period_ms;
+  return task;
+}
+
+}  // namespace
+
+TEST(JournaledTask, RoundTripsThroughTheEncoding) {
+  JournaledTask task = Every(1700000000123, 5000);
+  task.priority = 0;
+  task.recurrence.jitter_ms = 250;
+  task.recurrence.mode = RecurrenceMode::kFixedDelay;
+  task.recurrence.overrun = OverrunPolicy::kCatchUp;
+
+  const std::string bytes = EncodeJournaledTask(task);
+  JournaledTask decoded;
+  ASSERT_TRUE(DecodeJournaledTask(reinterpret_cast<const uint8_t*>(bytes.data()),
+                                  bytes.size(), &decoded));
+  EXPECT_EQ(decoded.due_unix_ms, task.due_unix_ms);
+  EXPECT_EQ(decoded.priority, 0);
+  EXPECT_TRUE(decoded.recurring);
+  EXPECT_EQ(decoded.recurrence.period_ms, 5000);
+  EXPECT_EQ(decoded.recurrence.jitter_ms, 250);
+  EXPECT_EQ(decoded.recurrence.mode, RecurrenceMode::kFixedDelay);
+  EXPECT_EQ(decoded.recurrence.overrun, OverrunPolicy::kCatchUp);
+
+  EXPECT_FALSE(DecodeJournaledTask(reinterpret_cast<const uint8_t*>(bytes.data()),
+                                   bytes.size() - 1, &decoded));
+}
+
+TEST(JournaledTask, ReplayAppliesTheOverduePolicy) {
+  int64_t delay = -1;
+  EXPECT_TRUE(PlanReplay(OneShot(1500), 1000, OverduePolicy::kSkip, &delay));
+  EXPECT_EQ(delay, 500);
+
+  EXPECT_TRUE(PlanReplay(OneShot(900), 1000, OverduePolicy::kFire, &delay));
+  EXPECT_EQ(delay, 0);
+  EXPECT_FALSE(PlanReplay(OneShot(900), 1000, OverduePolicy::kSkip, &delay));
+
+  // Skipping keeps a recurring job on its original grid.
+  EXPECT_TRUE(PlanReplay(Every(0, 300), 1000, OverduePolicy::kSkip, &delay));
+  EXPECT_EQ(delay, 200);
+  EXPECT_TRUE(PlanReplay(Every(0, 250), 1000, OverduePolicy::kSkip, &delay));
+  EXPECT_EQ(delay, 0);
+}
+
+TEST(HeldReplay, OverdueTaskWaitsForTheListener) {
+  HeldReplay held;
+  EXPECT_TRUE(held.Hold("overdue", OneShot(900), 1000, OverduePolicy::kFire));
+  EXPECT_TRUE(held.Hold("later", OneShot(3000), 1000, OverduePolicy::kFire));
+  EXPECT_FALSE(held.Hold("skipped", OneShot(900), 1000, OverduePolicy::kSkip));
+  EXPECT_EQ(held.size(), 2u);
+
+  // The listener attaches a second after registration; the overdue task
+  // only runs now, and the other keeps its planned due time.
+  std::map<std::string, int64_t> scheduled;
+  held.Release(2000, [&](const std::string& id, const JournaledTask&, int64_t delay_ms) {
+    scheduled[id] = delay_ms;
+  });
+  ASSERT_EQ(scheduled.size(), 2u);
+  EXPECT_EQ(scheduled.at("overdue"), 0);
+  EXPECT_EQ(scheduled.at("later"), 1000);
+  EXPECT_EQ(held.size(), 0u);
+}
+
+TEST(HeldReplay, ForgetsTasksDartSchedulesItself) {
+  HeldReplay held;
+  held.Hold("task", OneShot(900), 1000, OverduePolicy::kFire);
+  held.Forget("task");
+
+  bool scheduled = false;
+  held.Release(2000, [&](const std::string&, const JournaledTask&, int64_t) {
+    scheduled = true;
+  });
+  EXPECT_FALSE(scheduled);
+}
+
+TEST_F(TaskJournalTest, OverdueTaskIsRetiredOnlyOnceDelivered) {
+  {
+    TaskJournal journal(path_);
+    ASSERT_TRUE(journal.Open());
+    journal.Record("task", OneShot(900));
+  }
+
+  {
+    // Replayed at registration, before anything listens for the result.
+    TaskJournal journal(path_);
+    ASSERT_TRUE(journal.Open());
+    const OverduePolicy policy = journal.overdue_policy();
+    HeldReplay held;
+    journal.ForEachTask([&](const std::string& id, const JournaledTask& task) {
+      EXPECT_TRUE(held.Hold(id, task, 1000, policy));
+    });
+    EXPECT_EQ(journal.size(), 1u);
+
+    std::vector<std::pair<std::string, int64_t>> released;
+    held.Release(1500, [&](const std::string& id, const JournaledTask& task, int64_t) {
+      released.emplace_back(id, task.due_unix_ms);
+    });
+    ASSERT_EQ(released.size(), 1u);
+    // Still pending until the listener has the result.
+    EXPECT_EQ(journal.size(), 1u);
+    EXPECT_TRUE(journal.Complete(released[0].first, released[0].second));
+  }
+  EXPECT_TRUE(Load().empty());
+}
+
+TEST_F(TaskJournalTest, PendingTasksSurviveReopening) {
+  {
+    TaskJournal journal(path_);
+    ASSERT_TRUE(journal.Open());
+    EXPECT_TRUE(journal.Record("once", OneShot(1000)));
+    EXPECT_TRUE(journal.Record("heartbeat", Every(2000, 60000)));
+    EXPECT_TRUE(journal.Record("cancelled", OneShot(3000)));
+    EXPECT_TRUE(journal.Erase("cancelled"));
+    EXPECT_TRUE(journal.SetOverduePolicy(OverduePolicy::kSkip));
+  }
+
+  const auto tasks = Load();
+  ASSERT_EQ(tasks.size(), 2u);
+  EXPECT_EQ(tasks.at("once").due_unix_ms, 1000);
+  EXPECT_TRUE(tasks.at("heartbeat").recurring);
+
+  TaskJournal journal(path_);
+  ASSERT_TRUE(journal.Open());
+  EXPECT_EQ(journal.overdue_policy(), OverduePolicy::kSkip);
+  EXPECT_EQ(journal.size(), 2u);
+}
+
+TEST_F(TaskJournalTest, CompleteKeepsARescheduledTask) {
+  TaskJournal journal(path_);
+  ASSERT_TRUE(journal.Open());
+  journal.Record("task", OneShot(1000));
+  journal.Record("task", OneShot(2000));
+
+  // The run that was due at 1000 finishing late must not drop the new one.
+  EXPECT_FALSE(journal.Complete("task", 1000));
+  EXPECT_EQ(journal.size(), 1u);
+  EXPECT_TRUE(journal.Complete("task", 2000));
+  EXPECT_EQ(journal.size(), 0u);
+}
+
+TEST_F(TaskJournalTest, TruncatesATornRecord) {
+  {
+    TaskJournal journal(path_);
+    ASSERT_TRUE(journal.Open());
+    journal.Record("kept", OneShot(1000));
+    journal.Record("torn", OneShot(2000));
+  }
+  // Cut the last record short, as a crash mid-append would.
+  const int fd = open(path_.c_str(), O_RDWR);
+  ASSERT_GE(fd, 0);
+  const off_t size = lseek(fd, 0, SEEK_END);
+  ASSERT_EQ(ftruncate(fd, size - 3), 0);
+  close(fd);
+
+  {
+    TaskJournal journal(path_);
+    ASSERT_TRUE(journal.Open());
+    EXPECT_EQ(journal.size(), 1u);
+    // Appends after the truncation read back normally.
+    journal.Record("after", OneShot(3000));
+  }
+  const auto tasks = Load();
+  EXPECT_EQ(tasks.size(), 2u);
+  EXPECT_EQ(tasks.count("kept"), 1u);
+  EXPECT_EQ(tasks.count("after"), 1u);
+}
+
+TEST_F(TaskJournalTest, CompactsSupersededRecords) {
+  TaskJournal journal(path_);
+  ASSERT_TRUE(journal.Open());
+  journal.Record("stable", OneShot(1));
+  for (int i = 0; i < 10000; i++) {
+    journal.Record("churn", OneShot(i));
+  }
+  journal.Erase("churn");
+
+  // Only a snapshot's worth of records is left on disk.
+  EXPECT_LT(journal.file_size(), 64u * 1024u);
+  EXPECT_EQ(journal.size(), 1u);
+
+  const auto tasks = Load();
+  ASSERT_EQ(tasks.size(), 1u);
+  EXPECT_EQ(tasks.at("stable").due_unix_ms, 1);
+}
+
+TEST_F(TaskJournalTest, RemoveDeletesTheFile) {
+  TaskJournal journal(path_);
+  ASSERT_TRUE(journal.Open());
+  journal.Record("task", OneShot(1000));
+  journal.Remove();
+
+  EXPECT_NE(access(path_.c_str(), F_OK), 0);
+  EXPECT_FALSE(journal.Record("task", OneShot(1000)));
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
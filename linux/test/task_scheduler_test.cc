@@ -0,0 +1,341 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "task_scheduler.h"
+#include "native_metrics.h"
+
+namespace flutter_mcp {
+namespace test {
+
+namespace {
+
+// Collects fired task ids and lets the test wait for a given count.
+class FiredLog {
+ public:
+  void Add(const std::string& id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ids_.push_back(id);
+    cv_.notify_all();
+  }
+
+  bool WaitFor(size_t count, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cv_.wait_for(lock, timeout, [&] { return ids_.size() >= count; });
+  }
+
+  std::vector<std::string> ids() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ids_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<std::string> ids_;
+};
+
+// Records what the scheduler asks of its timer; tests fire it by hand.
+class FakeTimer : public SchedulerTimer {
+ public:
+  struct State {
+    bool armed = false;
+    Clock::time_point deadline;
+  };
+
+  explicit FakeTimer(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+  void Arm(Clock::time_point deadline) override {
+    state_->armed = true;
+    state_->deadline = deadline;
+  }
+
+  void Disarm() override { state_->armed = false; }
+
+ private:
+  std::shared_ptr<State> state_;
+};
+
+// What a one-shot timer does when it expires.
+void Fire(TaskScheduler& scheduler, FakeTimer::State& timer) {
+  timer.armed = false;
+  scheduler.RunDue();
+}
+
+}  // namespace
+
+TEST(TaskScheduler, FiresInDeadlineOrder) {
+  TaskScheduler scheduler;
+  FiredLog log;
+
+  scheduler.Schedule("late", 60, [&] { log.Add("late"); });
+  scheduler.Schedule("early", 10, [&] { log.Add("early"); });
+  scheduler.Schedule("middle", 30, [&] { log.Add("middle"); });
+
+  ASSERT_TRUE(log.WaitFor(3, std::chrono::seconds(2)));
+  EXPECT_EQ(log.ids(), (std::vector<std::string>{"early", "middle", "late"}));
+}
+
+TEST(TaskScheduler, FiresShortDelayWithoutWaitingForLongerTasks) {
+  TaskScheduler scheduler;
+  FiredLog log;
+
+  scheduler.Schedule("far", 60000, [&] { log.Add("far"); });
+  auto start = std::chrono::steady_clock::now();
+  scheduler.Schedule("near", 20, [&] { log.Add("near"); });
+
+  ASSERT_TRUE(log.WaitFor(1, std::chrono::seconds(2)));
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(500));
+  EXPECT_EQ(log.ids(), std::vector<std::string>{"near"});
+  EXPECT_EQ(scheduler.PendingCount(), 1u);
+}
+
+TEST(TaskScheduler, CancelRemovesPendingTask) {
+  TaskScheduler scheduler;
+  FiredLog log;
+
+  scheduler.Schedule("cancelled", 20, [&] { log.Add("cancelled"); });
+  scheduler.Schedule("kept", 40, [&] { log.Add("kept"); });
+  EXPECT_TRUE(scheduler.Cancel("cancelled"));
+  EXPECT_FALSE(scheduler.Cancel("cancelled"));
+
+  ASSERT_TRUE(log.WaitFor(1, std::chrono::seconds(2)));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(log.ids(), std::vector<std::string>{"kept"});
+}
+
+TEST(TaskScheduler, RescheduleReplacesExistingTask) {
+  TaskScheduler scheduler;
+  FiredLog log;
+
+  scheduler.Schedule("task", 60000, [&] { log.Add("old"); });
+  scheduler.Schedule("task", 10, [&] { log.Add("new"); });
+  EXPECT_EQ(scheduler.PendingCount(), 1u);
+
+  ASSERT_TRUE(log.WaitFor(1, std::chrono::seconds(2)));
+  EXPECT_EQ(log.ids(), std::vector<std::string>{"new"});
+}
+
+TEST(TaskScheduler, HandlesManyPendingTasks) {
+  TaskScheduler scheduler;
+  std::atomic<int> fired(0);
+
+  const int kTasks = 5000;
+  for (int i = 0; i < kTasks; i++) {
+    scheduler.Schedule("task_" + std::to_string(i), 200 + i % 50,
+                       [&] { fired++; });
+  }
+  for (int i = 0; i < kTasks; i += 2) {
+    scheduler.Cancel("task_" + std::to_string(i));
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (fired < kTasks / 2 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_EQ(fired, kTasks / 2);
+  EXPECT_EQ(scheduler.PendingCount(), 0u);
+}
+
+TEST(TaskScheduler, StopDropsPendingTasks) {
+  TaskScheduler scheduler;
+  FiredLog log;
+
+  scheduler.Schedule("dropped", 50, [&] { log.Add("dropped"); });
+  scheduler.Stop();
+  EXPECT_EQ(scheduler.PendingCount(), 0u);
+
+  scheduler.Schedule("after_stop", 10, [&] { log.Add("after_stop"); });
+  ASSERT_TRUE(log.WaitFor(1, std::chrono::seconds(2)));
+  EXPECT_EQ(log.ids(), std::vector<std::string>{"after_stop"});
+}
+
+TEST(TaskScheduler, RecordsDispatchLateness) {
+  LatencyHistogram lateness;
+  TaskScheduler scheduler;
+  scheduler.SetLatenessHistogram(&lateness);
+  FiredLog log;
+
+  scheduler.Schedule("a", 0, [&] { log.Add("a"); });
+  scheduler.Schedule("b", 20, [&] { log.Add("b"); });
+
+  ASSERT_TRUE(log.WaitFor(2, std::chrono::seconds(2)));
+  EXPECT_EQ(lateness.count(), 2u);
+}
+
+TEST(TaskScheduler, TimerDispatchesDueTasks) {
+  auto timer = std::make_shared<FakeTimer::State>();
+  TaskScheduler scheduler;
+  scheduler.SetWorkerThreads(0);
+  scheduler.SetTimer(std::make_unique<FakeTimer>(timer));
+  FiredLog log;
+
+  scheduler.Schedule("later", 60000, [&] { log.Add("later"); });
+  scheduler.Schedule("now", 0, [&] { log.Add("now"); });
+  ASSERT_TRUE(timer->armed);
+
+  Fire(scheduler, *timer);
+  EXPECT_EQ(log.ids(), std::vector<std::string>{"now"});
+  // Re-armed for the task still pending.
+  EXPECT_TRUE(timer->armed);
+  EXPECT_EQ(scheduler.PendingCount(), 1u);
+
+  scheduler.Stop();
+  EXPECT_FALSE(timer->armed);
+  EXPECT_EQ(scheduler.PendingCount(), 0u);
+}
+
+TEST(TaskScheduler, TimerFollowsEarliestDeadline) {
+  auto timer = std::make_shared<FakeTimer::State>();
+  TaskScheduler scheduler;
+  scheduler.SetTimer(std::make_unique<FakeTimer>(timer));
+  FiredLog log;
+
+  const auto before = TaskScheduler::Clock::now();
+  scheduler.Schedule("far", 60000, [&] { log.Add("far"); });
+  scheduler.Schedule("near", 1000, [&] { log.Add("near"); });
+  EXPECT_LT(timer->deadline, before + std::chrono::seconds(30));
+
+  // Firing early dispatches nothing and re-arms the timer.
+  Fire(scheduler, *timer);
+  EXPECT_TRUE(log.ids().empty());
+  EXPECT_TRUE(timer->armed);
+
+  EXPECT_TRUE(scheduler.Cancel("near"));
+  EXPECT_TRUE(scheduler.Cancel("far"));
+  Fire(scheduler, *timer);
+  EXPECT_FALSE(timer->armed);
+}
+
+TEST(TaskScheduler, SwitchingDispatchKeepsPendingTasks) {
+  auto timer = std::make_shared<FakeTimer::State>();
+  TaskScheduler scheduler;
+  FiredLog log;
+
+  scheduler.Schedule("a", 40, [&] { log.Add("a"); });
+  scheduler.SetTimer(std::make_unique<FakeTimer>(timer));
+  EXPECT_TRUE(timer->armed);
+  EXPECT_EQ(scheduler.PendingCount(), 1u);
+
+  // Back on the thread, which picks up the task it left behind.
+  scheduler.SetTimer(nullptr);
+  scheduler.Schedule("b", 0, [&] { log.Add("b"); });
+  ASSERT_TRUE(log.WaitFor(2, std::chrono::seconds(2)));
+  EXPECT_EQ(log.ids(), (std::vector<std::string>{"b", "a"}));
+}
+
+// Timers that wait out callbacks on destruction need the lock free, or a
+// RunDue() in flight could never finish.
+TEST(TaskScheduler, ReplacedTimerIsDestroyedWithoutTheLock) {
+  class WaitingTimer : public SchedulerTimer {
+   public:
+    explicit WaitingTimer(std::function<void()> on_destroy)
+        : on_destroy_(std::move(on_destroy)) {}
+    ~WaitingTimer() override { on_destroy_(); }
+    void Arm(Clock::time_point) override {}
+    void Disarm() override {}
+
+   private:
+    std::function<void()> on_destroy_;
+  };
+
+  TaskScheduler scheduler;
+  scheduler.Schedule("a", 60000, [] {});
+  std::atomic<bool> destroyed{false};
+  scheduler.SetTimer(std::make_unique<WaitingTimer>([&] {
+    // Takes the scheduler's lock, as a RunDue() being waited for would.
+    EXPECT_EQ(scheduler.PendingCount(), 1u);
+    destroyed = true;
+  }));
+  scheduler.SetTimer(nullptr);
+  EXPECT_TRUE(destroyed);
+  scheduler.Stop();
+}
+
+TEST(TaskScheduler, RecurringJobRunsUntilCancelled) {
+  TaskScheduler scheduler;
+  FiredLog log;
+  Recurrence recurrence;
+  recurrence.period_ms = 10;
+
+  scheduler.ScheduleRecurring("heartbeat", 0, recurrence, [&] { log.Add("heartbeat"); });
+  ASSERT_TRUE(log.WaitFor(3, std::chrono::seconds(2)));
+  EXPECT_EQ(scheduler.RecurringCount(), 1u);
+
+  EXPECT_TRUE(scheduler.Cancel("heartbeat"));
+  EXPECT_EQ(scheduler.RecurringCount(), 0u);
+  const size_t runs = log.ids().size();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  // At most the run that was already in flight.
+  EXPECT_LE(log.ids().size(), runs + 1);
+  EXPECT_EQ(scheduler.PendingCount(), 0u);
+}
+
+TEST(TaskScheduler, RecurringJobKeepsItsRateOnTheTimer) {
+  auto timer = std::make_shared<FakeTimer::State>();
+  TaskScheduler scheduler;
+  scheduler.SetWorkerThreads(0);
+  scheduler.SetTimer(std::make_unique<FakeTimer>(timer));
+  FiredLog log;
+  Recurrence recurrence;
+  recurrence.period_ms = 1000;
+
+  const auto before = TaskScheduler::Clock::now();
+  scheduler.ScheduleRecurring("heartbeat", 0, recurrence, [&] { log.Add("heartbeat"); });
+  Fire(scheduler, *timer);
+  EXPECT_EQ(log.ids().size(), 1u);
+
+  // Queued again one period after the first run was due, not after it ran.
+  ASSERT_TRUE(timer->armed);
+  EXPECT_GE(timer->deadline, before + std::chrono::milliseconds(1000));
+  EXPECT_LT(timer->deadline, TaskScheduler::Clock::now() + std::chrono::milliseconds(1000));
+  EXPECT_EQ(scheduler.PendingCount(), 1u);
+
+  // A one-shot task takes the id over.
+  scheduler.Schedule("heartbeat", 0, [&] { log.Add("once"); });
+  Fire(scheduler, *timer);
+  EXPECT_EQ(log.ids(), (std::vector<std::string>{"heartbeat", "once"}));
+  EXPECT_EQ(scheduler.RecurringCount(), 0u);
+  EXPECT_FALSE(timer->armed);
+}
+
+TEST(TaskScheduler, CancelStopsRecurringJobMidRun) {
+  TaskScheduler scheduler;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool started = false;
+  bool release = false;
+  Recurrence recurrence;
+  recurrence.period_ms = 0;
+
+  scheduler.ScheduleRecurring("slow", 0, recurrence, [&] {
+    std::unique_lock<std::mutex> lock(mutex);
+    started = true;
+    cv.notify_all();
+    cv.wait(lock, [&] { return release; });
+  });
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(2), [&] { return started; }));
+  }
+
+  EXPECT_TRUE(scheduler.Cancel("slow"));
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    release = true;
+  }
+  cv.notify_all();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(scheduler.PendingCount(), 0u);
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
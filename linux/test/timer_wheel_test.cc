@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "timer_wheel.h"
+
+namespace flutter_mcp {
+namespace test {
+
+namespace {
+
+std::vector<TimerWheel::TimerId> AdvanceTo(TimerWheel& wheel, uint64_t now_ms) {
+  std::vector<TimerWheel::TimerId> expired;
+  wheel.Advance(now_ms, &expired);
+  std::sort(expired.begin(), expired.end());
+  return expired;
+}
+
+}  // namespace
+
+TEST(TimerWheel, FiresOnceDeadlinePasses) {
+  TimerWheel wheel(8, 100, 1000);
+  const auto id = wheel.Schedule(1000, 250);
+
+  EXPECT_TRUE(AdvanceTo(wheel, 1100).empty());
+  EXPECT_TRUE(AdvanceTo(wheel, 1200).empty());
+  EXPECT_EQ(AdvanceTo(wheel, 1300), std::vector<TimerWheel::TimerId>{id});
+  EXPECT_TRUE(wheel.empty());
+  EXPECT_TRUE(AdvanceTo(wheel, 2000).empty());
+}
+
+TEST(TimerWheel, DeadlinesBeyondOneRevolutionWaitTheirTurn) {
+  TimerWheel wheel(4, 10, 0);
+  const auto soon = wheel.Schedule(0, 20);
+  // Lands in the same bucket as |soon| but three revolutions later.
+  const auto later = wheel.Schedule(0, 140);
+
+  EXPECT_EQ(AdvanceTo(wheel, 20), std::vector<TimerWheel::TimerId>{soon});
+  EXPECT_TRUE(AdvanceTo(wheel, 100).empty());
+  EXPECT_EQ(AdvanceTo(wheel, 140), std::vector<TimerWheel::TimerId>{later});
+}
+
+TEST(TimerWheel, CancelledTimersDoNotFire) {
+  TimerWheel wheel(8, 10, 0);
+  const auto cancelled = wheel.Schedule(0, 30);
+  const auto kept = wheel.Schedule(0, 30);
+
+  EXPECT_TRUE(wheel.Cancel(cancelled));
+  EXPECT_FALSE(wheel.Cancel(cancelled));
+  EXPECT_EQ(wheel.size(), 1u);
+  EXPECT_EQ(AdvanceTo(wheel, 30), std::vector<TimerWheel::TimerId>{kept});
+}
+
+TEST(TimerWheel, LongStallFiresEverythingDue) {
+  TimerWheel wheel(4, 10, 0);
+  std::vector<TimerWheel::TimerId> ids;
+  for (uint64_t delay = 10; delay <= 200; delay += 10) {
+    ids.push_back(wheel.Schedule(0, delay));
+  }
+  const auto pending = wheel.Schedule(0, 10000);
+
+  EXPECT_EQ(AdvanceTo(wheel, 5000), ids);
+  EXPECT_EQ(wheel.size(), 1u);
+  EXPECT_EQ(AdvanceTo(wheel, 10000), std::vector<TimerWheel::TimerId>{pending});
+}
+
+TEST(TimerWheel, ZeroDelayFiresOnNextTick) {
+  TimerWheel wheel(8, 10, 55);
+  const auto id = wheel.Schedule(55, 0);
+
+  EXPECT_TRUE(AdvanceTo(wheel, 59).empty());
+  EXPECT_EQ(AdvanceTo(wheel, 60), std::vector<TimerWheel::TimerId>{id});
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "tray_menu_diff.h"
+
+namespace flutter_mcp {
+namespace test {
+
+namespace {
+
+TrayMenuItem Item(const std::string& id, const std::string& label,
+                  bool disabled = false) {
+  TrayMenuItem item;
+  item.id = id;
+  item.label = label;
+  item.disabled = disabled;
+  return item;
+}
+
+TrayMenuItem Separator() {
+  TrayMenuItem item;
+  item.is_separator = true;
+  return item;
+}
+
+// Replays |ops| the way a platform menu would.
+std::vector<TrayMenuItem> Apply(std::vector<TrayMenuItem> menu,
+                                const std::vector<TrayMenuOp>& ops) {
+  for (const auto& op : ops) {
+    switch (op.kind) {
+      case TrayMenuOp::Kind::kInsert:
+        menu.insert(menu.begin() + op.index, *op.item);
+        break;
+      case TrayMenuOp::Kind::kRemove:
+        menu.erase(menu.begin() + op.index);
+        break;
+      case TrayMenuOp::Kind::kMove: {
+        EXPECT_LT(op.index, op.from);
+        TrayMenuItem moved = menu[op.from];
+        menu.erase(menu.begin() + op.from);
+        menu.insert(menu.begin() + op.index, moved);
+        break;
+      }
+      case TrayMenuOp::Kind::kUpdate:
+        EXPECT_EQ(menu[op.index].is_separator, op.item->is_separator);
+        menu[op.index].label = op.item->label;
+        menu[op.index].disabled = op.item->disabled;
+        break;
+    }
+  }
+  return menu;
+}
+
+void ExpectSameMenu(const std::vector<TrayMenuItem>& actual,
+                    const std::vector<TrayMenuItem>& expected) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); i++) {
+    EXPECT_EQ(actual[i].id, expected[i].id) << i;
+    EXPECT_TRUE(SameTrayMenuContent(actual[i], expected[i])) << i;
+  }
+}
+
+}  // namespace
+
+TEST(TrayMenuDiff, UnchangedMenuNeedsNoEdits) {
+  std::vector<TrayMenuItem> menu = {Item("a", "A"), Separator(), Item("b", "B")};
+  EXPECT_TRUE(DiffTrayMenu(menu, menu).empty());
+}
+
+TEST(TrayMenuDiff, RelabelIsASingleUpdate) {
+  std::vector<TrayMenuItem> current = {Item("status", "3 connections"),
+                                       Separator(), Item("quit", "Quit")};
+  std::vector<TrayMenuItem> next = {Item("status", "4 connections"),
+                                    Separator(), Item("quit", "Quit", true)};
+
+  auto ops = DiffTrayMenu(current, next);
+  ASSERT_EQ(ops.size(), 2u);
+  EXPECT_EQ(ops[0].kind, TrayMenuOp::Kind::kUpdate);
+  EXPECT_EQ(ops[0].index, 0u);
+  EXPECT_EQ(ops[1].kind, TrayMenuOp::Kind::kUpdate);
+  EXPECT_EQ(ops[1].index, 2u);
+  ExpectSameMenu(Apply(current, ops), next);
+}
+
+TEST(TrayMenuDiff, InsertsRemovesAndReorders) {
+  std::vector<TrayMenuItem> current = {Item("a", "A"), Item("b", "B"),
+                                       Item("c", "C"), Item("d", "D")};
+  std::vector<TrayMenuItem> next = {Item("d", "D"), Item("new", "New"),
+                                    Item("a", "A2"), Separator(), Item("c", "C")};
+
+  auto ops = DiffTrayMenu(current, next);
+  ExpectSameMenu(Apply(current, ops), next);
+  for (const auto& op : ops) {
+    // Only "b" goes away; the rest are kept rather than rebuilt.
+    if (op.kind == TrayMenuOp::Kind::kRemove) {
+      EXPECT_EQ(op.index, 1u);
+    }
+  }
+}
+
+TEST(TrayMenuDiff, ItemTurningIntoSeparatorIsReplaced) {
+  std::vector<TrayMenuItem> current = {Item("x", "X")};
+  TrayMenuItem separator = Separator();
+  separator.id = "x";
+  std::vector<TrayMenuItem> next = {separator};
+
+  auto ops = DiffTrayMenu(current, next);
+  ASSERT_EQ(ops.size(), 2u);
+  EXPECT_EQ(ops[0].kind, TrayMenuOp::Kind::kRemove);
+  EXPECT_EQ(ops[1].kind, TrayMenuOp::Kind::kInsert);
+  ExpectSameMenu(Apply(current, ops), next);
+}
+
+TEST(TrayMenuDiff, DuplicateIdsStayDistinct) {
+  std::vector<TrayMenuItem> current = {Item("dup", "1"), Item("dup", "2")};
+  std::vector<TrayMenuItem> next = {Item("dup", "1"), Item("dup", "2"),
+                                    Item("dup", "3")};
+
+  auto ops = DiffTrayMenu(current, next);
+  ASSERT_EQ(ops.size(), 1u);
+  EXPECT_EQ(ops[0].kind, TrayMenuOp::Kind::kInsert);
+  EXPECT_EQ(ops[0].index, 2u);
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "worker_pool.h"
+
+namespace flutter_mcp {
+namespace test {
+
+TEST(WorkerPool, RunsHigherPriorityJobsFirst) {
+  WorkerPool pool(1);
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool release = false;
+  std::vector<std::string> order;
+
+  // Hold the only worker so the remaining jobs queue up behind it.
+  pool.Submit([&] {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return release; });
+  }, TaskPriority::kNormal, nullptr);
+
+  auto record = [&](const char* name) {
+    return [&, name] {
+      std::lock_guard<std::mutex> lock(mutex);
+      order.push_back(name);
+    };
+  };
+  pool.Submit(record("low"), TaskPriority::kLow, nullptr);
+  pool.Submit(record("normal"), TaskPriority::kNormal, nullptr);
+  pool.Submit(record("high"), TaskPriority::kHigh, nullptr);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    release = true;
+  }
+  cv.notify_all();
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (std::chrono::steady_clock::now() < deadline) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (order.size() == 3) break;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_EQ(order, (std::vector<std::string>{"high", "normal", "low"}));
+}
+
+TEST(WorkerPool, ReportsQueueDelayAndRunTime) {
+  WorkerPool pool(2);
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+  TaskTiming reported;
+
+  pool.Submit([] { std::this_thread::sleep_for(std::chrono::milliseconds(20)); },
+              TaskPriority::kNormal,
+              [&](const TaskTiming& timing) {
+                std::lock_guard<std::mutex> lock(mutex);
+                reported = timing;
+                done = true;
+                cv.notify_all();
+              });
+
+  std::unique_lock<std::mutex> lock(mutex);
+  ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(2), [&] { return done; }));
+  EXPECT_GE(reported.run_time_us, 20000);
+  EXPECT_GE(reported.queue_delay_us, 0);
+}
+
+TEST(WorkerPool, SpreadsWorkAcrossWorkers) {
+  WorkerPool pool(4);
+  std::atomic<int> completed(0);
+
+  const int kJobs = 10000;
+  for (int i = 0; i < kJobs; i++) {
+    pool.Submit([&] { completed++; }, static_cast<TaskPriority>(i % 3), nullptr);
+  }
+  pool.SetThreadCount(2);
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (completed < kJobs && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(completed, kJobs);
+}
+
+// A job that submits while SetThreadCount() waits for it must not block
+// the resize, nor be blocked by it.
+TEST(WorkerPool, JobsMaySubmitWhileThePoolResizes) {
+  WorkerPool pool(1);
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool resizing = false;
+  std::atomic<int> completed(0);
+
+  pool.Submit([&] {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [&] { return resizing; });
+    }
+    // Give SetThreadCount() time to start joining this worker.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    pool.Submit([&] { completed++; }, TaskPriority::kNormal, nullptr);
+  }, TaskPriority::kNormal, [&](const TaskTiming&) {
+    pool.Submit([&] { completed++; }, TaskPriority::kNormal, nullptr);
+  });
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    resizing = true;
+  }
+  cv.notify_all();
+  pool.SetThreadCount(0);
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (completed < 2 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(completed, 2);
+}
+
+TEST(WorkerPool, ShutdownRunsQueuedJobsBeforeJoining) {
+  WorkerPool pool(1);
+  std::atomic<bool> release(false);
+  std::atomic<int> completed(0);
+
+  // Hold the only worker so the rest are still queued at Shutdown().
+  pool.Submit([&] {
+    while (!release) {
+      std::this_thread::yield();
+    }
+  }, TaskPriority::kNormal, nullptr);
+  const int kQueued = 10;
+  for (int i = 0; i < kQueued; i++) {
+    pool.Submit([&] { completed++; }, TaskPriority::kNormal, nullptr);
+  }
+
+  std::thread releaser([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    release = true;
+  });
+  pool.Shutdown();
+  releaser.join();
+  EXPECT_EQ(completed, kQueued);
+}
+
+TEST(WorkerPool, ZeroThreadsRunsInline) {
+  WorkerPool pool(0);
+  std::thread::id ran_on;
+  pool.Submit([&] { ran_on = std::this_thread::get_id(); },
+              TaskPriority::kNormal, nullptr);
+  EXPECT_EQ(ran_on, std::this_thread::get_id());
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
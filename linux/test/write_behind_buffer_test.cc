@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "write_behind_buffer.h"
+
+namespace flutter_mcp {
+namespace test {
+
+namespace {
+
+void PutText(WriteBehindBuffer& buffer, const std::string& key, const std::string& value) {
+  buffer.Put(key, PendingWrite::Kind::kText, value.data(), value.size());
+}
+
+std::vector<std::string> Keys(const std::vector<PendingWrite>& writes) {
+  std::vector<std::string> keys;
+  for (const auto& write : writes) {
+    keys.push_back(write.key);
+  }
+  return keys;
+}
+
+}  // namespace
+
+TEST(WriteBehindBuffer, KeepsOnlyTheNewestWritePerKey) {
+  WriteBehindBuffer buffer;
+  for (int i = 0; i < 100; i++) {
+    PutText(buffer, "token", "v" + std::to_string(i));
+  }
+
+  EXPECT_EQ(buffer.size(), 1u);
+  std::vector<PendingWrite> writes = buffer.Take();
+  ASSERT_EQ(writes.size(), 1u);
+  EXPECT_EQ(writes[0].value, "v99");
+  EXPECT_EQ(buffer.size(), 0u);
+}
+
+TEST(WriteBehindBuffer, TakesKeysInTheOrderOfTheirNewestWrite) {
+  WriteBehindBuffer buffer;
+  PutText(buffer, "a", "1");
+  PutText(buffer, "b", "1");
+  PutText(buffer, "c", "1");
+  // Rewriting "a" moves it behind "c".
+  PutText(buffer, "a", "2");
+
+  EXPECT_EQ(Keys(buffer.Take()), (std::vector<std::string>{"b", "c", "a"}));
+}
+
+TEST(WriteBehindBuffer, LooksUpBufferedWritesAndDeletes) {
+  WriteBehindBuffer buffer;
+  PutText(buffer, "kept", "secret");
+  buffer.Put("gone", PendingWrite::Kind::kDelete, "", 0);
+
+  PendingWrite::Kind kind;
+  std::string value;
+  ASSERT_TRUE(buffer.Lookup("kept", &kind, &value));
+  EXPECT_EQ(kind, PendingWrite::Kind::kText);
+  EXPECT_EQ(value, "secret");
+  ASSERT_TRUE(buffer.Lookup("gone", &kind, nullptr));
+  EXPECT_EQ(kind, PendingWrite::Kind::kDelete);
+  EXPECT_FALSE(buffer.Lookup("missing", &kind, &value));
+}
+
+TEST(WriteBehindBuffer, KeepsBytesValuesExactly) {
+  WriteBehindBuffer buffer;
+  const std::string bytes("\0\x01\xff", 3);
+  buffer.Put("blob", PendingWrite::Kind::kBytes, bytes.data(), bytes.size());
+
+  std::vector<PendingWrite> writes = buffer.Take();
+  ASSERT_EQ(writes.size(), 1u);
+  EXPECT_EQ(writes[0].kind, PendingWrite::Kind::kBytes);
+  EXPECT_EQ(writes[0].value, bytes);
+}
+
+TEST(WriteBehindBuffer, ReportsWhenFull) {
+  WriteBehindBuffer buffer;
+  WriteBehindConfig config;
+  config.enabled = true;
+  config.max_pending = 2;
+  buffer.Configure(config);
+
+  EXPECT_FALSE(buffer.Put("a", PendingWrite::Kind::kText, "1", 1));
+  // Superseding a write does not grow the buffer.
+  EXPECT_FALSE(buffer.Put("a", PendingWrite::Kind::kText, "2", 1));
+  EXPECT_TRUE(buffer.Put("b", PendingWrite::Kind::kText, "1", 1));
+}
+
+TEST(WriteBehindBuffer, DisablesWithoutRoomForWrites) {
+  WriteBehindBuffer buffer;
+  WriteBehindConfig config;
+  config.enabled = true;
+  config.max_pending = 0;
+  config.delay_ms = -5;
+  buffer.Configure(config);
+
+  EXPECT_FALSE(buffer.enabled());
+  EXPECT_EQ(buffer.config().delay_ms, 0);
+}
+
+TEST(WriteBehindBuffer, ClearDropsEveryWrite) {
+  WriteBehindBuffer buffer;
+  PutText(buffer, "a", "1");
+  PutText(buffer, "b", "2");
+  buffer.Clear();
+
+  PendingWrite::Kind kind;
+  EXPECT_FALSE(buffer.Lookup("a", &kind, nullptr));
+  EXPECT_TRUE(buffer.Take().empty());
+}
+
+TEST(WriteBehindBuffer, ReportsFailuresOnce) {
+  WriteBehindBuffer buffer;
+  buffer.RecordFailures(2);
+  buffer.RecordFailures(1);
+
+  EXPECT_EQ(buffer.TakeFailures(), 3u);
+  EXPECT_EQ(buffer.TakeFailures(), 0u);
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
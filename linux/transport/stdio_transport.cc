@@ -0,0 +1,541 @@
+#include "stdio_transport.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+
+#include "native_trace.h"
+
+extern char** environ;
+
+namespace flutter_mcp {
+
+namespace {
+
+constexpr int kStdin = 0;
+constexpr int kStdout = 1;
+constexpr int kStderr = 2;
+constexpr int kWake = -1;
+
+constexpr int kMaxEvents = 64;
+constexpr size_t kReadChunk = 64 * 1024;
+// Bounds one server's share of a wakeup; epoll reports it again if more
+// output is waiting.
+constexpr int kMaxReadsPerWakeup = 16;
+// How often a server whose output closed is checked for having exited.
+constexpr int kReapPollMs = 100;
+// How long the destructor lets a server exit after SIGTERM.
+constexpr auto kTerminateGrace = std::chrono::milliseconds(500);
+
+bool SetNonBlocking(int fd) {
+  const int flags = fcntl(fd, F_GETFL);
+  return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+void CloseAll(std::initializer_list<int> fds) {
+  for (int fd : fds) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+}
+
+// The inherited environment with |overrides| added or replacing entries.
+std::vector<std::string> BuildEnvironment(const std::vector<std::string>& overrides) {
+  auto name_of = [](const std::string& entry) { return entry.substr(0, entry.find('=')); };
+  std::vector<std::string> names;
+  names.reserve(overrides.size());
+  for (const auto& entry : overrides) {
+    names.push_back(name_of(entry));
+  }
+
+  std::vector<std::string> env;
+  for (char** entry = environ; entry && *entry; entry++) {
+    const std::string inherited(*entry);
+    bool replaced = false;
+    for (const auto& name : names) {
+      if (name_of(inherited) == name) {
+        replaced = true;
+        break;
+      }
+    }
+    if (!replaced) {
+      env.push_back(inherited);
+    }
+  }
+  env.insert(env.end(), overrides.begin(), overrides.end());
+  return env;
+}
+
+std::vector<char*> ToPointers(const std::vector<std::string>& strings) {
+  std::vector<char*> pointers;
+  pointers.reserve(strings.size() + 1);
+  for (const auto& value : strings) {
+    pointers.push_back(const_cast<char*>(value.c_str()));
+  }
+  pointers.push_back(nullptr);
+  return pointers;
+}
+
+int ExitCode(int status) {
+  if (WIFEXITED(status)) {
+    return WEXITSTATUS(status);
+  }
+  return WIFSIGNALED(status) ? -WTERMSIG(status) : -1;
+}
+
+}  // namespace
+
+StdioTransport::Server::Server(std::string server_id, Framing server_framing,
+                               const RoutingRules& routing)
+    : id(std::move(server_id)),
+      framing(server_framing),
+      pid(-1),
+      endpoints{{this, kStdin}, {this, kStdout}, {this, kStderr}},
+      stdout_fd(-1),
+      stderr_fd(-1),
+      stdout_framer(server_framing),
+      stderr_framer(Framing::kNewline),
+      router(routing),
+      stdin_fd(-1),
+      pending_offset(0) {}
+
+StdioTransport::StdioTransport(MessagesCallback on_messages, ExitCallback on_exit)
+    : on_messages_(std::move(on_messages)),
+      on_exit_(std::move(on_exit)),
+      epoll_fd_(-1),
+      wake_fd_(-1),
+      wake_endpoint_{nullptr, kWake},
+      stopping_(false),
+      pending_write_bytes_(0) {}
+
+StdioTransport::~StdioTransport() {
+  std::map<std::string, std::shared_ptr<Server>> servers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    for (auto& entry : servers_) {
+      std::lock_guard<std::mutex> write_lock(entry.second->write_mutex);
+      CloseStdinLocked(entry.second.get());
+      kill(entry.second->pid, SIGTERM);
+    }
+    servers.swap(servers_);
+  }
+  if (reactor_.joinable()) {
+    const uint64_t one = 1;
+    ssize_t written;
+    do {
+      written = write(wake_fd_, &one, sizeof(one));
+    } while (written < 0 && errno == EINTR);
+    reactor_.join();
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + kTerminateGrace;
+  for (auto& entry : servers) {
+    Server* server = entry.second.get();
+    int status;
+    while (waitpid(server->pid, &status, WNOHANG) == 0) {
+      if (std::chrono::steady_clock::now() >= deadline) {
+        kill(server->pid, SIGKILL);
+        waitpid(server->pid, &status, 0);
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    CloseAll({server->stdout_fd, server->stderr_fd});
+  }
+  CloseAll({epoll_fd_, wake_fd_});
+}
+
+bool StdioTransport::Spawn(const std::string& server_id, const Options& options, pid_t* pid,
+                           std::string* error) {
+  if (options.argv.empty()) {
+    *error = "No command given";
+    return false;
+  }
+#if !defined(__GLIBC__) || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 29)
+  if (!options.working_directory.empty()) {
+    *error = "A working directory needs glibc 2.29 or later";
+    return false;
+  }
+#endif
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stopping_) {
+    *error = "Transport is shutting down";
+    return false;
+  }
+  if (servers_.count(server_id) > 0) {
+    *error = "Server is already running";
+    return false;
+  }
+  EnsureReactorLocked();
+  if (epoll_fd_ < 0) {
+    *error = std::string("Could not start the reactor: ") + strerror(errno);
+    return false;
+  }
+
+  // stdin is a socket so writes can pass MSG_NOSIGNAL; a server that exits
+  // must not raise SIGPIPE in the app. libuv sets up child stdio the same way.
+  int stdin_pair[2] = {-1, -1};
+  int stdout_pipe[2] = {-1, -1};
+  int stderr_pipe[2] = {-1, -1};
+  if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, stdin_pair) != 0 ||
+      pipe2(stdout_pipe, O_CLOEXEC) != 0 || pipe2(stderr_pipe, O_CLOEXEC) != 0 ||
+      !SetNonBlocking(stdin_pair[0]) || !SetNonBlocking(stdout_pipe[0]) ||
+      !SetNonBlocking(stderr_pipe[0])) {
+    *error = std::string("Could not create pipes: ") + strerror(errno);
+    CloseAll({stdin_pair[0], stdin_pair[1], stdout_pipe[0], stdout_pipe[1], stderr_pipe[0],
+              stderr_pipe[1]});
+    return false;
+  }
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, stdin_pair[1], STDIN_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, stdout_pipe[1], STDOUT_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, stderr_pipe[1], STDERR_FILENO);
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 29)
+  if (!options.working_directory.empty()) {
+    posix_spawn_file_actions_addchdir_np(&actions, options.working_directory.c_str());
+  }
+#endif
+
+  // The app may block or ignore signals, SIGPIPE in particular; the server
+  // starts with the defaults.
+  posix_spawnattr_t attributes;
+  posix_spawnattr_init(&attributes);
+  sigset_t no_signals;
+  sigemptyset(&no_signals);
+  posix_spawnattr_setsigmask(&attributes, &no_signals);
+  sigset_t default_signals;
+  sigemptyset(&default_signals);
+  sigaddset(&default_signals, SIGPIPE);
+  posix_spawnattr_setsigdefault(&attributes, &default_signals);
+  posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+  const std::vector<std::string> env = BuildEnvironment(options.env);
+  std::vector<char*> argv = ToPointers(options.argv);
+  std::vector<char*> envp = ToPointers(env);
+  pid_t child;
+  const int result =
+      posix_spawnp(&child, argv[0], &actions, &attributes, argv.data(), envp.data());
+  posix_spawnattr_destroy(&attributes);
+  posix_spawn_file_actions_destroy(&actions);
+  CloseAll({stdin_pair[1], stdout_pipe[1], stderr_pipe[1]});
+  if (result != 0) {
+    *error = "Could not start " + options.argv[0] + ": " + strerror(result);
+    CloseAll({stdin_pair[0], stdout_pipe[0], stderr_pipe[0]});
+    return false;
+  }
+
+  auto server = std::make_shared<Server>(server_id, options.framing, options.routing);
+  server->pid = child;
+  server->stdin_fd = stdin_pair[0];
+  server->stdout_fd = stdout_pipe[0];
+  server->stderr_fd = stderr_pipe[0];
+  for (int kind : {kStdout, kStderr}) {
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = &server->endpoints[kind];
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, kind == kStdout ? server->stdout_fd : server->stderr_fd,
+              &event);
+  }
+  servers_[server_id] = std::move(server);
+  *pid = child;
+  return true;
+}
+
+bool StdioTransport::Send(const std::string& server_id, const uint8_t* data, size_t size) {
+  std::shared_ptr<Server> server;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = servers_.find(server_id);
+    if (it == servers_.end()) {
+      return false;
+    }
+    server = it->second;
+  }
+
+  std::lock_guard<std::mutex> lock(server->write_mutex);
+  if (server->stdin_fd < 0) {
+    return false;
+  }
+  server->router.OnOutgoing(reinterpret_cast<const char*>(data), size);
+  const std::string prefix = FramePrefix(server->framing, size);
+  const char* suffix = FrameSuffix(server->framing);
+  const size_t suffix_size = strlen(suffix);
+  const size_t total = prefix.size() + size + suffix_size;
+
+  // Behind earlier writes; keep the order.
+  if (server->pending_offset < server->pending.size()) {
+    server->pending.append(prefix);
+    server->pending.append(reinterpret_cast<const char*>(data), size);
+    server->pending.append(suffix, suffix_size);
+    pending_write_bytes_ += total;
+    return true;
+  }
+
+  iovec parts[3] = {{const_cast<char*>(prefix.data()), prefix.size()},
+                    {const_cast<uint8_t*>(data), size},
+                    {const_cast<char*>(suffix), suffix_size}};
+  msghdr message = {};
+  message.msg_iov = parts;
+  message.msg_iovlen = 3;
+  ssize_t sent;
+  do {
+    sent = sendmsg(server->stdin_fd, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+  } while (sent < 0 && errno == EINTR);
+  if (sent < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      CloseStdinLocked(server.get());
+      return false;
+    }
+    sent = 0;
+  }
+  if (static_cast<size_t>(sent) == total) {
+    return true;
+  }
+
+  // Only the part the socket could not take is copied.
+  size_t skip = static_cast<size_t>(sent);
+  server->pending.clear();
+  server->pending_offset = 0;
+  for (const iovec& part : parts) {
+    if (skip >= part.iov_len) {
+      skip -= part.iov_len;
+      continue;
+    }
+    server->pending.append(static_cast<const char*>(part.iov_base) + skip, part.iov_len - skip);
+    skip = 0;
+  }
+  pending_write_bytes_ += server->pending.size();
+
+  epoll_event event = {};
+  event.events = EPOLLOUT;
+  event.data.ptr = &server->endpoints[kStdin];
+  epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, server->stdin_fd, &event);
+  return true;
+}
+
+bool StdioTransport::Close(const std::string& server_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = servers_.find(server_id);
+  if (it == servers_.end()) {
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> write_lock(it->second->write_mutex);
+    CloseStdinLocked(it->second.get());
+  }
+  kill(it->second->pid, SIGTERM);
+  return true;
+}
+
+bool StdioTransport::ConfigureRouting(const std::string& server_id, const RoutingRules& rules) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = servers_.find(server_id);
+  if (it == servers_.end()) {
+    return false;
+  }
+  it->second->router.Configure(rules);
+  return true;
+}
+
+size_t StdioTransport::server_count() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return servers_.size();
+}
+
+size_t StdioTransport::pending_write_bytes() {
+  return pending_write_bytes_.load(std::memory_order_relaxed);
+}
+
+RoutingCounts StdioTransport::routing_counts() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  RoutingCounts counts = retired_counts_;
+  for (const auto& entry : servers_) {
+    counts += entry.second->router.counts();
+  }
+  return counts;
+}
+
+void StdioTransport::EnsureReactorLocked() {
+  if (epoll_fd_ >= 0) {
+    return;
+  }
+  const int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  const int wake_fd = epoll_fd >= 0 ? eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK) : -1;
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.ptr = &wake_endpoint_;
+  if (wake_fd < 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event) != 0) {
+    const int saved = errno;
+    CloseAll({epoll_fd, wake_fd});
+    errno = saved;
+    return;
+  }
+  epoll_fd_ = epoll_fd;
+  wake_fd_ = wake_fd;
+  reactor_ = std::thread(&StdioTransport::ReactorLoop, this);
+}
+
+void StdioTransport::ReactorLoop() {
+  NativeTracer::NameThread("transport");
+  epoll_event events[kMaxEvents];
+  bool reaping = false;
+  while (!stopping_) {
+    const int count = epoll_wait(epoll_fd_, events, kMaxEvents, reaping ? kReapPollMs : -1);
+    if (count < 0 && errno != EINTR) {
+      return;
+    }
+    for (int i = 0; i < count; i++) {
+      const Endpoint* endpoint = static_cast<const Endpoint*>(events[i].data.ptr);
+      if (endpoint->kind == kWake) {
+        uint64_t value;
+        while (read(wake_fd_, &value, sizeof(value)) > 0) {
+        }
+        continue;
+      }
+      Server* server = endpoint->server;
+      if (endpoint->kind == kStdin) {
+        FlushPending(server);
+        continue;
+      }
+      const Stream stream = endpoint->kind == kStdout ? Stream::kStdout : Stream::kStderr;
+      TraceSpan span(TraceCategory::kTransport, "read");
+      RoutedBatch batch;
+      ReadOutput(server, stream, &batch);
+      if (!batch.empty()) {
+        on_messages_(server->id, stream, batch.Take());
+      }
+    }
+    // Only after the batch, which may still refer to a server that exited.
+    reaping = ReapExited();
+  }
+}
+
+bool StdioTransport::ReadOutput(Server* server, Stream stream, RoutedBatch* batch) {
+  int& fd = stream == Stream::kStdout ? server->stdout_fd : server->stderr_fd;
+  MessageFramer& framer = stream == Stream::kStdout ? server->stdout_framer : server->stderr_framer;
+  auto collect = [server, stream, batch](const char* data, size_t length) {
+    if (stream == Stream::kStdout) {
+      server->router.Route(data, length, batch);
+    } else {
+      batch->Add(data, length);
+    }
+  };
+
+  char buffer[kReadChunk];
+  for (int reads = 0; reads < kMaxReadsPerWakeup; reads++) {
+    const ssize_t length = read(fd, buffer, sizeof(buffer));
+    if (length > 0) {
+      if (!framer.Feed(buffer, static_cast<size_t>(length), collect) &&
+          stream == Stream::kStdout) {
+        // Nothing more from this server can be trusted to line up.
+        kill(server->pid, SIGTERM);
+      }
+      continue;
+    }
+    if (length < 0 && errno == EINTR) {
+      continue;
+    }
+    if (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return true;
+    }
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    fd = -1;
+    return false;
+  }
+  return true;
+}
+
+void StdioTransport::FlushPending(Server* server) {
+  std::lock_guard<std::mutex> lock(server->write_mutex);
+  if (server->stdin_fd < 0) {
+    return;
+  }
+  while (server->pending_offset < server->pending.size()) {
+    const ssize_t sent =
+        send(server->stdin_fd, server->pending.data() + server->pending_offset,
+             server->pending.size() - server->pending_offset, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (sent > 0) {
+      server->pending_offset += static_cast<size_t>(sent);
+      pending_write_bytes_ -= static_cast<size_t>(sent);
+      continue;
+    }
+    if (sent < 0 && errno == EINTR) {
+      continue;
+    }
+    if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return;
+    }
+    CloseStdinLocked(server);
+    return;
+  }
+  server->pending.clear();
+  server->pending_offset = 0;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, server->stdin_fd, nullptr);
+}
+
+void StdioTransport::CloseStdinLocked(Server* server) {
+  if (server->stdin_fd < 0) {
+    return;
+  }
+  if (server->pending_offset < server->pending.size()) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, server->stdin_fd, nullptr);
+    pending_write_bytes_ -= server->pending.size() - server->pending_offset;
+  }
+  server->pending.clear();
+  server->pending_offset = 0;
+  close(server->stdin_fd);
+  server->stdin_fd = -1;
+}
+
+bool StdioTransport::ReapExited() {
+  std::vector<std::pair<std::shared_ptr<Server>, int>> exited;
+  bool waiting = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = servers_.begin(); it != servers_.end();) {
+      Server* server = it->second.get();
+      if (server->stdout_fd >= 0 || server->stderr_fd >= 0) {
+        ++it;
+        continue;
+      }
+      int status = 0;
+      const pid_t reaped = waitpid(server->pid, &status, WNOHANG);
+      if (reaped == 0) {
+        waiting = true;
+        ++it;
+        continue;
+      }
+      {
+        std::lock_guard<std::mutex> write_lock(server->write_mutex);
+        CloseStdinLocked(server);
+      }
+      retired_counts_ += server->router.counts();
+      exited.emplace_back(it->second, reaped > 0 ? ExitCode(status) : -1);
+      it = servers_.erase(it);
+    }
+  }
+  for (const auto& entry : exited) {
+    on_exit_(entry.first->id, entry.second);
+  }
+  return waiting;
+}
+
+}  // namespace flutter_mcp
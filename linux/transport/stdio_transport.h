@@ -0,0 +1,138 @@
+#ifndef STDIO_TRANSPORT_H_
+#define STDIO_TRANSPORT_H_
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "jsonrpc_router.h"
+#include "message_framer.h"
+
+namespace flutter_mcp {
+
+// Runs local MCP servers as child processes and pumps their stdio.
+//
+// Each server gets a socket for stdin and pipes for stdout and stderr. One
+// reactor thread, started by the first Spawn, waits on every server's
+// output with epoll, frames it natively and reports each wakeup's complete
+// messages as one batch, after a JsonRpcRouter has dropped or coalesced
+// what Dart does not need. Send writes from the caller's buffer straight into
+// the socket and copies only what the socket cannot take yet; the reactor
+// flushes that remainder as the server reads.
+//
+// Thread-safe. Callbacks run on the reactor thread.
+class StdioTransport {
+ public:
+  struct Options {
+    // argv[0] is looked up on PATH.
+    std::vector<std::string> argv;
+    // NAME=value entries added to, or replacing, the inherited environment.
+    std::vector<std::string> env;
+    // Empty to inherit the current directory.
+    std::string working_directory;
+    Framing framing = Framing::kNewline;
+    // Applied to stdout; stderr lines are passed through as they are.
+    RoutingRules routing;
+  };
+
+  enum class Stream { kStdout, kStderr };
+
+  // Complete messages from stdout, or complete lines from stderr.
+  using MessagesCallback = std::function<void(
+      const std::string& server_id, Stream stream, std::vector<std::string>&& messages)>;
+  // |exit_code| is the negated signal number for a server killed by one.
+  using ExitCallback = std::function<void(const std::string& server_id, int exit_code)>;
+
+  StdioTransport(MessagesCallback on_messages, ExitCallback on_exit);
+  // Terminates every server still running and waits for it.
+  ~StdioTransport();
+
+  StdioTransport(const StdioTransport&) = delete;
+  StdioTransport& operator=(const StdioTransport&) = delete;
+
+  // Starts a server under |server_id|, which must not be running already.
+  // On failure returns false and describes why in |error|.
+  bool Spawn(const std::string& server_id, const Options& options, pid_t* pid,
+             std::string* error);
+
+  // Frames and writes one message. False if the server is not running or
+  // has closed its stdin.
+  bool Send(const std::string& server_id, const uint8_t* data, size_t size);
+
+  // Closes the server's stdin and sends it SIGTERM; its exit is reported
+  // through the exit callback as usual.
+  bool Close(const std::string& server_id);
+
+  // Replaces the server's routing rules. False if it is not running.
+  bool ConfigureRouting(const std::string& server_id, const RoutingRules& rules);
+
+  size_t server_count();
+  // Bytes waiting to be written to servers that are not reading.
+  size_t pending_write_bytes();
+  // Routing totals over every server, including those that have exited.
+  RoutingCounts routing_counts();
+
+ private:
+  struct Server;
+
+  // What an epoll event refers to.
+  struct Endpoint {
+    Server* server;
+    int kind;
+  };
+
+  struct Server {
+    Server(std::string id, Framing framing, const RoutingRules& routing);
+
+    const std::string id;
+    const Framing framing;
+    pid_t pid;
+    Endpoint endpoints[3];
+    // Reactor only
+    int stdout_fd;
+    int stderr_fd;
+    MessageFramer stdout_framer;
+    MessageFramer stderr_framer;
+    JsonRpcRouter router;
+
+    std::mutex write_mutex;
+    int stdin_fd;
+    // Unwritten tail of earlier sends, flushed by the reactor
+    std::string pending;
+    size_t pending_offset;
+  };
+
+  void EnsureReactorLocked();
+  void ReactorLoop();
+  // Reads until the pipe is empty; false once it reached EOF.
+  bool ReadOutput(Server* server, Stream stream, RoutedBatch* batch);
+  void FlushPending(Server* server);
+  void CloseStdinLocked(Server* server);
+  // Reaps servers whose output has closed; true if some are still exiting.
+  bool ReapExited();
+
+  MessagesCallback on_messages_;
+  ExitCallback on_exit_;
+
+  std::mutex mutex_;
+  std::map<std::string, std::shared_ptr<Server>> servers_;
+  RoutingCounts retired_counts_;
+  std::thread reactor_;
+  int epoll_fd_;
+  int wake_fd_;
+  Endpoint wake_endpoint_;
+  std::atomic<bool> stopping_;
+  std::atomic<size_t> pending_write_bytes_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // STDIO_TRANSPORT_H_
@@ -0,0 +1,88 @@
+#include "tray_icon_atlas.h"
+
+#include <glib/gstdio.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+namespace flutter_mcp {
+
+TrayIconAtlas::TrayIconAtlas() {
+  // One directory per process so concurrent instances cannot clobber or
+  // delete each other's icons.
+  g_autofree gchar* leaf = g_strdup_printf("tray-icons-%d", static_cast<int>(getpid()));
+  g_autofree gchar* path =
+      g_build_filename(g_get_user_runtime_dir(), "flutter_mcp", leaf, nullptr);
+  theme_path_ = path;
+}
+
+TrayIconAtlas::~TrayIconAtlas() {
+  for (const auto& entry : icons_) {
+    g_remove(FilePath(entry.second).c_str());
+  }
+  g_rmdir(theme_path_.c_str());
+}
+
+bool TrayIconAtlas::AddFromFile(const std::string& name, const std::string& path,
+                                GError** error) {
+  g_autoptr(GdkPixbuf) pixbuf = gdk_pixbuf_new_from_file(path.c_str(), error);
+  return pixbuf && Save(name, pixbuf, error);
+}
+
+bool TrayIconAtlas::AddFromBytes(const std::string& name, const guint8* data,
+                                 size_t length, GError** error) {
+  // The loader sniffs the format, so PNG and ICO both work here.
+  g_autoptr(GdkPixbufLoader) loader = gdk_pixbuf_loader_new();
+  if (!gdk_pixbuf_loader_write(loader, data, length, error)) {
+    gdk_pixbuf_loader_close(loader, nullptr);
+    return false;
+  }
+  if (!gdk_pixbuf_loader_close(loader, error)) {
+    return false;
+  }
+
+  GdkPixbuf* pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
+  if (!pixbuf) {
+    g_set_error(error, GDK_PIXBUF_ERROR, GDK_PIXBUF_ERROR_CORRUPT_IMAGE,
+                "No image in icon data");
+    return false;
+  }
+  return Save(name, pixbuf, error);
+}
+
+const std::string* TrayIconAtlas::Find(const std::string& name) const {
+  auto it = icons_.find(name);
+  return it != icons_.end() ? &it->second : nullptr;
+}
+
+bool TrayIconAtlas::Save(const std::string& name, GdkPixbuf* pixbuf,
+                         GError** error) {
+  if (g_mkdir_with_parents(theme_path_.c_str(), 0700) != 0) {
+    g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(errno),
+                "Cannot create %s", theme_path_.c_str());
+    return false;
+  }
+
+  g_autofree gchar* theme_name = g_strdup_printf("flutter-mcp-%u", next_serial_++);
+  if (!gdk_pixbuf_save(pixbuf, FilePath(theme_name).c_str(), "png", error,
+                       nullptr)) {
+    return false;
+  }
+
+  auto it = icons_.find(name);
+  if (it != icons_.end()) {
+    g_remove(FilePath(it->second).c_str());
+    it->second = theme_name;
+  } else {
+    icons_.emplace(name, theme_name);
+  }
+  return true;
+}
+
+std::string TrayIconAtlas::FilePath(const std::string& theme_name) const {
+  g_autofree gchar* file = g_strconcat(theme_name.c_str(), ".png", nullptr);
+  g_autofree gchar* path = g_build_filename(theme_path_.c_str(), file, nullptr);
+  return path;
+}
+
+}  // namespace flutter_mcp
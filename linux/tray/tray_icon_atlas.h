@@ -0,0 +1,53 @@
+#ifndef TRAY_ICON_ATLAS_H_
+#define TRAY_ICON_ATLAS_H_
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+#include <string>
+#include <unordered_map>
+
+namespace flutter_mcp {
+
+// Tray icons registered by name and exposed to AppIndicator as an icon
+// theme directory.
+//
+// Each icon is decoded once, from a file or from PNG/ICO bytes, and written
+// as a PNG into a private directory under the user runtime dir. The
+// indicator is pointed at that directory once; switching icons is then a
+// theme-name lookup with no decoding or path resolution on our side.
+// Re-registering a name writes a new theme name so the shell does not keep
+// showing a cached copy. The directory is removed with the atlas.
+//
+// Must be used from the main thread.
+class TrayIconAtlas {
+ public:
+  TrayIconAtlas();
+  ~TrayIconAtlas();
+
+  TrayIconAtlas(const TrayIconAtlas&) = delete;
+  TrayIconAtlas& operator=(const TrayIconAtlas&) = delete;
+
+  bool AddFromFile(const std::string& name, const std::string& path,
+                   GError** error);
+  bool AddFromBytes(const std::string& name, const guint8* data, size_t length,
+                    GError** error);
+
+  // Icon-theme name registered for |name|, or nullptr.
+  const std::string* Find(const std::string& name) const;
+
+  // Directory to hand to app_indicator_set_icon_theme_path().
+  const std::string& theme_path() const { return theme_path_; }
+  bool empty() const { return icons_.empty(); }
+
+ private:
+  bool Save(const std::string& name, GdkPixbuf* pixbuf, GError** error);
+  std::string FilePath(const std::string& theme_name) const;
+
+  std::string theme_path_;
+  unsigned int next_serial_ = 0;
+  std::unordered_map<std::string, std::string> icons_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // TRAY_ICON_ATLAS_H_
@@ -1,135 +1,214 @@
 #include "background_service.h"
 #include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "native_trace.h"
 
 namespace flutter_mcp {
 
+namespace {
+
+// Periodic ticks may fire up to a tenth of the interval late, capped at a
+// second, so the system can batch them with other timers
+constexpr int64_t kMaxTickWindowMs = 1000;
+
+// Negative FILETIME values are relative, in 100 ns units
+FILETIME RelativeDueTime(int64_t hundred_ns) {
+  ULARGE_INTEGER due;
+  due.QuadPart = static_cast<ULONGLONG>(-hundred_ns);
+  FILETIME time;
+  time.dwLowDateTime = due.LowPart;
+  time.dwHighDateTime = due.HighPart;
+  return time;
+}
+
+void CancelTimer(PTP_TIMER timer) {
+  SetThreadpoolTimer(timer, nullptr, 0, 0);
+  WaitForThreadpoolTimerCallbacks(timer, TRUE);
+}
+
+}  // namespace
+
+TimerBackend ParseTimerBackend(const std::string& name) {
+  return name == "thread" ? TimerBackend::kThread : TimerBackend::kThreadpool;
+}
+
 BackgroundService::BackgroundService() 
     : is_running_(false), 
       interval_ms_(60000), // Default 1 minute
-      scheduler_running_(false) {
+      backend_(TimerBackend::kThreadpool),
+      active_backend_(TimerBackend::kThreadpool),
+      tick_timer_(CreateThreadpoolTimer(&BackgroundService::OnTickTimer, this, nullptr)),
+      ticking_(false) {
+  InstallScheduleTimer();
+  if (!tick_timer_ || !schedule_timer_->valid()) {
+    if (tick_timer_) CloseThreadpoolTimer(tick_timer_);
+    tick_timer_ = nullptr;
+    backend_ = TimerBackend::kThread;
+  }
 }
 
 BackgroundService::~BackgroundService() {
   Stop();
+  if (tick_timer_) CloseThreadpoolTimer(tick_timer_);
 }
 
-void BackgroundService::Start(EventCallback callback) {
+void BackgroundService::Start(EventCallback callback, EventWanted wanted) {
   if (is_running_) return;
   
   event_callback_ = callback;
+  event_wanted_ = std::move(wanted);
   is_running_ = true;
-  scheduler_running_ = true;
-  
-  // Start background worker thread
-  worker_thread_ = std::thread(&BackgroundService::BackgroundWorker, this);
-  
-  // Start task scheduler thread
-  scheduler_thread_ = std::thread(&BackgroundService::TaskScheduler, this);
+  active_backend_ = backend_;
+  StartTimers();
 }
 
 void BackgroundService::Stop() {
   if (!is_running_) return;
   
   is_running_ = false;
-  scheduler_running_ = false;
-  
-  // Wake up scheduler thread
-  tasks_cv_.notify_all();
-  
-  // Wait for threads to finish
+  StopTimers();
+
+  // Drops the scheduled tasks; ones already dispatched still run
+  scheduler_.Stop();
+}
+
+void BackgroundService::SetInterval(int interval_ms) {
+  interval_ms_ = interval_ms;
+
+  bool ticking;
+  {
+    std::lock_guard<std::mutex> lock(worker_mutex_);
+    ticking = ticking_;
+  }
+  if (ticking && active_backend_ == TimerBackend::kThreadpool) {
+    ArmTickTimer(interval_ms);
+  }
+}
+
+void BackgroundService::SetTimerBackend(TimerBackend backend) {
+  if (!tick_timer_) {
+    backend = TimerBackend::kThread;
+  }
+  backend_ = backend;
+  if (!is_running_ || backend == active_backend_) {
+    return;
+  }
+
+  StopTimers();
+  active_backend_ = backend;
+  StartTimers();
+}
+
+void BackgroundService::InstallScheduleTimer() {
+  auto timer = std::make_unique<ThreadpoolTimer>([this] { scheduler_.RunDue(); });
+  schedule_timer_ = timer.get();
+  scheduler_.SetTimer(std::move(timer));
+}
+
+void BackgroundService::StartTimers() {
+  {
+    std::lock_guard<std::mutex> lock(worker_mutex_);
+    ticking_ = true;
+  }
+
+  if (active_backend_ == TimerBackend::kThread) {
+    worker_thread_ = std::thread(&BackgroundService::BackgroundWorker, this);
+    // Back to the scheduler's own thread, keeping the pending tasks
+    schedule_timer_ = nullptr;
+    scheduler_.SetTimer(nullptr);
+    return;
+  }
+
+  // The first tick is immediate, as with the worker thread
+  ArmTickTimer(0);
+  schedule_timer_->Enable();
+}
+
+void BackgroundService::StopTimers() {
+  {
+    // Flip the flag under the lock so the worker cannot miss the wakeup
+    std::lock_guard<std::mutex> lock(worker_mutex_);
+    ticking_ = false;
+  }
+  worker_cv_.notify_all();
   if (worker_thread_.joinable()) {
     worker_thread_.join();
   }
-  
-  if (scheduler_thread_.joinable()) {
-    scheduler_thread_.join();
+
+  // Waits out callbacks already running, so none outlives the service
+  if (tick_timer_) {
+    CancelTimer(tick_timer_);
   }
-  
-  // Clear scheduled tasks
-  {
-    std::lock_guard<std::mutex> lock(tasks_mutex_);
-    scheduled_tasks_.clear();
+  if (schedule_timer_) {
+    schedule_timer_->Disable();
+  } else {
+    // Joins the scheduler thread and holds the tasks until the next start
+    InstallScheduleTimer();
   }
 }
 
-void BackgroundService::SetInterval(int interval_ms) {
-  interval_ms_ = interval_ms;
+void BackgroundService::ArmTickTimer(int64_t due_ms) {
+  const int64_t interval_ms = interval_ms_.load() > 0 ? interval_ms_.load() : 1;
+  const int64_t window_ms = (std::min)(interval_ms / 10, kMaxTickWindowMs);
+  FILETIME due = RelativeDueTime(due_ms * 10000);
+  SetThreadpoolTimer(tick_timer_, &due, static_cast<DWORD>(interval_ms),
+                     static_cast<DWORD>(window_ms));
 }
 
-void BackgroundService::ScheduleTask(const std::string& task_id, int64_t delay_millis, std::function<void()> task) {
-  std::lock_guard<std::mutex> lock(tasks_mutex_);
-  
-  ScheduledTask scheduled_task;
-  scheduled_task.id = task_id;
-  scheduled_task.execute_time = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay_millis);
-  scheduled_task.task = task;
-  
-  scheduled_tasks_[task_id] = scheduled_task;
-  tasks_cv_.notify_one();
+VOID CALLBACK BackgroundService::OnTickTimer(PTP_CALLBACK_INSTANCE /* instance */, PVOID context,
+                                             PTP_TIMER /* timer */) {
+  static_cast<BackgroundService*>(context)->EmitPeriodicEvent();
+}
+
+void BackgroundService::SetWorkerThreads(size_t count) {
+  scheduler_.SetWorkerThreads(count);
+}
+
+void BackgroundService::ScheduleTask(const std::string& task_id, int64_t delay_millis, std::function<void()> task,
+                                     TaskPriority priority, WorkerPool::Completion on_complete) {
+  scheduler_.Schedule(task_id, delay_millis, std::move(task), priority, std::move(on_complete));
+}
+
+void BackgroundService::ScheduleRecurringTask(const std::string& task_id, int64_t initial_delay_millis,
+                                              const Recurrence& recurrence, std::function<void()> task,
+                                              TaskPriority priority, WorkerPool::Completion on_complete) {
+  scheduler_.ScheduleRecurring(task_id, initial_delay_millis, recurrence, std::move(task), priority,
+                               std::move(on_complete));
 }
 
 void BackgroundService::CancelTask(const std::string& task_id) {
-  std::lock_guard<std::mutex> lock(tasks_mutex_);
-  scheduled_tasks_.erase(task_id);
+  scheduler_.Cancel(task_id);
 }
 
-void BackgroundService::BackgroundWorker() {
-  while (is_running_) {
-    // Perform periodic background work
-    if (event_callback_) {
-      std::map<std::string, flutter::EncodableValue> data;
-      data["timestamp"] = flutter::EncodableValue(static_cast<int64_t>(
-          std::chrono::system_clock::now().time_since_epoch().count()));
-      data["type"] = flutter::EncodableValue("periodic");
-      
-      event_callback_("backgroundEvent", data);
-    }
+void BackgroundService::EmitPeriodicEvent() {
+  if (event_callback_ && (!event_wanted_ || event_wanted_("backgroundEvent"))) {
+    std::map<std::string, flutter::EncodableValue> data;
+    data["timestamp"] = flutter::EncodableValue(static_cast<int64_t>(
+        std::chrono::system_clock::now().time_since_epoch().count()));
+    data["type"] = flutter::EncodableValue("periodic");
     
-    // Sleep for the configured interval
-    std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms_.load()));
+    event_callback_("backgroundEvent", data);
   }
 }
 
-void BackgroundService::TaskScheduler() {
-  while (scheduler_running_) {
-    std::unique_lock<std::mutex> lock(tasks_mutex_);
-    
-    if (scheduled_tasks_.empty()) {
-      // Wait for new tasks or stop signal
-      tasks_cv_.wait(lock, [this] { 
-        return !scheduled_tasks_.empty() || !scheduler_running_; 
-      });
-      continue;
-    }
-    
-    // Find the task with the earliest execution time
-    auto earliest = std::min_element(
-        scheduled_tasks_.begin(), 
-        scheduled_tasks_.end(),
-        [](const auto& a, const auto& b) {
-          return a.second.execute_time < b.second.execute_time;
-        });
+void BackgroundService::BackgroundWorker() {
+  NativeTracer::NameThread("background");
+  std::unique_lock<std::mutex> lock(worker_mutex_);
+  while (ticking_) {
+    lock.unlock();
+    EmitPeriodicEvent();
+    lock.lock();
     
-    if (earliest != scheduled_tasks_.end()) {
-      auto now = std::chrono::steady_clock::now();
-      
-      if (earliest->second.execute_time <= now) {
-        // Execute the task
-        auto task = earliest->second.task;
-        scheduled_tasks_.erase(earliest);
-        
-        lock.unlock();
-        if (task) {
-          task();
-        }
-      } else {
-        // Wait until the next task is ready
-        tasks_cv_.wait_until(lock, earliest->second.execute_time, [this] {
-          return !scheduler_running_;
-        });
-      }
-    }
+    // Sleep for the configured interval, or until stopped
+    worker_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms_.load()),
+                        [this] { return !ticking_; });
   }
 }
 
-}  // namespace flutter_mcp
\ No newline at end of file
+void BackgroundService::SetLatenessHistogram(LatencyHistogram* histogram) {
+  scheduler_.SetLatenessHistogram(histogram);
+}
+
+}  // namespace flutter_mcp
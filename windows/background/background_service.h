@@ -12,42 +12,97 @@
 #include <chrono>
 #include <flutter/encodable_value.h>
 
+#include "recurrence.h"
+#include "task_scheduler.h"
+#include "threadpool_timer.h"
+#include "worker_pool.h"
+
 namespace flutter_mcp {
 
+class LatencyHistogram;
+
+// What drives the periodic tick and scheduled task dispatch
+enum class TimerBackend {
+  // Thread pool timers; no dedicated threads while idle
+  kThreadpool,
+  // A worker thread and a scheduler thread
+  kThread,
+};
+
+// "thread" selects kThread; anything else, such as "eventLoop", kThreadpool
+TimerBackend ParseTimerBackend(const std::string& name);
+
+// The periodic tick plus the shared TaskScheduler, woken by a thread pool
+// timer or by its own thread depending on the backend
 class BackgroundService {
  public:
   using EventCallback = std::function<void(const std::string&, const std::map<std::string, flutter::EncodableValue>&)>;
+  // Asked with the event type before an event is built
+  using EventWanted = std::function<bool(const char*)>;
 
   BackgroundService();
   ~BackgroundService();
 
-  void Start(EventCallback callback);
+  // Periodic events are only built once |wanted|, if given, returns true
+  void Start(EventCallback callback, EventWanted wanted = nullptr);
   void Stop();
   void SetInterval(int interval_ms);
-  void ScheduleTask(const std::string& task_id, int64_t delay_millis, std::function<void()> task);
+  void SetWorkerThreads(size_t count);
+  // Switches a running service over without dropping scheduled tasks. Falls
+  // back to kThread when thread pool timers could not be created
+  void SetTimerBackend(TimerBackend backend);
+  TimerBackend timer_backend() const { return backend_; }
+  // Due tasks are dispatched to a worker pool; on_complete runs on the same
+  // worker afterwards with the task's queueing delay and run time.
+  void ScheduleTask(const std::string& task_id, int64_t delay_millis, std::function<void()> task,
+                    TaskPriority priority = TaskPriority::kNormal,
+                    WorkerPool::Completion on_complete = nullptr);
+  // Runs |task| on |recurrence|, first after |initial_delay_millis|. The
+  // next run is queued once the previous one and its on_complete finish, so
+  // runs of one job never overlap. Replaces any task with the same id
+  void ScheduleRecurringTask(const std::string& task_id, int64_t initial_delay_millis,
+                             const Recurrence& recurrence, std::function<void()> task,
+                             TaskPriority priority = TaskPriority::kNormal,
+                             WorkerPool::Completion on_complete = nullptr);
+  // Also stops a recurring job whose run is in flight
   void CancelTask(const std::string& task_id);
+  // Records how late each due task is dispatched, in microseconds; nullptr
+  // stops recording. The histogram must outlive the service
+  void SetLatenessHistogram(LatencyHistogram* histogram);
   bool IsRunning() const { return is_running_; }
 
  private:
   void BackgroundWorker();
-  void TaskScheduler();
+  void EmitPeriodicEvent();
+  // Start and stop whichever backend is active, keeping scheduled tasks
+  void StartTimers();
+  void StopTimers();
+  // Hands the scheduler a new, disabled thread pool timer, which holds
+  // scheduled tasks until StartTimers enables it
+  void InstallScheduleTimer();
+  void ArmTickTimer(int64_t due_ms);
+  static VOID CALLBACK OnTickTimer(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_TIMER timer);
 
   std::thread worker_thread_;
-  std::thread scheduler_thread_;
   std::atomic<bool> is_running_;
   std::atomic<int> interval_ms_;
   EventCallback event_callback_;
-  
-  struct ScheduledTask {
-    std::string id;
-    std::chrono::steady_clock::time_point execute_time;
-    std::function<void()> task;
-  };
-  
-  std::map<std::string, ScheduledTask> scheduled_tasks_;
-  std::mutex tasks_mutex_;
-  std::condition_variable tasks_cv_;
-  std::atomic<bool> scheduler_running_;
+  EventWanted event_wanted_;
+
+  TimerBackend backend_;
+  // The backend the running service was started with; only changed while
+  // the timers are stopped
+  TimerBackend active_backend_;
+  PTP_TIMER tick_timer_;
+  // Lets Stop interrupt the worker thread's wait between ticks
+  std::mutex worker_mutex_;
+  std::condition_variable worker_cv_;
+  bool ticking_;
+
+  // Owned by scheduler_ while installed; nullptr while the scheduler runs
+  // on its own thread
+  ThreadpoolTimer* schedule_timer_ = nullptr;
+  TaskScheduler scheduler_;
 };
 
 }  // namespace flutter_mcp
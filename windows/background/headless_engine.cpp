@@ -0,0 +1,199 @@
+#include "headless_engine.h"
+
+#include <windows.h>
+
+#include <flutter/method_result_functions.h>
+#include <flutter/standard_method_codec.h>
+
+#include <chrono>
+#include <utility>
+
+namespace flutter_mcp {
+
+namespace {
+
+constexpr char kChannelName[] = "flutter_mcp/headless";
+
+int64_t NowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// The directory holding the running executable, where the Flutter tool
+// puts the app's data directory
+std::wstring ExecutableDirectory() {
+  wchar_t path[MAX_PATH];
+  const DWORD length = GetModuleFileNameW(nullptr, path, MAX_PATH);
+  if (length == 0 || length == MAX_PATH) {
+    return std::wstring();
+  }
+  std::wstring directory(path, length);
+  const size_t separator = directory.find_last_of(L"\\/");
+  return separator == std::wstring::npos ? std::wstring() : directory.substr(0, separator);
+}
+
+}  // namespace
+
+HeadlessEngine::HeadlessEngine(std::function<void()> on_failed)
+    : on_failed_(std::move(on_failed)) {}
+
+HeadlessEngine::~HeadlessEngine() {
+  Stop();
+}
+
+bool HeadlessEngine::Start(const std::string& entrypoint, int64_t callback_handle) {
+  if (engine_) {
+    if (!failed_) {
+      return true;
+    }
+    Stop();
+  }
+  start_us_ = NowMicros();
+
+  const std::wstring data_directory = ExecutableDirectory() + L"\\data";
+  const std::wstring assets_path = data_directory + L"\\flutter_assets";
+  const std::wstring icu_data_path = data_directory + L"\\icudtl.dat";
+  const std::wstring aot_library_path = data_directory + L"\\app.so";
+  const std::string handle_argument = std::to_string(callback_handle);
+  const char* arguments[] = {handle_argument.c_str()};
+
+  FlutterDesktopEngineProperties properties = {};
+  properties.assets_path = assets_path.c_str();
+  properties.icu_data_path = icu_data_path.c_str();
+  properties.aot_library_path = aot_library_path.c_str();
+  properties.dart_entrypoint_argc = 1;
+  properties.dart_entrypoint_argv = arguments;
+
+  engine_ = FlutterDesktopEngineCreate(&properties);
+  if (!engine_) {
+    return false;
+  }
+  registrar_ = std::make_unique<flutter::PluginRegistrar>(
+      FlutterDesktopEngineGetPluginRegistrar(engine_, "FlutterMcpHeadless"));
+  channel_ = std::make_unique<flutter::MethodChannel<flutter::EncodableValue>>(
+      registrar_->messenger(), kChannelName, &flutter::StandardMethodCodec::GetInstance());
+  channel_->SetMethodCallHandler([this](const auto& call, auto result) {
+    HandleMethodCall(call, std::move(result));
+  });
+
+  if (!FlutterDesktopEngineRun(engine_, entrypoint.c_str())) {
+    Stop();
+    return false;
+  }
+  return true;
+}
+
+void HeadlessEngine::Stop() {
+  if (!engine_) {
+    return;
+  }
+  std::map<uint64_t, InFlightRun> in_flight;
+  in_flight.swap(in_flight_);
+  channel_.reset();
+  registrar_.reset();
+  FlutterDesktopEngineDestroy(engine_);
+  engine_ = nullptr;
+  ready_ = false;
+  failed_ = false;
+
+  // Torn down first, so a callback that runs another task fails at once
+  const std::string error = "Headless engine stopped";
+  FailQueued(error);
+  for (auto& entry : in_flight) {
+    entry.second.done(flutter::EncodableValue(), &error, NowMicros() - entry.second.start_us);
+  }
+}
+
+void HeadlessEngine::Run(const std::string& task_id, flutter::EncodableValue data,
+                         RunCallback done) {
+  QueuedRun run{task_id, std::move(data), std::move(done)};
+  if (!engine_ || failed_) {
+    const std::string error =
+        failed_ ? "Headless callback not found" : "Headless engine not running";
+    run.done(flutter::EncodableValue(), &error, 0);
+    return;
+  }
+  if (!ready_) {
+    queued_.push_back(std::move(run));
+    return;
+  }
+  Invoke(std::move(run));
+}
+
+void HeadlessEngine::HandleMethodCall(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  if (call.method_name() != "ready") {
+    result->NotImplemented();
+    return;
+  }
+  // False when the dispatcher could not resolve the callback handle
+  const auto* ok = std::get_if<bool>(call.arguments());
+  result->Success();
+  if (!ok || !*ok) {
+    // Nothing can run here any more. The engine is inside this handler, so
+    // it is only torn down by the next Stop() or Start()
+    failed_ = true;
+    FailQueued("Headless callback not found");
+    if (on_failed_) {
+      on_failed_();
+    }
+    return;
+  }
+  ready_ = true;
+  warm_up_us_ = NowMicros() - start_us_;
+  std::vector<QueuedRun> queued;
+  queued.swap(queued_);
+  for (auto& run : queued) {
+    Invoke(std::move(run));
+  }
+}
+
+void HeadlessEngine::Invoke(QueuedRun run) {
+  flutter::EncodableMap arguments;
+  arguments[flutter::EncodableValue("taskId")] = flutter::EncodableValue(run.task_id);
+  arguments[flutter::EncodableValue("data")] = std::move(run.data);
+
+  // The reply handlers only carry the id; whichever of them runs, or Stop(),
+  // reports the run and the others find it gone. The engine, which owns
+  // them, never outlives this object
+  const uint64_t id = next_invocation_++;
+  in_flight_[id] = InFlightRun{std::move(run.done), NowMicros()};
+  channel_->InvokeMethod(
+      "runTask", std::make_unique<flutter::EncodableValue>(std::move(arguments)),
+      std::make_unique<flutter::MethodResultFunctions<flutter::EncodableValue>>(
+          [this, id](const flutter::EncodableValue* value) {
+            Complete(id, value ? *value : flutter::EncodableValue(), nullptr);
+          },
+          [this, id](const std::string& code, const std::string& message,
+                     const flutter::EncodableValue*) {
+            const std::string error = message.empty() ? code : message;
+            Complete(id, flutter::EncodableValue(), &error);
+          },
+          [this, id]() {
+            const std::string error = "runTask not handled";
+            Complete(id, flutter::EncodableValue(), &error);
+          }));
+}
+
+void HeadlessEngine::Complete(uint64_t id, const flutter::EncodableValue& value,
+                              const std::string* error) {
+  auto it = in_flight_.find(id);
+  if (it == in_flight_.end()) {
+    return;
+  }
+  InFlightRun run = std::move(it->second);
+  in_flight_.erase(it);
+  run.done(value, error, NowMicros() - run.start_us);
+}
+
+void HeadlessEngine::FailQueued(const std::string& error) {
+  std::vector<QueuedRun> queued;
+  queued.swap(queued_);
+  for (auto& run : queued) {
+    run.done(flutter::EncodableValue(), &error, 0);
+  }
+}
+
+}  // namespace flutter_mcp
@@ -0,0 +1,98 @@
+#ifndef HEADLESS_ENGINE_H_
+#define HEADLESS_ENGINE_H_
+
+#include <flutter/encodable_value.h>
+#include <flutter/method_channel.h>
+#include <flutter/plugin_registrar.h>
+#include <flutter_windows.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace flutter_mcp {
+
+// A FlutterEngine with no view that runs Dart-scheduled background tasks.
+//
+// Started once and kept warm, so each task costs one method call on the
+// "flutter_mcp/headless" channel instead of an engine start, and its Dart
+// work runs on the engine's own UI thread rather than the window's. The
+// engine runs |entrypoint| from the app's main library with the callback
+// handle as its only argument; that function hands over to the plugin's
+// runHeadlessDispatcher(), which reports ready once the callback is found.
+// Only Dart plugins are registered in it, since the app's native plugin
+// registrant cannot be called from here.
+//
+// Must be used from the platform thread
+class HeadlessEngine {
+ public:
+  // |result| is the callback's return value, or null with |error| set
+  using RunCallback = std::function<void(const flutter::EncodableValue& result,
+                                         const std::string* error, int64_t run_time_us)>;
+
+  // |on_failed| runs on the platform thread if the engine reports that it
+  // cannot run tasks, after the runs waiting on it have been failed
+  explicit HeadlessEngine(std::function<void()> on_failed = nullptr);
+  ~HeadlessEngine();
+
+  HeadlessEngine(const HeadlessEngine&) = delete;
+  HeadlessEngine& operator=(const HeadlessEngine&) = delete;
+
+  // Starts the engine from the app's data directory next to the executable,
+  // restarting it if it failed. False if it could not be created or run
+  bool Start(const std::string& entrypoint, int64_t callback_handle);
+  // Fails every run not yet reported with "Headless engine stopped"
+  void Stop();
+
+  // False once the engine has failed, though it is kept until Stop()
+  bool running() const { return engine_ != nullptr && !failed_; }
+  // How long Start() and the isolate's start-up took, 0 until it is ready
+  int64_t warm_up_us() const { return ready_ ? warm_up_us_ : 0; }
+
+  // Runs |task_id| in the engine's isolate; queued until it is ready.
+  // |done| runs exactly once, on the platform thread, failing at once if
+  // the engine is not running
+  void Run(const std::string& task_id, flutter::EncodableValue data, RunCallback done);
+
+ private:
+  struct QueuedRun {
+    std::string task_id;
+    flutter::EncodableValue data;
+    RunCallback done;
+  };
+
+  void HandleMethodCall(const flutter::MethodCall<flutter::EncodableValue>& call,
+                        std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void Invoke(QueuedRun run);
+  // Reports invocation |id| unless Stop() already failed it
+  void Complete(uint64_t id, const flutter::EncodableValue& value, const std::string* error);
+  void FailQueued(const std::string& error);
+
+  FlutterDesktopEngineRef engine_ = nullptr;
+  // Both are released before the engine
+  std::unique_ptr<flutter::PluginRegistrar> registrar_;
+  std::unique_ptr<flutter::MethodChannel<flutter::EncodableValue>> channel_;
+  std::function<void()> on_failed_;
+  bool ready_ = false;
+  // Set when the dispatcher could not find the callback
+  bool failed_ = false;
+  int64_t start_us_ = 0;
+  int64_t warm_up_us_ = 0;
+  std::vector<QueuedRun> queued_;
+
+  struct InFlightRun {
+    RunCallback done;
+    int64_t start_us = 0;
+  };
+  // Runs sent to the isolate and not yet answered, by invocation id. The
+  // engine drops their replies when it is destroyed, so Stop() fails them
+  std::map<uint64_t, InFlightRun> in_flight_;
+  uint64_t next_invocation_ = 0;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // HEADLESS_ENGINE_H_
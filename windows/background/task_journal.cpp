@@ -0,0 +1,76 @@
+#include "task_journal.h"
+
+#include <vector>
+
+namespace flutter_mcp {
+
+TaskJournal::TaskJournal(const std::wstring& path)
+    : path_(path), store_(std::make_unique<RecordStore>(path)) {}
+
+bool TaskJournal::Open() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return store_->Open();
+}
+
+bool TaskJournal::Record(const std::string& task_id, const JournaledTask& task) {
+  const std::string value = EncodeJournaledTask(task);
+  std::lock_guard<std::mutex> lock(mutex_);
+  return store_->Put(task_id, reinterpret_cast<const BYTE*>(value.data()), value.size());
+}
+
+bool TaskJournal::Complete(const std::string& task_id, int64_t due_unix_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  JournaledTask task;
+  if (!GetLocked(task_id, &task) || task.recurring || task.due_unix_ms != due_unix_ms) {
+    return false;
+  }
+  return store_->Erase(task_id);
+}
+
+bool TaskJournal::Erase(const std::string& task_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return store_->Erase(task_id);
+}
+
+bool TaskJournal::SetOverduePolicy(OverduePolicy policy) {
+  const BYTE value = policy == OverduePolicy::kSkip ? 's' : 'f';
+  std::lock_guard<std::mutex> lock(mutex_);
+  return store_->Put(kJournalPolicyKey, &value, 1);
+}
+
+OverduePolicy TaskJournal::overdue_policy() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const BYTE* data = nullptr;
+  size_t length = 0;
+  return store_->Get(kJournalPolicyKey, &data, &length) && length == 1 && data[0] == 's'
+             ? OverduePolicy::kSkip
+             : OverduePolicy::kFire;
+}
+
+void TaskJournal::ForEachTask(
+    const std::function<void(const std::string& task_id, const JournaledTask& task)>& visit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Get may remap the file, so collect the keys before reading any value
+  std::vector<std::string> keys;
+  store_->ForEachKey([&keys](const std::string& key) { keys.push_back(key); });
+  for (const auto& key : keys) {
+    JournaledTask task;
+    if (key != kJournalPolicyKey && GetLocked(key, &task)) {
+      visit(key, task);
+    }
+  }
+}
+
+void TaskJournal::Remove() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  store_ = std::make_unique<RecordStore>(path_);
+  DeleteFileW(path_.c_str());
+}
+
+bool TaskJournal::GetLocked(const std::string& task_id, JournaledTask* task) {
+  const BYTE* data = nullptr;
+  size_t length = 0;
+  return store_->Get(task_id, &data, &length) && DecodeJournaledTask(data, length, task);
+}
+
+}  // namespace flutter_mcp
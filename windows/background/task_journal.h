@@ -0,0 +1,60 @@
+#ifndef TASK_JOURNAL_H_
+#define TASK_JOURNAL_H_
+
+#include <windows.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "journaled_task.h"
+#include "storage/record_store.h"
+
+namespace flutter_mcp {
+
+// Journal of the Dart-scheduled tasks still pending, replayed at plugin
+// registration so they survive restarts.
+//
+// Each task is one RecordStore record keyed by its id, so appends,
+// torn-record recovery and compaction are the record file's. Thread-safe;
+// completions are recorded from worker threads
+class TaskJournal {
+ public:
+  explicit TaskJournal(const std::wstring& path);
+
+  TaskJournal(const TaskJournal&) = delete;
+  TaskJournal& operator=(const TaskJournal&) = delete;
+
+  // Opens or creates the file and loads it. The directory must exist
+  bool Open();
+
+  // Records |task| as pending under |task_id|, replacing any earlier entry
+  bool Record(const std::string& task_id, const JournaledTask& task);
+  // Drops |task_id| if it is still the one-shot task due at |due_unix_ms|,
+  // so a run that finishes after a reschedule keeps the new entry
+  bool Complete(const std::string& task_id, int64_t due_unix_ms);
+  bool Erase(const std::string& task_id);
+
+  bool SetOverduePolicy(OverduePolicy policy);
+  OverduePolicy overdue_policy();
+
+  // Visits every pending task, in no particular order
+  void ForEachTask(
+      const std::function<void(const std::string& task_id, const JournaledTask& task)>& visit);
+
+  // Closes and deletes the file
+  void Remove();
+
+ private:
+  bool GetLocked(const std::string& task_id, JournaledTask* task);
+
+  std::wstring path_;
+  std::mutex mutex_;
+  std::unique_ptr<RecordStore> store_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // TASK_JOURNAL_H_
@@ -0,0 +1,95 @@
+#include "threadpool_timer.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace flutter_mcp {
+
+namespace {
+
+// Scheduled tasks may fire up to a twentieth of their delay late, capped
+// here, so the system can batch them with other timers
+constexpr int64_t kMaxScheduleWindowMs = 15;
+
+}  // namespace
+
+ThreadpoolTimer::ThreadpoolTimer(std::function<void()> fire)
+    : fire_(std::move(fire)),
+      timer_(CreateThreadpoolTimer(&ThreadpoolTimer::OnTimer, this, nullptr)) {}
+
+ThreadpoolTimer::~ThreadpoolTimer() {
+  if (timer_) {
+    Disable();
+    CloseThreadpoolTimer(timer_);
+  }
+}
+
+void ThreadpoolTimer::Arm(Clock::time_point deadline) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  armed_ = true;
+  deadline_ = deadline;
+  SetLocked();
+}
+
+void ThreadpoolTimer::Disarm() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  armed_ = false;
+  if (timer_ && enabled_) {
+    SetThreadpoolTimer(timer_, nullptr, 0, 0);
+  }
+}
+
+void ThreadpoolTimer::Enable() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  enabled_ = true;
+  SetLocked();
+}
+
+void ThreadpoolTimer::Disable() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    enabled_ = false;
+    if (!timer_) {
+      return;
+    }
+    SetThreadpoolTimer(timer_, nullptr, 0, 0);
+  }
+  WaitForThreadpoolTimerCallbacks(timer_, TRUE);
+}
+
+void ThreadpoolTimer::SetLocked() {
+  if (!timer_ || !enabled_ || !armed_) {
+    return;
+  }
+
+  using HundredNs = std::chrono::duration<int64_t, std::ratio<1, 10000000>>;
+  const auto delay = deadline_ - Clock::now();
+  // Due time 0 would be read as an absolute time, so always at least 100 ns
+  const int64_t delay_100ns = (std::max)(std::chrono::duration_cast<HundredNs>(delay).count(),
+                                         static_cast<int64_t>(1));
+  const int64_t window_ms = (std::min)(delay_100ns / 10000 / 20, kMaxScheduleWindowMs);
+
+  // Negative FILETIME values are relative, in 100 ns units
+  ULARGE_INTEGER relative;
+  relative.QuadPart = static_cast<ULONGLONG>(-delay_100ns);
+  FILETIME due;
+  due.dwLowDateTime = relative.LowPart;
+  due.dwHighDateTime = relative.HighPart;
+  SetThreadpoolTimer(timer_, &due, 0, static_cast<DWORD>(window_ms));
+}
+
+VOID CALLBACK ThreadpoolTimer::OnTimer(PTP_CALLBACK_INSTANCE /* instance */, PVOID context,
+                                       PTP_TIMER /* timer */) {
+  auto* self = static_cast<ThreadpoolTimer*>(context);
+  {
+    std::lock_guard<std::mutex> lock(self->mutex_);
+    if (!self->enabled_) {
+      return;
+    }
+    // RunDue arms the timer again for whatever is left
+    self->armed_ = false;
+  }
+  self->fire_();
+}
+
+}  // namespace flutter_mcp
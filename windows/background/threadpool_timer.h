@@ -0,0 +1,53 @@
+#ifndef THREADPOOL_TIMER_H_
+#define THREADPOOL_TIMER_H_
+
+#include <windows.h>
+
+#include <functional>
+#include <mutex>
+
+#include "task_scheduler.h"
+
+namespace flutter_mcp {
+
+// Wakes a TaskScheduler from a thread pool timer instead of its thread, so
+// nothing waits on a dedicated thread while no task is due.
+//
+// Created disabled: Arm only records the deadline until Enable, which lets
+// the owner hold scheduled tasks while the service is stopped
+class ThreadpoolTimer : public SchedulerTimer {
+ public:
+  explicit ThreadpoolTimer(std::function<void()> fire);
+  ~ThreadpoolTimer() override;
+
+  ThreadpoolTimer(const ThreadpoolTimer&) = delete;
+  ThreadpoolTimer& operator=(const ThreadpoolTimer&) = delete;
+
+  // False when the thread pool timer could not be created
+  bool valid() const { return timer_ != nullptr; }
+
+  void Arm(Clock::time_point deadline) override;
+  void Disarm() override;
+
+  // Sets the timer for the deadline armed while disabled, if any
+  void Enable();
+  // Stops firing and waits out callbacks already running. Must not be
+  // called with the scheduler's lock held, since a callback may be waiting
+  // for it
+  void Disable();
+
+ private:
+  static VOID CALLBACK OnTimer(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_TIMER timer);
+  void SetLocked();
+
+  std::function<void()> fire_;
+  PTP_TIMER timer_;
+  std::mutex mutex_;
+  bool enabled_ = false;
+  bool armed_ = false;
+  Clock::time_point deadline_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // THREADPOOL_TIMER_H_
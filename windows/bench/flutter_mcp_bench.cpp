@@ -0,0 +1,374 @@
+#include <windows.h>
+#include <benchmark/benchmark.h>
+#include <flutter/encodable_value.h>
+#include <flutter/standard_message_codec.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "background/background_service.h"
+#include "event_ring_buffer.h"
+#include "jsonrpc_router.h"
+#include "method_table.h"
+#include "storage/record_store.h"
+#include "storage/value_cipher.h"
+
+// Microbenchmarks for the plugin's native hot paths.
+//
+// Run with --benchmark_format=json, or --benchmark_out=<file>
+// --benchmark_out_format=json, for machine-readable results that can be
+// compared between builds.
+
+namespace flutter_mcp {
+namespace bench {
+
+namespace {
+
+constexpr int64_t kEventsPerProducer = 100000;
+
+// Built the way SendEvent wraps a periodic background event
+flutter::EncodableValue NewPeriodicEvent(int64_t timestamp) {
+  flutter::EncodableMap data;
+  data[flutter::EncodableValue("type")] = flutter::EncodableValue("periodic");
+  data[flutter::EncodableValue("timestamp")] = flutter::EncodableValue(timestamp);
+
+  flutter::EncodableMap event;
+  event[flutter::EncodableValue("type")] = flutter::EncodableValue("backgroundEvent");
+  event[flutter::EncodableValue("data")] = flutter::EncodableValue(std::move(data));
+  return flutter::EncodableValue(std::move(event));
+}
+
+// Counts completed tasks and lets the benchmark wait for a given total
+class Countdown {
+ public:
+  explicit Countdown(int64_t count) : remaining_(count) {}
+
+  void Done() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--remaining_ == 0) {
+      cv_.notify_all();
+    }
+  }
+
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return remaining_ == 0; });
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  int64_t remaining_;
+};
+
+// Scratch files under %TEMP%, removed when the benchmark ends, so nothing
+// touches the user's real secure storage
+class TempPath {
+ public:
+  explicit TempPath(const wchar_t* name) {
+    wchar_t dir[MAX_PATH];
+    GetTempPathW(MAX_PATH, dir);
+    path_ = std::wstring(dir) + L"flutter_mcp_bench_" +
+            std::to_wstring(GetCurrentProcessId()) + L"_" + name;
+    DeleteFileW(path_.c_str());
+  }
+
+  ~TempPath() { DeleteFileW(path_.c_str()); }
+
+  const std::wstring& get() const { return path_; }
+
+ private:
+  std::wstring path_;
+};
+
+std::vector<std::string> MakeKeys(size_t count) {
+  std::vector<std::string> keys;
+  keys.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    keys.push_back("mcp.credential." + std::to_string(i));
+  }
+  return keys;
+}
+
+// Started with a short tick so Stop() does not wait out the default minute
+void StartService(BackgroundService& service) {
+  service.SetInterval(10);
+  service.Start([](const std::string&, const std::map<std::string, flutter::EncodableValue>&) {});
+}
+
+}  // namespace
+
+// Method dispatch
+
+static void BM_LookupMethod(benchmark::State& state) {
+  const size_t count = static_cast<size_t>(Method::kUnknown);
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LookupMethod(MethodName(static_cast<Method>(i))));
+    i = i + 1 < count ? i + 1 : 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LookupMethod);
+
+static void BM_LookupUnknownMethod(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LookupMethod("secureReadEverything"));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LookupUnknownMethod);
+
+// Event construction
+
+static void BM_BuildEventMap(benchmark::State& state) {
+  int64_t timestamp = 0;
+  for (auto _ : state) {
+    flutter::EncodableValue event = NewPeriodicEvent(timestamp++);
+    benchmark::DoNotOptimize(event);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BuildEventMap);
+
+static void BM_EncodeEventMap(benchmark::State& state) {
+  const auto& codec = flutter::StandardMessageCodec::GetInstance();
+  const flutter::EncodableValue event = NewPeriodicEvent(1);
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    auto message = codec.EncodeMessage(event);
+    bytes += static_cast<int64_t>(message->size());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_EncodeEventMap);
+
+// Scheduler
+
+static void BM_SchedulerInsertCancel(benchmark::State& state) {
+  const int64_t count = state.range(0);
+  for (auto _ : state) {
+    BackgroundService service;
+    StartService(service);
+    // Far enough out that nothing fires while the heap is being built
+    for (int64_t i = 0; i < count; i++) {
+      service.ScheduleTask("task-" + std::to_string(i), 3600000 + (i * 7919) % 60000, [] {});
+    }
+    for (int64_t i = 0; i < count; i++) {
+      service.CancelTask("task-" + std::to_string(i));
+    }
+    state.PauseTiming();
+    service.Stop();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_SchedulerInsertCancel)
+    ->RangeMultiplier(10)
+    ->Range(10000, 1000000)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_SchedulerFire(benchmark::State& state) {
+  const int64_t count = state.range(0);
+  for (auto _ : state) {
+    BackgroundService service;
+    // Inline on the scheduler thread, so this measures dispatch alone
+    service.SetWorkerThreads(0);
+    StartService(service);
+    Countdown countdown(count);
+    for (int64_t i = 0; i < count; i++) {
+      service.ScheduleTask("task-" + std::to_string(i), 0, [&countdown] { countdown.Done(); });
+    }
+    countdown.Wait();
+    state.PauseTiming();
+    service.Stop();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_SchedulerFire)
+    ->RangeMultiplier(10)
+    ->Range(10000, 1000000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Secure storage, against the record file backend in a scratch file
+
+static void BM_RecordStorePut(benchmark::State& state) {
+  TempPath path(L"put.db");
+  RecordStore store(path.get());
+  if (!store.Open()) {
+    state.SkipWithError("Could not open the record file");
+    return;
+  }
+  const std::vector<std::string> keys = MakeKeys(1024);
+  const std::string value(static_cast<size_t>(state.range(0)), 'v');
+  size_t i = 0;
+  for (auto _ : state) {
+    store.Put(keys[i++ & 1023], reinterpret_cast<const BYTE*>(value.data()), value.size());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RecordStorePut)->Arg(64)->Arg(4096);
+
+static void BM_RecordStoreGet(benchmark::State& state) {
+  TempPath path(L"get.db");
+  RecordStore store(path.get());
+  if (!store.Open()) {
+    state.SkipWithError("Could not open the record file");
+    return;
+  }
+  const size_t key_count = static_cast<size_t>(state.range(0));
+  const std::vector<std::string> keys = MakeKeys(key_count);
+  const std::string value(256, 'v');
+  for (const auto& key : keys) {
+    store.Put(key, reinterpret_cast<const BYTE*>(value.data()), value.size());
+  }
+  const BYTE* data = nullptr;
+  size_t length = 0;
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(store.Get(keys[i++ % key_count], &data, &length));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RecordStoreGet)->Arg(128)->Arg(65536);
+
+// Arg 0 is the value size; each iteration seals and unseals one value
+static void BM_ValueCipherRoundTrip(benchmark::State& state) {
+  TempPath key_path(L"master.key");
+  ValueCipher cipher;
+  if (!cipher.Open(key_path.get())) {
+    state.SkipWithError("Could not create the master key");
+    return;
+  }
+  const size_t size = static_cast<size_t>(state.range(0));
+  const std::vector<BYTE> plain(size, 0x5a);
+  std::vector<BYTE> sealed(ValueCipher::SealedSize(size));
+  std::vector<BYTE> opened(size);
+  for (auto _ : state) {
+    cipher.Seal("key", plain.data(), size, sealed.data());
+    benchmark::DoNotOptimize(cipher.Unseal("key", sealed.data(), sealed.size(), opened.data()));
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ValueCipherRoundTrip)->Arg(64)->Arg(4096);
+
+// Event delivery
+
+// One thread pushes a batch and drains it, as a burst of events followed
+// by the platform-thread drain would
+static void BM_EventQueuePushDrain(benchmark::State& state) {
+  const int64_t batch = state.range(0);
+  EventRingBuffer<flutter::EncodableValue> queue(1024);
+  flutter::EncodableValue event;
+  for (auto _ : state) {
+    for (int64_t i = 0; i < batch; i++) {
+      queue.TryPush(NewPeriodicEvent(i));
+    }
+    while (queue.TryPop(event)) {
+      benchmark::DoNotOptimize(event);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_EventQueuePushDrain)->Arg(1)->Arg(64)->Arg(1024);
+
+// Several producer threads post events while one consumer drains them;
+// producers spin while the buffer is full, as under the blocking policy
+static void BM_EventQueueContended(benchmark::State& state) {
+  const int producers = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    EventRingBuffer<flutter::EncodableValue> queue(1024);
+    std::atomic<int> running(producers);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+      threads.emplace_back([&queue, &running] {
+        for (int64_t i = 0; i < kEventsPerProducer; i++) {
+          flutter::EncodableValue event = NewPeriodicEvent(i);
+          while (!queue.TryPush(std::move(event))) {
+            std::this_thread::yield();
+          }
+        }
+        running--;
+      });
+    }
+    flutter::EncodableValue event;
+    int64_t drained = 0;
+    while (true) {
+      const bool done = running == 0;
+      while (queue.TryPop(event)) {
+        drained++;
+      }
+      if (done) {
+        break;
+      }
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    benchmark::DoNotOptimize(drained);
+  }
+  state.SetItemsProcessed(state.iterations() * producers * kEventsPerProducer);
+}
+BENCHMARK(BM_EventQueueContended)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Transport routing
+
+static std::string ResponseWithText(size_t text_size) {
+  return "{\"jsonrpc\":\"2.0\",\"id\":7,\"result\":{\"content\":[{\"type\":\"text\","
+         "\"text\":\"" + std::string(text_size, 'x') + "\"}]}}";
+}
+
+// The envelope scan every server message pays, skipping a result of the
+// given size
+static void BM_ParseEnvelope(benchmark::State& state) {
+  const std::string message = ResponseWithText(static_cast<size_t>(state.range(0)));
+  JsonRpcEnvelope envelope;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ParseJsonRpcEnvelope(message.data(), message.size(), &envelope));
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(message.size()));
+}
+BENCHMARK(BM_ParseEnvelope)->Arg(64)->Arg(4096)->Arg(1 << 20);
+
+// A read's worth of progress notifications for a few tokens, coalesced to
+// one per token
+static void BM_RouteProgressBatch(benchmark::State& state) {
+  const int64_t batch_size = state.range(0);
+  std::vector<std::string> messages;
+  for (int64_t i = 0; i < batch_size; i++) {
+    messages.push_back(
+        "{\"jsonrpc\":\"2.0\",\"method\":\"notifications/progress\",\"params\":{"
+        "\"progressToken\":" + std::to_string(i % 4) + ",\"progress\":" + std::to_string(i) + "}}");
+  }
+  JsonRpcRouter router;
+  for (auto _ : state) {
+    RoutedBatch batch;
+    for (const auto& message : messages) {
+      router.Route(message.data(), message.size(), &batch);
+    }
+    benchmark::DoNotOptimize(batch.Take());
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+}
+BENCHMARK(BM_RouteProgressBatch)->Arg(16)->Arg(256);
+
+}  // namespace bench
+}  // namespace flutter_mcp
+
+BENCHMARK_MAIN();
@@ -14,8 +14,13 @@
 #include <flutter/standard_method_codec.h>
 #include <flutter/event_channel.h>
 #include <flutter/event_stream_handler_functions.h>
+#include <flutter/method_result_functions.h>
 
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
 #include <memory>
+#include <iterator>
 #include <sstream>
 #include <map>
 #include <thread>
@@ -26,9 +31,95 @@
 #include "notification/notification_manager.h"
 #include "storage/secure_storage_service.h"
 #include "background/background_service.h"
+#include "background/headless_engine.h"
+#include "background/task_journal.h"
+#include "transport/stdio_transport.h"
+#include "method_table.h"
+#include "native_metrics.h"
+#include "native_trace.h"
 
 namespace flutter_mcp {
 
+namespace {
+
+constexpr wchar_t kMessageWindowClassName[] = L"FlutterMCPPluginWindow";
+// WM_TIMER id for the periodic metrics event on the message window
+constexpr UINT_PTR kMetricsTimerId = 0x4D43;
+// WM_TIMER id for flushing write-behind secure storage
+constexpr UINT_PTR kSecureFlushTimerId = 0x4D44;
+
+int64_t UnixMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Per application, so two apps using the plugin keep separate journals
+std::wstring TaskJournalPath() {
+  std::wstring app = L"default";
+  wchar_t module[MAX_PATH];
+  const DWORD length = GetModuleFileNameW(nullptr, module, MAX_PATH);
+  if (length > 0 && length < MAX_PATH) {
+    std::wstring exe(module, length);
+    const size_t slash = exe.find_last_of(L"\\/");
+    exe = exe.substr(slash == std::wstring::npos ? 0 : slash + 1);
+    const size_t dot = exe.find_last_of(L'.');
+    app = exe.substr(0, dot);
+  }
+
+  wchar_t base[MAX_PATH];
+  if (FAILED(SHGetFolderPath(nullptr, CSIDL_LOCAL_APPDATA, nullptr, 0, base))) {
+    GetCurrentDirectory(MAX_PATH, base);
+  }
+  return std::wstring(base) + L"\\flutter_mcp\\" + app + L"\\tasks.journal";
+}
+
+std::shared_ptr<TaskJournal> OpenTaskJournal() {
+  const std::wstring path = TaskJournalPath();
+  const std::wstring dir = path.substr(0, path.find_last_of(L'\\'));
+  const int created = SHCreateDirectoryExW(nullptr, dir.c_str(), nullptr);
+  if (created != ERROR_SUCCESS && created != ERROR_ALREADY_EXISTS) {
+    return nullptr;
+  }
+  auto journal = std::make_shared<TaskJournal>(path);
+  return journal->Open() ? journal : nullptr;
+}
+
+// Reads an int argument of either width
+bool LookupInt64(const flutter::EncodableMap& arguments, const char* key, int64_t* value) {
+  auto it = arguments.find(flutter::EncodableValue(key));
+  if (it == arguments.end()) {
+    return false;
+  }
+  if (const auto* number = std::get_if<int32_t>(&it->second)) {
+    *value = *number;
+    return true;
+  }
+  if (const auto* number = std::get_if<int64_t>(&it->second)) {
+    *value = *number;
+    return true;
+  }
+  return false;
+}
+
+bool LookupFlag(const flutter::EncodableMap& arguments, const char* key) {
+  auto it = arguments.find(flutter::EncodableValue(key));
+  if (it == arguments.end()) {
+    return false;
+  }
+  const auto* flag = std::get_if<bool>(&it->second);
+  return flag && *flag;
+}
+
+flutter::EncodableValue EncodeSubsystemTimings(const NativeMetrics& metrics) {
+  flutter::EncodableMap timings;
+  metrics.ForEachSubsystem([&timings](const char* name, int64_t micros) {
+    timings[flutter::EncodableValue(name)] = flutter::EncodableValue(micros);
+  });
+  return flutter::EncodableValue(std::move(timings));
+}
+
+}  // namespace
+
 // static
 void FlutterMcpPlugin::RegisterWithRegistrar(
     flutter::PluginRegistrarWindows *registrar) {
@@ -65,113 +156,373 @@ void FlutterMcpPlugin::RegisterWithRegistrar(
 
   event_channel->SetStreamHandler(std::move(event_handler));
 
+  // MCP server traffic, kept off the general event channel
+  auto transport_channel =
+      std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+          registrar->messenger(), "flutter_mcp/transport",
+          &flutter::StandardMethodCodec::GetInstance());
+  transport_channel->SetStreamHandler(std::make_unique<flutter::StreamHandlerFunctions<>>(
+      [plugin_pointer = plugin.get()](
+          const flutter::EncodableValue* /* arguments */,
+          std::unique_ptr<flutter::EventSink<>>&& events)
+          -> std::unique_ptr<flutter::StreamHandlerError<>> {
+        plugin_pointer->transport_sink_ = std::move(events);
+        return nullptr;
+      },
+      [plugin_pointer = plugin.get()](const flutter::EncodableValue* /* arguments */)
+          -> std::unique_ptr<flutter::StreamHandlerError<>> {
+        plugin_pointer->transport_sink_ = nullptr;
+        return nullptr;
+      }));
+
   registrar->AddPlugin(std::move(plugin));
 }
 
 FlutterMcpPlugin::FlutterMcpPlugin(flutter::PluginRegistrarWindows *registrar)
     : registrar_(registrar),
-      tray_manager_(std::make_unique<TrayIconManager>(registrar->GetView())),
-      notification_manager_(std::make_unique<NotificationManager>()),
-      secure_storage_(std::make_unique<SecureStorageService>()),
-      background_service_(std::make_unique<BackgroundService>()) {}
+      metrics_(std::make_unique<NativeMetrics>()),
+      event_batcher_(std::make_unique<EventBatcher<flutter::EncodableValue>>(
+          [this](const std::string& type, std::vector<flutter::EncodableValue>&& events,
+                 size_t coalesced) {
+            SendEventBatch(type, std::move(events), coalesced);
+          })),
+      event_queue_(kEventQueueCapacity),
+      platform_thread_id_(std::this_thread::get_id()) {
+  // Producers post one message per drain to the plugin's own message
+  // window, created on the platform thread, so it runs there. Unlike the
+  // app's top-level window it exists without a view and never sees the
+  // app's own traffic.
+  drain_events_message_ = RegisterWindowMessage(L"FlutterMcpDrainEvents");
+  drain_transport_message_ = RegisterWindowMessage(L"FlutterMcpDrainTransport");
+  run_headless_message_ = RegisterWindowMessage(L"FlutterMcpRunHeadless");
+  CreateMessageWindow();
+
+  // Needs the window, which carries the replayed tasks' results
+  ReplayTaskJournal();
+}
 
 FlutterMcpPlugin::~FlutterMcpPlugin() {
+  // Joins the reactor first, since its callbacks post to this plugin
+  transport_.reset();
   // Clean up resources
-  background_service_->Stop();
-  tray_manager_->HideTrayIcon();
+  if (background_service_) {
+    background_service_->Stop();
+  }
+  headless_running_ = false;
+  headless_engine_.reset();
+  if (metrics_interval_ms_ && message_window_) {
+    KillTimer(message_window_, kMetricsTimerId);
+  }
+  if (secure_flush_armed_) {
+    KillTimer(message_window_, kSecureFlushTimerId);
+  }
+  // Flush anything still buffered while the sink is alive
+  event_batcher_.reset();
+  // Messages still queued for the window are discarded with it
+  DestroyMessageWindow();
+  if (tray_manager_) {
+    tray_manager_->HideTrayIcon();
+  }
+}
+
+// Subsystems are created the first time a method needs them, or up front
+// by initialize, so registration costs nothing for the ones an app never
+// uses. Each records how long it took to create
+
+TrayIconManager& FlutterMcpPlugin::Tray() {
+  if (!tray_manager_) {
+    const auto start = NativeMetrics::Clock::now();
+    tray_manager_ = std::make_unique<TrayIconManager>(registrar_->GetView());
+    metrics_->RecordSubsystemInit(Subsystem::kTray, NativeMetrics::MicrosSince(start));
+  }
+  return *tray_manager_;
+}
+
+NotificationManager& FlutterMcpPlugin::Notifications() {
+  if (!notification_manager_) {
+    const auto start = NativeMetrics::Clock::now();
+    notification_manager_ = std::make_unique<NotificationManager>();
+    metrics_->RecordSubsystemInit(Subsystem::kNotifications, NativeMetrics::MicrosSince(start));
+  }
+  return *notification_manager_;
+}
+
+SecureStorageService& FlutterMcpPlugin::SecureStorage() {
+  if (!secure_storage_) {
+    const auto start = NativeMetrics::Clock::now();
+    secure_storage_ = std::make_unique<SecureStorageService>();
+    metrics_->RecordSubsystemInit(Subsystem::kSecureStorage, NativeMetrics::MicrosSince(start));
+  }
+  return *secure_storage_;
+}
+
+BackgroundService& FlutterMcpPlugin::Background() {
+  if (!background_service_) {
+    const auto start = NativeMetrics::Clock::now();
+    background_service_ = std::make_unique<BackgroundService>();
+    background_service_->SetLatenessHistogram(&metrics_->scheduler_lateness);
+    metrics_->RecordSubsystemInit(Subsystem::kBackground, NativeMetrics::MicrosSince(start));
+  }
+  return *background_service_;
+}
+
+StdioTransport& FlutterMcpPlugin::Transport() {
+  if (!transport_) {
+    const auto start = NativeMetrics::Clock::now();
+    transport_ = std::make_unique<StdioTransport>(
+        [this](const std::string& server_id, StdioTransport::Stream stream,
+               std::vector<std::string>&& messages) {
+          flutter::EncodableList list;
+          list.reserve(messages.size());
+          for (auto& message : messages) {
+            list.emplace_back(std::move(message));
+          }
+          flutter::EncodableMap event;
+          event[flutter::EncodableValue("serverId")] = flutter::EncodableValue(server_id);
+          event[flutter::EncodableValue("type")] = flutter::EncodableValue(
+              stream == StdioTransport::Stream::kStdout ? "messages" : "stderr");
+          event[flutter::EncodableValue("messages")] = flutter::EncodableValue(std::move(list));
+          PostTransportEvent(flutter::EncodableValue(std::move(event)));
+        },
+        [this](const std::string& server_id, int exit_code) {
+          flutter::EncodableMap event;
+          event[flutter::EncodableValue("serverId")] = flutter::EncodableValue(server_id);
+          event[flutter::EncodableValue("type")] = flutter::EncodableValue("exit");
+          event[flutter::EncodableValue("exitCode")] = flutter::EncodableValue(exit_code);
+          PostTransportEvent(flutter::EncodableValue(std::move(event)));
+        });
+    metrics_->RecordSubsystemInit(Subsystem::kTransport, NativeMetrics::MicrosSince(start));
+  }
+  return *transport_;
 }
 
 void FlutterMcpPlugin::HandleMethodCall(
     const flutter::MethodCall<flutter::EncodableValue> &method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  const auto& method_name = method_call.method_name();
-
-  if (method_name.compare("getPlatformVersion") == 0) {
-    std::ostringstream version_stream;
-    version_stream << "Windows ";
-    if (IsWindows10OrGreater()) {
-      version_stream << "10+";
-    } else if (IsWindows8OrGreater()) {
-      version_stream << "8";
-    } else if (IsWindows7OrGreater()) {
-      version_stream << "7";
-    }
-    result->Success(flutter::EncodableValue(version_stream.str()));
-  } else if (method_name.compare("initialize") == 0) {
-    Initialize(method_call, std::move(result));
-  } else if (method_name.compare("startBackgroundService") == 0) {
-    StartBackgroundService(std::move(result));
-  } else if (method_name.compare("stopBackgroundService") == 0) {
-    StopBackgroundService(std::move(result));
-  } else if (method_name.compare("configureBackgroundService") == 0) {
-    ConfigureBackgroundService(method_call, std::move(result));
-  } else if (method_name.compare("scheduleBackgroundTask") == 0) {
-    ScheduleBackgroundTask(method_call, std::move(result));
-  } else if (method_name.compare("cancelBackgroundTask") == 0) {
-    CancelBackgroundTask(method_call, std::move(result));
-  } else if (method_name.compare("showNotification") == 0) {
-    ShowNotification(method_call, std::move(result));
-  } else if (method_name.compare("requestNotificationPermission") == 0) {
-    // Windows doesn't require notification permission
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("configureNotifications") == 0) {
-    ConfigureNotifications(method_call, std::move(result));
-  } else if (method_name.compare("cancelNotification") == 0) {
-    CancelNotification(method_call, std::move(result));
-  } else if (method_name.compare("cancelAllNotifications") == 0) {
-    CancelAllNotifications(std::move(result));
-  } else if (method_name.compare("secureStore") == 0) {
-    SecureStore(method_call, std::move(result));
-  } else if (method_name.compare("secureRead") == 0) {
-    SecureRead(method_call, std::move(result));
-  } else if (method_name.compare("secureDelete") == 0) {
-    SecureDelete(method_call, std::move(result));
-  } else if (method_name.compare("secureContainsKey") == 0) {
-    SecureContainsKey(method_call, std::move(result));
-  } else if (method_name.compare("secureDeleteAll") == 0) {
-    SecureDeleteAll(std::move(result));
-  } else if (method_name.compare("showTrayIcon") == 0) {
-    ShowTrayIcon(method_call, std::move(result));
-  } else if (method_name.compare("hideTrayIcon") == 0) {
-    HideTrayIcon(std::move(result));
-  } else if (method_name.compare("setTrayMenu") == 0) {
-    SetTrayMenu(method_call, std::move(result));
-  } else if (method_name.compare("updateTrayTooltip") == 0) {
-    UpdateTrayTooltip(method_call, std::move(result));
-  } else if (method_name.compare("configureTray") == 0) {
-    ConfigureTray(method_call, std::move(result));
-  } else if (method_name.compare("checkPermission") == 0) {
-    // Windows doesn't require most permissions
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("requestPermission") == 0) {
-    // Windows doesn't require most permissions
-    result->Success(flutter::EncodableValue(true));
-  } else if (method_name.compare("shutdown") == 0) {
-    Shutdown(std::move(result));
-  } else {
-    result->NotImplemented();
+  const Method method = LookupMethod(method_call.method_name().c_str());
+
+  // Every handler answers before returning, so this covers the whole call
+  const auto start = NativeMetrics::Clock::now();
+  {
+    TraceSpan span(TraceCategory::kMethod, MethodName(method));
+    DispatchMethodCall(method, method_call, std::move(result));
+  }
+  const int64_t micros = NativeMetrics::MicrosSince(start);
+  metrics_->RecordMethod(method, micros);
+  if (IsSecureStorageMethod(method)) {
+    metrics_->secure_storage.Record(micros);
+  }
+}
+
+void FlutterMcpPlugin::DispatchMethodCall(
+    Method method, const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  switch (method) {
+    case Method::kGetPlatformVersion: {
+      std::ostringstream version_stream;
+      version_stream << "Windows ";
+      if (IsWindows10OrGreater()) {
+        version_stream << "10+";
+      } else if (IsWindows8OrGreater()) {
+        version_stream << "8";
+      } else if (IsWindows7OrGreater()) {
+        version_stream << "7";
+      }
+      result->Success(flutter::EncodableValue(version_stream.str()));
+      break;
+    }
+    case Method::kInitialize:
+      Initialize(method_call, std::move(result));
+      break;
+    case Method::kStartBackgroundService:
+      StartBackgroundService(std::move(result));
+      break;
+    case Method::kStopBackgroundService:
+      StopBackgroundService(std::move(result));
+      break;
+    case Method::kConfigureBackgroundService:
+      ConfigureBackgroundService(method_call, std::move(result));
+      break;
+    case Method::kScheduleBackgroundTask:
+      ScheduleBackgroundTask(method_call, std::move(result));
+      break;
+    case Method::kScheduleRecurringTask:
+      ScheduleRecurringTask(method_call, std::move(result));
+      break;
+    case Method::kCancelBackgroundTask:
+      CancelBackgroundTask(method_call, std::move(result));
+      break;
+    case Method::kStartHeadlessEngine:
+      StartHeadlessEngine(method_call, std::move(result));
+      break;
+    case Method::kStopHeadlessEngine:
+      StopHeadlessEngine(std::move(result));
+      break;
+    case Method::kShowNotification:
+      ShowNotification(method_call, std::move(result));
+      break;
+    case Method::kRequestNotificationPermission:
+      // Windows doesn't require notification permission
+      result->Success(flutter::EncodableValue(true));
+      break;
+    case Method::kConfigureNotifications:
+      ConfigureNotifications(method_call, std::move(result));
+      break;
+    case Method::kCancelNotification:
+      CancelNotification(method_call, std::move(result));
+      break;
+    case Method::kCancelAllNotifications:
+      CancelAllNotifications(std::move(result));
+      break;
+    case Method::kSecureStore:
+      SecureStore(method_call, std::move(result));
+      break;
+    case Method::kSecureRead:
+      SecureRead(method_call, std::move(result));
+      break;
+    case Method::kSecureStoreBytes:
+      SecureStoreBytes(method_call, std::move(result));
+      break;
+    case Method::kSecureReadBytes:
+      SecureReadBytes(method_call, std::move(result));
+      break;
+    case Method::kSecureDelete:
+      SecureDelete(method_call, std::move(result));
+      break;
+    case Method::kSecureContainsKey:
+      SecureContainsKey(method_call, std::move(result));
+      break;
+    case Method::kSecureDeleteAll:
+      SecureDeleteAll(std::move(result));
+      break;
+    case Method::kSecureReadMany:
+      SecureReadMany(method_call, std::move(result));
+      break;
+    case Method::kSecureReadPrefix:
+      SecureReadPrefix(method_call, std::move(result));
+      break;
+    case Method::kConfigureSecureStorage:
+      ConfigureSecureStorage(method_call, std::move(result));
+      break;
+    case Method::kSecureFlush:
+      SecureFlush(std::move(result));
+      break;
+    case Method::kShowTrayIcon:
+      ShowTrayIcon(method_call, std::move(result));
+      break;
+    case Method::kHideTrayIcon:
+      HideTrayIcon(std::move(result));
+      break;
+    case Method::kRegisterTrayIcons:
+      RegisterTrayIcons(method_call, std::move(result));
+      break;
+    case Method::kSetTrayIcon:
+      SetTrayIcon(method_call, std::move(result));
+      break;
+    case Method::kSetTrayMenu:
+      SetTrayMenu(method_call, std::move(result));
+      break;
+    case Method::kUpdateTrayMenuItem:
+      UpdateTrayMenuItem(method_call, std::move(result));
+      break;
+    case Method::kUpdateTrayTooltip:
+      UpdateTrayTooltip(method_call, std::move(result));
+      break;
+    case Method::kConfigureTray:
+      ConfigureTray(method_call, std::move(result));
+      break;
+    case Method::kCheckPermission:
+      // Windows doesn't require most permissions
+      result->Success(flutter::EncodableValue(true));
+      break;
+    case Method::kRequestPermission:
+      // Windows doesn't require most permissions
+      result->Success(flutter::EncodableValue(true));
+      break;
+    case Method::kConfigureEvents:
+      ConfigureEvents(method_call, std::move(result));
+      break;
+    case Method::kGetEventQueueStats:
+      GetEventQueueStats(std::move(result));
+      break;
+    case Method::kGetNativeMetrics:
+      GetNativeMetrics(method_call, std::move(result));
+      break;
+    case Method::kConfigureNativeMetrics:
+      ConfigureNativeMetrics(method_call, std::move(result));
+      break;
+    case Method::kTransportSpawn:
+      TransportSpawn(method_call, std::move(result));
+      break;
+    case Method::kTransportSend:
+      TransportSend(method_call, std::move(result));
+      break;
+    case Method::kTransportClose:
+      TransportClose(method_call, std::move(result));
+      break;
+    case Method::kTransportConfigureRouting:
+      TransportConfigureRouting(method_call, std::move(result));
+      break;
+    case Method::kTransportStats:
+      TransportStats(std::move(result));
+      break;
+    case Method::kStartNativeTrace:
+      StartNativeTrace(std::move(result));
+      break;
+    case Method::kStopNativeTrace:
+      StopNativeTrace(method_call, std::move(result));
+      break;
+    case Method::kExecuteBatch:
+      ExecuteBatch(method_call, std::move(result));
+      break;
+    case Method::kShutdown:
+      Shutdown(std::move(result));
+      break;
+    default:
+      result->NotImplemented();
+      break;
   }
 }
 
+// Creates the subsystems the MCPConfig flags ask for now rather than on
+// first use, and answers with every subsystem's init time so far
 void FlutterMcpPlugin::Initialize(
     const flutter::MethodCall<flutter::EncodableValue> &method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  // Initialize components based on config
-  result->Success();
+  if (const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments())) {
+    if (LookupFlag(*arguments, "useTray")) {
+      Tray();
+    }
+    if (LookupFlag(*arguments, "useNotification")) {
+      Notifications();
+    }
+    if (LookupFlag(*arguments, "secure")) {
+      SecureStorage();
+    }
+    if (LookupFlag(*arguments, "useBackgroundService")) {
+      Background();
+    }
+  }
+
+  flutter::EncodableMap response;
+  response[flutter::EncodableValue("subsystemInitUs")] = EncodeSubsystemTimings(*metrics_);
+  result->Success(flutter::EncodableValue(std::move(response)));
 }
 
 void FlutterMcpPlugin::StartBackgroundService(
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  background_service_->Start([this](const std::string& event_type, 
-                                   const std::map<std::string, flutter::EncodableValue>& data) {
+  Background().Start([this](const std::string& event_type, 
+                           const std::map<std::string, flutter::EncodableValue>& data) {
     SendEvent(event_type, data);
-  });
+  }, [this](const char* event_type) { return EventWanted(event_type); });
   result->Success(flutter::EncodableValue(true));
 }
 
 void FlutterMcpPlugin::StopBackgroundService(
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  background_service_->Stop();
+  if (background_service_) {
+    background_service_->Stop();
+  }
   result->Success(flutter::EncodableValue(true));
 }
 
@@ -183,7 +534,44 @@ void FlutterMcpPlugin::ConfigureBackgroundService(
     auto interval_it = arguments->find(flutter::EncodableValue("intervalMs"));
     if (interval_it != arguments->end()) {
       if (const auto* interval = std::get_if<int32_t>(&interval_it->second)) {
-        background_service_->SetInterval(*interval);
+        Background().SetInterval(*interval);
+      }
+    }
+
+    auto workers_it = arguments->find(flutter::EncodableValue("workerThreads"));
+    if (workers_it != arguments->end()) {
+      if (const auto* workers = std::get_if<int32_t>(&workers_it->second)) {
+        if (*workers >= 0) {
+          Background().SetWorkerThreads(static_cast<size_t>(*workers));
+        }
+      }
+    }
+
+    // Keeps pending tasks on disk so they come back after a restart; turning
+    // it off deletes the journal
+    auto journal_it = arguments->find(flutter::EncodableValue("persistTasks"));
+    if (journal_it != arguments->end()) {
+      if (const auto* persist = std::get_if<bool>(&journal_it->second)) {
+        if (*persist && !task_journal_) {
+          task_journal_ = OpenTaskJournal();
+        } else if (!*persist && task_journal_) {
+          task_journal_->Remove();
+          task_journal_.reset();
+        }
+      }
+    }
+    auto overdue_it = arguments->find(flutter::EncodableValue("overduePolicy"));
+    if (overdue_it != arguments->end() && task_journal_) {
+      if (const auto* policy = std::get_if<std::string>(&overdue_it->second)) {
+        task_journal_->SetOverduePolicy(ParseOverduePolicy(policy->c_str()));
+      }
+    }
+
+    // "eventLoop" (thread pool timers, the default) or "thread"
+    auto backend_it = arguments->find(flutter::EncodableValue("timerBackend"));
+    if (backend_it != arguments->end()) {
+      if (const auto* backend = std::get_if<std::string>(&backend_it->second)) {
+        Background().SetTimerBackend(ParseTimerBackend(*backend));
       }
     }
   }
@@ -215,14 +603,286 @@ void FlutterMcpPlugin::ScheduleBackgroundTask(
     return;
   }
 
-  background_service_->ScheduleTask(*task_id, *delay_millis, [this, task_id = *task_id]() {
-    std::map<std::string, flutter::EncodableValue> data;
-    data["taskId"] = flutter::EncodableValue(task_id);
-    data["timestamp"] = flutter::EncodableValue(static_cast<int64_t>(
-        std::chrono::system_clock::now().time_since_epoch().count()));
+  TaskPriority priority = TaskPriority::kNormal;
+  auto priority_it = arguments->find(flutter::EncodableValue("priority"));
+  if (priority_it != arguments->end()) {
+    if (const auto* name = std::get_if<std::string>(&priority_it->second)) {
+      priority = ParseTaskPriority(name->c_str());
+    }
+  }
+
+  // Only kept while a headless engine can run the task's callback
+  auto data_it = arguments->find(flutter::EncodableValue("data"));
+  if (headless_engine_ && data_it != arguments->end() && !data_it->second.IsNull()) {
+    task_data_[*task_id] = data_it->second;
+  }
+
+  int64_t journal_due_ms = -1;
+  if (task_journal_) {
+    JournaledTask journaled;
+    journaled.due_unix_ms = UnixMs() + (std::max)(*delay_millis, static_cast<int64_t>(0));
+    journaled.priority = static_cast<uint8_t>(priority);
+    task_journal_->Record(*task_id, journaled);
+    journal_due_ms = journaled.due_unix_ms;
+  }
+  held_replay_.Forget(*task_id);
+
+  // Dart-scheduled tasks have no native work; the result event is built on
+  // the worker once the task completes so it can report its timings.
+  Background().ScheduleTask(*task_id, *delay_millis, nullptr, priority,
+                            TaskResultSender(*task_id, journal_due_ms));
+
+  result->Success();
+}
+
+std::function<void(const TaskTiming&)> FlutterMcpPlugin::TaskResultSender(
+    const std::string& task_id, int64_t journal_due_ms) {
+  std::function<void()> retire;
+  if (journal_due_ms >= 0 && task_journal_) {
+    std::shared_ptr<TaskJournal> journal = task_journal_;
+    retire = [journal, task_id, journal_due_ms] { journal->Complete(task_id, journal_due_ms); };
+  }
+  return [this, task_id, retire](const TaskTiming& timing) {
+    if (headless_running_) {
+      // The event waits for the task's Dart callback, which has to run on
+      // the platform thread
+      {
+        std::lock_guard<std::mutex> lock(headless_mutex_);
+        headless_runs_.push_back(HeadlessRun{task_id, timing, retire});
+      }
+      PostMessage(message_window_, run_headless_message_, 0, 0);
+      return;
+    }
+    SendTaskResult(task_id, timing, retire);
+  };
+}
+
+void FlutterMcpPlugin::SendTaskResult(const std::string& task_id, const TaskTiming& timing,
+                                      const std::function<void()>& retire,
+                                      std::map<std::string, flutter::EncodableValue> extra) {
+  if (!EventWanted("backgroundTaskResult")) {
+    // Filtered out by the listener, so it is never coming; with nobody
+    // listening the task stays journaled for the next start
+    if (retire && event_listening_) {
+      retire();
+    }
+    return;
+  }
+  std::map<std::string, flutter::EncodableValue> data = std::move(extra);
+  data["taskId"] = flutter::EncodableValue(task_id);
+  data["timestamp"] = flutter::EncodableValue(static_cast<int64_t>(
+      std::chrono::system_clock::now().time_since_epoch().count()));
+  data["queueDelayMicros"] = flutter::EncodableValue(timing.queue_delay_us);
+  data["runTimeMicros"] = flutter::EncodableValue(timing.run_time_us);
+  if (!retire) {
     SendEvent("backgroundTaskResult", data);
+    return;
+  }
+
+  // Skips the batcher, which would lose track of when it is delivered
+  flutter::EncodableMap payload;
+  for (auto& entry : data) {
+    payload[flutter::EncodableValue(entry.first)] = std::move(entry.second);
+  }
+  flutter::EncodableMap event;
+  event[flutter::EncodableValue("type")] = flutter::EncodableValue("backgroundTaskResult");
+  event[flutter::EncodableValue("data")] = flutter::EncodableValue(std::move(payload));
+  PostEvent(flutter::EncodableValue(std::move(event)), retire);
+}
+
+void FlutterMcpPlugin::DrainHeadlessRuns() {
+  std::vector<HeadlessRun> runs;
+  {
+    std::lock_guard<std::mutex> lock(headless_mutex_);
+    runs.swap(headless_runs_);
+  }
+  for (auto& run : runs) {
+    flutter::EncodableValue data;
+    auto data_it = task_data_.find(run.task_id);
+    if (data_it != task_data_.end()) {
+      data = std::move(data_it->second);
+      task_data_.erase(data_it);
+    }
+    // Stopped or failed since the worker posted the run; report it as before
+    if (!headless_engine_ || !headless_engine_->running()) {
+      SendTaskResult(run.task_id, run.timing, run.retire);
+      continue;
+    }
+    const std::string task_id = run.task_id;
+    const TaskTiming timing = run.timing;
+    const std::function<void()> retire = run.retire;
+    headless_engine_->Run(
+        task_id, std::move(data),
+        [this, task_id, timing, retire](const flutter::EncodableValue& value,
+                                        const std::string* error, int64_t run_time_us) {
+          std::map<std::string, flutter::EncodableValue> extra;
+          extra["headless"] = flutter::EncodableValue(true);
+          extra["headlessRunMicros"] = flutter::EncodableValue(run_time_us);
+          if (error) {
+            extra["error"] = flutter::EncodableValue(*error);
+          } else {
+            extra["result"] = value;
+          }
+          SendTaskResult(task_id, timing, retire, std::move(extra));
+        });
+  }
+}
+
+// The engine is started once and kept for later tasks. It needs the
+// message window, which carries finished tasks to the platform thread
+void FlutterMcpPlugin::StartHeadlessEngine(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  if (!arguments) {
+    result->Error("INVALID_ARGS", "Missing arguments");
+    return;
+  }
+  int64_t callback_handle = 0;
+  if (!LookupInt64(*arguments, "callbackHandle", &callback_handle)) {
+    result->Error("INVALID_ARGS", "Missing callback handle");
+    return;
+  }
+  std::string entrypoint = "flutterMcpHeadlessMain";
+  auto entrypoint_it = arguments->find(flutter::EncodableValue("entrypoint"));
+  if (entrypoint_it != arguments->end()) {
+    if (const auto* name = std::get_if<std::string>(&entrypoint_it->second)) {
+      entrypoint = *name;
+    }
+  }
+  if (!message_window_) {
+    result->Error("UNAVAILABLE", "No message window to run headless tasks on");
+    return;
+  }
+
+  if (!headless_engine_) {
+    // The callback could not be found, so tasks go back to reporting
+    // without it
+    headless_engine_ = std::make_unique<HeadlessEngine>([this] {
+      headless_running_ = false;
+      task_data_.clear();
+    });
+  }
+  if (!headless_engine_->Start(entrypoint, callback_handle)) {
+    headless_engine_.reset();
+    result->Error("ENGINE_START_FAILED", "Failed to start the headless engine");
+    return;
+  }
+  headless_running_ = true;
+  result->Success();
+}
+
+// Runs still queued for or running in the engine are reported with an
+// error
+void FlutterMcpPlugin::StopHeadlessEngine(
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  headless_running_ = false;
+  headless_engine_.reset();
+  task_data_.clear();
+  result->Success();
+}
+
+// Plans the journaled tasks before Dart is running and holds them until
+// ReleaseTaskJournal(). A journal only exists if an earlier run turned it on
+void FlutterMcpPlugin::ReplayTaskJournal() {
+  if (GetFileAttributesW(TaskJournalPath().c_str()) == INVALID_FILE_ATTRIBUTES) {
+    return;
+  }
+  task_journal_ = OpenTaskJournal();
+  if (!task_journal_) {
+    return;
+  }
+
+  const int64_t now = UnixMs();
+  const OverduePolicy policy = task_journal_->overdue_policy();
+  std::vector<std::string> dropped;
+  task_journal_->ForEachTask([&](const std::string& task_id, const JournaledTask& task) {
+    if (!held_replay_.Hold(task_id, task, now, policy)) {
+      dropped.push_back(task_id);
+    }
+  });
+  for (const auto& task_id : dropped) {
+    task_journal_->Erase(task_id);
+  }
+}
+
+// Puts the held tasks on the scheduler once Dart listens for their results
+void FlutterMcpPlugin::ReleaseTaskJournal() {
+  if (held_replay_.size() == 0) {
+    return;
+  }
+  held_replay_.Release(UnixMs(), [this](const std::string& task_id, const JournaledTask& task,
+                                        int64_t delay_ms) {
+    const auto priority = static_cast<TaskPriority>(task.priority);
+    if (task.recurring) {
+      Background().ScheduleRecurringTask(task_id, delay_ms, task.recurrence, nullptr,
+                                         priority, TaskResultSender(task_id));
+    } else {
+      Background().ScheduleTask(task_id, delay_ms, nullptr, priority,
+                                TaskResultSender(task_id, task.due_unix_ms));
+    }
   });
+}
+
+// Registered once; every run sends its own backgroundTaskResult event
+void FlutterMcpPlugin::ScheduleRecurringTask(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  if (!arguments) {
+    result->Error("INVALID_ARGS", "Missing arguments");
+    return;
+  }
+
+  auto task_id_it = arguments->find(flutter::EncodableValue("taskId"));
+  const std::string* task_id =
+      task_id_it != arguments->end() ? std::get_if<std::string>(&task_id_it->second) : nullptr;
+  Recurrence recurrence;
+  if (!task_id || !LookupInt64(*arguments, "periodMs", &recurrence.period_ms)) {
+    result->Error("INVALID_ARGS", "Missing required arguments");
+    return;
+  }
+  if (recurrence.period_ms <= 0) {
+    result->Error("INVALID_ARGS", "periodMs must be positive");
+    return;
+  }
+
+  auto mode_it = arguments->find(flutter::EncodableValue("mode"));
+  if (mode_it != arguments->end()) {
+    if (const auto* name = std::get_if<std::string>(&mode_it->second)) {
+      recurrence.mode = ParseRecurrenceMode(name->c_str());
+    }
+  }
+  LookupInt64(*arguments, "jitterMs", &recurrence.jitter_ms);
+  auto overrun_it = arguments->find(flutter::EncodableValue("overrun"));
+  if (overrun_it != arguments->end()) {
+    if (const auto* name = std::get_if<std::string>(&overrun_it->second)) {
+      recurrence.overrun = ParseOverrunPolicy(name->c_str());
+    }
+  }
+
+  int64_t initial_delay_millis = recurrence.period_ms;
+  LookupInt64(*arguments, "initialDelayMs", &initial_delay_millis);
+
+  TaskPriority priority = TaskPriority::kNormal;
+  auto priority_it = arguments->find(flutter::EncodableValue("priority"));
+  if (priority_it != arguments->end()) {
+    if (const auto* name = std::get_if<std::string>(&priority_it->second)) {
+      priority = ParseTaskPriority(name->c_str());
+    }
+  }
 
+  if (task_journal_) {
+    JournaledTask journaled;
+    journaled.due_unix_ms = UnixMs() + (std::max)(initial_delay_millis, static_cast<int64_t>(0));
+    journaled.priority = static_cast<uint8_t>(priority);
+    journaled.recurring = true;
+    journaled.recurrence = recurrence;
+    task_journal_->Record(*task_id, journaled);
+  }
+  held_replay_.Forget(*task_id);
+  Background().ScheduleRecurringTask(*task_id, initial_delay_millis, recurrence, nullptr,
+                                     priority, TaskResultSender(*task_id));
   result->Success();
 }
 
@@ -247,7 +907,14 @@ void FlutterMcpPlugin::CancelBackgroundTask(
     return;
   }
 
-  background_service_->CancelTask(*task_id);
+  if (background_service_) {
+    background_service_->CancelTask(*task_id);
+  }
+  if (task_journal_) {
+    task_journal_->Erase(*task_id);
+  }
+  held_replay_.Forget(*task_id);
+  task_data_.erase(*task_id);
   result->Success();
 }
 
@@ -279,14 +946,83 @@ void FlutterMcpPlugin::ShowNotification(
     return;
   }
 
-  notification_manager_->ShowNotification(*title, *body, *id);
+  std::string group_key;
+  auto group_it = arguments->find(flutter::EncodableValue("groupKey"));
+  if (group_it != arguments->end()) {
+    if (const auto* group = std::get_if<std::string>(&group_it->second)) {
+      group_key = *group;
+    }
+  }
+
+  Notifications().ShowNotification(*title, *body, *id, group_key);
   result->Success();
 }
 
+namespace {
+
+// Reads an int or double argument
+bool LookupNumber(const flutter::EncodableMap& arguments, const char* key, double* value) {
+  auto it = arguments.find(flutter::EncodableValue(key));
+  if (it == arguments.end()) {
+    return false;
+  }
+  if (const auto* number = std::get_if<int32_t>(&it->second)) {
+    *value = *number;
+    return true;
+  }
+  if (const auto* number = std::get_if<int64_t>(&it->second)) {
+    *value = static_cast<double>(*number);
+    return true;
+  }
+  if (const auto* number = std::get_if<double>(&it->second)) {
+    *value = *number;
+    return true;
+  }
+  return false;
+}
+
+}  // namespace
+
 void FlutterMcpPlugin::ConfigureNotifications(
     const flutter::MethodCall<flutter::EncodableValue> &method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  // Configuration can be extended as needed
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  if (!arguments) {
+    result->Success();
+    return;
+  }
+
+  NotificationPolicy policy = Notifications().policy();
+  auto throttle_it = arguments->find(flutter::EncodableValue("throttle"));
+  if (throttle_it != arguments->end()) {
+    if (const auto* throttle = std::get_if<bool>(&throttle_it->second)) {
+      policy.enabled = *throttle;
+    }
+  }
+
+  double number;
+  if (LookupNumber(*arguments, "rateLimitPerSecond", &number)) {
+    if (number < 0) {
+      result->Error("INVALID_ARGS", "rateLimitPerSecond must not be negative");
+      return;
+    }
+    policy.rate_per_second = number;
+  }
+  if (LookupNumber(*arguments, "burst", &number)) {
+    if (number < 1) {
+      result->Error("INVALID_ARGS", "burst must be at least 1");
+      return;
+    }
+    policy.burst = static_cast<size_t>(number);
+  }
+  if (LookupNumber(*arguments, "groupWindowMs", &number) && number >= 0) {
+    policy.group_window_ms = static_cast<int64_t>(number);
+  }
+  if (LookupNumber(*arguments, "maxPending", &number) && number >= 0) {
+    policy.max_pending = static_cast<size_t>(number);
+  }
+
+  Notifications().Configure(policy);
   result->Success();
 }
 
@@ -311,13 +1047,17 @@ void FlutterMcpPlugin::CancelNotification(
     return;
   }
 
-  notification_manager_->CancelNotification(*id);
+  if (notification_manager_) {
+    notification_manager_->CancelNotification(*id);
+  }
   result->Success();
 }
 
 void FlutterMcpPlugin::CancelAllNotifications(
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  notification_manager_->CancelAllNotifications();
+  if (notification_manager_) {
+    notification_manager_->CancelAllNotifications();
+  }
   result->Success();
 }
 
@@ -346,7 +1086,8 @@ void FlutterMcpPlugin::SecureStore(
     return;
   }
 
-  if (secure_storage_->Store(*key, *value)) {
+  if (SecureStorage().Store(*key, *value)) {
+    ScheduleSecureFlush();
     result->Success();
   } else {
     result->Error("STORAGE_ERROR", "Failed to store value");
@@ -375,13 +1116,69 @@ void FlutterMcpPlugin::SecureRead(
   }
 
   std::string value;
-  if (secure_storage_->Read(*key, value)) {
+  if (SecureStorage().Read(*key, value)) {
     result->Success(flutter::EncodableValue(value));
   } else {
     result->Error("KEY_NOT_FOUND", "Key not found");
   }
 }
 
+// Binary-safe: the Uint8List buffer is encrypted in place and the read
+// decrypts straight into the reply's buffer
+void FlutterMcpPlugin::SecureStoreBytes(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  if (!arguments) {
+    result->Error("INVALID_ARGS", "Missing arguments");
+    return;
+  }
+
+  auto key_it = arguments->find(flutter::EncodableValue("key"));
+  auto value_it = arguments->find(flutter::EncodableValue("value"));
+  const auto* key = key_it != arguments->end() ? std::get_if<std::string>(&key_it->second)
+                                               : nullptr;
+  const auto* value = value_it != arguments->end()
+                          ? std::get_if<std::vector<uint8_t>>(&value_it->second)
+                          : nullptr;
+  if (!key || !value) {
+    result->Error("INVALID_ARGS", "Missing required arguments");
+    return;
+  }
+
+  if (SecureStorage().StoreBytes(*key, value->data(), value->size())) {
+    ScheduleSecureFlush();
+    result->Success();
+  } else {
+    result->Error("STORAGE_ERROR", "Failed to store value");
+  }
+}
+
+void FlutterMcpPlugin::SecureReadBytes(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  if (!arguments) {
+    result->Error("INVALID_ARGS", "Missing arguments");
+    return;
+  }
+
+  auto key_it = arguments->find(flutter::EncodableValue("key"));
+  const auto* key = key_it != arguments->end() ? std::get_if<std::string>(&key_it->second)
+                                               : nullptr;
+  if (!key) {
+    result->Error("INVALID_ARGS", "Missing key");
+    return;
+  }
+
+  std::vector<uint8_t> value;
+  if (SecureStorage().ReadBytes(*key, value)) {
+    result->Success(flutter::EncodableValue(std::move(value)));
+  } else {
+    result->Error("KEY_NOT_FOUND", "Key not found");
+  }
+}
+
 void FlutterMcpPlugin::SecureDelete(
     const flutter::MethodCall<flutter::EncodableValue> &method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
@@ -403,7 +1200,8 @@ void FlutterMcpPlugin::SecureDelete(
     return;
   }
 
-  secure_storage_->Delete(*key);
+  SecureStorage().Delete(*key);
+  ScheduleSecureFlush();
   result->Success();
 }
 
@@ -428,21 +1226,208 @@ void FlutterMcpPlugin::SecureContainsKey(
     return;
   }
 
-  result->Success(flutter::EncodableValue(secure_storage_->ContainsKey(*key)));
+  result->Success(flutter::EncodableValue(SecureStorage().ContainsKey(*key)));
 }
 
 void FlutterMcpPlugin::SecureDeleteAll(
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  secure_storage_->DeleteAll();
+  SecureStorage().DeleteAll();
   result->Success();
 }
 
-void FlutterMcpPlugin::ShowTrayIcon(
-    const flutter::MethodCall<flutter::EncodableValue> &method_call,
-    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+namespace {
+
+flutter::EncodableValue EncodeEntries(const std::map<std::string, std::string>& values) {
+  flutter::EncodableMap entries;
+  for (const auto& entry : values) {
+    entries[flutter::EncodableValue(entry.first)] = flutter::EncodableValue(entry.second);
+  }
+  return flutter::EncodableValue(std::move(entries));
+}
+
+}  // namespace
+
+void FlutterMcpPlugin::SecureReadMany(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  if (!arguments) {
+    result->Error("INVALID_ARGS", "Missing arguments");
+    return;
+  }
+
+  auto keys_it = arguments->find(flutter::EncodableValue("keys"));
+  const auto* key_list = keys_it != arguments->end()
+      ? std::get_if<flutter::EncodableList>(&keys_it->second)
+      : nullptr;
+  if (!key_list) {
+    result->Error("INVALID_ARGS", "Missing keys");
+    return;
+  }
+
+  std::vector<std::string> keys;
+  for (const auto& key_value : *key_list) {
+    if (const auto* key = std::get_if<std::string>(&key_value)) {
+      keys.push_back(*key);
+    }
+  }
+
+  std::map<std::string, std::string> values;
+  SecureStorage().ReadMany(keys, values);
+  result->Success(EncodeEntries(values));
+}
+
+void FlutterMcpPlugin::SecureReadPrefix(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  if (!arguments) {
+    result->Error("INVALID_ARGS", "Missing arguments");
+    return;
+  }
+
+  auto prefix_it = arguments->find(flutter::EncodableValue("prefix"));
+  const auto* prefix = prefix_it != arguments->end()
+      ? std::get_if<std::string>(&prefix_it->second)
+      : nullptr;
+  if (!prefix) {
+    result->Error("INVALID_ARGS", "Missing prefix");
+    return;
+  }
+
+  std::map<std::string, std::string> values;
+  if (!SecureStorage().ReadPrefix(*prefix, values)) {
+    // File names hold only a hash of each key, so there is nothing to match
+    result->Error("UNSUPPORTED",
+                  "Prefix reads need the recordFile storage backend; the files backend "
+                  "does not keep key names");
+    return;
+  }
+  result->Success(EncodeEntries(values));
+}
+
+void FlutterMcpPlugin::ConfigureSecureStorage(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  if (!arguments) {
+    result->Error("INVALID_ARGS", "Missing arguments");
+    return;
+  }
+
+  SecretCacheConfig config;
+
+  auto cache_it = arguments->find(flutter::EncodableValue("cache"));
+  if (cache_it != arguments->end()) {
+    if (const auto* enabled = std::get_if<bool>(&cache_it->second)) {
+      config.enabled = *enabled;
+    }
+  }
+
+  auto entries_it = arguments->find(flutter::EncodableValue("cacheMaxEntries"));
+  if (entries_it != arguments->end()) {
+    if (const auto* entries = std::get_if<int32_t>(&entries_it->second)) {
+      if (*entries > 0) {
+        config.max_entries = static_cast<size_t>(*entries);
+      }
+    }
+  }
+
+  auto ttl_it = arguments->find(flutter::EncodableValue("cacheTtlMs"));
+  if (ttl_it != arguments->end()) {
+    if (const auto* ttl = std::get_if<int32_t>(&ttl_it->second)) {
+      config.ttl_ms = *ttl;
+    }
+  }
+
+  auto backend_it = arguments->find(flutter::EncodableValue("backend"));
+  if (backend_it != arguments->end()) {
+    if (const auto* backend = std::get_if<std::string>(&backend_it->second)) {
+      if (!SecureStorage().SetBackend(ParseStorageBackend(*backend))) {
+        result->Error("STORAGE_ERROR", "Failed to open storage backend");
+        return;
+      }
+    }
+  }
+
+  auto encryption_it = arguments->find(flutter::EncodableValue("encryption"));
+  if (encryption_it != arguments->end()) {
+    if (const auto* encryption = std::get_if<std::string>(&encryption_it->second)) {
+      if (!SecureStorage().SetEncryption(ParseEncryptionMode(*encryption))) {
+        result->Error("STORAGE_ERROR", "Failed to load the master key");
+        return;
+      }
+    }
+  }
+
+  auto write_behind_it = arguments->find(flutter::EncodableValue("writeBehind"));
+  if (write_behind_it != arguments->end()) {
+    if (const auto* enabled = std::get_if<bool>(&write_behind_it->second)) {
+      WriteBehindConfig write_behind;
+      write_behind.enabled = *enabled;
+      auto delay_it = arguments->find(flutter::EncodableValue("writeBehindDelayMs"));
+      if (delay_it != arguments->end()) {
+        if (const auto* delay = std::get_if<int32_t>(&delay_it->second)) {
+          write_behind.delay_ms = *delay;
+        }
+      }
+      SecureStorage().ConfigureWriteBehind(write_behind);
+    }
+  }
+
+  SecureStorage().ConfigureCache(config);
+  result->Success();
+}
+
+// Persists everything buffered so far; fails if any buffered write since
+// the last flush could not be persisted
+void FlutterMcpPlugin::SecureFlush(
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  if (!secure_storage_) {
+    result->Success();
+    return;
+  }
+  FlushSecureStorage();
+  const size_t failures = secure_storage_->TakeWriteFailures();
+  if (failures > 0) {
+    result->Error("STORAGE_ERROR",
+                  std::to_string(failures) + " buffered writes could not be persisted");
+    return;
+  }
+  result->Success();
+}
+
+void FlutterMcpPlugin::ScheduleSecureFlush() {
+  if (secure_flush_armed_ || !secure_storage_ || secure_storage_->pending_writes() == 0) {
+    return;
+  }
+  // Without a window to time on, write-behind degrades to write-through
+  if (!message_window_) {
+    secure_storage_->Flush();
+    return;
+  }
+  // Armed by the first buffered write and not pushed back by later ones,
+  // so a steady stream of writes is still flushed every delay_ms
+  const auto delay = secure_storage_->write_behind_config().delay_ms;
+  secure_flush_armed_ = true;
+  SetTimer(message_window_, kSecureFlushTimerId, static_cast<UINT>(delay), nullptr);
+}
+
+void FlutterMcpPlugin::FlushSecureStorage() {
+  if (secure_flush_armed_) {
+    KillTimer(message_window_, kSecureFlushTimerId);
+    secure_flush_armed_ = false;
+  }
+  secure_storage_->Flush();
+}
+
+void FlutterMcpPlugin::ShowTrayIcon(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
   const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
   
   std::wstring icon_path;
+  std::string icon_name;
   std::wstring tooltip;
   
   if (arguments) {
@@ -452,6 +1437,13 @@ void FlutterMcpPlugin::ShowTrayIcon(
         icon_path = std::wstring(path->begin(), path->end());
       }
     }
+
+    auto name_it = arguments->find(flutter::EncodableValue("iconName"));
+    if (name_it != arguments->end()) {
+      if (const auto* name = std::get_if<std::string>(&name_it->second)) {
+        icon_name = *name;
+      }
+    }
     
     auto tooltip_it = arguments->find(flutter::EncodableValue("tooltip"));
     if (tooltip_it != arguments->end()) {
@@ -461,13 +1453,101 @@ void FlutterMcpPlugin::ShowTrayIcon(
     }
   }
   
-  tray_manager_->ShowTrayIcon(icon_path, tooltip);
+  Tray().ShowTrayIcon(icon_path, icon_name, tooltip);
   result->Success();
 }
 
 void FlutterMcpPlugin::HideTrayIcon(
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  tray_manager_->HideTrayIcon();
+  if (tray_manager_) {
+    tray_manager_->HideTrayIcon();
+  }
+  result->Success();
+}
+
+void FlutterMcpPlugin::RegisterTrayIcons(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  if (!arguments) {
+    result->Error("INVALID_ARGS", "Missing arguments");
+    return;
+  }
+
+  auto icons_it = arguments->find(flutter::EncodableValue("icons"));
+  const auto* icons = icons_it != arguments->end()
+                          ? std::get_if<flutter::EncodableList>(&icons_it->second)
+                          : nullptr;
+  if (!icons) {
+    result->Error("INVALID_ARGS", "Missing icons");
+    return;
+  }
+
+  // Decode everything up front so switching icons later never touches disk
+  for (const auto& icon : *icons) {
+    const auto* icon_map = std::get_if<flutter::EncodableMap>(&icon);
+    if (!icon_map) {
+      result->Error("INVALID_ARGS", "Invalid icon entry");
+      return;
+    }
+
+    auto name_it = icon_map->find(flutter::EncodableValue("name"));
+    const auto* name = name_it != icon_map->end()
+                           ? std::get_if<std::string>(&name_it->second)
+                           : nullptr;
+    if (!name || name->empty()) {
+      result->Error("INVALID_ARGS", "Missing icon name");
+      return;
+    }
+
+    bool registered = false;
+    auto bytes_it = icon_map->find(flutter::EncodableValue("bytes"));
+    auto path_it = icon_map->find(flutter::EncodableValue("iconPath"));
+    const std::vector<uint8_t>* bytes =
+        bytes_it != icon_map->end() ? std::get_if<std::vector<uint8_t>>(&bytes_it->second)
+                                    : nullptr;
+    const std::string* path = path_it != icon_map->end()
+                                  ? std::get_if<std::string>(&path_it->second)
+                                  : nullptr;
+    if (bytes) {
+      registered = Tray().RegisterIcon(*name, bytes->data(), bytes->size());
+    } else if (path) {
+      registered = Tray().RegisterIcon(*name, std::wstring(path->begin(), path->end()));
+    } else {
+      result->Error("INVALID_ARGS", "Icon " + *name + " needs bytes or iconPath");
+      return;
+    }
+
+    if (!registered) {
+      result->Error("INVALID_ICON", "Could not decode icon " + *name);
+      return;
+    }
+  }
+  result->Success();
+}
+
+void FlutterMcpPlugin::SetTrayIcon(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  if (!arguments) {
+    result->Error("INVALID_ARGS", "Missing arguments");
+    return;
+  }
+
+  auto name_it = arguments->find(flutter::EncodableValue("name"));
+  const auto* name = name_it != arguments->end()
+                         ? std::get_if<std::string>(&name_it->second)
+                         : nullptr;
+  if (!name) {
+    result->Error("INVALID_ARGS", "Missing icon name");
+    return;
+  }
+
+  if (!Tray().SetIcon(*name)) {
+    result->Error("ICON_NOT_FOUND", "No tray icon registered as " + *name);
+    return;
+  }
   result->Success();
 }
 
@@ -530,13 +1610,60 @@ void FlutterMcpPlugin::SetTrayMenu(
     menu_items.push_back(menu_item);
   }
 
-  tray_manager_->SetMenuItems(menu_items, [this](const std::string& item_id) {
+  bool incremental = true;
+  auto incremental_it = arguments->find(flutter::EncodableValue("incremental"));
+  if (incremental_it != arguments->end()) {
+    if (const auto* value = std::get_if<bool>(&incremental_it->second)) {
+      incremental = *value;
+    }
+  }
+
+  Tray().SetMenuItems(menu_items, [this](const std::string& item_id) {
+    if (!EventWanted("trayEvent")) {
+      return;
+    }
     std::map<std::string, flutter::EncodableValue> data;
     data["action"] = flutter::EncodableValue("menuItemClicked");
     data["itemId"] = flutter::EncodableValue(item_id);
     SendEvent("trayEvent", data);
-  });
+  }, !incremental);
+
+  result->Success();
+}
+
+void FlutterMcpPlugin::UpdateTrayMenuItem(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  if (!arguments) {
+    result->Error("INVALID_ARGS", "Missing arguments");
+    return;
+  }
+
+  auto id_it = arguments->find(flutter::EncodableValue("id"));
+  const auto* id = id_it != arguments->end() ? std::get_if<std::string>(&id_it->second)
+                                             : nullptr;
+  if (!id) {
+    result->Error("INVALID_ARGS", "Missing item id");
+    return;
+  }
+
+  const std::string* label = nullptr;
+  auto label_it = arguments->find(flutter::EncodableValue("label"));
+  if (label_it != arguments->end()) {
+    label = std::get_if<std::string>(&label_it->second);
+  }
+
+  const bool* disabled = nullptr;
+  auto disabled_it = arguments->find(flutter::EncodableValue("disabled"));
+  if (disabled_it != arguments->end()) {
+    disabled = std::get_if<bool>(&disabled_it->second);
+  }
 
+  if (!Tray().UpdateMenuItem(*id, label, disabled)) {
+    result->Error("ITEM_NOT_FOUND", "No tray menu item with id " + *id);
+    return;
+  }
   result->Success();
 }
 
@@ -561,7 +1688,7 @@ void FlutterMcpPlugin::UpdateTrayTooltip(
     return;
   }
 
-  tray_manager_->UpdateTooltip(std::wstring(tooltip->begin(), tooltip->end()));
+  Tray().UpdateTooltip(std::wstring(tooltip->begin(), tooltip->end()));
   result->Success();
 }
 
@@ -574,18 +1701,259 @@ void FlutterMcpPlugin::ConfigureTray(
 
 void FlutterMcpPlugin::Shutdown(
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  // Stop background service
-  background_service_->Stop();
-  
-  // Hide tray icon
-  tray_manager_->HideTrayIcon();
-  
-  // Cancel all notifications
-  notification_manager_->CancelAllNotifications();
+  // Only the subsystems that were ever created have anything to undo
+  if (background_service_) {
+    background_service_->Stop();
+  }
+  headless_running_ = false;
+  headless_engine_.reset();
+  task_data_.clear();
+  if (tray_manager_) {
+    tray_manager_->HideTrayIcon();
+  }
+  if (notification_manager_) {
+    notification_manager_->CancelAllNotifications();
+  }
+  if (secure_storage_) {
+    FlushSecureStorage();
+  }
+  // Terminates MCP servers
+  transport_.reset();
   
   result->Success();
 }
 
+namespace {
+
+// Reads dropNotifications, coalesceProgress and matchResponses; missing
+// entries keep their defaults
+RoutingRules ParseRoutingRules(const flutter::EncodableMap& arguments) {
+  RoutingRules rules;
+  auto dropped_it = arguments.find(flutter::EncodableValue("dropNotifications"));
+  if (dropped_it != arguments.end()) {
+    if (const auto* list = std::get_if<flutter::EncodableList>(&dropped_it->second)) {
+      for (const auto& method : *list) {
+        if (const auto* name = std::get_if<std::string>(&method)) {
+          rules.dropped_notifications.insert(*name);
+        }
+      }
+    }
+  }
+  auto coalesce_it = arguments.find(flutter::EncodableValue("coalesceProgress"));
+  if (coalesce_it != arguments.end()) {
+    if (const auto* coalesce = std::get_if<bool>(&coalesce_it->second)) {
+      rules.coalesce_progress = *coalesce;
+    }
+  }
+  auto match_it = arguments.find(flutter::EncodableValue("matchResponses"));
+  if (match_it != arguments.end()) {
+    if (const auto* match = std::get_if<bool>(&match_it->second)) {
+      rules.match_responses = *match;
+    }
+  }
+  return rules;
+}
+
+}  // namespace
+
+void FlutterMcpPlugin::TransportSpawn(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  if (!arguments) {
+    result->Error("INVALID_ARGS", "Missing arguments");
+    return;
+  }
+
+  auto id_it = arguments->find(flutter::EncodableValue("serverId"));
+  auto command_it = arguments->find(flutter::EncodableValue("command"));
+  const auto* server_id = id_it != arguments->end() ? std::get_if<std::string>(&id_it->second)
+                                                    : nullptr;
+  const auto* command = command_it != arguments->end()
+                            ? std::get_if<std::string>(&command_it->second)
+                            : nullptr;
+  if (!server_id || !command) {
+    result->Error("INVALID_ARGS", "Missing serverId or command");
+    return;
+  }
+
+  StdioTransport::Options options;
+  options.argv.push_back(*command);
+  auto arguments_it = arguments->find(flutter::EncodableValue("arguments"));
+  if (arguments_it != arguments->end()) {
+    if (const auto* list = std::get_if<flutter::EncodableList>(&arguments_it->second)) {
+      for (const auto& argument : *list) {
+        if (const auto* text = std::get_if<std::string>(&argument)) {
+          options.argv.push_back(*text);
+        }
+      }
+    }
+  }
+  auto env_it = arguments->find(flutter::EncodableValue("environment"));
+  if (env_it != arguments->end()) {
+    if (const auto* env = std::get_if<flutter::EncodableMap>(&env_it->second)) {
+      for (const auto& entry : *env) {
+        const auto* name = std::get_if<std::string>(&entry.first);
+        const auto* value = std::get_if<std::string>(&entry.second);
+        if (name && value) {
+          options.env.push_back(*name + "=" + *value);
+        }
+      }
+    }
+  }
+  auto directory_it = arguments->find(flutter::EncodableValue("workingDirectory"));
+  if (directory_it != arguments->end()) {
+    if (const auto* directory = std::get_if<std::string>(&directory_it->second)) {
+      options.working_directory = *directory;
+    }
+  }
+  auto framing_it = arguments->find(flutter::EncodableValue("framing"));
+  if (framing_it != arguments->end()) {
+    if (const auto* framing = std::get_if<std::string>(&framing_it->second)) {
+      options.framing = ParseFraming(framing->c_str());
+    }
+  }
+  options.routing = ParseRoutingRules(*arguments);
+
+  DWORD pid = 0;
+  std::string error;
+  if (!Transport().Spawn(*server_id, options, &pid, &error)) {
+    result->Error("SPAWN_FAILED", error);
+    return;
+  }
+  flutter::EncodableMap response;
+  response[flutter::EncodableValue("pid")] = flutter::EncodableValue(static_cast<int64_t>(pid));
+  result->Success(flutter::EncodableValue(std::move(response)));
+}
+
+// False if the server is not running
+void FlutterMcpPlugin::TransportSend(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  if (!arguments) {
+    result->Error("INVALID_ARGS", "Missing arguments");
+    return;
+  }
+
+  auto id_it = arguments->find(flutter::EncodableValue("serverId"));
+  auto message_it = arguments->find(flutter::EncodableValue("message"));
+  const auto* server_id = id_it != arguments->end() ? std::get_if<std::string>(&id_it->second)
+                                                    : nullptr;
+  if (!server_id || message_it == arguments->end()) {
+    result->Error("INVALID_ARGS", "Missing serverId or message");
+    return;
+  }
+
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+  if (const auto* bytes = std::get_if<std::vector<uint8_t>>(&message_it->second)) {
+    data = bytes->data();
+    size = bytes->size();
+  } else if (const auto* text = std::get_if<std::string>(&message_it->second)) {
+    data = reinterpret_cast<const uint8_t*>(text->data());
+    size = text->size();
+  } else {
+    result->Error("INVALID_ARGS", "message must be a String or Uint8List");
+    return;
+  }
+
+  const bool sent = transport_ && transport_->Send(*server_id, data, size);
+  result->Success(flutter::EncodableValue(sent));
+}
+
+void FlutterMcpPlugin::TransportClose(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  auto id_it = arguments ? arguments->find(flutter::EncodableValue("serverId"))
+                         : flutter::EncodableMap::const_iterator();
+  const auto* server_id = arguments && id_it != arguments->end()
+                              ? std::get_if<std::string>(&id_it->second)
+                              : nullptr;
+  if (!server_id) {
+    result->Error("INVALID_ARGS", "Missing serverId");
+    return;
+  }
+
+  const bool closed = transport_ && transport_->Close(*server_id);
+  result->Success(flutter::EncodableValue(closed));
+}
+
+void FlutterMcpPlugin::TransportConfigureRouting(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  auto id_it = arguments ? arguments->find(flutter::EncodableValue("serverId"))
+                         : flutter::EncodableMap::const_iterator();
+  const auto* server_id = arguments && id_it != arguments->end()
+                              ? std::get_if<std::string>(&id_it->second)
+                              : nullptr;
+  if (!server_id) {
+    result->Error("INVALID_ARGS", "Missing serverId");
+    return;
+  }
+
+  const bool configured =
+      transport_ && transport_->ConfigureRouting(*server_id, ParseRoutingRules(*arguments));
+  result->Success(flutter::EncodableValue(configured));
+}
+
+void FlutterMcpPlugin::TransportStats(
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const RoutingCounts counts = transport_ ? transport_->routing_counts() : RoutingCounts();
+  auto as_int = [](uint64_t value) {
+    return flutter::EncodableValue(static_cast<int64_t>(value));
+  };
+  flutter::EncodableMap stats;
+  stats[flutter::EncodableValue("servers")] = as_int(transport_ ? transport_->server_count() : 0);
+  stats[flutter::EncodableValue("pendingWriteBytes")] =
+      as_int(transport_ ? transport_->pending_write_bytes() : 0);
+  stats[flutter::EncodableValue("droppedNotifications")] = as_int(counts.dropped_notifications);
+  stats[flutter::EncodableValue("coalescedProgress")] = as_int(counts.coalesced_progress);
+  stats[flutter::EncodableValue("unmatchedResponses")] = as_int(counts.unmatched_responses);
+  result->Success(flutter::EncodableValue(std::move(stats)));
+}
+
+void FlutterMcpPlugin::StartNativeTrace(
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  NativeTracer::NameThread("platform");
+  NativeTracer::Instance().Start();
+  result->Success();
+}
+
+// Writes the trace to "path" when given, otherwise returns it as "trace"
+void FlutterMcpPlugin::StopNativeTrace(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const TraceDump dump = NativeTracer::Instance().Stop(GetCurrentProcessId());
+
+  flutter::EncodableMap reply;
+  reply[flutter::EncodableValue("events")] =
+      flutter::EncodableValue(static_cast<int64_t>(dump.events));
+  reply[flutter::EncodableValue("dropped")] =
+      flutter::EncodableValue(static_cast<int64_t>(dump.dropped));
+  const std::string* path = nullptr;
+  if (auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments())) {
+    auto path_it = arguments->find(flutter::EncodableValue("path"));
+    if (path_it != arguments->end()) {
+      path = std::get_if<std::string>(&path_it->second);
+    }
+  }
+  if (path) {
+    std::ofstream file(std::filesystem::u8path(*path), std::ios::binary | std::ios::trunc);
+    file.write(dump.json.data(), static_cast<std::streamsize>(dump.json.size()));
+    if (!file) {
+      result->Error("TRACE_WRITE_FAILED", "Failed to write trace to " + *path);
+      return;
+    }
+    reply[flutter::EncodableValue("path")] = flutter::EncodableValue(*path);
+  } else {
+    reply[flutter::EncodableValue("trace")] = flutter::EncodableValue(dump.json);
+  }
+  result->Success(flutter::EncodableValue(std::move(reply)));
+}
+
 void FlutterMcpPlugin::CheckPermission(
     const flutter::MethodCall<flutter::EncodableValue> &method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
@@ -660,27 +2028,528 @@ void FlutterMcpPlugin::RequestPermission(
   }
 }
 
+void FlutterMcpPlugin::ConfigureEvents(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  if (!arguments) {
+    result->Error("INVALID_ARGS", "Missing arguments");
+    return;
+  }
+
+  EventBatchingConfig config;
+
+  auto batching_it = arguments->find(flutter::EncodableValue("batching"));
+  if (batching_it != arguments->end()) {
+    if (const auto* enabled = std::get_if<bool>(&batching_it->second)) {
+      config.enabled = *enabled;
+    }
+  }
+
+  auto size_it = arguments->find(flutter::EncodableValue("maxBatchSize"));
+  if (size_it != arguments->end()) {
+    if (const auto* size = std::get_if<int32_t>(&size_it->second)) {
+      if (*size > 0) {
+        config.max_batch_size = static_cast<size_t>(*size);
+      }
+    }
+  }
+
+  auto delay_it = arguments->find(flutter::EncodableValue("maxBatchDelayMs"));
+  if (delay_it != arguments->end()) {
+    if (const auto* delay = std::get_if<int32_t>(&delay_it->second)) {
+      config.max_delay_ms = *delay;
+    }
+  }
+
+  auto coalesce_it = arguments->find(flutter::EncodableValue("coalescePeriodic"));
+  if (coalesce_it != arguments->end()) {
+    if (const auto* coalesce = std::get_if<bool>(&coalesce_it->second)) {
+      config.coalesce_periodic = *coalesce;
+    }
+  }
+
+  auto policy_it = arguments->find(flutter::EncodableValue("overflowPolicy"));
+  if (policy_it != arguments->end()) {
+    if (const auto* policy = std::get_if<std::string>(&policy_it->second)) {
+      overflow_policy_ = ParseOverflowPolicy(*policy);
+    }
+  }
+
+  event_batcher_->Configure(config);
+  result->Success();
+}
+
+void FlutterMcpPlugin::GetEventQueueStats(
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const uint64_t dropped_oldest = dropped_oldest_;
+  const uint64_t dropped_newest = dropped_newest_;
+  flutter::EncodableMap stats;
+  stats[flutter::EncodableValue("capacity")] =
+      flutter::EncodableValue(static_cast<int64_t>(event_queue_.capacity()));
+  stats[flutter::EncodableValue("droppedOldest")] =
+      flutter::EncodableValue(static_cast<int64_t>(dropped_oldest));
+  stats[flutter::EncodableValue("droppedNewest")] =
+      flutter::EncodableValue(static_cast<int64_t>(dropped_newest));
+  stats[flutter::EncodableValue("droppedEvents")] =
+      flutter::EncodableValue(static_cast<int64_t>(dropped_oldest + dropped_newest));
+  stats[flutter::EncodableValue("filteredEvents")] =
+      flutter::EncodableValue(static_cast<int64_t>(event_filter_.filtered()));
+  result->Success(flutter::EncodableValue(stats));
+}
+
+namespace {
+
+flutter::EncodableValue EncodeHistogram(const LatencyHistogram& histogram) {
+  const HistogramSnapshot snapshot = histogram.Snapshot();
+  auto as_int = [](uint64_t value) {
+    return flutter::EncodableValue(static_cast<int64_t>(value));
+  };
+  flutter::EncodableMap encoded;
+  encoded[flutter::EncodableValue("count")] = as_int(snapshot.count);
+  encoded[flutter::EncodableValue("sumUs")] = as_int(snapshot.sum);
+  encoded[flutter::EncodableValue("meanUs")] = flutter::EncodableValue(snapshot.mean());
+  encoded[flutter::EncodableValue("minUs")] = as_int(snapshot.min);
+  encoded[flutter::EncodableValue("maxUs")] = as_int(snapshot.max);
+  encoded[flutter::EncodableValue("p50Us")] = as_int(snapshot.p50);
+  encoded[flutter::EncodableValue("p90Us")] = as_int(snapshot.p90);
+  encoded[flutter::EncodableValue("p99Us")] = as_int(snapshot.p99);
+  encoded[flutter::EncodableValue("p999Us")] = as_int(snapshot.p999);
+  return flutter::EncodableValue(std::move(encoded));
+}
+
+// Everything recorded so far, in the shape getNativeMetrics returns
+flutter::EncodableMap EncodeMetrics(const NativeMetrics& metrics) {
+  flutter::EncodableMap methods;
+  metrics.ForEachMethod([&methods](const char* name, const LatencyHistogram& histogram) {
+    methods[flutter::EncodableValue(name)] = EncodeHistogram(histogram);
+  });
+
+  flutter::EncodableMap queue;
+  queue[flutter::EncodableValue("depth")] =
+      flutter::EncodableValue(metrics.event_queue_depth.value());
+  queue[flutter::EncodableValue("maxDepth")] =
+      flutter::EncodableValue(metrics.event_queue_depth.max());
+
+  flutter::EncodableMap snapshot;
+  snapshot[flutter::EncodableValue("methods")] = flutter::EncodableValue(std::move(methods));
+  snapshot[flutter::EncodableValue("schedulerLatenessUs")] =
+      EncodeHistogram(metrics.scheduler_lateness);
+  snapshot[flutter::EncodableValue("secureStorageUs")] = EncodeHistogram(metrics.secure_storage);
+  snapshot[flutter::EncodableValue("eventPostUs")] = EncodeHistogram(metrics.event_post);
+  snapshot[flutter::EncodableValue("eventQueue")] = flutter::EncodableValue(std::move(queue));
+  snapshot[flutter::EncodableValue("subsystemInitUs")] = EncodeSubsystemTimings(metrics);
+  return snapshot;
+}
+
+}  // namespace
+
+void FlutterMcpPlugin::GetNativeMetrics(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  flutter::EncodableMap snapshot = EncodeMetrics(*metrics_);
+
+  if (const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments())) {
+    auto reset_it = arguments->find(flutter::EncodableValue("reset"));
+    if (reset_it != arguments->end()) {
+      const auto* reset = std::get_if<bool>(&reset_it->second);
+      if (reset && *reset) {
+        metrics_->Reset();
+      }
+    }
+  }
+  result->Success(flutter::EncodableValue(std::move(snapshot)));
+}
+
+void FlutterMcpPlugin::ConfigureNativeMetrics(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  if (!arguments) {
+    result->Error("INVALID_ARGS", "Missing arguments");
+    return;
+  }
+
+  double interval_ms = 0;
+  if (!LookupNumber(*arguments, "eventIntervalMs", &interval_ms) || interval_ms < 0) {
+    result->Error("INVALID_ARGS", "Invalid eventIntervalMs");
+    return;
+  }
+  if (interval_ms > 0 && !message_window_) {
+    result->Error("UNAVAILABLE", "No window to run the metrics timer on");
+    return;
+  }
+
+  if (metrics_interval_ms_) {
+    KillTimer(message_window_, kMetricsTimerId);
+    metrics_interval_ms_ = 0;
+  }
+  if (interval_ms > 0) {
+    metrics_interval_ms_ = static_cast<UINT>(interval_ms);
+    SetTimer(message_window_, kMetricsTimerId, metrics_interval_ms_, nullptr);
+  }
+  result->Success();
+}
+
+namespace {
+
+flutter::EncodableMap BatchError(const std::string& code, const std::string& message,
+                                 const flutter::EncodableValue* details) {
+  flutter::EncodableMap error;
+  error[flutter::EncodableValue("code")] = flutter::EncodableValue(code);
+  error[flutter::EncodableValue("message")] = flutter::EncodableValue(message);
+  error[flutter::EncodableValue("details")] =
+      details ? *details : flutter::EncodableValue();
+
+  flutter::EncodableMap entry;
+  entry[flutter::EncodableValue("success")] = flutter::EncodableValue(false);
+  entry[flutter::EncodableValue("error")] = flutter::EncodableValue(std::move(error));
+  return entry;
+}
+
+}  // namespace
+
+void FlutterMcpPlugin::ExecuteBatch(
+    const flutter::MethodCall<flutter::EncodableValue> &method_call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+  const flutter::EncodableList* operations = nullptr;
+  if (arguments) {
+    auto operations_it = arguments->find(flutter::EncodableValue("operations"));
+    if (operations_it != arguments->end()) {
+      operations = std::get_if<flutter::EncodableList>(&operations_it->second);
+    }
+  }
+  if (!operations) {
+    result->Error("INVALID_ARGS", "Missing operations");
+    return;
+  }
+
+  // Every handler completes its result before returning, so each operation
+  // can be run through HandleMethodCall and captured in place
+  flutter::EncodableList results;
+  results.reserve(operations->size());
+  for (const auto& operation : *operations) {
+    const auto* op = std::get_if<flutter::EncodableMap>(&operation);
+    const std::string* method = nullptr;
+    const flutter::EncodableValue* op_args = nullptr;
+    if (op) {
+      auto method_it = op->find(flutter::EncodableValue("method"));
+      if (method_it != op->end()) {
+        method = std::get_if<std::string>(&method_it->second);
+      }
+      auto args_it = op->find(flutter::EncodableValue("args"));
+      if (args_it != op->end()) {
+        op_args = &args_it->second;
+      }
+    }
+
+    flutter::EncodableMap entry;
+    if (!method) {
+      entry = BatchError("INVALID_ARGS", "Missing method", nullptr);
+    } else if (LookupMethod(method->c_str()) == Method::kExecuteBatch) {
+      entry = BatchError("INVALID_ARGS", "Batches cannot be nested", nullptr);
+    } else {
+      flutter::MethodCall<flutter::EncodableValue> call(
+          *method, op_args ? std::make_unique<flutter::EncodableValue>(*op_args)
+                           : std::make_unique<flutter::EncodableValue>());
+      entry = BatchError("NO_RESULT", *method, nullptr);
+      HandleMethodCall(call, std::make_unique<flutter::MethodResultFunctions<flutter::EncodableValue>>(
+          [&entry](const flutter::EncodableValue* value) {
+            entry.clear();
+            entry[flutter::EncodableValue("success")] = flutter::EncodableValue(true);
+            entry[flutter::EncodableValue("result")] =
+                value ? *value : flutter::EncodableValue();
+          },
+          [&entry](const std::string& code, const std::string& message,
+                   const flutter::EncodableValue* details) {
+            entry = BatchError(code, message, details);
+          },
+          [&entry, method]() {
+            entry = BatchError("NOT_IMPLEMENTED", *method, nullptr);
+          }));
+    }
+    results.emplace_back(std::move(entry));
+  }
+
+  result->Success(flutter::EncodableValue(std::move(results)));
+}
+
+// Listen arguments may narrow the stream: {types: [...]} sends only those
+// types, and {sampling: {type: rate}} sends that fraction of a type
 void FlutterMcpPlugin::OnListen(
     const flutter::EncodableValue* arguments,
     std::unique_ptr<flutter::EventSink<flutter::EncodableValue>>&& events) {
-  std::lock_guard<std::mutex> lock(event_sink_mutex_);
+  EventSubscription subscription;
+  const auto* options = arguments ? std::get_if<flutter::EncodableMap>(arguments) : nullptr;
+  if (options) {
+    auto types_it = options->find(flutter::EncodableValue("types"));
+    const auto* types = types_it != options->end()
+                            ? std::get_if<flutter::EncodableList>(&types_it->second)
+                            : nullptr;
+    if (types) {
+      subscription.all_types = false;
+      for (const auto& type : *types) {
+        if (const auto* name = std::get_if<std::string>(&type)) {
+          subscription.rates[*name] = 1.0;
+        }
+      }
+    }
+
+    auto sampling_it = options->find(flutter::EncodableValue("sampling"));
+    const auto* sampling = sampling_it != options->end()
+                               ? std::get_if<flutter::EncodableMap>(&sampling_it->second)
+                               : nullptr;
+    if (sampling) {
+      for (const auto& entry : *sampling) {
+        const auto* name = std::get_if<std::string>(&entry.first);
+        // Sampling a type the list left out does not subscribe to it
+        if (!name || (!subscription.all_types && subscription.rates.count(*name) == 0)) {
+          continue;
+        }
+        if (const auto* rate = std::get_if<double>(&entry.second)) {
+          subscription.rates[*name] = *rate;
+        } else if (const auto* whole = std::get_if<int32_t>(&entry.second)) {
+          subscription.rates[*name] = *whole;
+        }
+      }
+    }
+  }
+  event_filter_.Subscribe(subscription);
   event_sink_ = std::move(events);
+  event_listening_ = true;
+  ReleaseTaskJournal();
 }
 
-void FlutterMcpPlugin::OnCancel(const flutter::EncodableValue* arguments) {
-  std::lock_guard<std::mutex> lock(event_sink_mutex_);
+void FlutterMcpPlugin::OnCancel(const flutter::EncodableValue* /* arguments */) {
+  event_listening_ = false;
   event_sink_ = nullptr;
+  event_filter_.Reset();
+}
+
+bool FlutterMcpPlugin::EventWanted(const char* event_type) {
+  return event_listening_ && event_filter_.Admit(event_type);
 }
 
 void FlutterMcpPlugin::SendEvent(const std::string& event_type,
                                 const std::map<std::string, flutter::EncodableValue>& data) {
-  std::lock_guard<std::mutex> lock(event_sink_mutex_);
-  if (event_sink_) {
-    flutter::EncodableMap event;
-    event[flutter::EncodableValue("type")] = flutter::EncodableValue(event_type);
-    event[flutter::EncodableValue("data")] = flutter::EncodableValue(data);
-    event_sink_->Success(flutter::EncodableValue(event));
+  flutter::EncodableMap payload;
+  for (const auto& entry : data) {
+    payload[flutter::EncodableValue(entry.first)] = entry.second;
+  }
+
+  // Only periodic background ticks are safe to fold into the latest one
+  bool coalescible = false;
+  if (event_type == "backgroundEvent") {
+    auto type_it = data.find("type");
+    if (type_it != data.end()) {
+      const auto* type = std::get_if<std::string>(&type_it->second);
+      coalescible = type && *type == "periodic";
+    }
+  }
+
+  flutter::EncodableValue value(std::move(payload));
+  if (event_batcher_ && event_batcher_->Add(event_type, std::move(value), coalescible)) {
+    return;
+  }
+
+  flutter::EncodableMap event;
+  event[flutter::EncodableValue("type")] = flutter::EncodableValue(event_type);
+  event[flutter::EncodableValue("data")] = std::move(value);
+  PostEvent(flutter::EncodableValue(std::move(event)));
+}
+
+void FlutterMcpPlugin::SendEventBatch(const std::string& event_type,
+                                     std::vector<flutter::EncodableValue>&& events,
+                                     size_t coalesced) {
+  flutter::EncodableList list(std::make_move_iterator(events.begin()),
+                              std::make_move_iterator(events.end()));
+  flutter::EncodableMap event;
+  event[flutter::EncodableValue("type")] = flutter::EncodableValue(event_type);
+  event[flutter::EncodableValue("batch")] = flutter::EncodableValue(true);
+  event[flutter::EncodableValue("data")] = flutter::EncodableValue(std::move(list));
+  event[flutter::EncodableValue("coalesced")] =
+      flutter::EncodableValue(static_cast<int64_t>(coalesced));
+  PostEvent(flutter::EncodableValue(std::move(event)));
+}
+
+void FlutterMcpPlugin::PostEvent(flutter::EncodableValue event,
+                                 std::function<void()> on_delivered) {
+  TraceSpan span(TraceCategory::kEvents, "post");
+  // Includes any wait for room under the blocking policy
+  const auto start = NativeMetrics::Clock::now();
+  QueuedEvent queued{std::move(event), std::move(on_delivered)};
+  while (!event_queue_.TryPush(std::move(queued))) {
+    OverflowPolicy policy = overflow_policy_;
+    // Nobody would ever make room without a window to drain on
+    if (policy == OverflowPolicy::kBlock && !message_window_) {
+      policy = OverflowPolicy::kDropNewest;
+    }
+
+    switch (policy) {
+      case OverflowPolicy::kDropNewest:
+        dropped_newest_++;
+        metrics_->event_post.Record(NativeMetrics::MicrosSince(start));
+        return;
+      case OverflowPolicy::kDropOldest: {
+        QueuedEvent oldest;
+        if (event_queue_.TryPop(oldest)) {
+          dropped_oldest_++;
+          metrics_->event_queue_depth.Add(-1);
+        }
+        break;
+      }
+      case OverflowPolicy::kBlock:
+        if (std::this_thread::get_id() == platform_thread_id_) {
+          // The consumer is this thread; waiting would never end
+          DrainEvents();
+        } else {
+          ScheduleDrain();
+          std::this_thread::yield();
+        }
+        break;
+    }
+  }
+  metrics_->event_queue_depth.Add(1);
+  metrics_->event_post.Record(NativeMetrics::MicrosSince(start));
+  ScheduleDrain();
+}
+
+void FlutterMcpPlugin::ScheduleDrain() {
+  // One message per drain, however many events are pushed before it runs
+  if (!drain_scheduled_.exchange(true) && message_window_) {
+    PostMessage(message_window_, drain_events_message_, 0, 0);
+  }
+}
+
+void FlutterMcpPlugin::DrainEvents() {
+  TraceSpan span(TraceCategory::kEvents, "deliver");
+  // Clear the flag first so a push racing with this drain schedules another
+  drain_scheduled_ = false;
+
+  // Publish at most one buffer's worth per message so a flood of events
+  // cannot starve the rest of the message loop
+  QueuedEvent queued;
+  for (size_t i = 0; i < event_queue_.capacity(); i++) {
+    if (!event_queue_.TryPop(queued)) {
+      return;
+    }
+    metrics_->event_queue_depth.Add(-1);
+    if (event_sink_) {
+      event_sink_->Success(queued.event);
+      if (queued.on_delivered) {
+        queued.on_delivered();
+      }
+    }
+  }
+  ScheduleDrain();
+}
+
+void FlutterMcpPlugin::PostTransportEvent(flutter::EncodableValue event) {
+  bool first;
+  {
+    std::lock_guard<std::mutex> lock(transport_mutex_);
+    first = transport_events_.empty();
+    transport_events_.push_back(std::move(event));
+  }
+  // Server output is never dropped, so this queue is unbounded; one message
+  // per drain, as for events
+  if (first && message_window_) {
+    PostMessage(message_window_, drain_transport_message_, 0, 0);
+  }
+}
+
+void FlutterMcpPlugin::DrainTransport() {
+  TraceSpan span(TraceCategory::kTransport, "deliver");
+  flutter::EncodableList events;
+  {
+    std::lock_guard<std::mutex> lock(transport_mutex_);
+    events.swap(transport_events_);
+  }
+  // Everything queued goes out as one list
+  if (transport_sink_ && !events.empty()) {
+    transport_sink_->Success(flutter::EncodableValue(std::move(events)));
+  }
+}
+
+void FlutterMcpPlugin::CreateMessageWindow() {
+  WNDCLASSEX wc = {0};
+  wc.cbSize = sizeof(WNDCLASSEX);
+  wc.lpfnWndProc = MessageWindowProc;
+  wc.hInstance = GetModuleHandle(nullptr);
+  wc.lpszClassName = kMessageWindowClassName;
+
+  // A second engine's plugin in the same process reuses the registered class
+  if (!RegisterClassEx(&wc) && GetLastError() != ERROR_CLASS_ALREADY_EXISTS) {
+    return;
+  }
+
+  message_window_ = CreateWindowEx(
+      0,
+      kMessageWindowClassName,
+      L"Flutter MCP Window",
+      0,
+      0, 0, 0, 0,
+      HWND_MESSAGE,
+      nullptr,
+      GetModuleHandle(nullptr),
+      nullptr
+  );
+  if (message_window_) {
+    SetWindowLongPtr(message_window_, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
+  }
+}
+
+void FlutterMcpPlugin::DestroyMessageWindow() {
+  if (message_window_) {
+    SetWindowLongPtr(message_window_, GWLP_USERDATA, 0);
+    DestroyWindow(message_window_);
+    message_window_ = nullptr;
+  }
+  // Fails harmlessly while another plugin still has a window of this class
+  UnregisterClass(kMessageWindowClassName, GetModuleHandle(nullptr));
+}
+
+LRESULT CALLBACK FlutterMcpPlugin::MessageWindowProc(HWND hwnd, UINT message, WPARAM wparam,
+                                                     LPARAM lparam) {
+  auto* plugin = reinterpret_cast<FlutterMcpPlugin*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
+  if (plugin) {
+    if (auto handled = plugin->HandleWindowProc(message, wparam)) {
+      return *handled;
+    }
+  }
+  return DefWindowProc(hwnd, message, wparam, lparam);
+}
+
+std::optional<LRESULT> FlutterMcpPlugin::HandleWindowProc(UINT message, WPARAM wparam) {
+  if (message == drain_events_message_) {
+    DrainEvents();
+    return 0;
+  }
+  if (message == drain_transport_message_) {
+    DrainTransport();
+    return 0;
+  }
+  if (message == run_headless_message_) {
+    DrainHeadlessRuns();
+    return 0;
+  }
+  if (message == WM_TIMER && wparam == kSecureFlushTimerId) {
+    FlushSecureStorage();
+    return 0;
+  }
+  if (message == WM_TIMER && wparam == kMetricsTimerId) {
+    if (!EventWanted("metrics")) {
+      return 0;
+    }
+    std::map<std::string, flutter::EncodableValue> data;
+    for (auto& entry : EncodeMetrics(*metrics_)) {
+      data[std::get<std::string>(entry.first)] = std::move(entry.second);
+    }
+    SendEvent("metrics", data);
+    return 0;
   }
+  return std::nullopt;
 }
 
 }  // namespace flutter_mcp
\ No newline at end of file
@@ -6,10 +6,23 @@
 #include <flutter/event_sink.h>
 #include <flutter/event_channel.h>
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <map>
 #include <string>
 #include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "event_batcher.h"
+#include "event_filter.h"
+#include "event_ring_buffer.h"
+#include "journaled_task.h"
+#include "method_table.h"
+#include "tray_menu_diff.h"
+#include "worker_pool.h"
 
 namespace flutter_mcp {
 
@@ -18,13 +31,10 @@ class TrayIconManager;
 class NotificationManager;
 class SecureStorageService;
 class BackgroundService;
-
-struct TrayMenuItem {
-  std::string id;
-  std::string label;
-  bool is_separator = false;
-  bool disabled = false;
-};
+class StdioTransport;
+class TaskJournal;
+class HeadlessEngine;
+class NativeMetrics;
 
 class FlutterMcpPlugin : public flutter::Plugin {
  public:
@@ -58,8 +68,13 @@ class FlutterMcpPlugin : public flutter::Plugin {
                                   std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
   void ScheduleBackgroundTask(const flutter::MethodCall<flutter::EncodableValue> &method_call,
                               std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void ScheduleRecurringTask(const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                             std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
   void CancelBackgroundTask(const flutter::MethodCall<flutter::EncodableValue> &method_call,
                             std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void StartHeadlessEngine(const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                           std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void StopHeadlessEngine(std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
   void ShowNotification(const flutter::MethodCall<flutter::EncodableValue> &method_call,
                         std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
   void ConfigureNotifications(const flutter::MethodCall<flutter::EncodableValue> &method_call,
@@ -71,16 +86,32 @@ class FlutterMcpPlugin : public flutter::Plugin {
                    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
   void SecureRead(const flutter::MethodCall<flutter::EncodableValue> &method_call,
                   std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void SecureStoreBytes(const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                        std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void SecureReadBytes(const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
   void SecureDelete(const flutter::MethodCall<flutter::EncodableValue> &method_call,
                     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
   void SecureContainsKey(const flutter::MethodCall<flutter::EncodableValue> &method_call,
                          std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
   void SecureDeleteAll(std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void SecureReadMany(const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void SecureReadPrefix(const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                        std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void ConfigureSecureStorage(const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                              std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
   void ShowTrayIcon(const flutter::MethodCall<flutter::EncodableValue> &method_call,
                     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
   void HideTrayIcon(std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void RegisterTrayIcons(const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                         std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void SetTrayIcon(const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                   std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
   void SetTrayMenu(const flutter::MethodCall<flutter::EncodableValue> &method_call,
                    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void UpdateTrayMenuItem(const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                          std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
   void UpdateTrayTooltip(const flutter::MethodCall<flutter::EncodableValue> &method_call,
                          std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
   void ConfigureTray(const flutter::MethodCall<flutter::EncodableValue> &method_call,
@@ -89,20 +120,152 @@ class FlutterMcpPlugin : public flutter::Plugin {
                        std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
   void RequestPermission(const flutter::MethodCall<flutter::EncodableValue> &method_call,
                          std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void ConfigureEvents(const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void ExecuteBatch(const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void GetEventQueueStats(std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void GetNativeMetrics(const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                        std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void ConfigureNativeMetrics(const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                              std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void TransportSpawn(const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void TransportSend(const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void TransportClose(const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void TransportConfigureRouting(
+      const flutter::MethodCall<flutter::EncodableValue> &method_call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void TransportStats(std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void SecureFlush(std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void StartNativeTrace(std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void StopNativeTrace(const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
   void Shutdown(std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void DispatchMethodCall(Method method,
+                          const flutter::MethodCall<flutter::EncodableValue> &method_call,
+                          std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Sends backgroundTaskResult with each run's timings
+  // With |journal_due_ms| set, a journaled one-shot task is retired once a
+  // listener has its result or has filtered the result out. One that
+  // finishes while nobody listens stays journaled and runs again on the
+  // next start
+  std::function<void(const TaskTiming&)> TaskResultSender(const std::string& task_id,
+                                                          int64_t journal_due_ms = -1);
+  // |retire|, if set, drops the task from the journal. |extra| adds to the
+  // timings, for runs that went through the headless engine
+  void SendTaskResult(const std::string& task_id, const TaskTiming& timing,
+                      const std::function<void()>& retire,
+                      std::map<std::string, flutter::EncodableValue> extra = {});
+  // Hands finished tasks to the headless engine and reports each once its
+  // callback has returned
+  void DrainHeadlessRuns();
+  void ReplayTaskJournal();
+  void ReleaseTaskJournal();
+
+  // Create the subsystem on first use and record its init time
+  TrayIconManager& Tray();
+  NotificationManager& Notifications();
+  SecureStorageService& SecureStorage();
+  BackgroundService& Background();
+  StdioTransport& Transport();
 
   // Event sending
+  // Asked before building an event; false while no listener is attached.
+  // Counts as one event for sampling
+  bool EventWanted(const char* event_type);
   void SendEvent(const std::string& event_type,
                  const std::map<std::string, flutter::EncodableValue>& data);
+  void SendEventBatch(const std::string& event_type,
+                      std::vector<flutter::EncodableValue>&& events,
+                      size_t coalesced);
+  // |on_delivered| runs on the platform thread only if a listener gets the
+  // event
+  void PostEvent(flutter::EncodableValue event, std::function<void()> on_delivered = nullptr);
+  void ScheduleDrain();
+  void DrainEvents();
+  // Arms the write-behind flush timer if secure storage has writes waiting
+  void ScheduleSecureFlush();
+  void FlushSecureStorage();
+  // MCP server output, published on the "flutter_mcp/transport" channel
+  void PostTransportEvent(flutter::EncodableValue event);
+  void DrainTransport();
+  // The plugin's HWND_MESSAGE window, which carries the drain, headless
+  // and timer messages
+  void CreateMessageWindow();
+  void DestroyMessageWindow();
+  static LRESULT CALLBACK MessageWindowProc(HWND hwnd, UINT message, WPARAM wparam,
+                                            LPARAM lparam);
+  std::optional<LRESULT> HandleWindowProc(UINT message, WPARAM wparam);
 
   // Member variables
   flutter::PluginRegistrarWindows* registrar_;
+  // Declared first so it outlives everything that records into it
+  std::unique_ptr<NativeMetrics> metrics_;
+  // Null until first used; see Tray() and the other accessors
   std::unique_ptr<TrayIconManager> tray_manager_;
   std::unique_ptr<NotificationManager> notification_manager_;
   std::unique_ptr<SecureStorageService> secure_storage_;
   std::unique_ptr<BackgroundService> background_service_;
+  std::unique_ptr<StdioTransport> transport_;
+  // Pending Dart-scheduled tasks on disk, when enabled; shared with the
+  // completions that retire them
+  std::shared_ptr<TaskJournal> task_journal_;
+  // Journaled tasks waiting for the first listener; see ReplayTaskJournal()
+  HeldReplay held_replay_;
+  // Only touched on the platform thread
   std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> event_sink_;
-  std::mutex event_sink_mutex_;
+  std::unique_ptr<EventBatcher<flutter::EncodableValue>> event_batcher_;
+
+  // Events built on any thread, published on the platform thread
+  struct QueuedEvent {
+    flutter::EncodableValue event;
+    std::function<void()> on_delivered;
+  };
+  static constexpr size_t kEventQueueCapacity = 1024;
+  EventRingBuffer<QueuedEvent> event_queue_;
+  std::atomic<bool> drain_scheduled_{false};
+  std::atomic<OverflowPolicy> overflow_policy_{OverflowPolicy::kDropOldest};
+  // Event types and sampling rates the Dart listener subscribed to
+  EventFilter event_filter_;
+  // Whether event_sink_ is set, for producers on other threads
+  std::atomic<bool> event_listening_{false};
+  std::atomic<uint64_t> dropped_oldest_{0};
+  std::atomic<uint64_t> dropped_newest_{0};
+  std::thread::id platform_thread_id_;
+  // Created by the constructor on the platform thread; null if that failed
+  HWND message_window_ = nullptr;
+  UINT drain_events_message_ = 0;
+  // Periodic "metrics" event on message_window_, 0 when disabled
+  UINT metrics_interval_ms_ = 0;
+  // Set while the write-behind flush timer is pending
+  bool secure_flush_armed_ = false;
+
+  // Transport events from the reactor thread, drained on the platform thread
+  std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> transport_sink_;
+  std::mutex transport_mutex_;
+  flutter::EncodableList transport_events_;
+  UINT drain_transport_message_ = 0;
+
+  // Runs the Dart side of scheduled tasks once started; only touched on the
+  // platform thread, like task_data_
+  std::unique_ptr<HeadlessEngine> headless_engine_;
+  // Each task's "data" argument, kept for its headless run
+  std::map<std::string, flutter::EncodableValue> task_data_;
+  // Read by workers to decide where a finished task goes
+  std::atomic<bool> headless_running_{false};
+  // Finished tasks posted by workers for DrainHeadlessRuns()
+  std::mutex headless_mutex_;
+  struct HeadlessRun {
+    std::string task_id;
+    TaskTiming timing;
+    std::function<void()> retire;
+  };
+  std::vector<HeadlessRun> headless_runs_;
+  UINT run_headless_message_ = 0;
 };
 
 }  // namespace flutter_mcp
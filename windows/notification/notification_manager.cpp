@@ -1,45 +1,44 @@
 #include "notification_manager.h"
-#include <shellapi.h>
 #include <strsafe.h>
 
 namespace flutter_mcp {
 
-NotificationManager* NotificationManager::instance_ = nullptr;
+namespace {
 
-NotificationManager::NotificationManager() {
-  instance_ = this;
+constexpr wchar_t kWindowClassName[] = L"FlutterMCPNotificationWindow";
+constexpr size_t kWheelSlots = 64;
+
+}  // namespace
+
+NotificationManager::NotificationManager()
+    : window_handle_(nullptr),
+      timer_running_(false),
+      next_icon_id_(NOTIFICATION_ID_BASE),
+      expirations_(kWheelSlots, EXPIRY_TICK_MS, GetTickCount64()),
+      throttle_(static_cast<int64_t>(GetTickCount64())) {
+  CreateMessageWindow();
 }
 
 NotificationManager::~NotificationManager() {
   CancelAllNotifications();
-  instance_ = nullptr;
+  DestroyMessageWindow();
 }
 
-void NotificationManager::ShowNotification(const std::string& title, const std::string& body, const std::string& id) {
-  // Cancel existing notification with same ID
-  CancelNotification(id);
-
-  // Create notification data
-  auto data = std::make_unique<NotificationData>();
-  data->title = title;
-  data->body = body;
-  data->id = id;
-
-  // Register window class for this notification
+void NotificationManager::CreateMessageWindow() {
   WNDCLASSEX wc = {0};
   wc.cbSize = sizeof(WNDCLASSEX);
   wc.lpfnWndProc = NotificationWindowProc;
   wc.hInstance = GetModuleHandle(nullptr);
-  
-  std::wstring class_name = L"FlutterMCPNotification_" + std::wstring(id.begin(), id.end());
-  wc.lpszClassName = class_name.c_str();
-  
-  RegisterClassEx(&wc);
+  wc.lpszClassName = kWindowClassName;
+
+  // A second manager in the same process reuses the registered class
+  if (!RegisterClassEx(&wc) && GetLastError() != ERROR_CLASS_ALREADY_EXISTS) {
+    return;
+  }
 
-  // Create message-only window for this notification
-  data->hwnd = CreateWindowEx(
+  window_handle_ = CreateWindowEx(
       0,
-      class_name.c_str(),
+      kWindowClassName,
       L"Notification Window",
       0,
       0, 0, 0, 0,
@@ -48,63 +47,105 @@ void NotificationManager::ShowNotification(const std::string& title, const std::
       GetModuleHandle(nullptr),
       nullptr
   );
+  if (window_handle_) {
+    SetWindowLongPtr(window_handle_, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
+  }
+}
 
-  if (data->hwnd) {
-    // Store pointer to notification data in window
-    SetWindowLongPtr(data->hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(data.get()));
-    
-    ShowBalloonNotification(*data);
-    active_notifications_[id] = std::move(data);
+void NotificationManager::DestroyMessageWindow() {
+  if (window_handle_) {
+    if (timer_running_) {
+      KillTimer(window_handle_, EXPIRY_TIMER_ID);
+      timer_running_ = false;
+    }
+    SetWindowLongPtr(window_handle_, GWLP_USERDATA, 0);
+    DestroyWindow(window_handle_);
+    window_handle_ = nullptr;
   }
+  // Fails harmlessly while another manager still has a window of this class
+  UnregisterClass(kWindowClassName, GetModuleHandle(nullptr));
 }
 
-void NotificationManager::ShowBalloonNotification(const NotificationData& data) {
-  NOTIFYICONDATA nid = {0};
-  nid.cbSize = sizeof(NOTIFYICONDATA);
-  nid.hWnd = data.hwnd;
-  nid.uID = NOTIFICATION_ID_BASE + std::hash<std::string>{}(data.id);
-  nid.uFlags = NIF_INFO | NIF_MESSAGE;
-  nid.uCallbackMessage = WM_TRAYNOTIFY;
-  
+void NotificationManager::ShowNotification(const std::string& title, const std::string& body, const std::string& id,
+                                           const std::string& group_key) {
+  if (!window_handle_) return;
+
+  NotificationRequest request;
+  request.id = id;
+  request.title = title;
+  request.body = body;
+  request.group_key = group_key;
+  for (const auto& action : throttle_.Submit(request, static_cast<int64_t>(GetTickCount64()))) {
+    Present(action);
+  }
+  UpdateTimer();
+}
+
+void NotificationManager::Present(const NotificationAction& action) {
+  const std::string& id = action.id;
+
+  // Reuse the slot of an active notification with the same ID
+  auto it = active_notifications_.find(id);
+  const bool update = it != active_notifications_.end();
+  if (!update) {
+    auto data = std::make_unique<NotificationData>();
+    data->id = id;
+    ZeroMemory(&data->nid, sizeof(NOTIFYICONDATA));
+    data->nid.cbSize = sizeof(NOTIFYICONDATA);
+    data->nid.hWnd = window_handle_;
+    data->nid.uID = AcquireIconId();
+    data->nid.uCallbackMessage = WM_TRAYNOTIFY;
+    data->nid.hIcon = LoadIcon(nullptr, IDI_INFORMATION);
+    data->expiry = 0;
+    icon_owners_[data->nid.uID] = id;
+    it = active_notifications_.emplace(id, std::move(data)).first;
+  }
+
+  NotificationData& data = *it->second;
+  NOTIFYICONDATA& nid = data.nid;
+  nid.uFlags = NIF_INFO | NIF_MESSAGE | NIF_ICON;
+
   // Set notification text
-  std::wstring wide_title(data.title.begin(), data.title.end());
-  std::wstring wide_body(data.body.begin(), data.body.end());
-  
+  std::wstring wide_title(action.title.begin(), action.title.end());
+  std::wstring wide_body(action.body.begin(), action.body.end());
+
   StringCchCopy(nid.szInfoTitle, ARRAYSIZE(nid.szInfoTitle), wide_title.c_str());
   StringCchCopy(nid.szInfo, ARRAYSIZE(nid.szInfo), wide_body.c_str());
-  
+
   nid.dwInfoFlags = NIIF_INFO;
-  nid.uTimeout = 10000; // 10 seconds
-  
-  // Add icon to show notification
-  nid.uFlags |= NIF_ICON;
-  nid.hIcon = LoadIcon(nullptr, IDI_INFORMATION);
-  
-  Shell_NotifyIcon(NIM_ADD, &nid);
-  
-  // Schedule removal after timeout
-  SetTimer(data.hwnd, 1, 10000, nullptr);
+  nid.uTimeout = NOTIFICATION_TIMEOUT_MS;
+
+  if (!Shell_NotifyIcon(update ? NIM_MODIFY : NIM_ADD, &nid) && !update) {
+    throttle_.Dismissed(id);
+    RemoveNotification(id);
+    return;
+  }
+
+  ScheduleExpiry(data);
 }
 
 void NotificationManager::CancelNotification(const std::string& id) {
+  throttle_.Dismissed(id);
+  RemoveNotification(id);
+  UpdateTimer();
+}
+
+void NotificationManager::RemoveNotification(const std::string& id) {
   auto it = active_notifications_.find(id);
-  if (it != active_notifications_.end()) {
-    NOTIFYICONDATA nid = {0};
-    nid.cbSize = sizeof(NOTIFYICONDATA);
-    nid.hWnd = it->second->hwnd;
-    nid.uID = NOTIFICATION_ID_BASE + std::hash<std::string>{}(id);
-    
-    Shell_NotifyIcon(NIM_DELETE, &nid);
-    
-    if (it->second->hwnd) {
-      DestroyWindow(it->second->hwnd);
-    }
-    
-    std::wstring class_name = L"FlutterMCPNotification_" + std::wstring(id.begin(), id.end());
-    UnregisterClass(class_name.c_str(), GetModuleHandle(nullptr));
-    
-    active_notifications_.erase(it);
+  if (it == active_notifications_.end()) {
+    return;
+  }
+
+  NotificationData& data = *it->second;
+  Shell_NotifyIcon(NIM_DELETE, &data.nid);
+
+  if (data.expiry) {
+    expirations_.Cancel(data.expiry);
+    expiry_owners_.erase(data.expiry);
   }
+  icon_owners_.erase(data.nid.uID);
+  ReleaseIconId(data.nid.uID);
+  active_notifications_.erase(it);
 }
 
 void NotificationManager::CancelAllNotifications() {
@@ -114,33 +155,109 @@ void NotificationManager::CancelAllNotifications() {
   }
   
   for (const auto& id : ids) {
-    CancelNotification(id);
+    RemoveNotification(id);
+  }
+  throttle_.Clear();
+  UpdateTimer();
+}
+
+void NotificationManager::Configure(const NotificationPolicy& policy) {
+  throttle_.Configure(policy, static_cast<int64_t>(GetTickCount64()));
+}
+
+UINT NotificationManager::AcquireIconId() {
+  if (!free_icon_ids_.empty()) {
+    UINT icon_id = free_icon_ids_.back();
+    free_icon_ids_.pop_back();
+    return icon_id;
   }
+  return next_icon_id_++;
+}
+
+void NotificationManager::ReleaseIconId(UINT icon_id) {
+  free_icon_ids_.push_back(icon_id);
 }
 
-void NotificationManager::Configure(const std::map<std::string, std::string>& config) {
-  // Configuration can be extended as needed
+void NotificationManager::ScheduleExpiry(NotificationData& data) {
+  const uint64_t now = GetTickCount64();
+  if (data.expiry) {
+    expirations_.Cancel(data.expiry);
+    expiry_owners_.erase(data.expiry);
+  }
+
+  if (!timer_running_) {
+    // Nothing is pending, so catching the wheel up cannot fire anything
+    std::vector<TimerWheel::TimerId> expired;
+    expirations_.Advance(now, &expired);
+  }
+
+  data.expiry = expirations_.Schedule(now, NOTIFICATION_TIMEOUT_MS);
+  expiry_owners_[data.expiry] = data.id;
+  UpdateTimer();
+}
+
+void NotificationManager::UpdateTimer() {
+  if (!window_handle_) return;
+
+  const bool needed = !expirations_.empty() || throttle_.HasPendingWork();
+  if (needed && !timer_running_) {
+    timer_running_ = SetTimer(window_handle_, EXPIRY_TIMER_ID, EXPIRY_TICK_MS, nullptr) != 0;
+  } else if (!needed && timer_running_) {
+    KillTimer(window_handle_, EXPIRY_TIMER_ID);
+    timer_running_ = false;
+  }
+}
+
+void NotificationManager::OnTimerTick() {
+  const uint64_t now = GetTickCount64();
+  std::vector<TimerWheel::TimerId> expired;
+  expirations_.Advance(now, &expired);
+  for (TimerWheel::TimerId timer_id : expired) {
+    auto owner = expiry_owners_.find(timer_id);
+    if (owner == expiry_owners_.end()) {
+      continue;
+    }
+    const std::string id = owner->second;
+    expiry_owners_.erase(owner);
+    auto it = active_notifications_.find(id);
+    if (it != active_notifications_.end()) {
+      it->second->expiry = 0;
+    }
+    throttle_.Dismissed(id);
+    RemoveNotification(id);
+  }
+
+  for (const auto& action : throttle_.Flush(static_cast<int64_t>(now))) {
+    Present(action);
+  }
+  UpdateTimer();
 }
 
 LRESULT CALLBACK NotificationManager::NotificationWindowProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam) {
-  NotificationData* data = reinterpret_cast<NotificationData*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
-  
+  auto* manager = reinterpret_cast<NotificationManager*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
+  if (!manager) return DefWindowProc(hwnd, msg, wparam, lparam);
+
   switch (msg) {
-    case WM_TRAYNOTIFY:
+    case WM_TRAYNOTIFY: {
+      // wparam carries the tray icon id of the notification
+      auto owner = manager->icon_owners_.find(static_cast<UINT>(wparam));
+      if (owner == manager->icon_owners_.end()) {
+        return 0;
+      }
       if (LOWORD(lparam) == NIN_BALLOONUSERCLICK) {
         // User clicked the notification
         // Could send event to Flutter here
       } else if (LOWORD(lparam) == NIN_BALLOONTIMEOUT || LOWORD(lparam) == NIN_BALLOONHIDE) {
         // Notification closed
-        if (data && instance_) {
-          instance_->CancelNotification(data->id);
-        }
+        const std::string id = owner->second;
+        manager->CancelNotification(id);
       }
       return 0;
+    }
       
     case WM_TIMER:
-      if (wparam == 1 && data && instance_) {
-        instance_->CancelNotification(data->id);
+      if (wparam == EXPIRY_TIMER_ID) {
+        manager->OnTimerTick();
       }
       return 0;
       
@@ -149,4 +266,4 @@ LRESULT CALLBACK NotificationManager::NotificationWindowProc(HWND hwnd, UINT msg
   }
 }
 
-}  // namespace flutter_mcp
\ No newline at end of file
+}  // namespace flutter_mcp
@@ -2,39 +2,80 @@
 #define NOTIFICATION_MANAGER_H_
 
 #include <windows.h>
+#include <shellapi.h>
 #include <string>
 #include <map>
 #include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "notification_throttle.h"
+#include "timer_wheel.h"
 
 namespace flutter_mcp {
 
+// Shows notifications as balloon tips on per-notification tray icons.
+//
+// All notifications share one window class and one message-only window;
+// each active notification is a pooled slot holding its NOTIFYICONDATA and
+// a tray icon id that is recycled once it is cancelled. Expirations run off
+// a single timer wheel ticked by one window timer, which only runs while
+// something is pending. Showing an id that is already active updates it in
+// place.
+//
+// Requests pass through a NotificationThrottle first, which rate limits new
+// popups and coalesces grouped ones; its flushes ride the same timer.
 class NotificationManager {
  public:
   NotificationManager();
   ~NotificationManager();
 
-  void ShowNotification(const std::string& title, const std::string& body, const std::string& id);
+  void ShowNotification(const std::string& title, const std::string& body, const std::string& id,
+                        const std::string& group_key = std::string());
   void CancelNotification(const std::string& id);
   void CancelAllNotifications();
-  void Configure(const std::map<std::string, std::string>& config);
+  void Configure(const NotificationPolicy& policy);
+  const NotificationPolicy& policy() const { return throttle_.policy(); }
+
+  size_t active_count() const { return active_notifications_.size(); }
 
  private:
   struct NotificationData {
-    std::string title;
-    std::string body;
     std::string id;
-    HWND hwnd;
+    NOTIFYICONDATA nid;
+    TimerWheel::TimerId expiry;
   };
 
-  void ShowBalloonNotification(const NotificationData& data);
+  void Present(const NotificationAction& action);
+  void RemoveNotification(const std::string& id);
+  void UpdateTimer();
+  void CreateMessageWindow();
+  void DestroyMessageWindow();
+  UINT AcquireIconId();
+  void ReleaseIconId(UINT icon_id);
+  void ScheduleExpiry(NotificationData& data);
+  void OnTimerTick();
   static LRESULT CALLBACK NotificationWindowProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam);
-  
+
+  HWND window_handle_;
+  bool timer_running_;
   std::map<std::string, std::unique_ptr<NotificationData>> active_notifications_;
-  static NotificationManager* instance_;
+  // Tray icon id to notification id, for routing shell callbacks
+  std::unordered_map<UINT, std::string> icon_owners_;
+  std::vector<UINT> free_icon_ids_;
+  UINT next_icon_id_;
+  // Timer id to notification id
+  std::unordered_map<TimerWheel::TimerId, std::string> expiry_owners_;
+  TimerWheel expirations_;
+  NotificationThrottle throttle_;
+
   static constexpr UINT WM_TRAYNOTIFY = WM_APP + 100;
   static constexpr UINT NOTIFICATION_ID_BASE = 3000;
+  static constexpr UINT_PTR EXPIRY_TIMER_ID = 1;
+  static constexpr UINT EXPIRY_TICK_MS = 250;
+  static constexpr UINT NOTIFICATION_TIMEOUT_MS = 10000;
 };
 
 }  // namespace flutter_mcp
 
-#endif  // NOTIFICATION_MANAGER_H_
\ No newline at end of file
+#endif  // NOTIFICATION_MANAGER_H_
@@ -0,0 +1,382 @@
+#include "record_store.h"
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+namespace flutter_mcp {
+
+namespace {
+
+constexpr char kFileMagic[8] = {'F', 'M', 'C', 'P', 'R', 'E', 'C', '1'};
+constexpr uint32_t kRecordMagic = 0x52434d46;  // "FMCR"
+constexpr uint32_t kTombstone = 0xffffffff;
+// Keys and values are small; anything larger marks a corrupt header
+constexpr uint32_t kMaxFieldLength = 64 * 1024 * 1024;
+// Files below this size are never compacted
+constexpr uint64_t kCompactMinBytes = 256 * 1024;
+
+struct RecordHeader {
+  uint32_t magic;
+  uint32_t key_length;
+  // kTombstone for an erased key
+  uint32_t value_length;
+  uint32_t checksum;
+};
+
+uint32_t Crc32(uint32_t crc, const BYTE* data, size_t length) {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> entries = {};
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; k++) {
+        c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      }
+      entries[i] = c;
+    }
+    return entries;
+  }();
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++) {
+    crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+uint32_t RecordChecksum(const RecordHeader& header, const BYTE* key,
+                        const BYTE* value) {
+  uint32_t crc = Crc32(0, reinterpret_cast<const BYTE*>(&header.key_length),
+                       sizeof(header.key_length) + sizeof(header.value_length));
+  crc = Crc32(crc, key, header.key_length);
+  if (header.value_length != kTombstone) {
+    crc = Crc32(crc, value, header.value_length);
+  }
+  return crc;
+}
+
+bool WriteAll(HANDLE file, uint64_t offset, const BYTE* data, size_t length) {
+  OVERLAPPED overlapped = {};
+  overlapped.Offset = static_cast<DWORD>(offset);
+  overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+  DWORD written = 0;
+  return WriteFile(file, data, static_cast<DWORD>(length), &written,
+                   &overlapped) &&
+         written == length;
+}
+
+}  // namespace
+
+RecordStore::RecordStore(const std::wstring& path)
+    : path_(path),
+      file_(INVALID_HANDLE_VALUE),
+      mapping_(nullptr),
+      view_(nullptr),
+      mapped_size_(0),
+      end_(0),
+      live_bytes_(0) {}
+
+RecordStore::~RecordStore() {
+  Close();
+}
+
+bool RecordStore::Open() {
+  Close();
+
+  // A leftover temporary file is an interrupted compaction; the original
+  // is still intact because the rename never happened
+  DeleteFileW((path_ + L".tmp").c_str());
+
+  file_ = CreateFileW(path_.c_str(), GENERIC_READ | GENERIC_WRITE,
+                      FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                      FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file_ == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file_, &size)) {
+    Close();
+    return false;
+  }
+
+  if (size.QuadPart == 0) {
+    if (!WriteAll(file_, 0, reinterpret_cast<const BYTE*>(kFileMagic),
+                  sizeof(kFileMagic))) {
+      Close();
+      return false;
+    }
+    end_ = sizeof(kFileMagic);
+    return true;
+  }
+
+  end_ = static_cast<uint64_t>(size.QuadPart);
+  if (!Scan()) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+bool RecordStore::Scan() {
+  if (end_ < sizeof(kFileMagic) || !Map() ||
+      memcmp(view_, kFileMagic, sizeof(kFileMagic)) != 0) {
+    return false;
+  }
+
+  index_.clear();
+  live_bytes_ = 0;
+  uint64_t offset = sizeof(kFileMagic);
+  while (offset + sizeof(RecordHeader) <= mapped_size_) {
+    RecordHeader header;
+    memcpy(&header, view_ + offset, sizeof(header));
+    const bool tombstone = header.value_length == kTombstone;
+    const uint64_t value_length = tombstone ? 0 : header.value_length;
+    if (header.magic != kRecordMagic || header.key_length > kMaxFieldLength ||
+        value_length > kMaxFieldLength) {
+      break;
+    }
+    const uint64_t record_size =
+        sizeof(RecordHeader) + header.key_length + value_length;
+    if (offset + record_size > mapped_size_) {
+      break;
+    }
+
+    const BYTE* key = view_ + offset + sizeof(RecordHeader);
+    if (RecordChecksum(header, key, key + header.key_length) !=
+        header.checksum) {
+      break;
+    }
+
+    std::string name(reinterpret_cast<const char*>(key), header.key_length);
+    auto it = index_.find(name);
+    if (it != index_.end()) {
+      live_bytes_ -= it->second.record_size;
+      index_.erase(it);
+    }
+    if (!tombstone) {
+      index_[name] = Location{offset, static_cast<uint32_t>(record_size),
+                              header.value_length};
+      live_bytes_ += record_size;
+    }
+    offset += record_size;
+  }
+
+  if (offset < end_) {
+    // Drop the torn tail so the next append starts on a record boundary
+    Unmap();
+    LARGE_INTEGER position;
+    position.QuadPart = static_cast<LONGLONG>(offset);
+    if (!SetFilePointerEx(file_, position, nullptr, FILE_BEGIN) ||
+        !SetEndOfFile(file_)) {
+      return false;
+    }
+    end_ = offset;
+  }
+  return true;
+}
+
+bool RecordStore::Put(const std::string& key, const BYTE* data, size_t length) {
+  if (file_ == INVALID_HANDLE_VALUE || key.size() > kMaxFieldLength ||
+      length > kMaxFieldLength) {
+    return false;
+  }
+
+  Location location;
+  if (!Append(key, data, static_cast<uint32_t>(length), false, &location)) {
+    return false;
+  }
+
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    live_bytes_ -= it->second.record_size;
+    it->second = location;
+  } else {
+    index_[key] = location;
+  }
+  live_bytes_ += location.record_size;
+
+  MaybeCompact();
+  return true;
+}
+
+bool RecordStore::Get(const std::string& key, const BYTE** data,
+                      size_t* length) {
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return false;
+  }
+
+  const Location& location = it->second;
+  // Appends grow the file past the mapping; remap lazily on first read
+  if (location.record_offset + location.record_size > mapped_size_ && !Map()) {
+    return false;
+  }
+
+  *data = view_ + location.record_offset + sizeof(RecordHeader) + key.size();
+  *length = location.value_length;
+  return true;
+}
+
+bool RecordStore::Contains(const std::string& key) const {
+  return index_.find(key) != index_.end();
+}
+
+bool RecordStore::Erase(const std::string& key) {
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return true;
+  }
+
+  if (!Append(key, nullptr, 0, true, nullptr)) {
+    return false;
+  }
+  live_bytes_ -= it->second.record_size;
+  index_.erase(it);
+
+  MaybeCompact();
+  return true;
+}
+
+bool RecordStore::Clear() {
+  return Rewrite(true);
+}
+
+void RecordStore::ForEachKey(
+    const std::function<void(const std::string& key)>& visit) const {
+  for (const auto& entry : index_) {
+    visit(entry.first);
+  }
+}
+
+bool RecordStore::Append(const std::string& key, const BYTE* data,
+                         uint32_t length, bool tombstone, Location* location) {
+  RecordHeader header;
+  header.magic = kRecordMagic;
+  header.key_length = static_cast<uint32_t>(key.size());
+  header.value_length = tombstone ? kTombstone : length;
+  header.checksum = RecordChecksum(
+      header, reinterpret_cast<const BYTE*>(key.data()), data);
+
+  const size_t value_length = tombstone ? 0 : length;
+  std::vector<BYTE> record(sizeof(header) + key.size() + value_length);
+  memcpy(record.data(), &header, sizeof(header));
+  memcpy(record.data() + sizeof(header), key.data(), key.size());
+  if (value_length > 0) {
+    memcpy(record.data() + sizeof(header) + key.size(), data, value_length);
+  }
+
+  // One write per record, so a crash leaves at most one torn record
+  if (!WriteAll(file_, end_, record.data(), record.size())) {
+    return false;
+  }
+
+  if (location) {
+    *location = Location{end_, static_cast<uint32_t>(record.size()), length};
+  }
+  end_ += record.size();
+  return true;
+}
+
+bool RecordStore::Map() {
+  Unmap();
+  if (end_ == 0) {
+    return false;
+  }
+
+  mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY,
+                                static_cast<DWORD>(end_ >> 32),
+                                static_cast<DWORD>(end_), nullptr);
+  if (!mapping_) {
+    return false;
+  }
+  view_ = static_cast<const BYTE*>(
+      MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+  if (!view_) {
+    CloseHandle(mapping_);
+    mapping_ = nullptr;
+    return false;
+  }
+  mapped_size_ = end_;
+  return true;
+}
+
+void RecordStore::Unmap() {
+  if (view_) {
+    UnmapViewOfFile(view_);
+    view_ = nullptr;
+  }
+  if (mapping_) {
+    CloseHandle(mapping_);
+    mapping_ = nullptr;
+  }
+  mapped_size_ = 0;
+}
+
+void RecordStore::Close() {
+  Unmap();
+  if (file_ != INVALID_HANDLE_VALUE) {
+    CloseHandle(file_);
+    file_ = INVALID_HANDLE_VALUE;
+  }
+  index_.clear();
+  end_ = 0;
+  live_bytes_ = 0;
+}
+
+void RecordStore::MaybeCompact() {
+  const uint64_t dead_bytes = end_ - sizeof(kFileMagic) - live_bytes_;
+  if (end_ >= kCompactMinBytes && dead_bytes > live_bytes_) {
+    Rewrite(false);
+  }
+}
+
+bool RecordStore::Rewrite(bool drop_all) {
+  if (file_ == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  if (!drop_all && end_ > mapped_size_ && !Map()) {
+    return false;
+  }
+
+  const std::wstring temp_path = path_ + L".tmp";
+  HANDLE temp = CreateFileW(temp_path.c_str(), GENERIC_WRITE, 0, nullptr,
+                            CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (temp == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  bool ok = WriteAll(temp, 0, reinterpret_cast<const BYTE*>(kFileMagic),
+                     sizeof(kFileMagic));
+  uint64_t offset = sizeof(kFileMagic);
+  if (!drop_all) {
+    for (const auto& entry : index_) {
+      if (!ok) {
+        break;
+      }
+      const Location& location = entry.second;
+      ok = WriteAll(temp, offset, view_ + location.record_offset,
+                    location.record_size);
+      offset += location.record_size;
+    }
+  }
+  // The new file must be on disk before it replaces the old one
+  ok = ok && FlushFileBuffers(temp);
+  CloseHandle(temp);
+  if (!ok) {
+    DeleteFileW(temp_path.c_str());
+    return false;
+  }
+
+  Unmap();
+  CloseHandle(file_);
+  file_ = INVALID_HANDLE_VALUE;
+  if (!MoveFileExW(temp_path.c_str(), path_.c_str(),
+                   MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+    DeleteFileW(temp_path.c_str());
+    Open();
+    return false;
+  }
+  return Open();
+}
+
+}  // namespace flutter_mcp
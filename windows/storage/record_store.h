@@ -0,0 +1,78 @@
+#ifndef RECORD_STORE_H_
+#define RECORD_STORE_H_
+
+#include <windows.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+namespace flutter_mcp {
+
+// Append-only key/value record file, read through a memory mapping.
+//
+// Every Put or Erase appends one checksummed record; an in-memory index of
+// the live records is rebuilt on Open. A torn record at the end of the file
+// (a crash mid-append) is detected by its checksum and truncated away. Once
+// superseded records outweigh live ones, the live records are rewritten to
+// a temporary file that atomically replaces the original.
+//
+// Values are stored as given; callers encrypt them first. Not thread-safe.
+class RecordStore {
+ public:
+  explicit RecordStore(const std::wstring& path);
+  ~RecordStore();
+
+  RecordStore(const RecordStore&) = delete;
+  RecordStore& operator=(const RecordStore&) = delete;
+
+  // Opens or creates the file and indexes its records.
+  bool Open();
+
+  bool Put(const std::string& key, const BYTE* data, size_t length);
+  // Points |data| at the stored value inside the mapping. The pointer is
+  // valid until the next call that modifies the store.
+  bool Get(const std::string& key, const BYTE** data, size_t* length);
+  bool Contains(const std::string& key) const;
+  bool Erase(const std::string& key);
+  bool Clear();
+  // Visits every live key from the in-memory index, in no particular order.
+  void ForEachKey(const std::function<void(const std::string& key)>& visit) const;
+
+  size_t size() const { return index_.size(); }
+  uint64_t file_size() const { return end_; }
+
+ private:
+  struct Location {
+    uint64_t record_offset;
+    uint32_t record_size;
+    uint32_t value_length;
+  };
+
+  bool Append(const std::string& key, const BYTE* data, uint32_t length,
+              bool tombstone, Location* location);
+  bool Scan();
+  bool Map();
+  void Unmap();
+  void Close();
+  void MaybeCompact();
+  // Rewrites the live records, or none when |drop_all|, and swaps the
+  // result in with an atomic rename.
+  bool Rewrite(bool drop_all);
+
+  std::wstring path_;
+  HANDLE file_;
+  HANDLE mapping_;
+  const BYTE* view_;
+  uint64_t mapped_size_;
+  // Offset just past the last valid record
+  uint64_t end_;
+  // Bytes taken by records that are still current
+  uint64_t live_bytes_;
+  std::unordered_map<std::string, Location> index_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // RECORD_STORE_H_
@@ -2,13 +2,31 @@
 #include <shlobj.h>
 #include <shlwapi.h>
 #include <fstream>
+#include <cwchar>
+#include <unordered_set>
 #include <vector>
 
+#include "native_trace.h"
+
 #pragma comment(lib, "crypt32.lib")
 #pragma comment(lib, "shlwapi.lib")
 
 namespace flutter_mcp {
 
+StorageBackend ParseStorageBackend(const std::string& name) {
+  if (name == "recordFile") {
+    return StorageBackend::kRecordFile;
+  }
+  return StorageBackend::kFiles;
+}
+
+EncryptionMode ParseEncryptionMode(const std::string& name) {
+  if (name == "masterKey") {
+    return EncryptionMode::kMasterKey;
+  }
+  return EncryptionMode::kDpapi;
+}
+
 SecureStorageService::SecureStorageService() {
   storage_dir_ = GetStoragePath();
   
@@ -19,19 +37,90 @@ SecureStorageService::SecureStorageService() {
 }
 
 SecureStorageService::~SecureStorageService() {
+  // Nothing buffered outlives the service
+  Flush();
 }
 
 bool SecureStorageService::Store(const std::string& key, const std::string& value) {
+  TraceSpan span(TraceCategory::kSecureStorage, "store");
+  cache_.Invalidate(key);
+
+  if (write_behind_.enabled()) {
+    BufferWrite(key, PendingWrite::Kind::kText, value.data(), value.size());
+    return true;
+  }
+  return StoreNow(key, reinterpret_cast<const BYTE*>(value.data()), value.size(), false);
+}
+
+bool SecureStorageService::Read(const std::string& key, std::string& value) {
+  TraceSpan span(TraceCategory::kSecureStorage, "lookup");
+  PendingWrite::Kind kind;
+  if (write_behind_.Lookup(key, &kind, &value)) {
+    return kind != PendingWrite::Kind::kDelete;
+  }
+  if (cache_.Lookup(key, value)) {
+    return true;
+  }
+  if (!ReadDecrypted(key, value)) {
+    return false;
+  }
+  cache_.Put(key, value);
+  return true;
+}
+
+bool SecureStorageService::StoreBytes(const std::string& key, const uint8_t* data,
+                                      size_t size) {
+  TraceSpan span(TraceCategory::kSecureStorage, "store");
+  cache_.Invalidate(key);
+
+  if (write_behind_.enabled()) {
+    BufferWrite(key, PendingWrite::Kind::kBytes, reinterpret_cast<const char*>(data), size);
+    return true;
+  }
+  return StoreNow(key, data, size, true);
+}
+
+bool SecureStorageService::ReadBytes(const std::string& key, std::vector<uint8_t>& value) {
+  TraceSpan span(TraceCategory::kSecureStorage, "lookup");
+  PendingWrite::Kind kind;
+  std::string pending;
+  if (write_behind_.Lookup(key, &kind, &pending)) {
+    value.assign(pending.begin(), pending.end());
+    SecureZero(pending);
+    return kind != PendingWrite::Kind::kDelete;
+  }
+  return ReadDecrypted(key, value);
+}
+
+bool SecureStorageService::StoreNow(const std::string& key, const BYTE* data, size_t size,
+                                    bool binary) {
   std::vector<BYTE> encrypted_data;
-  if (!EncryptData(value, encrypted_data)) {
+  if (!EncryptData(key, data, size, binary, encrypted_data)) {
     return false;
   }
+  return WriteEncrypted(key, encrypted_data);
+}
+
+bool SecureStorageService::WriteEncrypted(const std::string& key,
+                                          const std::vector<BYTE>& encrypted_data) {
+  if (record_store_) {
+    return record_store_->Put(key, encrypted_data.data(), encrypted_data.size());
+  }
   
   std::wstring file_path = GetFilePath(key);
   return SaveToFile(file_path, encrypted_data);
 }
 
-bool SecureStorageService::Read(const std::string& key, std::string& value) {
+template <typename Buffer>
+bool SecureStorageService::ReadDecrypted(const std::string& key, Buffer& plain) {
+  if (record_store_) {
+    // Decrypt straight out of the mapped file
+    const BYTE* encrypted_data = nullptr;
+    size_t length = 0;
+    return record_store_->Get(key, &encrypted_data, &length) &&
+           DecryptData(key, encrypted_data, length, plain);
+  }
+  
   std::wstring file_path = GetFilePath(key);
   if (!PathFileExists(file_path.c_str())) {
     return false;
@@ -41,11 +130,25 @@ bool SecureStorageService::Read(const std::string& key, std::string& value) {
   if (!LoadFromFile(file_path, encrypted_data)) {
     return false;
   }
-  
-  return DecryptData(encrypted_data, value);
+  return DecryptData(key, encrypted_data.data(), encrypted_data.size(), plain);
 }
 
 bool SecureStorageService::Delete(const std::string& key) {
+  TraceSpan span(TraceCategory::kSecureStorage, "clear");
+  cache_.Invalidate(key);
+
+  if (write_behind_.enabled()) {
+    BufferWrite(key, PendingWrite::Kind::kDelete, "", 0);
+    return true;
+  }
+  return DeleteNow(key);
+}
+
+bool SecureStorageService::DeleteNow(const std::string& key) {
+  if (record_store_) {
+    return record_store_->Erase(key);
+  }
+  
   std::wstring file_path = GetFilePath(key);
   if (PathFileExists(file_path.c_str())) {
     return DeleteFile(file_path.c_str()) != 0;
@@ -54,11 +157,34 @@ bool SecureStorageService::Delete(const std::string& key) {
 }
 
 bool SecureStorageService::ContainsKey(const std::string& key) {
+  PendingWrite::Kind kind;
+  if (write_behind_.Lookup(key, &kind, nullptr)) {
+    return kind != PendingWrite::Kind::kDelete;
+  }
+  if (record_store_) {
+    return record_store_->Contains(key);
+  }
+  
   std::wstring file_path = GetFilePath(key);
   return PathFileExists(file_path.c_str()) != 0;
 }
 
 void SecureStorageService::DeleteAll() {
+  TraceSpan span(TraceCategory::kSecureStorage, "clearAll");
+  // Buffered writes would only be deleted again
+  write_behind_.Clear();
+  cache_.Clear();
+
+  if (record_store_) {
+    record_store_->Clear();
+    return;
+  }
+  
+  ForEachValueFile([](const std::wstring& path) { DeleteFile(path.c_str()); });
+}
+
+void SecureStorageService::ForEachValueFile(
+    const std::function<void(const std::wstring& path)>& visit) {
   WIN32_FIND_DATA find_data;
   std::wstring search_path = storage_dir_ + L"\\*.dat";
   
@@ -66,8 +192,7 @@ void SecureStorageService::DeleteAll() {
   if (find_handle != INVALID_HANDLE_VALUE) {
     do {
       if (!(find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
-        std::wstring file_path = storage_dir_ + L"\\" + find_data.cFileName;
-        DeleteFile(file_path.c_str());
+        visit(storage_dir_ + L"\\" + find_data.cFileName);
       }
     } while (FindNextFile(find_handle, &find_data));
     
@@ -75,15 +200,181 @@ void SecureStorageService::DeleteAll() {
   }
 }
 
-bool SecureStorageService::EncryptData(const std::string& plain_text, std::vector<BYTE>& encrypted_data) {
+void SecureStorageService::ReadMany(const std::vector<std::string>& keys,
+                                    std::map<std::string, std::string>& values) {
+  TraceSpan span(TraceCategory::kSecureStorage, "lookup");
+  // Buffered writes and cached values answer first; the rest need storage
+  std::vector<const std::string*> stored;
+  for (const auto& key : keys) {
+    std::string value;
+    PendingWrite::Kind kind;
+    if (write_behind_.Lookup(key, &kind, &value)) {
+      if (kind != PendingWrite::Kind::kDelete) {
+        values[key] = std::move(value);
+      }
+    } else if (cache_.Lookup(key, value)) {
+      values[key] = std::move(value);
+    } else {
+      stored.push_back(&key);
+    }
+  }
+  if (stored.empty()) {
+    return;
+  }
+
+  // With the files backend, one directory pass tells which keys have a
+  // file, instead of probing each key's path
+  std::unordered_set<std::wstring> files;
+  if (!record_store_) {
+    ForEachValueFile([&](const std::wstring& path) { files.insert(path); });
+  }
+  for (const std::string* key : stored) {
+    std::string value;
+    bool found;
+    if (record_store_) {
+      found = ReadDecrypted(*key, value);
+    } else {
+      const std::wstring path = GetFilePath(*key);
+      std::vector<BYTE> encrypted_data;
+      found = files.count(path) != 0 && LoadFromFile(path, encrypted_data) &&
+              DecryptData(*key, encrypted_data.data(), encrypted_data.size(), value);
+    }
+    if (found) {
+      cache_.Put(*key, value);
+      values[*key] = std::move(value);
+    }
+  }
+}
+
+bool SecureStorageService::ReadPrefix(const std::string& prefix,
+                                      std::map<std::string, std::string>& values) {
+  TraceSpan span(TraceCategory::kSecureStorage, "search");
+  if (!record_store_) {
+    return false;
+  }
+  
+  std::vector<std::string> keys;
+  record_store_->ForEachKey([&](const std::string& key) {
+    if (key.compare(0, prefix.size(), prefix) == 0) {
+      keys.push_back(key);
+    }
+  });
+  // Buffered keys not persisted yet; Read() answers buffered deletes
+  write_behind_.ForEach([&](const PendingWrite& write) {
+    if (write.key.compare(0, prefix.size(), prefix) == 0 && !record_store_->Contains(write.key)) {
+      keys.push_back(write.key);
+    }
+  });
+  ReadMany(keys, values);
+  return true;
+}
+
+void SecureStorageService::ConfigureWriteBehind(const WriteBehindConfig& config) {
+  write_behind_.Configure(config);
+  if (!config.enabled) {
+    Flush();
+  }
+}
+
+void SecureStorageService::Flush() {
+  std::vector<PendingWrite> writes = write_behind_.Take();
+  if (writes.empty()) {
+    return;
+  }
+  TraceSpan span(TraceCategory::kSecureStorage, "flush");
+  size_t failures = 0;
+  for (PendingWrite& write : writes) {
+    bool written;
+    if (write.kind == PendingWrite::Kind::kDelete) {
+      written = DeleteNow(write.key);
+    } else {
+      written = StoreNow(write.key, reinterpret_cast<const BYTE*>(write.value.data()),
+                         write.value.size(), write.kind == PendingWrite::Kind::kBytes);
+    }
+    if (!written) {
+      failures++;
+    }
+    SecureZero(write.value);
+  }
+  write_behind_.RecordFailures(failures);
+}
+
+void SecureStorageService::BufferWrite(const std::string& key, PendingWrite::Kind kind,
+                                       const char* data, size_t size) {
+  if (write_behind_.Put(key, kind, data, size)) {
+    Flush();
+  }
+}
+
+void SecureStorageService::ConfigureCache(const SecretCacheConfig& config) {
+  cache_.Configure(config);
+}
+
+bool SecureStorageService::SetBackend(StorageBackend backend) {
+  // Buffered writes belong to the backend they were made against
+  Flush();
+  if (backend == StorageBackend::kFiles) {
+    record_store_.reset();
+    cache_.Clear();
+    return true;
+  }
+  if (record_store_) {
+    return true;
+  }
+  
+  auto store = std::make_unique<RecordStore>(storage_dir_ + L"\\" + kRecordFileName);
+  if (!store->Open()) {
+    return false;
+  }
+  record_store_ = std::move(store);
+  cache_.Clear();
+  return true;
+}
+
+bool SecureStorageService::SetEncryption(EncryptionMode mode) {
+  if (mode == EncryptionMode::kDpapi) {
+    use_master_key_ = false;
+    return true;
+  }
+  
+  if (!LoadCipher()) {
+    return false;
+  }
+  use_master_key_ = true;
+  return true;
+}
+
+bool SecureStorageService::LoadCipher() {
+  if (cipher_) {
+    return true;
+  }
+  auto cipher = std::make_unique<ValueCipher>();
+  if (!cipher->Open(storage_dir_ + L"\\" + kMasterKeyFileName)) {
+    return false;
+  }
+  cipher_ = std::move(cipher);
+  return true;
+}
+
+bool SecureStorageService::EncryptData(const std::string& key, const BYTE* plain, size_t size,
+                                       bool binary, std::vector<BYTE>& encrypted_data) {
+  if (use_master_key_) {
+    encrypted_data.resize(ValueCipher::SealedSize(size));
+    return cipher_->Seal(key, plain, size, encrypted_data.data());
+  }
+  
   DATA_BLOB data_in;
   DATA_BLOB data_out;
   
-  data_in.pbData = (BYTE*)plain_text.c_str();
-  data_in.cbData = plain_text.length() + 1;
+  // DPAPI text values keep their historical trailing NUL so existing files
+  // read back unchanged; DecryptData strips exactly that byte. Bytes values
+  // are stored exactly, marked by their description.
+  data_in.pbData = const_cast<BYTE*>(plain);
+  data_in.cbData = static_cast<DWORD>(binary ? size : size + 1);
   
   // Use Windows DPAPI to encrypt data
-  if (CryptProtectData(&data_in, L"flutter_mcp", nullptr, nullptr, nullptr, 0, &data_out)) {
+  if (CryptProtectData(&data_in, binary ? kBytesDescription : kTextDescription, nullptr,
+                       nullptr, nullptr, 0, &data_out)) {
     encrypted_data.assign(data_out.pbData, data_out.pbData + data_out.cbData);
     LocalFree(data_out.pbData);
     return true;
@@ -92,16 +383,42 @@ bool SecureStorageService::EncryptData(const std::string& plain_text, std::vecto
   return false;
 }
 
-bool SecureStorageService::DecryptData(const std::vector<BYTE>& encrypted_data, std::string& plain_text) {
+template <typename Buffer>
+bool SecureStorageService::DecryptData(const std::string& key, const BYTE* encrypted_data,
+                                       size_t length, Buffer& plain) {
+  // Sealed values are recognized by their header whichever mode is active
+  if (ValueCipher::IsSealed(encrypted_data, length)) {
+    if (!LoadCipher()) {
+      return false;
+    }
+    plain.resize(ValueCipher::PlainSize(length));
+    if (!cipher_->Unseal(key, encrypted_data, length, reinterpret_cast<BYTE*>(plain.data()))) {
+      SecureZeroMemory(plain.data(), plain.size());
+      plain.clear();
+      return false;
+    }
+    return true;
+  }
+  
   DATA_BLOB data_in;
   DATA_BLOB data_out;
+  LPWSTR description = nullptr;
   
-  data_in.pbData = const_cast<BYTE*>(encrypted_data.data());
-  data_in.cbData = encrypted_data.size();
+  data_in.pbData = const_cast<BYTE*>(encrypted_data);
+  data_in.cbData = static_cast<DWORD>(length);
   
   // Use Windows DPAPI to decrypt data
-  if (CryptUnprotectData(&data_in, nullptr, nullptr, nullptr, nullptr, 0, &data_out)) {
-    plain_text = std::string((char*)data_out.pbData);
+  if (CryptUnprotectData(&data_in, &description, nullptr, nullptr, nullptr, 0, &data_out)) {
+    const bool binary = description && wcscmp(description, kBytesDescription) == 0;
+    LocalFree(description);
+    const DWORD size =
+        !binary && data_out.cbData > 0 && data_out.pbData[data_out.cbData - 1] == 0
+            ? data_out.cbData - 1
+            : data_out.cbData;
+    using Element = typename Buffer::value_type;
+    plain.assign(reinterpret_cast<const Element*>(data_out.pbData),
+                 reinterpret_cast<const Element*>(data_out.pbData) + size);
+    SecureZeroMemory(data_out.pbData, data_out.cbData);
     LocalFree(data_out.pbData);
     return true;
   }
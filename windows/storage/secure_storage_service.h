@@ -3,11 +3,39 @@
 
 #include <windows.h>
 #include <wincrypt.h>
+#include <functional>
 #include <string>
 #include <map>
+#include <memory>
+#include <vector>
+
+#include "secret_cache.h"
+#include "record_store.h"
+#include "value_cipher.h"
+#include "write_behind_buffer.h"
 
 namespace flutter_mcp {
 
+enum class StorageBackend {
+  // One DPAPI-protected file per key
+  kFiles,
+  // DPAPI-protected records in a single memory-mapped file
+  kRecordFile,
+};
+
+// Parses "files"/"recordFile"; anything else maps to kFiles.
+StorageBackend ParseStorageBackend(const std::string& name);
+
+enum class EncryptionMode {
+  // One DPAPI call per value
+  kDpapi,
+  // AES-GCM under a DPAPI-wrapped master key unwrapped once
+  kMasterKey,
+};
+
+// Parses "dpapi"/"masterKey"; anything else maps to kDpapi.
+EncryptionMode ParseEncryptionMode(const std::string& name);
+
 class SecureStorageService {
  public:
   SecureStorageService();
@@ -15,20 +43,90 @@ class SecureStorageService {
 
   bool Store(const std::string& key, const std::string& value);
   bool Read(const std::string& key, std::string& value);
+  // Binary-safe variants. |data| goes straight to DPAPI or AES-GCM and the
+  // value is decrypted straight into |value|; bytes values skip the cache.
+  bool StoreBytes(const std::string& key, const uint8_t* data, size_t size);
+  bool ReadBytes(const std::string& key, std::vector<uint8_t>& value);
   bool Delete(const std::string& key);
   bool ContainsKey(const std::string& key);
   void DeleteAll();
 
+  // Reads every listed key that exists. With the record file backend this
+  // is one pass over the in-memory index and the mapped file; with the
+  // files backend, one directory listing decides which files to open.
+  void ReadMany(const std::vector<std::string>& keys,
+                std::map<std::string, std::string>& values);
+  // Reads every key starting with |prefix|. Needs the record file backend:
+  // the files backend names each file after a hash of its key, so no
+  // listing can recover which keys match. Returns false there.
+  bool ReadPrefix(const std::string& prefix,
+                  std::map<std::string, std::string>& values);
+
+  // Keeps recently read values decrypted in memory; off by default
+  void ConfigureCache(const SecretCacheConfig& config);
+
+  // Switches where values are kept. Values written through one backend are
+  // not visible through the other. Returns false, keeping the current
+  // backend, if the record file cannot be opened.
+  bool SetBackend(StorageBackend backend);
+
+  // Switches how new values are encrypted. Values written under either
+  // mode stay readable. Returns false, keeping DPAPI, if the master key
+  // cannot be loaded or created.
+  bool SetEncryption(EncryptionMode mode);
+
+  // With write-behind on, Store, StoreBytes and Delete only buffer the
+  // newest write per key and succeed at once; reads see buffered writes.
+  // Buffered writes are persisted by Flush(), which the caller schedules,
+  // or at once when max_pending keys are waiting. Until then they exist
+  // only in memory. Turning it off flushes
+  void ConfigureWriteBehind(const WriteBehindConfig& config);
+  WriteBehindConfig write_behind_config() { return write_behind_.config(); }
+  size_t pending_writes() { return write_behind_.size(); }
+
+  // Persists every buffered write, in the order of each key's newest write
+  void Flush();
+
+  // Buffered writes that failed to persist since the last call
+  size_t TakeWriteFailures() { return write_behind_.TakeFailures(); }
+
  private:
-  bool EncryptData(const std::string& plain_text, std::vector<BYTE>& encrypted_data);
-  bool DecryptData(const std::vector<BYTE>& encrypted_data, std::string& plain_text);
+  // DPAPI text values carry a trailing NUL; bytes values are told apart by
+  // their DPAPI description and stored exactly
+  bool EncryptData(const std::string& key, const BYTE* plain, size_t size, bool binary,
+                   std::vector<BYTE>& encrypted_data);
+  // |Buffer| is std::string or std::vector<uint8_t>
+  template <typename Buffer>
+  bool DecryptData(const std::string& key, const BYTE* encrypted_data, size_t length,
+                   Buffer& plain);
+  bool WriteEncrypted(const std::string& key, const std::vector<BYTE>& encrypted_data);
+  bool StoreNow(const std::string& key, const BYTE* data, size_t size, bool binary);
+  bool DeleteNow(const std::string& key);
+  void BufferWrite(const std::string& key, PendingWrite::Kind kind, const char* data,
+                   size_t size);
+  template <typename Buffer>
+  bool ReadDecrypted(const std::string& key, Buffer& plain);
+  bool LoadCipher();
   std::wstring GetStoragePath();
   std::wstring GetFilePath(const std::string& key);
   bool SaveToFile(const std::wstring& path, const std::vector<BYTE>& data);
   bool LoadFromFile(const std::wstring& path, std::vector<BYTE>& data);
+  // Visits the path of every value file of the files backend
+  void ForEachValueFile(const std::function<void(const std::wstring& path)>& visit);
   
   std::wstring storage_dir_;
+  SecretCache cache_;
+  WriteBehindBuffer write_behind_;
+  // Set while the record file backend is active
+  std::unique_ptr<RecordStore> record_store_;
+  // Loaded once the master key mode has been enabled
+  std::unique_ptr<ValueCipher> cipher_;
+  bool use_master_key_ = false;
   static constexpr const wchar_t* kStorageSubDir = L"flutter_mcp\\secure_storage";
+  static constexpr const wchar_t* kRecordFileName = L"store.db";
+  static constexpr const wchar_t* kMasterKeyFileName = L"master.key";
+  static constexpr const wchar_t* kTextDescription = L"flutter_mcp";
+  static constexpr const wchar_t* kBytesDescription = L"flutter_mcp.bytes";
 };
 
 }  // namespace flutter_mcp
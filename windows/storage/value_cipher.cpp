@@ -0,0 +1,198 @@
+#include "value_cipher.h"
+
+#include <wincrypt.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#pragma comment(lib, "bcrypt.lib")
+#pragma comment(lib, "crypt32.lib")
+
+namespace flutter_mcp {
+
+namespace {
+
+constexpr BYTE kMagic[4] = {'F', 'M', 'G', '1'};
+constexpr size_t kNonceLength = 12;
+constexpr size_t kTagLength = 16;
+constexpr size_t kKeyLength = 32;
+
+bool Succeeded(NTSTATUS status) {
+  return status >= 0;
+}
+
+void InitAuthInfo(BCRYPT_AUTHENTICATED_CIPHER_MODE_INFO& info,
+                  const std::string& key, BYTE* nonce, BYTE* tag) {
+  BCRYPT_INIT_AUTH_MODE_INFO(info);
+  info.pbNonce = nonce;
+  info.cbNonce = static_cast<ULONG>(kNonceLength);
+  info.pbAuthData = reinterpret_cast<PUCHAR>(const_cast<char*>(key.data()));
+  info.cbAuthData = static_cast<ULONG>(key.size());
+  info.pbTag = tag;
+  info.cbTag = static_cast<ULONG>(kTagLength);
+}
+
+}  // namespace
+
+ValueCipher::ValueCipher() : algorithm_(nullptr), key_(nullptr) {}
+
+ValueCipher::~ValueCipher() {
+  if (key_) {
+    BCryptDestroyKey(key_);
+  }
+  if (algorithm_) {
+    BCryptCloseAlgorithmProvider(algorithm_, 0);
+  }
+}
+
+bool ValueCipher::Open(const std::wstring& key_path) {
+  if (key_) {
+    return true;
+  }
+
+  if (!algorithm_) {
+    if (!Succeeded(BCryptOpenAlgorithmProvider(&algorithm_, BCRYPT_AES_ALGORITHM,
+                                               nullptr, 0))) {
+      algorithm_ = nullptr;
+      return false;
+    }
+    if (!Succeeded(BCryptSetProperty(
+            algorithm_, BCRYPT_CHAINING_MODE,
+            reinterpret_cast<PUCHAR>(const_cast<wchar_t*>(BCRYPT_CHAIN_MODE_GCM)),
+            sizeof(BCRYPT_CHAIN_MODE_GCM), 0))) {
+      return false;
+    }
+  }
+
+  BYTE key_bytes[kKeyLength];
+  bool loaded = GetFileAttributesW(key_path.c_str()) != INVALID_FILE_ATTRIBUTES
+                    ? LoadKey(key_path, key_bytes, kKeyLength)
+                    : CreateKey(key_path, key_bytes, kKeyLength);
+  if (loaded &&
+      !Succeeded(BCryptGenerateSymmetricKey(algorithm_, &key_, nullptr, 0,
+                                            key_bytes, kKeyLength, 0))) {
+    key_ = nullptr;
+    loaded = false;
+  }
+  SecureZeroMemory(key_bytes, sizeof(key_bytes));
+  return loaded;
+}
+
+bool ValueCipher::LoadKey(const std::wstring& key_path, BYTE* key_bytes,
+                          size_t length) {
+  std::ifstream file(key_path, std::ios::binary);
+  std::vector<BYTE> wrapped((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+  if (wrapped.empty()) {
+    return false;
+  }
+
+  DATA_BLOB data_in;
+  DATA_BLOB data_out;
+  data_in.pbData = wrapped.data();
+  data_in.cbData = static_cast<DWORD>(wrapped.size());
+  if (!CryptUnprotectData(&data_in, nullptr, nullptr, nullptr, nullptr, 0, &data_out)) {
+    return false;
+  }
+
+  const bool valid = data_out.cbData == length;
+  if (valid) {
+    memcpy(key_bytes, data_out.pbData, length);
+  }
+  SecureZeroMemory(data_out.pbData, data_out.cbData);
+  LocalFree(data_out.pbData);
+  return valid;
+}
+
+bool ValueCipher::CreateKey(const std::wstring& key_path, BYTE* key_bytes,
+                            size_t length) {
+  if (!Succeeded(BCryptGenRandom(nullptr, key_bytes, static_cast<ULONG>(length),
+                                 BCRYPT_USE_SYSTEM_PREFERRED_RNG))) {
+    return false;
+  }
+
+  DATA_BLOB data_in;
+  DATA_BLOB data_out;
+  data_in.pbData = key_bytes;
+  data_in.cbData = static_cast<DWORD>(length);
+  if (!CryptProtectData(&data_in, L"flutter_mcp master key", nullptr, nullptr,
+                        nullptr, 0, &data_out)) {
+    return false;
+  }
+
+  // Write then rename so a crash never leaves a truncated key behind
+  const std::wstring temp_path = key_path + L".tmp";
+  bool written;
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(data_out.pbData), data_out.cbData);
+    file.close();
+    written = file.good();
+  }
+  LocalFree(data_out.pbData);
+
+  if (!written ||
+      !MoveFileExW(temp_path.c_str(), key_path.c_str(), MOVEFILE_WRITE_THROUGH)) {
+    DeleteFileW(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+// static
+bool ValueCipher::IsSealed(const BYTE* sealed, size_t length) {
+  return length >= kOverhead && memcmp(sealed, kMagic, sizeof(kMagic)) == 0;
+}
+
+bool ValueCipher::Seal(const std::string& key, const BYTE* plain, size_t length,
+                       BYTE* out) {
+  if (!key_) {
+    return false;
+  }
+
+  BYTE* nonce = out + sizeof(kMagic);
+  BYTE* tag = nonce + kNonceLength;
+  BYTE* ciphertext = tag + kTagLength;
+  memcpy(out, kMagic, sizeof(kMagic));
+  if (!Succeeded(BCryptGenRandom(nullptr, nonce, static_cast<ULONG>(kNonceLength),
+                                 BCRYPT_USE_SYSTEM_PREFERRED_RNG))) {
+    return false;
+  }
+
+  BCRYPT_AUTHENTICATED_CIPHER_MODE_INFO info;
+  InitAuthInfo(info, key, nonce, tag);
+  ULONG written = 0;
+  return Succeeded(BCryptEncrypt(key_, const_cast<PUCHAR>(plain),
+                                 static_cast<ULONG>(length), &info, nullptr, 0,
+                                 ciphertext, static_cast<ULONG>(length),
+                                 &written, 0)) &&
+         written == length;
+}
+
+bool ValueCipher::Unseal(const std::string& key, const BYTE* sealed,
+                         size_t length, BYTE* out) {
+  if (!key_ || !IsSealed(sealed, length)) {
+    return false;
+  }
+
+  BYTE nonce[kNonceLength];
+  BYTE tag[kTagLength];
+  memcpy(nonce, sealed + sizeof(kMagic), kNonceLength);
+  memcpy(tag, sealed + sizeof(kMagic) + kNonceLength, kTagLength);
+  const BYTE* ciphertext = sealed + kOverhead;
+  const size_t plain_length = PlainSize(length);
+
+  BCRYPT_AUTHENTICATED_CIPHER_MODE_INFO info;
+  InitAuthInfo(info, key, nonce, tag);
+  ULONG written = 0;
+  return Succeeded(BCryptDecrypt(key_, const_cast<PUCHAR>(ciphertext),
+                                 static_cast<ULONG>(plain_length), &info,
+                                 nullptr, 0, out,
+                                 static_cast<ULONG>(plain_length), &written,
+                                 0)) &&
+         written == plain_length;
+}
+
+}  // namespace flutter_mcp
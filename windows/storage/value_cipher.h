@@ -0,0 +1,55 @@
+#ifndef VALUE_CIPHER_H_
+#define VALUE_CIPHER_H_
+
+#include <windows.h>
+#include <bcrypt.h>
+
+#include <cstddef>
+#include <string>
+
+namespace flutter_mcp {
+
+// AES-256-GCM sealing of secure storage values under one master key.
+//
+// The master key is generated once, kept on disk wrapped by DPAPI and
+// unwrapped when the cipher is opened, so a value costs one BCrypt call
+// instead of a DPAPI round trip. Sealed values are laid out as
+// magic | nonce | tag | ciphertext and are bound to their storage key,
+// which is passed as additional authenticated data.
+class ValueCipher {
+ public:
+  static constexpr size_t kOverhead = 4 + 12 + 16;
+
+  ValueCipher();
+  ~ValueCipher();
+
+  ValueCipher(const ValueCipher&) = delete;
+  ValueCipher& operator=(const ValueCipher&) = delete;
+
+  // Loads the master key from |key_path|, creating it on first use. Fails
+  // rather than replacing a key file that exists but cannot be unwrapped.
+  bool Open(const std::wstring& key_path);
+
+  // Whether |sealed| was produced by Seal, as opposed to a DPAPI blob.
+  static bool IsSealed(const BYTE* sealed, size_t length);
+
+  static size_t SealedSize(size_t plain_length) { return plain_length + kOverhead; }
+  static size_t PlainSize(size_t sealed_length) { return sealed_length - kOverhead; }
+
+  // Writes SealedSize(length) bytes to |out|.
+  bool Seal(const std::string& key, const BYTE* plain, size_t length, BYTE* out);
+  // Writes PlainSize(length) bytes to |out|; fails if the value was
+  // tampered with or sealed for another key.
+  bool Unseal(const std::string& key, const BYTE* sealed, size_t length, BYTE* out);
+
+ private:
+  bool LoadKey(const std::wstring& key_path, BYTE* key_bytes, size_t length);
+  bool CreateKey(const std::wstring& key_path, BYTE* key_bytes, size_t length);
+
+  BCRYPT_ALG_HANDLE algorithm_;
+  BCRYPT_KEY_HANDLE key_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // VALUE_CIPHER_H_
@@ -0,0 +1,280 @@
+#include <windows.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "background/background_service.h"
+#include "native_metrics.h"
+#include "stress_support.h"
+
+namespace flutter_mcp {
+namespace stress {
+
+namespace {
+
+// Per-task outcome flags, indexed by the task's slot
+class Outcomes {
+ public:
+  explicit Outcomes(size_t count)
+      : fired_(new std::atomic<uint32_t>[count]()),
+        cancel_attempted_(new std::atomic<bool>[count]()),
+        count_(count) {}
+
+  void Fire(size_t slot) {
+    if (fired_[slot].fetch_add(1) > 0) {
+      duplicates_++;
+    }
+    total_fired_++;
+  }
+  void AttemptCancel(size_t slot) { cancel_attempted_[slot] = true; }
+
+  size_t fired() const { return total_fired_; }
+  size_t duplicates() const { return duplicates_; }
+
+  // CancelTask reports nothing, so only tasks nobody tried to cancel are
+  // known to be owed a run
+  size_t UnfiredUncancelled() const {
+    size_t count = 0;
+    for (size_t i = 0; i < count_; i++) {
+      if (!cancel_attempted_[i] && fired_[i] == 0) {
+        count++;
+      }
+    }
+    return count;
+  }
+
+ private:
+  std::unique_ptr<std::atomic<uint32_t>[]> fired_;
+  std::unique_ptr<std::atomic<bool>[]> cancel_attempted_;
+  size_t count_;
+  std::atomic<size_t> total_fired_{0};
+  std::atomic<size_t> duplicates_{0};
+};
+
+void StartQuietly(BackgroundService& service, TimerBackend backend) {
+  service.SetTimerBackend(backend);
+  service.SetWorkerThreads(4);
+  // Keeps the periodic tick out of the way of the scheduled tasks
+  service.SetInterval(60000);
+  service.Start([](const std::string&, const std::map<std::string, flutter::EncodableValue>&) {});
+}
+
+}  // namespace
+
+// Every test runs against both timer backends
+class BackgroundServiceStress : public ::testing::TestWithParam<TimerBackend> {};
+
+TEST_P(BackgroundServiceStress, FiresEveryTaskOnceWithLowLateness) {
+  const size_t count = Scaled(100000);
+  const size_t threads = StressThreads();
+  BackgroundService service;
+  StartQuietly(service, GetParam());
+  Outcomes outcomes(count);
+  LatencyHistogram lateness;
+  std::unique_ptr<Clock::time_point[]> due(new Clock::time_point[count]);
+
+  const auto start = Clock::now();
+  std::vector<std::thread> schedulers;
+  for (size_t t = 0; t < threads; t++) {
+    schedulers.emplace_back([&, t] {
+      std::minstd_rand random(static_cast<uint32_t>(t + 1));
+      for (size_t slot = t; slot < count; slot += threads) {
+        const int64_t delay_ms = random() % 500;
+        due[slot] = Clock::now() + std::chrono::milliseconds(delay_ms);
+        service.ScheduleTask("task-" + std::to_string(slot), delay_ms, [&, slot] {
+          lateness.Record(MicrosBetween(due[slot], Clock::now()));
+          outcomes.Fire(slot);
+        });
+      }
+    });
+  }
+  for (auto& thread : schedulers) {
+    thread.join();
+  }
+  ReportThroughput("schedule", count, Clock::now() - start);
+
+  EXPECT_TRUE(WaitUntil([&] { return outcomes.fired() >= count; },
+                        std::chrono::milliseconds(60000)));
+  EXPECT_EQ(outcomes.fired(), count);
+  EXPECT_EQ(outcomes.duplicates(), 0u);
+  ReportLatency("fire_lateness", lateness);
+  service.Stop();
+}
+
+TEST_P(BackgroundServiceStress, DrainsABurstOfDueTasks) {
+  const size_t count = Scaled(100000);
+  BackgroundService service;
+  StartQuietly(service, GetParam());
+  Outcomes outcomes(count);
+
+  const auto start = Clock::now();
+  for (size_t slot = 0; slot < count; slot++) {
+    service.ScheduleTask("burst-" + std::to_string(slot), 0, [&, slot] { outcomes.Fire(slot); });
+  }
+  EXPECT_TRUE(WaitUntil([&] { return outcomes.fired() >= count; },
+                        std::chrono::milliseconds(60000)));
+  ReportThroughput("burst_fired", outcomes.fired(), Clock::now() - start);
+  EXPECT_EQ(outcomes.duplicates(), 0u);
+  service.Stop();
+}
+
+// Cancels race scheduling and dispatch: nothing runs twice, and every task
+// nobody tried to cancel still runs
+TEST_P(BackgroundServiceStress, CancelChurnNeverLosesOrRepeatsATask) {
+  const size_t threads = StressThreads();
+  const size_t per_thread = Scaled(20000) / threads;
+  const size_t count = per_thread * threads;
+  BackgroundService service;
+  StartQuietly(service, GetParam());
+  Outcomes outcomes(count);
+  std::atomic<size_t> next_slot{0};
+  std::atomic<bool> scheduling{true};
+
+  std::vector<std::thread> cancellers;
+  for (size_t t = 0; t < threads / 2; t++) {
+    cancellers.emplace_back([&, t] {
+      std::minstd_rand random(static_cast<uint32_t>(1000 + t));
+      while (scheduling) {
+        const size_t claimed = (std::min)(next_slot.load(), count);
+        if (claimed == 0) {
+          std::this_thread::yield();
+          continue;
+        }
+        // Any slot claimed so far, scheduled or about to be
+        const size_t slot = random() % claimed;
+        outcomes.AttemptCancel(slot);
+        service.CancelTask("churn-" + std::to_string(slot));
+      }
+    });
+  }
+
+  const auto start = Clock::now();
+  std::vector<std::thread> schedulers;
+  for (size_t t = 0; t < threads; t++) {
+    schedulers.emplace_back([&, t] {
+      std::minstd_rand random(static_cast<uint32_t>(t + 1));
+      for (size_t i = 0; i < per_thread; i++) {
+        const size_t slot = next_slot++;
+        service.ScheduleTask("churn-" + std::to_string(slot), random() % 20,
+                             [&, slot] { outcomes.Fire(slot); });
+      }
+    });
+  }
+  for (auto& thread : schedulers) {
+    thread.join();
+  }
+  scheduling = false;
+  for (auto& thread : cancellers) {
+    thread.join();
+  }
+  ReportThroughput("schedule", count, Clock::now() - start);
+
+  EXPECT_TRUE(WaitUntil([&] { return outcomes.UnfiredUncancelled() == 0; },
+                        std::chrono::milliseconds(30000)));
+  EXPECT_EQ(outcomes.duplicates(), 0u);
+  service.Stop();
+}
+
+// Stop and Start run on one thread, as they do on the platform thread,
+// while workers keep scheduling; nothing may run twice and the service
+// must still run tasks afterwards
+TEST_P(BackgroundServiceStress, StopRacingScheduleKeepsTheServiceUsable) {
+  const size_t threads = StressThreads();
+  const size_t per_thread = Scaled(5000);
+  const size_t count = per_thread * threads;
+  BackgroundService service;
+  StartQuietly(service, GetParam());
+  Outcomes outcomes(count);
+  std::atomic<bool> scheduling{true};
+  std::atomic<size_t> stops{0};
+
+  std::thread platform([&] {
+    while (scheduling) {
+      service.Stop();
+      stops++;
+      StartQuietly(service, GetParam());
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  std::vector<std::thread> schedulers;
+  for (size_t t = 0; t < threads; t++) {
+    schedulers.emplace_back([&, t] {
+      std::minstd_rand random(static_cast<uint32_t>(t + 1));
+      for (size_t i = 0; i < per_thread; i++) {
+        const size_t slot = t * per_thread + i;
+        service.ScheduleTask("stop-" + std::to_string(slot), random() % 5,
+                             [&, slot] { outcomes.Fire(slot); });
+      }
+    });
+  }
+  for (auto& thread : schedulers) {
+    thread.join();
+  }
+  scheduling = false;
+  platform.join();
+  std::printf("[ STRESS   ] %zu stops, %zu of %zu tasks fired\n", stops.load(),
+              outcomes.fired(), count);
+  EXPECT_EQ(outcomes.duplicates(), 0u);
+
+  std::atomic<bool> fired_after{false};
+  service.ScheduleTask("after-stop", 0, [&] { fired_after = true; });
+  EXPECT_TRUE(WaitUntil([&] { return fired_after.load(); }, std::chrono::milliseconds(5000)));
+  service.Stop();
+}
+
+// Recurring jobs registered and cancelled from many threads all stop
+TEST_P(BackgroundServiceStress, RecurringChurnLeavesNoJobRunning) {
+  constexpr size_t kJobs = 64;
+  const size_t threads = StressThreads();
+  const size_t per_thread = Scaled(2000);
+  BackgroundService service;
+  StartQuietly(service, GetParam());
+  std::atomic<size_t> runs{0};
+  Recurrence recurrence;
+  recurrence.period_ms = 1;
+
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      std::minstd_rand random(static_cast<uint32_t>(t + 1));
+      for (size_t i = 0; i < per_thread; i++) {
+        const std::string id = "job-" + std::to_string(random() % kJobs);
+        if (random() % 2) {
+          service.ScheduleRecurringTask(id, 0, recurrence, [&] { runs++; });
+        } else {
+          service.CancelTask(id);
+        }
+      }
+    });
+  }
+  for (auto& thread : workers) {
+    thread.join();
+  }
+  for (size_t job = 0; job < kJobs; job++) {
+    service.CancelTask("job-" + std::to_string(job));
+  }
+
+  // Runs already in flight when their job was cancelled may still finish
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  const size_t settled = runs;
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(runs.load(), settled);
+  service.Stop();
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, BackgroundServiceStress,
+                         ::testing::Values(TimerBackend::kThreadpool, TimerBackend::kThread),
+                         [](const ::testing::TestParamInfo<TimerBackend>& info) {
+                           return info.param == TimerBackend::kThread ? "Thread" : "Threadpool";
+                         });
+
+}  // namespace stress
+}  // namespace flutter_mcp
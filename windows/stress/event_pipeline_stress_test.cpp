@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "event_batcher.h"
+#include "event_ring_buffer.h"
+#include "native_metrics.h"
+#include "stress_support.h"
+
+namespace flutter_mcp {
+namespace stress {
+
+namespace {
+
+struct Event {
+  uint32_t producer = 0;
+  uint32_t sequence = 0;
+  Clock::time_point posted;
+};
+
+// PostEvent, ScheduleDrain and DrainEvents with the drop-oldest policy,
+// over a simulated platform thread. The sink and listening flag are only
+// touched there, like event_sink_
+class Pipeline {
+ public:
+  Pipeline(size_t capacity, size_t producers)
+      : queue_(capacity), next_(producers, 0) {}
+
+  void Post(Event event) {
+    while (!queue_.TryPush(std::move(event))) {
+      Event oldest;
+      if (queue_.TryPop(oldest)) {
+        dropped_oldest_++;
+      }
+    }
+    ScheduleDrain();
+  }
+
+  // What OnListen and OnCancel do to the sink, on the platform thread
+  void SetListening(bool listening) {
+    loop_.Post([this, listening] { listening_ = listening; });
+  }
+
+  // Waits for the drains already scheduled, and any they schedule
+  void Quiesce() { loop_.Quiesce(); }
+
+  bool empty() {
+    Event event;
+    return !queue_.TryPop(event);
+  }
+
+  size_t delivered() const { return delivered_; }
+  size_t dropped_cancelled() const { return dropped_cancelled_; }
+  size_t dropped_oldest() const { return dropped_oldest_; }
+  size_t out_of_order() const { return out_of_order_; }
+  size_t drains() const { return drains_; }
+  const LatencyHistogram& latency() const { return latency_; }
+
+ private:
+  void ScheduleDrain() {
+    if (!drain_scheduled_.exchange(true)) {
+      loop_.Post([this] { Drain(); });
+    }
+  }
+
+  void Drain() {
+    drains_++;
+    drain_scheduled_ = false;
+    Event event;
+    for (size_t i = 0; i < queue_.capacity(); i++) {
+      if (!queue_.TryPop(event)) {
+        return;
+      }
+      // Drop-oldest leaves gaps but must never reorder
+      if (event.sequence < next_[event.producer]) {
+        out_of_order_++;
+      }
+      next_[event.producer] = event.sequence + 1;
+      if (listening_) {
+        delivered_++;
+        latency_.Record(MicrosBetween(event.posted, Clock::now()));
+      } else {
+        dropped_cancelled_++;
+      }
+    }
+    ScheduleDrain();
+  }
+
+  EventRingBuffer<Event> queue_;
+  std::atomic<bool> drain_scheduled_{false};
+  std::atomic<size_t> dropped_oldest_{0};
+
+  // Platform thread only
+  std::vector<uint32_t> next_;
+  bool listening_ = true;
+  size_t delivered_ = 0;
+  size_t dropped_cancelled_ = 0;
+  size_t out_of_order_ = 0;
+  size_t drains_ = 0;
+  LatencyHistogram latency_;
+
+  // Declared last so its thread stops before the rest is destroyed
+  SimulatedMainLoop loop_;
+};
+
+}  // namespace
+
+// Bursts from many threads while the listener cancels and listens again:
+// every event is delivered, dropped while cancelled or evicted as the
+// oldest, exactly once and in order, and no push is left without a drain
+TEST(EventPipelineStress, AccountsForEveryEventWhileTheListenerComesAndGoes) {
+  const size_t producers = StressThreads();
+  const size_t per_producer = Scaled(50000);
+  Pipeline pipeline(1024, producers);
+  LatencyHistogram post_time;
+  std::atomic<bool> producing{true};
+
+  std::thread listener([&] {
+    bool listening = true;
+    while (producing) {
+      listening = !listening;
+      pipeline.SetListening(listening);
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    pipeline.SetListening(true);
+  });
+
+  const auto start = Clock::now();
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < producers; p++) {
+    threads.emplace_back([&, p] {
+      for (size_t i = 0; i < per_producer; i++) {
+        Event event;
+        event.producer = static_cast<uint32_t>(p);
+        event.sequence = static_cast<uint32_t>(i);
+        event.posted = Clock::now();
+        const auto posted = event.posted;
+        pipeline.Post(std::move(event));
+        post_time.Record(MicrosBetween(posted, Clock::now()));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  producing = false;
+  listener.join();
+  pipeline.Quiesce();
+  ReportThroughput("events_posted", producers * per_producer, Clock::now() - start);
+
+  EXPECT_TRUE(pipeline.empty());
+  EXPECT_EQ(pipeline.delivered() + pipeline.dropped_cancelled() + pipeline.dropped_oldest(),
+            producers * per_producer);
+  EXPECT_EQ(pipeline.out_of_order(), 0u);
+  std::printf("[ STRESS   ] %zu drains, %zu dropped while cancelled, %zu evicted\n",
+              pipeline.drains(), pipeline.dropped_cancelled(), pipeline.dropped_oldest());
+  ReportLatency("event_post", post_time);
+  ReportLatency("event_delivery", pipeline.latency());
+}
+
+// Producers add while another thread keeps reconfiguring batching: every
+// event is either flushed once or handed back for direct delivery, and
+// each type's flushed events stay in order
+TEST(EventPipelineStress, BatcherLosesNothingWhileReconfigured) {
+  const size_t producers = StressThreads();
+  const size_t per_producer = Scaled(20000);
+  std::mutex flushed_mutex;
+  std::vector<uint32_t> next(producers, 0);
+  size_t flushed = 0;
+  size_t out_of_order = 0;
+  std::atomic<size_t> direct{0};
+
+  EventBatcher<Event> batcher(
+      [&](const std::string&, std::vector<Event>&& events, size_t) {
+        std::lock_guard<std::mutex> lock(flushed_mutex);
+        for (const auto& event : events) {
+          if (event.sequence < next[event.producer]) {
+            out_of_order++;
+          }
+          next[event.producer] = event.sequence + 1;
+          flushed++;
+        }
+      });
+  EventBatchingConfig config;
+  config.enabled = true;
+  batcher.Configure(config);
+
+  std::atomic<bool> producing{true};
+  std::thread configurer([&] {
+    std::minstd_rand random(7);
+    while (producing) {
+      EventBatchingConfig next_config;
+      next_config.enabled = random() % 4 != 0;
+      next_config.max_batch_size = 1 + random() % 64;
+      next_config.max_delay_ms = random() % 5;
+      batcher.Configure(next_config);
+      std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+  });
+
+  const auto start = Clock::now();
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < producers; p++) {
+    threads.emplace_back([&, p] {
+      const std::string type = "type-" + std::to_string(p);
+      for (size_t i = 0; i < per_producer; i++) {
+        Event event;
+        event.producer = static_cast<uint32_t>(p);
+        event.sequence = static_cast<uint32_t>(i);
+        if (!batcher.Add(type, std::move(event), false)) {
+          direct++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  producing = false;
+  configurer.join();
+  batcher.Configure(EventBatchingConfig());
+  ReportThroughput("events_batched", producers * per_producer, Clock::now() - start);
+
+  std::lock_guard<std::mutex> lock(flushed_mutex);
+  EXPECT_EQ(flushed + direct, producers * per_producer);
+  EXPECT_EQ(out_of_order, 0u);
+}
+
+}  // namespace stress
+}  // namespace flutter_mcp
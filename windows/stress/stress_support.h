@@ -0,0 +1,151 @@
+#ifndef STRESS_SUPPORT_H_
+#define STRESS_SUPPORT_H_
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "native_metrics.h"
+
+namespace flutter_mcp {
+namespace stress {
+
+using Clock = std::chrono::steady_clock;
+
+// Multiplies |base| by FLUTTER_MCP_STRESS_SCALE, which is 1 unless set, so
+// the same tests double as a soak run
+inline size_t Scaled(size_t base) {
+  const char* scale = std::getenv("FLUTTER_MCP_STRESS_SCALE");
+  const long factor = scale ? std::strtol(scale, nullptr, 10) : 1;
+  return base * static_cast<size_t>(factor > 0 ? factor : 1);
+}
+
+// Threads that drive the code under test. Never fewer than four, so the
+// races still interleave on small machines
+inline size_t StressThreads() {
+  return (std::max)(static_cast<size_t>(4),
+                    static_cast<size_t>(std::thread::hardware_concurrency()));
+}
+
+inline int64_t MicrosBetween(Clock::time_point from, Clock::time_point to) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+// Prints |histogram|'s percentiles and records them as test properties,
+// which --gtest_output=xml keeps for comparing runs. With
+// FLUTTER_MCP_STRESS_MAX_P99_US set, a p99 above it fails the test
+inline void ReportLatency(const std::string& name, const LatencyHistogram& histogram) {
+  const HistogramSnapshot snapshot = histogram.Snapshot();
+  std::printf("[ STRESS   ] %s: n=%llu p50=%lluus p99=%lluus p999=%lluus max=%lluus\n",
+              name.c_str(), static_cast<unsigned long long>(snapshot.count),
+              static_cast<unsigned long long>(snapshot.p50),
+              static_cast<unsigned long long>(snapshot.p99),
+              static_cast<unsigned long long>(snapshot.p999),
+              static_cast<unsigned long long>(snapshot.max));
+  ::testing::Test::RecordProperty(name + "_p50_us", static_cast<int>(snapshot.p50));
+  ::testing::Test::RecordProperty(name + "_p99_us", static_cast<int>(snapshot.p99));
+  ::testing::Test::RecordProperty(name + "_max_us", static_cast<int>(snapshot.max));
+
+  if (const char* budget = std::getenv("FLUTTER_MCP_STRESS_MAX_P99_US")) {
+    EXPECT_LE(snapshot.p99, std::strtoull(budget, nullptr, 10)) << name;
+  }
+}
+
+// Prints and records how many |operations| per second took |elapsed|
+inline void ReportThroughput(const std::string& name, size_t operations,
+                             Clock::duration elapsed) {
+  const double seconds = std::chrono::duration<double>(elapsed).count();
+  const double rate = seconds > 0 ? static_cast<double>(operations) / seconds : 0.0;
+  std::printf("[ STRESS   ] %s: %zu in %.3fs (%.0f/s)\n", name.c_str(), operations, seconds,
+              rate);
+  ::testing::Test::RecordProperty(name + "_per_second", static_cast<int>(rate));
+}
+
+// Polls |done| until it holds or |timeout| passes; returns its last value
+template <typename Predicate>
+bool WaitUntil(Predicate done, std::chrono::milliseconds timeout) {
+  const auto deadline = Clock::now() + timeout;
+  while (!done()) {
+    if (Clock::now() >= deadline) {
+      return done();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+// Stands in for the platform thread: one thread running posted closures in
+// order, like messages posted to the plugin's message window
+class SimulatedMainLoop {
+ public:
+  SimulatedMainLoop() : thread_(&SimulatedMainLoop::Run, this) {}
+
+  ~SimulatedMainLoop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+
+  SimulatedMainLoop(const SimulatedMainLoop&) = delete;
+  SimulatedMainLoop& operator=(const SimulatedMainLoop&) = delete;
+
+  // Safe from any thread
+  void Post(std::function<void()> work) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push_back(std::move(work));
+    }
+    cv_.notify_all();
+  }
+
+  // Waits until nothing is queued or running
+  void Quiesce() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return queue_.empty() && !busy_; });
+  }
+
+ private:
+  void Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      std::function<void()> work = std::move(queue_.front());
+      queue_.pop_front();
+      busy_ = true;
+      lock.unlock();
+      work();
+      lock.lock();
+      busy_ = false;
+      cv_.notify_all();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> queue_;
+  bool busy_ = false;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+}  // namespace stress
+}  // namespace flutter_mcp
+
+#endif  // STRESS_SUPPORT_H_
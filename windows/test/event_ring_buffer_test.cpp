@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "event_ring_buffer.h"
+
+namespace flutter_mcp {
+namespace test {
+
+TEST(EventRingBuffer, RoundsCapacityUpToPowerOfTwo) {
+  EventRingBuffer<int> buffer(1000);
+  EXPECT_EQ(buffer.capacity(), 1024u);
+}
+
+TEST(EventRingBuffer, RejectsPushWhenFull) {
+  EventRingBuffer<int> buffer(4);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(buffer.TryPush(int(i)));
+  }
+  EXPECT_FALSE(buffer.TryPush(4));
+
+  int value = -1;
+  ASSERT_TRUE(buffer.TryPop(value));
+  EXPECT_EQ(value, 0);
+  EXPECT_TRUE(buffer.TryPush(4));
+
+  std::vector<int> drained;
+  while (buffer.TryPop(value)) {
+    drained.push_back(value);
+  }
+  EXPECT_EQ(drained, (std::vector<int>{1, 2, 3, 4}));
+}
+
+TEST(EventRingBuffer, FailedPushLeavesValueIntact) {
+  EventRingBuffer<std::unique_ptr<int>> buffer(2);
+  EXPECT_TRUE(buffer.TryPush(std::make_unique<int>(1)));
+  EXPECT_TRUE(buffer.TryPush(std::make_unique<int>(2)));
+
+  auto rejected = std::make_unique<int>(3);
+  EXPECT_FALSE(buffer.TryPush(std::move(rejected)));
+  ASSERT_TRUE(rejected);
+  EXPECT_EQ(*rejected, 3);
+}
+
+TEST(EventRingBuffer, ConcurrentProducersKeepPerProducerOrder) {
+  constexpr int kProducers = 4;
+  constexpr int kPerProducer = 20000;
+  EventRingBuffer<std::pair<int, int>> buffer(256);
+  std::atomic<int> finished(0);
+
+  std::vector<int> next(kProducers, 0);
+  size_t received = 0;
+  bool in_order = true;
+  std::thread consumer([&] {
+    std::pair<int, int> item;
+    while (true) {
+      if (buffer.TryPop(item)) {
+        in_order = in_order && item.second == next[item.first];
+        next[item.first] = item.second + 1;
+        received++;
+      } else if (finished == kProducers) {
+        if (!buffer.TryPop(item)) {
+          break;
+        }
+        in_order = in_order && item.second == next[item.first];
+        next[item.first] = item.second + 1;
+        received++;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::vector<std::thread> producers;
+  for (int producer = 0; producer < kProducers; producer++) {
+    producers.emplace_back([&, producer] {
+      for (int i = 0; i < kPerProducer; i++) {
+        while (!buffer.TryPush(std::make_pair(producer, i))) {
+          std::this_thread::yield();
+        }
+      }
+      finished++;
+    });
+  }
+  for (auto& thread : producers) {
+    thread.join();
+  }
+  consumer.join();
+
+  EXPECT_TRUE(in_order);
+  EXPECT_EQ(received, static_cast<size_t>(kProducers * kPerProducer));
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
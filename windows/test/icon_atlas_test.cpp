@@ -0,0 +1,88 @@
+#include <windows.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "tray/icon_atlas.h"
+
+namespace flutter_mcp {
+namespace test {
+
+namespace {
+
+void PutU16(std::vector<BYTE>& out, uint16_t value) {
+  out.push_back(static_cast<BYTE>(value));
+  out.push_back(static_cast<BYTE>(value >> 8));
+}
+
+void PutU32(std::vector<BYTE>& out, uint32_t value) {
+  PutU16(out, static_cast<uint16_t>(value));
+  PutU16(out, static_cast<uint16_t>(value >> 16));
+}
+
+// A one-image .ico holding a single opaque 32-bit pixel.
+std::vector<BYTE> TinyIco() {
+  std::vector<BYTE> ico;
+  PutU16(ico, 0);   // reserved
+  PutU16(ico, 1);   // type: icon
+  PutU16(ico, 1);   // image count
+
+  ico.push_back(1);  // width
+  ico.push_back(1);  // height
+  ico.push_back(0);  // palette size
+  ico.push_back(0);  // reserved
+  PutU16(ico, 1);    // planes
+  PutU16(ico, 32);   // bits per pixel
+  PutU32(ico, 48);   // image size
+  PutU32(ico, 22);   // image offset
+
+  PutU32(ico, 40);  // BITMAPINFOHEADER size
+  PutU32(ico, 1);   // width
+  PutU32(ico, 2);   // height, colour plus mask
+  PutU16(ico, 1);
+  PutU16(ico, 32);
+  for (int i = 0; i < 6; i++) {
+    PutU32(ico, 0);
+  }
+  PutU32(ico, 0xff3366cc);  // pixel
+  PutU32(ico, 0);           // AND mask row
+  return ico;
+}
+
+}  // namespace
+
+TEST(IconAtlas, DecodesIcoBytes) {
+  IconAtlas atlas;
+  const std::vector<BYTE> ico = TinyIco();
+
+  ASSERT_TRUE(atlas.AddFromBytes("busy", ico.data(), ico.size()));
+  EXPECT_NE(atlas.Find("busy"), nullptr);
+  EXPECT_EQ(atlas.Find("idle"), nullptr);
+  EXPECT_EQ(atlas.size(), 1u);
+}
+
+TEST(IconAtlas, ReplacingANameKeepsOneIcon) {
+  IconAtlas atlas;
+  const std::vector<BYTE> ico = TinyIco();
+
+  ASSERT_TRUE(atlas.AddFromBytes("status", ico.data(), ico.size()));
+  ASSERT_TRUE(atlas.AddFromBytes("status", ico.data(), ico.size()));
+  EXPECT_EQ(atlas.size(), 1u);
+}
+
+TEST(IconAtlas, RejectsGarbageAndTruncatedImages) {
+  IconAtlas atlas;
+  const BYTE garbage[] = {'n', 'o', 't', ' ', 'a', 'n', ' ', 'i', 'c', 'o', 'n'};
+  EXPECT_FALSE(atlas.AddFromBytes("bad", garbage, sizeof(garbage)));
+
+  std::vector<BYTE> truncated = TinyIco();
+  truncated.resize(30);
+  EXPECT_FALSE(atlas.AddFromBytes("bad", truncated.data(), truncated.size()));
+
+  EXPECT_FALSE(atlas.AddFromFile("missing", L"Z:\\no\\such\\icon.ico"));
+  EXPECT_EQ(atlas.size(), 0u);
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
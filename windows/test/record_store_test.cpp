@@ -0,0 +1,116 @@
+#include <windows.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "storage/record_store.h"
+
+namespace flutter_mcp {
+namespace test {
+
+namespace {
+
+class RecordStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    wchar_t dir[MAX_PATH];
+    GetTempPathW(MAX_PATH, dir);
+    path_ = std::wstring(dir) + L"flutter_mcp_record_store_test_" +
+            std::to_wstring(GetCurrentProcessId()) + L".db";
+    DeleteFileW(path_.c_str());
+  }
+
+  void TearDown() override { DeleteFileW(path_.c_str()); }
+
+  static bool Put(RecordStore& store, const std::string& key,
+                  const std::string& value) {
+    return store.Put(key, reinterpret_cast<const BYTE*>(value.data()),
+                     value.size());
+  }
+
+  static std::string Get(RecordStore& store, const std::string& key) {
+    const BYTE* data = nullptr;
+    size_t length = 0;
+    if (!store.Get(key, &data, &length)) {
+      return "<missing>";
+    }
+    return std::string(reinterpret_cast<const char*>(data), length);
+  }
+
+  std::wstring path_;
+};
+
+}  // namespace
+
+TEST_F(RecordStoreTest, LatestRecordWinsAcrossReopen) {
+  {
+    RecordStore store(path_);
+    ASSERT_TRUE(store.Open());
+    EXPECT_TRUE(Put(store, "a", "1"));
+    EXPECT_TRUE(Put(store, "b", std::string("x\0y", 3)));
+    EXPECT_TRUE(Put(store, "a", "2"));
+    EXPECT_TRUE(store.Erase("b"));
+    EXPECT_EQ(Get(store, "a"), "2");
+  }
+
+  RecordStore store(path_);
+  ASSERT_TRUE(store.Open());
+  EXPECT_EQ(store.size(), 1u);
+  EXPECT_EQ(Get(store, "a"), "2");
+  EXPECT_FALSE(store.Contains("b"));
+}
+
+TEST_F(RecordStoreTest, TornTailIsTruncated) {
+  uint64_t good_size;
+  {
+    RecordStore store(path_);
+    ASSERT_TRUE(store.Open());
+    EXPECT_TRUE(Put(store, "a", "1"));
+    good_size = store.file_size();
+  }
+
+  // Simulate a crash part way through appending the next record.
+  HANDLE file = CreateFileW(path_.c_str(), FILE_APPEND_DATA, 0, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  ASSERT_NE(file, INVALID_HANDLE_VALUE);
+  const char partial[] = "FMCR\x05\x00";
+  DWORD written = 0;
+  WriteFile(file, partial, sizeof(partial) - 1, &written, nullptr);
+  CloseHandle(file);
+
+  RecordStore store(path_);
+  ASSERT_TRUE(store.Open());
+  EXPECT_EQ(store.file_size(), good_size);
+  EXPECT_EQ(Get(store, "a"), "1");
+  EXPECT_TRUE(Put(store, "b", "2"));
+  EXPECT_EQ(Get(store, "b"), "2");
+}
+
+TEST_F(RecordStoreTest, CompactionKeepsLiveRecords) {
+  RecordStore store(path_);
+  ASSERT_TRUE(store.Open());
+  const std::string value(1024, 'v');
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_TRUE(Put(store, "hot", value + std::to_string(i)));
+  }
+  EXPECT_TRUE(Put(store, "cold", "kept"));
+
+  // Rewrites keep the file far below the 1000 appended records.
+  EXPECT_LT(store.file_size(), 512u * 1024u);
+  EXPECT_EQ(Get(store, "hot"), value + "999");
+  EXPECT_EQ(Get(store, "cold"), "kept");
+}
+
+TEST_F(RecordStoreTest, ClearDropsEverything) {
+  RecordStore store(path_);
+  ASSERT_TRUE(store.Open());
+  EXPECT_TRUE(Put(store, "a", "1"));
+  EXPECT_TRUE(store.Clear());
+  EXPECT_EQ(store.size(), 0u);
+  EXPECT_FALSE(store.Contains("a"));
+  EXPECT_TRUE(Put(store, "b", "2"));
+  EXPECT_EQ(Get(store, "b"), "2");
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
@@ -0,0 +1,85 @@
+#include <windows.h>
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+
+#include "background/task_journal.h"
+
+namespace flutter_mcp {
+namespace test {
+
+namespace {
+
+class TaskJournalTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    wchar_t dir[MAX_PATH];
+    GetTempPathW(MAX_PATH, dir);
+    path_ = std::wstring(dir) + L"flutter_mcp_task_journal_test_" +
+            std::to_wstring(GetCurrentProcessId()) + L".journal";
+    DeleteFileW(path_.c_str());
+  }
+
+  void TearDown() override { DeleteFileW(path_.c_str()); }
+
+  std::wstring path_;
+};
+
+JournaledTask OneShot(int64_t due_unix_ms) {
+  JournaledTask task;
+  task.due_unix_ms = due_unix_ms;
+  return task;
+}
+
+}  // namespace
+
+TEST_F(TaskJournalTest, PendingTasksSurviveReopening) {
+  {
+    TaskJournal journal(path_);
+    ASSERT_TRUE(journal.Open());
+    EXPECT_TRUE(journal.Record("once", OneShot(1000)));
+    JournaledTask heartbeat = OneShot(2000);
+    heartbeat.recurring = true;
+    heartbeat.recurrence.period_ms = 60000;
+    EXPECT_TRUE(journal.Record("heartbeat", heartbeat));
+    EXPECT_TRUE(journal.Record("cancelled", OneShot(3000)));
+    EXPECT_TRUE(journal.Erase("cancelled"));
+    EXPECT_TRUE(journal.SetOverduePolicy(OverduePolicy::kSkip));
+  }
+
+  TaskJournal journal(path_);
+  ASSERT_TRUE(journal.Open());
+  std::map<std::string, JournaledTask> tasks;
+  journal.ForEachTask([&](const std::string& id, const JournaledTask& task) {
+    tasks[id] = task;
+  });
+  ASSERT_EQ(tasks.size(), 2u);
+  EXPECT_EQ(tasks.at("once").due_unix_ms, 1000);
+  EXPECT_TRUE(tasks.at("heartbeat").recurring);
+  EXPECT_EQ(journal.overdue_policy(), OverduePolicy::kSkip);
+}
+
+TEST_F(TaskJournalTest, CompleteKeepsARescheduledTask) {
+  TaskJournal journal(path_);
+  ASSERT_TRUE(journal.Open());
+  journal.Record("task", OneShot(1000));
+  journal.Record("task", OneShot(2000));
+
+  EXPECT_FALSE(journal.Complete("task", 1000));
+  EXPECT_TRUE(journal.Complete("task", 2000));
+  EXPECT_FALSE(journal.Complete("task", 2000));
+}
+
+TEST_F(TaskJournalTest, RemoveDeletesTheFile) {
+  TaskJournal journal(path_);
+  ASSERT_TRUE(journal.Open());
+  journal.Record("task", OneShot(1000));
+  journal.Remove();
+
+  EXPECT_EQ(GetFileAttributesW(path_.c_str()), INVALID_FILE_ATTRIBUTES);
+  EXPECT_FALSE(journal.Record("task", OneShot(1000)));
+}
+
+}  // namespace test
+}  // namespace flutter_mcp
@@ -0,0 +1,628 @@
+#include "stdio_transport.h"
+
+#include <algorithm>
+#include <cwchar>
+#include <iterator>
+#include <utility>
+
+#include "native_trace.h"
+
+namespace flutter_mcp {
+
+namespace {
+
+constexpr int kStdin = 0;
+constexpr int kStdout = 1;
+constexpr int kStderr = 2;
+
+constexpr ULONG_PTR kIoKey = 0;
+constexpr ULONG_PTR kWakeKey = 1;
+
+constexpr ULONG kMaxEntries = 64;
+constexpr DWORD kReadChunk = 64 * 1024;
+constexpr DWORD kPipeBuffer = 64 * 1024;
+// Larger writes go out in pieces of this size
+constexpr size_t kMaxWrite = 16 * 1024 * 1024;
+// How often a server whose output closed is checked for having exited
+constexpr DWORD kReapPollMs = 100;
+
+std::wstring Utf8ToWide(const std::string& text) {
+  if (text.empty()) {
+    return std::wstring();
+  }
+  const int length = MultiByteToWideChar(CP_UTF8, 0, text.data(),
+                                         static_cast<int>(text.size()), nullptr, 0);
+  std::wstring wide(static_cast<size_t>(length), L'\0');
+  MultiByteToWideChar(CP_UTF8, 0, text.data(), static_cast<int>(text.size()), &wide[0],
+                      length);
+  return wide;
+}
+
+std::string ErrorMessage(const std::string& what, DWORD error) {
+  return what + " (error " + std::to_string(error) + ")";
+}
+
+// Quotes one argument so CommandLineToArgvW reads it back unchanged
+void AppendQuoted(const std::wstring& argument, std::wstring* command_line) {
+  if (!command_line->empty()) {
+    command_line->push_back(L' ');
+  }
+  if (!argument.empty() && argument.find_first_of(L" \t\n\v\"") == std::wstring::npos) {
+    command_line->append(argument);
+    return;
+  }
+  command_line->push_back(L'"');
+  size_t backslashes = 0;
+  for (wchar_t c : argument) {
+    if (c == L'\\') {
+      backslashes++;
+      continue;
+    }
+    // Backslashes only escape when a quote follows them
+    command_line->append(c == L'"' ? backslashes * 2 + 1 : backslashes, L'\\');
+    backslashes = 0;
+    command_line->push_back(c);
+  }
+  command_line->append(backslashes * 2, L'\\');
+  command_line->push_back(L'"');
+}
+
+// Entries such as "=C:=C:\" keep their leading '='
+std::wstring NameOf(const std::wstring& entry) {
+  return entry.substr(0, entry.find(L'=', 1));
+}
+
+// The inherited environment with |overrides| applied, as the sorted,
+// double-NUL-terminated block CreateProcess takes. Names compare without
+// case, as Windows does
+std::vector<wchar_t> BuildEnvironment(const std::vector<std::string>& overrides) {
+  std::vector<std::wstring> entries;
+  wchar_t* inherited = GetEnvironmentStringsW();
+  for (const wchar_t* entry = inherited; entry && *entry; entry += wcslen(entry) + 1) {
+    entries.emplace_back(entry);
+  }
+  if (inherited) {
+    FreeEnvironmentStringsW(inherited);
+  }
+
+  for (const auto& override_entry : overrides) {
+    std::wstring wide = Utf8ToWide(override_entry);
+    const std::wstring name = NameOf(wide);
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [&name](const std::wstring& entry) {
+                                   return _wcsicmp(NameOf(entry).c_str(), name.c_str()) == 0;
+                                 }),
+                  entries.end());
+    entries.push_back(std::move(wide));
+  }
+  std::sort(entries.begin(), entries.end(), [](const std::wstring& a, const std::wstring& b) {
+    return _wcsicmp(NameOf(a).c_str(), NameOf(b).c_str()) < 0;
+  });
+
+  std::vector<wchar_t> block;
+  for (const auto& entry : entries) {
+    block.insert(block.end(), entry.begin(), entry.end());
+    block.push_back(L'\0');
+  }
+  block.push_back(L'\0');
+  if (entries.empty()) {
+    block.push_back(L'\0');
+  }
+  return block;
+}
+
+// The parent's end is overlapped; the child's is a plain inheritable handle
+bool CreatePipePair(const std::wstring& name, bool parent_writes, HANDLE* parent,
+                    HANDLE* child) {
+  *parent = CreateNamedPipeW(
+      name.c_str(),
+      (parent_writes ? PIPE_ACCESS_OUTBOUND : PIPE_ACCESS_INBOUND) | FILE_FLAG_OVERLAPPED |
+          FILE_FLAG_FIRST_PIPE_INSTANCE,
+      PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1,
+      kPipeBuffer, kPipeBuffer, 0, nullptr);
+  if (*parent == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  // The child may adjust its end's pipe state, as libuv allows
+  SECURITY_ATTRIBUTES attributes = {sizeof(attributes), nullptr, TRUE};
+  *child = CreateFileW(name.c_str(),
+                       parent_writes ? GENERIC_READ | FILE_WRITE_ATTRIBUTES
+                                     : GENERIC_WRITE | FILE_READ_ATTRIBUTES,
+                       0, &attributes, OPEN_EXISTING, 0, nullptr);
+  if (*child == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  OVERLAPPED connect = {};
+  return !ConnectNamedPipe(*parent, &connect) && GetLastError() == ERROR_PIPE_CONNECTED;
+}
+
+void CloseValid(HANDLE& handle) {
+  if (handle != INVALID_HANDLE_VALUE && handle != nullptr) {
+    CloseHandle(handle);
+  }
+  handle = INVALID_HANDLE_VALUE;
+}
+
+}  // namespace
+
+StdioTransport::Server::Server(std::string server_id, Framing server_framing,
+                               const RoutingRules& routing)
+    : id(std::move(server_id)),
+      framing(server_framing),
+      process(nullptr),
+      pid(0),
+      ops{},
+      outstanding(0),
+      stdout_handle(INVALID_HANDLE_VALUE),
+      stderr_handle(INVALID_HANDLE_VALUE),
+      stdout_framer(server_framing),
+      stderr_framer(Framing::kNewline),
+      router(routing),
+      stdin_handle(INVALID_HANDLE_VALUE),
+      writing(false) {
+  for (int kind = kStdin; kind <= kStderr; kind++) {
+    ops[kind].server = this;
+    ops[kind].kind = kind;
+  }
+  ops[kStdout].buffer.resize(kReadChunk);
+  ops[kStderr].buffer.resize(kReadChunk);
+}
+
+StdioTransport::StdioTransport(MessagesCallback on_messages, ExitCallback on_exit)
+    : on_messages_(std::move(on_messages)),
+      on_exit_(std::move(on_exit)),
+      completion_port_(nullptr),
+      next_pipe_id_(0),
+      stopping_(false),
+      outstanding_(0),
+      pending_write_bytes_(0) {}
+
+StdioTransport::~StdioTransport() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    for (auto& entry : servers_) {
+      Server* server = entry.second.get();
+      {
+        std::lock_guard<std::mutex> write_lock(server->write_mutex);
+        CloseStdinLocked(server);
+      }
+      TerminateProcess(server->process, 1);
+    }
+  }
+  // The reactor cancels its reads and returns once every operation is done
+  if (reactor_.joinable()) {
+    PostQueuedCompletionStatus(completion_port_, 0, kWakeKey, nullptr);
+    reactor_.join();
+  }
+
+  for (auto& entry : servers_) {
+    Server* server = entry.second.get();
+    CloseValid(server->stdout_handle);
+    CloseValid(server->stderr_handle);
+    CloseValid(server->process);
+  }
+  servers_.clear();
+  if (completion_port_) {
+    CloseHandle(completion_port_);
+  }
+}
+
+bool StdioTransport::Spawn(const std::string& server_id, const Options& options, DWORD* pid,
+                           std::string* error) {
+  if (options.argv.empty()) {
+    *error = "No command given";
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stopping_) {
+    *error = "Transport is shutting down";
+    return false;
+  }
+  if (servers_.count(server_id) > 0) {
+    *error = "Server is already running";
+    return false;
+  }
+  EnsureReactorLocked();
+  if (!completion_port_) {
+    *error = ErrorMessage("Could not start the reactor", GetLastError());
+    return false;
+  }
+
+  HANDLE parent[3] = {INVALID_HANDLE_VALUE, INVALID_HANDLE_VALUE, INVALID_HANDLE_VALUE};
+  HANDLE child[3] = {INVALID_HANDLE_VALUE, INVALID_HANDLE_VALUE, INVALID_HANDLE_VALUE};
+  auto close_all = [&parent, &child] {
+    for (int kind = kStdin; kind <= kStderr; kind++) {
+      CloseValid(parent[kind]);
+      CloseValid(child[kind]);
+    }
+  };
+  const std::wstring pipe_prefix = L"\\\\.\\pipe\\flutter_mcp." +
+                                   std::to_wstring(GetCurrentProcessId()) + L"." +
+                                   std::to_wstring(next_pipe_id_++) + L".";
+  for (int kind = kStdin; kind <= kStderr; kind++) {
+    if (!CreatePipePair(pipe_prefix + std::to_wstring(kind), kind == kStdin, &parent[kind],
+                        &child[kind])) {
+      *error = ErrorMessage("Could not create pipes", GetLastError());
+      close_all();
+      return false;
+    }
+  }
+
+  // Only the three pipe ends are inherited, so servers started around the
+  // same time cannot hold each other's pipes open
+  SIZE_T list_size = 0;
+  InitializeProcThreadAttributeList(nullptr, 1, 0, &list_size);
+  std::vector<char> list_storage(list_size);
+  auto* attribute_list = reinterpret_cast<LPPROC_THREAD_ATTRIBUTE_LIST>(list_storage.data());
+  if (!InitializeProcThreadAttributeList(attribute_list, 1, 0, &list_size)) {
+    *error = ErrorMessage("Could not set up the process attributes", GetLastError());
+    close_all();
+    return false;
+  }
+  if (!UpdateProcThreadAttribute(attribute_list, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST, child,
+                                 sizeof(child), nullptr, nullptr)) {
+    *error = ErrorMessage("Could not set up the process attributes", GetLastError());
+    DeleteProcThreadAttributeList(attribute_list);
+    close_all();
+    return false;
+  }
+
+  std::wstring command_line;
+  for (const auto& argument : options.argv) {
+    AppendQuoted(Utf8ToWide(argument), &command_line);
+  }
+  std::vector<wchar_t> environment = BuildEnvironment(options.env);
+  const std::wstring directory = Utf8ToWide(options.working_directory);
+
+  STARTUPINFOEXW startup = {};
+  startup.StartupInfo.cb = sizeof(startup);
+  startup.StartupInfo.dwFlags = STARTF_USESTDHANDLES;
+  startup.StartupInfo.hStdInput = child[kStdin];
+  startup.StartupInfo.hStdOutput = child[kStdout];
+  startup.StartupInfo.hStdError = child[kStderr];
+  startup.lpAttributeList = attribute_list;
+  PROCESS_INFORMATION info = {};
+  const BOOL created = CreateProcessW(
+      nullptr, &command_line[0], nullptr, nullptr, TRUE,
+      EXTENDED_STARTUPINFO_PRESENT | CREATE_UNICODE_ENVIRONMENT | CREATE_NO_WINDOW,
+      environment.data(), directory.empty() ? nullptr : directory.c_str(),
+      &startup.StartupInfo, &info);
+  const DWORD create_error = GetLastError();
+  DeleteProcThreadAttributeList(attribute_list);
+  for (HANDLE& handle : child) {
+    CloseValid(handle);
+  }
+  if (!created) {
+    *error = ErrorMessage("Could not start " + options.argv[0], create_error);
+    close_all();
+    return false;
+  }
+  CloseHandle(info.hThread);
+
+  auto server = std::make_shared<Server>(server_id, options.framing, options.routing);
+  server->process = info.hProcess;
+  server->pid = info.dwProcessId;
+  server->stdin_handle = parent[kStdin];
+  server->stdout_handle = parent[kStdout];
+  server->stderr_handle = parent[kStderr];
+  for (HANDLE handle : parent) {
+    CreateIoCompletionPort(handle, completion_port_, kIoKey, 0);
+  }
+  StartRead(server.get(), kStdout);
+  StartRead(server.get(), kStderr);
+  servers_[server_id] = std::move(server);
+  *pid = info.dwProcessId;
+  return true;
+}
+
+bool StdioTransport::Send(const std::string& server_id, const uint8_t* data, size_t size) {
+  std::shared_ptr<Server> server;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = servers_.find(server_id);
+    if (it == servers_.end()) {
+      return false;
+    }
+    server = it->second;
+  }
+
+  std::lock_guard<std::mutex> lock(server->write_mutex);
+  if (server->stdin_handle == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  server->router.OnOutgoing(reinterpret_cast<const char*>(data), size);
+  // The overlapped write must own its bytes past this call, so this is the
+  // one copy
+  const size_t before = server->queued.size();
+  server->queued.append(FramePrefix(server->framing, size));
+  server->queued.append(reinterpret_cast<const char*>(data), size);
+  server->queued.append(FrameSuffix(server->framing));
+  pending_write_bytes_ += server->queued.size() - before;
+  return server->writing || StartWriteLocked(server.get());
+}
+
+bool StdioTransport::Close(const std::string& server_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = servers_.find(server_id);
+  if (it == servers_.end()) {
+    return false;
+  }
+  Server* server = it->second.get();
+  {
+    std::lock_guard<std::mutex> write_lock(server->write_mutex);
+    CloseStdinLocked(server);
+  }
+  if (server->terminate_at == std::chrono::steady_clock::time_point()) {
+    server->terminate_at = std::chrono::steady_clock::now() + kCloseGrace;
+  }
+  // Wakes the reactor so it starts watching the deadline
+  PostQueuedCompletionStatus(completion_port_, 0, kWakeKey, nullptr);
+  return true;
+}
+
+bool StdioTransport::ConfigureRouting(const std::string& server_id, const RoutingRules& rules) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = servers_.find(server_id);
+  if (it == servers_.end()) {
+    return false;
+  }
+  it->second->router.Configure(rules);
+  return true;
+}
+
+size_t StdioTransport::server_count() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return servers_.size();
+}
+
+size_t StdioTransport::pending_write_bytes() {
+  return pending_write_bytes_.load(std::memory_order_relaxed);
+}
+
+RoutingCounts StdioTransport::routing_counts() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  RoutingCounts counts = retired_counts_;
+  for (const auto& entry : servers_) {
+    counts += entry.second->router.counts();
+  }
+  return counts;
+}
+
+void StdioTransport::EnsureReactorLocked() {
+  if (completion_port_) {
+    return;
+  }
+  completion_port_ = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+  if (completion_port_) {
+    reactor_ = std::thread(&StdioTransport::ReactorLoop, this);
+  }
+}
+
+void StdioTransport::ReactorLoop() {
+  NativeTracer::NameThread("transport");
+  // Messages are reported once per server and stream per wakeup
+  struct Batch {
+    Server* server;
+    Stream stream;
+    RoutedBatch messages;
+  };
+
+  OVERLAPPED_ENTRY entries[kMaxEntries];
+  bool reaping = false;
+  bool cancelled = false;
+  while (true) {
+    if (stopping_) {
+      if (!cancelled) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : servers_) {
+          if (entry.second->stdout_handle != INVALID_HANDLE_VALUE) {
+            CancelIoEx(entry.second->stdout_handle, nullptr);
+          }
+          if (entry.second->stderr_handle != INVALID_HANDLE_VALUE) {
+            CancelIoEx(entry.second->stderr_handle, nullptr);
+          }
+        }
+        cancelled = true;
+      }
+      if (outstanding_ == 0) {
+        return;
+      }
+    }
+
+    ULONG count = 0;
+    if (!GetQueuedCompletionStatusEx(completion_port_, entries, kMaxEntries, &count,
+                                     reaping ? kReapPollMs : INFINITE, FALSE)) {
+      if (GetLastError() != WAIT_TIMEOUT) {
+        return;
+      }
+      count = 0;
+    }
+
+    // Framing, routing and reporting one wakeup's completions
+    TraceSpan span(TraceCategory::kTransport, "read");
+    std::vector<Batch> batches;
+    for (ULONG i = 0; i < count; i++) {
+      if (entries[i].lpCompletionKey != kIoKey || !entries[i].lpOverlapped) {
+        continue;
+      }
+      IoOp* op = CONTAINING_RECORD(entries[i].lpOverlapped, IoOp, overlapped);
+      Server* server = op->server;
+      // Internal holds the operation's NTSTATUS, zero on success
+      const bool ok = entries[i].lpOverlapped->Internal == 0;
+      const DWORD bytes = entries[i].dwNumberOfBytesTransferred;
+      if (op->kind == kStdin) {
+        FinishWrite(server, bytes, ok);
+      } else {
+        const Stream stream = op->kind == kStdout ? Stream::kStdout : Stream::kStderr;
+        auto batch = std::find_if(batches.begin(), batches.end(), [&](const Batch& candidate) {
+          return candidate.server == server && candidate.stream == stream;
+        });
+        if (batch == batches.end()) {
+          batches.push_back({server, stream, {}});
+          batch = std::prev(batches.end());
+        }
+        FinishRead(server, op->kind, bytes, ok, &batch->messages);
+      }
+      // Last, since the server may be reaped once nothing is outstanding
+      server->outstanding--;
+      outstanding_--;
+    }
+
+    if (stopping_) {
+      continue;
+    }
+    for (auto& batch : batches) {
+      if (!batch.messages.empty()) {
+        on_messages_(batch.server->id, batch.stream, batch.messages.Take());
+      }
+    }
+    reaping = ReapExited();
+  }
+}
+
+void StdioTransport::StartRead(Server* server, int kind) {
+  HANDLE& handle = kind == kStdout ? server->stdout_handle : server->stderr_handle;
+  IoOp& op = server->ops[kind];
+  ZeroMemory(&op.overlapped, sizeof(op.overlapped));
+  server->outstanding++;
+  outstanding_++;
+  if (!ReadFile(handle, op.buffer.data(), static_cast<DWORD>(op.buffer.size()), nullptr,
+                &op.overlapped) &&
+      GetLastError() != ERROR_IO_PENDING) {
+    server->outstanding--;
+    outstanding_--;
+    CloseValid(handle);
+  }
+}
+
+bool StdioTransport::FinishRead(Server* server, int kind, DWORD bytes, bool ok,
+                                RoutedBatch* batch) {
+  HANDLE& handle = kind == kStdout ? server->stdout_handle : server->stderr_handle;
+  MessageFramer& framer = kind == kStdout ? server->stdout_framer : server->stderr_framer;
+  if (ok && bytes > 0) {
+    const bool framed =
+        framer.Feed(server->ops[kind].buffer.data(), bytes,
+                    [server, kind, batch](const char* data, size_t length) {
+                      if (kind == kStdout) {
+                        server->router.Route(data, length, batch);
+                      } else {
+                        batch->Add(data, length);
+                      }
+                    });
+    if (!framed && kind == kStdout) {
+      // Nothing more from this server can be trusted to line up
+      TerminateProcess(server->process, 1);
+    }
+  }
+  if (!ok || stopping_) {
+    CloseValid(handle);
+    return false;
+  }
+  StartRead(server, kind);
+  return handle != INVALID_HANDLE_VALUE;
+}
+
+bool StdioTransport::StartWriteLocked(Server* server) {
+  if (server->in_flight.empty()) {
+    server->in_flight.swap(server->queued);
+  }
+  IoOp& op = server->ops[kStdin];
+  ZeroMemory(&op.overlapped, sizeof(op.overlapped));
+  server->outstanding++;
+  outstanding_++;
+  const DWORD size = static_cast<DWORD>((std::min)(server->in_flight.size(), kMaxWrite));
+  if (!WriteFile(server->stdin_handle, server->in_flight.data(), size, nullptr, &op.overlapped) &&
+      GetLastError() != ERROR_IO_PENDING) {
+    server->outstanding--;
+    outstanding_--;
+    pending_write_bytes_ -= server->in_flight.size();
+    server->in_flight.clear();
+    CloseStdinLocked(server);
+    return false;
+  }
+  server->writing = true;
+  return true;
+}
+
+void StdioTransport::FinishWrite(Server* server, DWORD bytes, bool ok) {
+  std::lock_guard<std::mutex> lock(server->write_mutex);
+  server->writing = false;
+  if (ok) {
+    pending_write_bytes_ -= bytes;
+    server->in_flight.erase(0, bytes);
+  }
+  if (!ok || server->stdin_handle == INVALID_HANDLE_VALUE) {
+    pending_write_bytes_ -= server->in_flight.size();
+    server->in_flight.clear();
+    CloseStdinLocked(server);
+    return;
+  }
+  if (!server->in_flight.empty() || !server->queued.empty()) {
+    StartWriteLocked(server);
+  }
+}
+
+void StdioTransport::CloseStdinLocked(Server* server) {
+  if (server->stdin_handle == INVALID_HANDLE_VALUE) {
+    return;
+  }
+  pending_write_bytes_ -= server->queued.size();
+  server->queued.clear();
+  // A write in flight completes as cancelled and gives back its buffer then
+  CancelIoEx(server->stdin_handle, nullptr);
+  CloseValid(server->stdin_handle);
+}
+
+bool StdioTransport::ReapExited() {
+  std::vector<std::pair<std::shared_ptr<Server>, int>> exited;
+  bool waiting = false;
+  const auto now = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = servers_.begin(); it != servers_.end();) {
+      Server* server = it->second.get();
+      const bool running = WaitForSingleObject(server->process, 0) == WAIT_TIMEOUT;
+      if (running && server->terminate_at != std::chrono::steady_clock::time_point()) {
+        if (now >= server->terminate_at) {
+          TerminateProcess(server->process, 1);
+        }
+        waiting = true;
+      }
+      // Output still open reports its own end
+      if (server->stdout_handle != INVALID_HANDLE_VALUE ||
+          server->stderr_handle != INVALID_HANDLE_VALUE) {
+        ++it;
+        continue;
+      }
+      if (running) {
+        waiting = true;
+        ++it;
+        continue;
+      }
+      {
+        std::lock_guard<std::mutex> write_lock(server->write_mutex);
+        CloseStdinLocked(server);
+      }
+      if (server->outstanding > 0) {
+        waiting = true;
+        ++it;
+        continue;
+      }
+      DWORD exit_code = 0;
+      GetExitCodeProcess(server->process, &exit_code);
+      retired_counts_ += server->router.counts();
+      exited.emplace_back(it->second, static_cast<int>(exit_code));
+      it = servers_.erase(it);
+    }
+  }
+  for (auto& entry : exited) {
+    CloseValid(entry.first->process);
+    on_exit_(entry.first->id, entry.second);
+  }
+  return waiting;
+}
+
+}  // namespace flutter_mcp
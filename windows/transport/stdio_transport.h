@@ -0,0 +1,154 @@
+#ifndef STDIO_TRANSPORT_H_
+#define STDIO_TRANSPORT_H_
+
+#include <windows.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "jsonrpc_router.h"
+#include "message_framer.h"
+
+namespace flutter_mcp {
+
+// Runs local MCP servers as child processes and pumps their stdio.
+//
+// Each server's stdio is a set of overlapped named pipes bound to one I/O
+// completion port. A reactor thread, started by the first Spawn, frames
+// output natively as reads complete and reports each wakeup's complete
+// messages as one batch, after a JsonRpcRouter has dropped or coalesced what
+// Dart does not need. Sends are appended to the server's write buffer;
+// one overlapped write is in flight at a time and carries everything queued
+// behind it, so a burst of sends costs a single write.
+//
+// Thread-safe. Callbacks run on the reactor thread
+class StdioTransport {
+ public:
+  struct Options {
+    // UTF-8. argv[0] is looked up the way CreateProcess does; batch files
+    // need to be run through cmd /c
+    std::vector<std::string> argv;
+    // NAME=value entries added to, or replacing, the inherited environment
+    std::vector<std::string> env;
+    // Empty to inherit the current directory
+    std::string working_directory;
+    Framing framing = Framing::kNewline;
+    // Applied to stdout; stderr lines are passed through as they are
+    RoutingRules routing;
+  };
+
+  enum class Stream { kStdout, kStderr };
+
+  // Complete messages from stdout, or complete lines from stderr
+  using MessagesCallback = std::function<void(
+      const std::string& server_id, Stream stream, std::vector<std::string>&& messages)>;
+  using ExitCallback = std::function<void(const std::string& server_id, int exit_code)>;
+
+  StdioTransport(MessagesCallback on_messages, ExitCallback on_exit);
+  // Terminates every server still running
+  ~StdioTransport();
+
+  StdioTransport(const StdioTransport&) = delete;
+  StdioTransport& operator=(const StdioTransport&) = delete;
+
+  // Starts a server under |server_id|, which must not be running already.
+  // On failure returns false and describes why in |error|
+  bool Spawn(const std::string& server_id, const Options& options, DWORD* pid,
+             std::string* error);
+
+  // Frames and queues one message. False if the server is not running or
+  // has closed its stdin
+  bool Send(const std::string& server_id, const uint8_t* data, size_t size);
+
+  // Closes the server's stdin and terminates it if it has not exited
+  // within kCloseGrace; its exit is reported through the exit callback
+  bool Close(const std::string& server_id);
+
+  // Replaces the server's routing rules. False if it is not running
+  bool ConfigureRouting(const std::string& server_id, const RoutingRules& rules);
+
+  size_t server_count();
+  // Bytes queued or in flight to servers
+  size_t pending_write_bytes();
+  // Routing totals over every server, including those that have exited
+  RoutingCounts routing_counts();
+
+  // Windows has no SIGTERM; this is how long a closed server gets to exit
+  // on its own
+  static constexpr std::chrono::milliseconds kCloseGrace{2000};
+
+ private:
+  struct Server;
+
+  // One overlapped operation; completions are mapped back through it
+  struct IoOp {
+    OVERLAPPED overlapped;
+    Server* server;
+    int kind;
+    std::vector<char> buffer;
+  };
+
+  struct Server {
+    Server(std::string id, Framing framing, const RoutingRules& routing);
+
+    const std::string id;
+    const Framing framing;
+    HANDLE process;
+    DWORD pid;
+    IoOp ops[3];
+    // Overlapped operations not yet completed; the server is kept until
+    // this drops to zero
+    std::atomic<int> outstanding;
+    // Reactor only
+    HANDLE stdout_handle;
+    HANDLE stderr_handle;
+    MessageFramer stdout_framer;
+    MessageFramer stderr_framer;
+    JsonRpcRouter router;
+    // Set by Close, zero otherwise. Guarded by |mutex_|
+    std::chrono::steady_clock::time_point terminate_at;
+
+    std::mutex write_mutex;
+    HANDLE stdin_handle;
+    bool writing;
+    std::string in_flight;
+    std::string queued;
+  };
+
+  void EnsureReactorLocked();
+  void ReactorLoop();
+  void StartRead(Server* server, int kind);
+  // Handles a finished read; false once the stream is closed
+  bool FinishRead(Server* server, int kind, DWORD bytes, bool ok,
+                  RoutedBatch* batch);
+  bool StartWriteLocked(Server* server);
+  void FinishWrite(Server* server, DWORD bytes, bool ok);
+  void CloseStdinLocked(Server* server);
+  // Reaps servers that have exited; true if some are still exiting
+  bool ReapExited();
+
+  MessagesCallback on_messages_;
+  ExitCallback on_exit_;
+
+  std::mutex mutex_;
+  std::map<std::string, std::shared_ptr<Server>> servers_;
+  RoutingCounts retired_counts_;
+  std::thread reactor_;
+  HANDLE completion_port_;
+  uint64_t next_pipe_id_;
+  std::atomic<bool> stopping_;
+  std::atomic<int> outstanding_;
+  std::atomic<size_t> pending_write_bytes_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // STDIO_TRANSPORT_H_
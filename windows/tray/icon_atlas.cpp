@@ -0,0 +1,127 @@
+#include "icon_atlas.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace flutter_mcp {
+
+namespace {
+
+constexpr BYTE kPngSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+constexpr size_t kIconDirSize = 6;
+constexpr size_t kIconDirEntrySize = 16;
+constexpr DWORD kIconVersion = 0x00030000;
+
+uint16_t ReadU16(const BYTE* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t ReadU32(const BYTE* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+}  // namespace
+
+IconAtlas::IconAtlas() : icon_size_(GetSystemMetrics(SM_CXSMICON)) {
+  if (icon_size_ <= 0) {
+    icon_size_ = 16;
+  }
+}
+
+IconAtlas::~IconAtlas() {
+  for (auto& entry : icons_) {
+    DestroyIcon(entry.second);
+  }
+}
+
+bool IconAtlas::AddFromFile(const std::string& name, const std::wstring& path) {
+  HICON icon = static_cast<HICON>(LoadImage(nullptr, path.c_str(), IMAGE_ICON,
+                                            icon_size_, icon_size_, LR_LOADFROMFILE));
+  if (!icon) {
+    return false;
+  }
+  Store(name, icon);
+  return true;
+}
+
+bool IconAtlas::AddFromBytes(const std::string& name, const BYTE* data, size_t length) {
+  HICON icon = DecodeIcon(data, length, icon_size_);
+  if (!icon) {
+    return false;
+  }
+  Store(name, icon);
+  return true;
+}
+
+HICON IconAtlas::Find(const std::string& name) const {
+  auto it = icons_.find(name);
+  return it != icons_.end() ? it->second : nullptr;
+}
+
+void IconAtlas::Store(const std::string& name, HICON icon) {
+  auto it = icons_.find(name);
+  if (it != icons_.end()) {
+    DestroyIcon(it->second);
+    it->second = icon;
+  } else {
+    icons_.emplace(name, icon);
+  }
+}
+
+// static
+HICON IconAtlas::DecodeIcon(const BYTE* data, size_t length, int size) {
+  if (!data || length == 0 || length > MAXDWORD) {
+    return nullptr;
+  }
+
+  // A bare PNG is accepted as an icon image as is
+  if (length >= sizeof(kPngSignature) &&
+      memcmp(data, kPngSignature, sizeof(kPngSignature)) == 0) {
+    return CreateIconFromResourceEx(const_cast<PBYTE>(data), static_cast<DWORD>(length),
+                                    TRUE, kIconVersion, size, size, LR_DEFAULTCOLOR);
+  }
+
+  // Otherwise expect an .ico file: a directory of images, of which the one
+  // nearest |size| is used
+  if (length < kIconDirSize || ReadU16(data) != 0 || ReadU16(data + 2) != 1) {
+    return nullptr;
+  }
+  const uint16_t count = ReadU16(data + 4);
+  if (count == 0 || length < kIconDirSize + count * kIconDirEntrySize) {
+    return nullptr;
+  }
+
+  const BYTE* best = nullptr;
+  int best_distance = 0;
+  int best_depth = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    const BYTE* entry = data + kIconDirSize + i * kIconDirEntrySize;
+    // A stored 0 means 256 pixels
+    const int width = entry[0] != 0 ? entry[0] : 256;
+    const int depth = ReadU16(entry + 6);
+    const uint32_t image_size = ReadU32(entry + 8);
+    const uint32_t image_offset = ReadU32(entry + 12);
+    if (image_offset > length || image_size > length - image_offset) {
+      continue;
+    }
+    const int distance = std::abs(width - size);
+    if (!best || distance < best_distance ||
+        (distance == best_distance && depth > best_depth)) {
+      best = entry;
+      best_distance = distance;
+      best_depth = depth;
+    }
+  }
+  if (!best) {
+    return nullptr;
+  }
+
+  const uint32_t image_size = ReadU32(best + 8);
+  const uint32_t image_offset = ReadU32(best + 12);
+  return CreateIconFromResourceEx(const_cast<PBYTE>(data + image_offset), image_size,
+                                  TRUE, kIconVersion, size, size, LR_DEFAULTCOLOR);
+}
+
+}  // namespace flutter_mcp
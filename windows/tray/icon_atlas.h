@@ -0,0 +1,47 @@
+#ifndef ICON_ATLAS_H_
+#define ICON_ATLAS_H_
+
+#include <windows.h>
+
+#include <string>
+#include <unordered_map>
+
+namespace flutter_mcp {
+
+// Tray icons decoded once and kept by name, so switching icons is just a
+// handle swap.
+//
+// Icons come from .ico files on disk or from PNG/ICO bytes in memory; the
+// image closest to the small-icon size is picked. The atlas owns every
+// handle it hands out. Not thread-safe.
+class IconAtlas {
+ public:
+  IconAtlas();
+  ~IconAtlas();
+
+  IconAtlas(const IconAtlas&) = delete;
+  IconAtlas& operator=(const IconAtlas&) = delete;
+
+  // Decodes and stores an icon under |name|, replacing any icon already
+  // there. Returns false if the source could not be decoded.
+  bool AddFromFile(const std::string& name, const std::wstring& path);
+  bool AddFromBytes(const std::string& name, const BYTE* data, size_t length);
+
+  // nullptr if nothing is stored under |name|
+  HICON Find(const std::string& name) const;
+  size_t size() const { return icons_.size(); }
+
+  // Decodes a PNG or an ICO file image held in memory. The caller owns the
+  // returned icon.
+  static HICON DecodeIcon(const BYTE* data, size_t length, int size);
+
+ private:
+  void Store(const std::string& name, HICON icon);
+
+  int icon_size_;
+  std::unordered_map<std::string, HICON> icons_;
+};
+
+}  // namespace flutter_mcp
+
+#endif  // ICON_ATLAS_H_
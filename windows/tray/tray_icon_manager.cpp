@@ -1,12 +1,18 @@
 #include "tray_icon_manager.h"
 #include <strsafe.h>
 
+#include <algorithm>
+
+#include "native_trace.h"
+
 namespace flutter_mcp {
 
 TrayIconManager* TrayIconManager::instance_ = nullptr;
 
 TrayIconManager::TrayIconManager(flutter::FlutterView* view)
-    : flutter_view_(view), window_handle_(nullptr), context_menu_(nullptr), is_visible_(false) {
+    : flutter_view_(view), window_handle_(nullptr), context_menu_(nullptr), is_visible_(false),
+      next_command_id_(MENU_ITEM_BASE_ID) {
+  ZeroMemory(&nid_, sizeof(NOTIFYICONDATA));
   instance_ = this;
   CreateTrayWindow();
 }
@@ -51,24 +57,49 @@ void TrayIconManager::DestroyTrayWindow() {
   UnregisterClass(L"FlutterMCPTrayWindow", GetModuleHandle(nullptr));
 }
 
-void TrayIconManager::ShowTrayIcon(const std::wstring& icon_path, const std::wstring& tooltip) {
+namespace {
+
+// Atlas key under which an icon file named by path is cached
+std::string PathIconName(const std::wstring& path) {
+  int length = WideCharToMultiByte(CP_UTF8, 0, path.c_str(), static_cast<int>(path.size()),
+                                   nullptr, 0, nullptr, nullptr);
+  std::string name(length, '\0');
+  WideCharToMultiByte(CP_UTF8, 0, path.c_str(), static_cast<int>(path.size()),
+                      name.data(), length, nullptr, nullptr);
+  return "\x1f" + name;
+}
+
+}  // namespace
+
+void TrayIconManager::ShowTrayIcon(const std::wstring& icon_path, const std::string& icon_name,
+                                   const std::wstring& tooltip) {
   if (!window_handle_) return;
 
-  ZeroMemory(&nid_, sizeof(NOTIFYICONDATA));
   nid_.cbSize = sizeof(NOTIFYICONDATA);
   nid_.hWnd = window_handle_;
   nid_.uID = TRAY_ICON_ID;
   nid_.uFlags = NIF_MESSAGE | NIF_ICON | NIF_TIP;
   nid_.uCallbackMessage = WM_TRAYICON;
 
-  // Load icon
-  if (!icon_path.empty()) {
-    nid_.hIcon = (HICON)LoadImage(nullptr, icon_path.c_str(), IMAGE_ICON, 16, 16, LR_LOADFROMFILE);
+  // Resolve the icon through the atlas; a file is read only the first time
+  HICON icon = nullptr;
+  if (!icon_name.empty()) {
+    icon = icons_.Find(icon_name);
+    current_icon_ = icon_name;
+  } else if (!icon_path.empty()) {
+    const std::string path_name = PathIconName(icon_path);
+    icon = icons_.Find(path_name);
+    if (!icon && icons_.AddFromFile(path_name, icon_path)) {
+      icon = icons_.Find(path_name);
+    }
+    current_icon_ = path_name;
   }
-  if (!nid_.hIcon) {
+  if (!icon) {
     // Use default application icon
-    nid_.hIcon = LoadIcon(nullptr, IDI_APPLICATION);
+    icon = LoadIcon(nullptr, IDI_APPLICATION);
+    current_icon_.clear();
   }
+  nid_.hIcon = icon;
 
   // Set tooltip
   if (!tooltip.empty()) {
@@ -87,15 +118,46 @@ void TrayIconManager::ShowTrayIcon(const std::wstring& icon_path, const std::wst
 }
 
 void TrayIconManager::HideTrayIcon() {
+  // The icon stays in the atlas for the next ShowTrayIcon
   if (is_visible_ && window_handle_) {
     Shell_NotifyIcon(NIM_DELETE, &nid_);
     is_visible_ = false;
   }
-  
-  if (nid_.hIcon && nid_.hIcon != LoadIcon(nullptr, IDI_APPLICATION)) {
-    DestroyIcon(nid_.hIcon);
+}
+
+bool TrayIconManager::RegisterIcon(const std::string& name, const std::wstring& path) {
+  return icons_.AddFromFile(name, path) && RefreshIcon(name);
+}
+
+bool TrayIconManager::RegisterIcon(const std::string& name, const BYTE* data, size_t length) {
+  return icons_.AddFromBytes(name, data, length) && RefreshIcon(name);
+}
+
+bool TrayIconManager::SetIcon(const std::string& name) {
+  HICON icon = icons_.Find(name);
+  if (!icon) {
+    return false;
+  }
+
+  current_icon_ = name;
+  if (nid_.hIcon == icon) {
+    return true;
+  }
+  nid_.hIcon = icon;
+  if (is_visible_ && window_handle_) {
+    nid_.uFlags = NIF_ICON;
+    Shell_NotifyIcon(NIM_MODIFY, &nid_);
+  }
+  return true;
+}
+
+bool TrayIconManager::RefreshIcon(const std::string& name) {
+  // Re-registering the icon on screen destroyed the handle it was showing
+  if (name == current_icon_) {
     nid_.hIcon = nullptr;
+    SetIcon(name);
   }
+  return true;
 }
 
 void TrayIconManager::UpdateTooltip(const std::wstring& tooltip) {
@@ -107,32 +169,128 @@ void TrayIconManager::UpdateTooltip(const std::wstring& tooltip) {
 }
 
 void TrayIconManager::SetMenuItems(const std::vector<TrayMenuItem>& items,
-                                   std::function<void(const std::string&)> callback) {
-  menu_items_ = items;
+                                   std::function<void(const std::string&)> callback,
+                                   bool rebuild) {
+  TraceSpan span(TraceCategory::kTray, "applyMenu");
   menu_callback_ = callback;
 
-  // Destroy old menu
+  if (!context_menu_ || rebuild) {
+    menu_items_ = items;
+    RebuildMenu();
+    return;
+  }
+
+  // Apply only what changed so an open menu does not flicker and unchanged
+  // entries keep their command ids
+  for (const auto& op : DiffTrayMenu(menu_items_, items)) {
+    switch (op.kind) {
+      case TrayMenuOp::Kind::kInsert: {
+        const UINT command_id = AllocateCommandId();
+        menu_items_.insert(menu_items_.begin() + op.index, *op.item);
+        command_ids_.insert(command_ids_.begin() + op.index, command_id);
+        InsertMenuEntry(op.index, *op.item, command_id);
+        break;
+      }
+      case TrayMenuOp::Kind::kRemove:
+        DeleteMenu(context_menu_, static_cast<UINT>(op.index), MF_BYPOSITION);
+        menu_items_.erase(menu_items_.begin() + op.index);
+        command_ids_.erase(command_ids_.begin() + op.index);
+        break;
+      case TrayMenuOp::Kind::kMove: {
+        // Win32 menus have no reorder; re-insert the entry under its old id
+        TrayMenuItem moved = menu_items_[op.from];
+        UINT command_id = command_ids_[op.from];
+        DeleteMenu(context_menu_, static_cast<UINT>(op.from), MF_BYPOSITION);
+        menu_items_.erase(menu_items_.begin() + op.from);
+        command_ids_.erase(command_ids_.begin() + op.from);
+        menu_items_.insert(menu_items_.begin() + op.index, moved);
+        command_ids_.insert(command_ids_.begin() + op.index, command_id);
+        InsertMenuEntry(op.index, moved, command_id);
+        break;
+      }
+      case TrayMenuOp::Kind::kUpdate:
+        menu_items_[op.index].label = op.item->label;
+        menu_items_[op.index].disabled = op.item->disabled;
+        UpdateMenuEntry(op.index, menu_items_[op.index]);
+        break;
+    }
+  }
+}
+
+bool TrayIconManager::UpdateMenuItem(const std::string& id, const std::string* label,
+                                     const bool* disabled) {
+  auto it = std::find_if(menu_items_.begin(), menu_items_.end(),
+                         [&id](const TrayMenuItem& item) {
+                           return !item.is_separator && item.id == id;
+                         });
+  if (it == menu_items_.end() || !context_menu_) {
+    return false;
+  }
+
+  if (label) {
+    it->label = *label;
+  }
+  if (disabled) {
+    it->disabled = *disabled;
+  }
+  UpdateMenuEntry(static_cast<size_t>(it - menu_items_.begin()), *it);
+  return true;
+}
+
+void TrayIconManager::RebuildMenu() {
   if (context_menu_) {
     DestroyMenu(context_menu_);
   }
 
-  // Create new menu
   context_menu_ = CreatePopupMenu();
-  int menu_id = MENU_ITEM_BASE_ID;
-
-  for (const auto& item : menu_items_) {
-    if (item.is_separator) {
-      AppendMenu(context_menu_, MF_SEPARATOR, 0, nullptr);
-    } else {
-      UINT flags = MF_STRING;
-      if (item.disabled) {
-        flags |= MF_GRAYED;
-      }
-      
-      std::wstring wide_label(item.label.begin(), item.label.end());
-      AppendMenu(context_menu_, flags, menu_id++, wide_label.c_str());
+  command_ids_.clear();
+  next_command_id_ = MENU_ITEM_BASE_ID;
+  for (size_t i = 0; i < menu_items_.size(); i++) {
+    const UINT command_id = AllocateCommandId();
+    command_ids_.push_back(command_id);
+    InsertMenuEntry(i, menu_items_[i], command_id);
+  }
+}
+
+UINT TrayIconManager::AllocateCommandId() {
+  // WM_COMMAND carries 16 bits of id; wrap around, skipping ids still in use
+  do {
+    if (next_command_id_ > 0xFFFF) {
+      next_command_id_ = MENU_ITEM_BASE_ID;
     }
+  } while (std::find(command_ids_.begin(), command_ids_.end(), next_command_id_++) !=
+           command_ids_.end());
+  return next_command_id_ - 1;
+}
+
+void TrayIconManager::InsertMenuEntry(size_t index, const TrayMenuItem& item,
+                                      UINT command_id) {
+  std::wstring wide_label(item.label.begin(), item.label.end());
+
+  MENUITEMINFO info = {0};
+  info.cbSize = sizeof(MENUITEMINFO);
+  info.fMask = MIIM_FTYPE | MIIM_ID;
+  info.wID = command_id;
+  if (item.is_separator) {
+    info.fType = MFT_SEPARATOR;
+  } else {
+    info.fMask |= MIIM_STRING | MIIM_STATE;
+    info.fType = MFT_STRING;
+    info.fState = item.disabled ? MFS_GRAYED : MFS_ENABLED;
+    info.dwTypeData = const_cast<wchar_t*>(wide_label.c_str());
   }
+  InsertMenuItem(context_menu_, static_cast<UINT>(index), TRUE, &info);
+}
+
+void TrayIconManager::UpdateMenuEntry(size_t index, const TrayMenuItem& item) {
+  std::wstring wide_label(item.label.begin(), item.label.end());
+
+  MENUITEMINFO info = {0};
+  info.cbSize = sizeof(MENUITEMINFO);
+  info.fMask = MIIM_STRING | MIIM_STATE;
+  info.fState = item.disabled ? MFS_GRAYED : MFS_ENABLED;
+  info.dwTypeData = const_cast<wchar_t*>(wide_label.c_str());
+  SetMenuItemInfo(context_menu_, static_cast<UINT>(index), TRUE, &info);
 }
 
 void TrayIconManager::ShowContextMenu() {
@@ -171,15 +329,17 @@ LRESULT CALLBACK TrayIconManager::WindowProc(HWND hwnd, UINT msg, WPARAM wparam,
       }
       return 0;
 
-    case WM_COMMAND:
-      if (wparam >= MENU_ITEM_BASE_ID && 
-          wparam < MENU_ITEM_BASE_ID + instance_->menu_items_.size()) {
-        int index = wparam - MENU_ITEM_BASE_ID;
-        if (instance_->menu_callback_ && !instance_->menu_items_[index].is_separator) {
-          instance_->menu_callback_(instance_->menu_items_[index].id);
+    case WM_COMMAND: {
+      const auto& ids = instance_->command_ids_;
+      auto it = std::find(ids.begin(), ids.end(), static_cast<UINT>(LOWORD(wparam)));
+      if (it != ids.end()) {
+        const auto& item = instance_->menu_items_[it - ids.begin()];
+        if (instance_->menu_callback_ && !item.is_separator) {
+          instance_->menu_callback_(item.id);
         }
       }
       return 0;
+    }
 
     default:
       return DefWindowProc(hwnd, msg, wparam, lparam);
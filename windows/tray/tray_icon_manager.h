@@ -9,32 +9,50 @@
 #include <vector>
 #include <memory>
 
-namespace flutter_mcp {
+#include "icon_atlas.h"
+#include "tray_menu_diff.h"
 
-struct TrayMenuItem {
-  std::string id;
-  std::string label;
-  bool is_separator = false;
-  bool disabled = false;
-};
+namespace flutter_mcp {
 
 class TrayIconManager {
  public:
   explicit TrayIconManager(flutter::FlutterView* view);
   ~TrayIconManager();
 
-  void ShowTrayIcon(const std::wstring& icon_path, const std::wstring& tooltip);
+  // Shows the icon registered as |icon_name|, else the one at |icon_path|,
+  // else the application icon. Icon files are decoded once and cached.
+  void ShowTrayIcon(const std::wstring& icon_path, const std::string& icon_name,
+                    const std::wstring& tooltip);
   void HideTrayIcon();
   void UpdateTooltip(const std::wstring& tooltip);
+
+  // Preloads an icon under |name| for SetIcon. Returns false if it could not
+  // be decoded.
+  bool RegisterIcon(const std::string& name, const std::wstring& path);
+  bool RegisterIcon(const std::string& name, const BYTE* data, size_t length);
+  // Switches to a registered icon. Returns false if |name| is unknown.
+  bool SetIcon(const std::string& name);
+  // Edits the existing menu in place to match |items| unless |rebuild| is
+  // set or there is no menu yet.
   void SetMenuItems(const std::vector<TrayMenuItem>& items,
-                    std::function<void(const std::string&)> callback);
+                    std::function<void(const std::string&)> callback,
+                    bool rebuild = false);
+  // Changes the label and/or enabled state of the item with |id|. Returns
+  // false if there is no such item.
+  bool UpdateMenuItem(const std::string& id, const std::string* label,
+                      const bool* disabled);
 
  private:
   static LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam);
   void CreateTrayWindow();
   void DestroyTrayWindow();
   void ShowContextMenu();
-  
+  bool RefreshIcon(const std::string& name);
+  void RebuildMenu();
+  UINT AllocateCommandId();
+  void InsertMenuEntry(size_t index, const TrayMenuItem& item, UINT command_id);
+  void UpdateMenuEntry(size_t index, const TrayMenuItem& item);
+
   static constexpr UINT WM_TRAYICON = WM_APP + 1;
   static constexpr UINT TRAY_ICON_ID = 1001;
   static constexpr UINT MENU_ITEM_BASE_ID = 2000;
@@ -44,7 +62,14 @@ class TrayIconManager {
   HMENU context_menu_;
   flutter::FlutterView* flutter_view_;
   bool is_visible_;
+  // Owns every icon shown except the shared application icon
+  IconAtlas icons_;
+  std::string current_icon_;
   std::vector<TrayMenuItem> menu_items_;
+  // Command id of each entry in |menu_items_|; an entry keeps its id across
+  // updates so a click is never attributed to the wrong item
+  std::vector<UINT> command_ids_;
+  UINT next_command_id_;
   std::function<void(const std::string&)> menu_callback_;
   static TrayIconManager* instance_;
 };